@@ -0,0 +1,424 @@
+/*
+ * Copyright © 2026 glview contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+// glviewのベンチマーク
+// headlessバックエンドのウインドウで以下の処理を計測する
+//   dispatch : 別スレッドからglvOnUserMsg()で送信し、userMsgハンドラが呼ばれるまでの遅延
+//   font     : glvFont_DrawUTF8String()によるUTF-8文字列の描画(frame time)
+//   gl       : glvGl_*の図形描画(frame time)
+//   sheet    : ウィジェットを多数配置したシートの再描画(frame time)
+// frame timeはendDraw(スワップ完了)の間隔とする
+//
+// usage: bench_glview [-n 回数] [-b baseline] [-t tolerance%] [-w output] dispatch|font|gl|sheet
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "glview.h"
+#include "glv_bench.h"
+
+#define BENCH_WINDOW_WIDTH		(800)
+#define BENCH_WINDOW_HEIGHT		(600)
+
+#define BENCH_DISPATCH_KIND		(1)
+#define BENCH_FONT_LINES		(24)
+#define BENCH_GL_RECTANGLES		(1000)
+#define BENCH_GL_LINES			(500)
+#define BENCH_GL_CIRCLES		(100)
+#define BENCH_SHEET_COLUMNS		(6)
+#define BENCH_SHEET_ROWS		(12)
+#define BENCH_SHEET_WIGETS		(BENCH_SHEET_COLUMNS * BENCH_SHEET_ROWS)
+
+typedef enum _bench_workload {
+	BENCH_WORKLOAD_DISPATCH,
+	BENCH_WORKLOAD_FONT,
+	BENCH_WORKLOAD_GL,
+	BENCH_WORKLOAD_SHEET,
+} BENCH_WORKLOAD_e;
+
+static const char *bench_font_text[] = {
+	"The quick brown fox jumps over the lazy dog 0123456789",
+	"日本語の文字列描画のベンチマークです。漢字、ひらがな、カタカナ",
+	"glview: Wayland/OpenGL GUI toolkit ABCDEFGHIJKLMNOPQRSTUVWXYZ",
+	"メニュー(M) ファイル(F) 編集(E) 表示(V) 移動(G) ヘルプ(H)",
+};
+#define BENCH_FONT_TEXT_NUM	((int)(sizeof(bench_font_text) / sizeof(bench_font_text[0])))
+
+static BENCH_WORKLOAD_e	bench_workload;
+static GLV_BENCH_t		bench;
+static int				bench_count;
+static int				bench_frame;
+static double			bench_chars;			// 1フレームで描画する文字数
+static glvWindow		bench_window = NULL;
+static glvSheet			bench_sheet = NULL;
+static glvWiget			bench_wiget[BENCH_SHEET_WIGETS];
+static pthread_t		bench_sender;
+static int				bench_sender_run = 0;
+
+static int bench_utf8_length(const char *str)
+{
+	int n = 0;
+	while (*str != '\0') {
+		if ((*str & 0xc0) != 0x80) n++;
+		str++;
+	}
+	return (n);
+}
+
+// 計測が終了したらイベントループを抜ける
+static void bench_done(glvWindow glv_win)
+{
+	glvBench_stop(&bench);
+	glvEscapeEventLoop(glv_win);
+}
+
+static void bench_next_frame(glvWindow glv_win)
+{
+	if (bench_frame == 0) {
+		// 最初のフレームは初期化(フォントのキャッシュ等)を含むため計測から除く
+		glvBench_start(&bench);
+	} else {
+		glvBench_frame(&bench);
+	}
+	bench_frame++;
+	if (bench_frame > bench_count) {
+		bench_done(glv_win);
+		return;
+	}
+	glvOnReDraw(glv_win);
+}
+
+// ------------------------------------------------------------------------------------------------
+// dispatch
+static void *bench_dispatch_sender(void *arg)
+{
+	glvWindow glv_win = arg;
+	struct timespec ts;
+	struct timespec interval = {0, 20000};	// 受信側が待機状態に入るように間隔をあける
+	int i;
+
+	for (i = 0; i < bench_count; i++) {
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		glvOnUserMsg(glv_win, BENCH_DISPATCH_KIND, &ts, sizeof(ts));
+		nanosleep(&interval, NULL);
+	}
+	return (NULL);
+}
+
+static int bench_window_userMsg(glvWindow glv_win, int kind, void *data)
+{
+	struct timespec *sent = data;
+	struct timespec ts;
+
+	if (kind != BENCH_DISPATCH_KIND) return (GLV_OK);
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	glvBench_sample(&bench, (double)(ts.tv_sec - sent->tv_sec) * 1000.0
+							+ (double)(ts.tv_nsec - sent->tv_nsec) / 1000000.0);
+	glvBench_addItems(&bench, 1);
+	if (bench.count >= bench_count) {
+		bench_done(glv_win);
+	}
+	return (GLV_OK);
+}
+
+// ------------------------------------------------------------------------------------------------
+// font
+static void bench_draw_font(void)
+{
+	int i;
+
+	glvFont_SetStyle(GLV_FONT_NAME_NORMAL, 20, 0.0f, 0, GLV_FONT_NAME | GLV_FONT_NOMAL | GLV_FONT_SIZE | GLV_FONT_LEFT);
+	glvFont_setColor4i(0, 0, 0, 255);
+	glvFont_SetBkgdColor4i(255, 255, 255, 255);
+	for (i = 0; i < BENCH_FONT_LINES; i++) {
+		glvFont_SetPosition(4, i * 24);
+		glvFont_DrawUTF8String((char *)bench_font_text[(i + bench_frame) % BENCH_FONT_TEXT_NUM]);
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+// gl
+static void bench_draw_gl(void)
+{
+	GLV_T_POINT_t line[2];
+	GLV_T_POINT_t center;
+	int i;
+
+	for (i = 0; i < BENCH_GL_RECTANGLES; i++) {
+		glvGl_ColorRGBA(GLV_SET_RGBA(i * 7, i * 13, i * 29, 255));
+		glvGl_drawRectangle((float)((i * 37 + bench_frame) % BENCH_WINDOW_WIDTH), (float)((i * 53) % BENCH_WINDOW_HEIGHT), 20.0f, 12.0f);
+	}
+	glvGl_ColorRGBA(GLV_SET_RGBA(0, 0, 255, 255));
+	for (i = 0; i < BENCH_GL_LINES; i++) {
+		line[0].x = (float)((i * 11) % BENCH_WINDOW_WIDTH);
+		line[0].y = (float)((i * 17 + bench_frame) % BENCH_WINDOW_HEIGHT);
+		line[1].x = line[0].x + 40.0f;
+		line[1].y = line[0].y + 25.0f;
+		glvGl_drawLines(line, 2, 2.0f);
+	}
+	glvGl_ColorRGBA(GLV_SET_RGBA(255, 0, 0, 255));
+	for (i = 0; i < BENCH_GL_CIRCLES; i++) {
+		center.x = (float)((i * 71 + bench_frame) % BENCH_WINDOW_WIDTH);
+		center.y = (float)((i * 43) % BENCH_WINDOW_HEIGHT);
+		glvGl_drawCircleFill(&center, 10.0f, 16);
+	}
+	glvGl_FlushBatch();
+}
+
+// ------------------------------------------------------------------------------------------------
+// sheet
+static int bench_sheet_init(glvWindow glv_win, glvSheet sheet, int window_width, int window_height)
+{
+	const struct glv_wiget_listener *listener;
+	GLV_WIGET_GEOMETRY_t geometry;
+	int i;
+
+	for (i = 0; i < BENCH_SHEET_WIGETS; i++) {
+		switch (i % 3) {
+		case 0:
+			listener = wiget_textOutput_listener;
+			break;
+		case 1:
+			listener = wiget_sliderBar_listener;
+			break;
+		default:
+			listener = wiget_checkBox_listener;
+			break;
+		}
+		bench_wiget[i] = glvCreateWiget(sheet, listener, GLV_WIGET_ATTR_NO_OPTIONS);
+		switch (i % 3) {
+		case 0:
+			glv_setValue(bench_wiget[i], "text", "S", "テキスト text");
+			break;
+		case 1:
+			glv_setValue(bench_wiget[i], "params", "ii", 0, 99);
+			glv_setValue(bench_wiget[i], "position", "i", i);
+			break;
+		default:
+			glv_setValue(bench_wiget[i], "check", "i", i & 1);
+			break;
+		}
+		memset(&geometry, 0, sizeof(geometry));
+		geometry.scale	= 1.0;
+		geometry.width	= (window_width / BENCH_SHEET_COLUMNS) - 10;
+		geometry.height	= 30;
+		if ((i % 3) == 2) {
+			geometry.width = 20;
+			geometry.height = 20;
+		}
+		geometry.x		= (i % BENCH_SHEET_COLUMNS) * (window_width / BENCH_SHEET_COLUMNS) + 5;
+		geometry.y		= (i / BENCH_SHEET_COLUMNS) * (window_height / BENCH_SHEET_ROWS) + 5;
+		glvWiget_setWigetGeometry(bench_wiget[i], &geometry);
+		glvWiget_setWigetVisible(bench_wiget[i], GLV_VISIBLE);
+	}
+	return (GLV_OK);
+}
+
+static int bench_sheet_redraw(glvWindow glv_win, glvSheet sheet, int drawStat)
+{
+	char text[32];
+	int i;
+
+	// 毎フレームすべてのウィジェットの値を変更する
+	for (i = 0; i < BENCH_SHEET_WIGETS; i++) {
+		switch (i % 3) {
+		case 0:
+			snprintf(text, sizeof(text), "frame %d", bench_frame + i);
+			glv_setValue(bench_wiget[i], "text", "S", text);
+			break;
+		case 1:
+			glv_setValue(bench_wiget[i], "position", "i", (bench_frame + i) % 100);
+			break;
+		default:
+			glv_setValue(bench_wiget[i], "check", "i", (bench_frame + i) & 1);
+			break;
+		}
+	}
+	glvSheet_reqDrawWigets(sheet);
+	glvSheet_reqSwapBuffers(sheet);
+	return (GLV_OK);
+}
+
+static const struct glv_sheet_listener _bench_sheet_listener = {
+	.init			= bench_sheet_init,
+	.redraw			= bench_sheet_redraw,
+	.update			= bench_sheet_redraw,
+};
+static const struct glv_sheet_listener *bench_sheet_listener = &_bench_sheet_listener;
+
+// ------------------------------------------------------------------------------------------------
+static int bench_window_init(glvWindow glv_win, int width, int height)
+{
+	glvGl_init();
+	glvWindow_setViewport(glv_win, width, height);
+
+	switch (bench_workload) {
+	case BENCH_WORKLOAD_DISPATCH:
+		glvBench_start(&bench);
+		if (pthread_create(&bench_sender, NULL, bench_dispatch_sender, glv_win) == 0) {
+			bench_sender_run = 1;
+		} else {
+			fprintf(stderr, "bench_glview:Error: pthread_create() failed\n");
+			bench_done(glv_win);
+		}
+		break;
+	case BENCH_WORKLOAD_SHEET:
+		bench_sheet = glvCreateSheet(glv_win, bench_sheet_listener, "bench sheet");
+		glvWindow_activeSheet(glv_win, bench_sheet);
+		break;
+	default:
+		break;
+	}
+	return (GLV_OK);
+}
+
+static int bench_window_reshape(glvWindow glv_win, int width, int height)
+{
+	glvWindow_setViewport(glv_win, width, height);
+	return (GLV_OK);
+}
+
+static int bench_window_redraw(glvWindow glv_win, int drawStat)
+{
+	glClearColor(1.0, 1.0, 1.0, 1.0);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	switch (bench_workload) {
+	case BENCH_WORKLOAD_FONT:
+		bench_draw_font();
+		glvBench_addItems(&bench, bench_chars);
+		break;
+	case BENCH_WORKLOAD_GL:
+		bench_draw_gl();
+		glvBench_addItems(&bench, BENCH_GL_RECTANGLES + BENCH_GL_LINES + BENCH_GL_CIRCLES);
+		break;
+	default:
+		break;
+	}
+	glvReqSwapBuffers(glv_win);
+	return (GLV_OK);
+}
+
+static int bench_window_endDraw(glvWindow glv_win, glvTime time)
+{
+	if (bench_workload != BENCH_WORKLOAD_DISPATCH) {
+		bench_next_frame(glv_win);
+	}
+	return (GLV_OK);
+}
+
+static const struct glv_window_listener _bench_window_listener = {
+	.init			= bench_window_init,
+	.reshape		= bench_window_reshape,
+	.redraw			= bench_window_redraw,
+	.update			= bench_window_redraw,
+	.userMsg		= bench_window_userMsg,
+	.endDraw		= bench_window_endDraw,
+};
+static const struct glv_window_listener *bench_window_listener = &_bench_window_listener;
+
+static int bench_frame_start(glvWindow frame_window, int width, int height)
+{
+	bench_window = glvCreateWindow(frame_window, bench_window_listener, "bench", 0, 0, width, height, GLV_WINDOW_ATTR_DEFAULT, NULL);
+	if (bench_workload != BENCH_WORKLOAD_DISPATCH) {
+		glvOnReDraw(bench_window);
+	}
+	return (GLV_OK);
+}
+
+static const struct glv_frame_listener _bench_frame_listener = {
+	.start	= bench_frame_start,
+};
+static const struct glv_frame_listener *bench_frame_listener = &_bench_frame_listener;
+
+int main(int argc, char *argv[])
+{
+	GLV_BENCH_OPTION_t option;
+	glvDisplay glv_dpy;
+	glvWindow frame_window = NULL;
+	const char *name;
+	int rateType = GLV_BENCH_RATE_FPS;
+	int arg, i, rc;
+
+	arg = glvBench_parseOption(argc, argv, &option);
+	if ((arg < 0) || (arg >= argc)) {
+		fprintf(stderr, "usage: %s [-n count] [-b baseline] [-t tolerance%%] [-w output] dispatch|font|gl|sheet\n", argv[0]);
+		return (2);
+	}
+	if (strcmp(argv[arg], "dispatch") == 0) {
+		bench_workload = BENCH_WORKLOAD_DISPATCH;
+		name = "glview_dispatch";
+		rateType = GLV_BENCH_RATE_ITEMS;
+		bench_count = 10000;
+	} else if (strcmp(argv[arg], "font") == 0) {
+		bench_workload = BENCH_WORKLOAD_FONT;
+		name = "glview_font";
+		bench_count = 300;
+	} else if (strcmp(argv[arg], "gl") == 0) {
+		bench_workload = BENCH_WORKLOAD_GL;
+		name = "glview_gl";
+		bench_count = 300;
+	} else if (strcmp(argv[arg], "sheet") == 0) {
+		bench_workload = BENCH_WORKLOAD_SHEET;
+		name = "glview_sheet";
+		bench_count = 300;
+	} else {
+		fprintf(stderr, "bench_glview:Error: unknown workload [%s]\n", argv[arg]);
+		return (2);
+	}
+	if (option.count > 0) bench_count = option.count;
+
+	bench_chars = 0.0;
+	for (i = 0; i < BENCH_FONT_LINES; i++) {
+		bench_chars += bench_utf8_length(bench_font_text[i % BENCH_FONT_TEXT_NUM]);
+	}
+
+	if (glvBench_init(&bench, name, rateType, bench_count) != 0) return (2);
+
+	glv_dpy = glvOpenDisplay(GLV_HEADLESS_DISPLAY_NAME);
+	if (!glv_dpy) {
+		fprintf(stderr, "bench_glview:Error: glvOpenDisplay() failed\n");
+		glvBench_finish(&bench);
+		return (2);
+	}
+
+	frame_window = glvCreateFrameWindow(glv_dpy, bench_frame_listener, "frame", "bench", BENCH_WINDOW_WIDTH, BENCH_WINDOW_HEIGHT, NULL);
+
+	/* ----------------------------------------------------------------------------------------------- */
+	glvEnterEventLoop(glv_dpy);		// event loop
+	/* ----------------------------------------------------------------------------------------------- */
+
+	if (bench_sender_run == 1) {
+		pthread_join(bench_sender, NULL);
+	}
+	glvDestroyWindow(&bench_window);
+	glvDestroyWindow(&frame_window);
+	glvCloseDisplay(glv_dpy);
+
+	rc = glvBench_report(&bench, &option);
+	glvBench_finish(&bench);
+	return (rc);
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright © 2026 glview contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+// pthread_msqのベンチマーク(ベースライン比較付き)
+// 1送信スレッド→1受信スレッドのスループット(1000件毎の処理時間)と送信から受信までの遅延を計測する
+// msq_lockfree_payloadは送信毎に可変長データをキューのプールから確保し、受信側で解放する
+// msq_lockfree_payload_mallocは比較用に、mallocした可変長データのポインタをdata[2]で渡す(プール導入前のglviewと同じ)
+//
+// usage: bench_msq [-n メッセージ数] [-b baseline] [-t tolerance%] [-w output]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pthread_msq.h"
+#include "glv_bench.h"
+
+#define BENCH_QUEUE_SIZE	(100)		// glviewのウィンドウと同じキューサイズ
+#define BENCH_BATCH			(1000)		// スループットの計測単位
+
+#define BENCH_PAYLOAD_POOL		(0)			// pthread_msq_payload_alloc()で確保する
+#define BENCH_PAYLOAD_MALLOC	(1)			// mallocで確保してdata[2]で渡す
+
+typedef struct _bench_arg {
+	pthread_msq_id_t	*queue;
+	int					count;
+	int					interval;		// 送信間隔(ns)
+	size_t				payload;		// 可変長データの大きさ(0:無し)
+	int					payloadType;	// BENCH_PAYLOAD_POOL/BENCH_PAYLOAD_MALLOC
+	int					allocFailed;	// 可変長データを確保できなかった数(可変長データ無しで送信する)
+} BENCH_ARG_t;
+
+static void *bench_producer(void *arg)
+{
+	BENCH_ARG_t *bench = arg;
+	pthread_msq_msg_t smsg;
+	struct timespec ts;
+	struct timespec interval = {0, bench->interval};
+	char *payload;
+	int i;
+
+	memset(&smsg, 0, sizeof(pthread_msq_msg_t));
+	for (i = 0; i < bench->count; i++) {
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		smsg.data[0] = ts.tv_sec;
+		smsg.data[1] = ts.tv_nsec;
+		smsg.data[2] = 0;
+		if ((bench->payload > 0) && (bench->payloadType == BENCH_PAYLOAD_MALLOC)) {
+			payload = malloc(bench->payload);
+			if (payload == NULL) {
+				bench->allocFailed++;
+			} else {
+				memset(payload, i, bench->payload);
+				smsg.data[2] = (size_t)payload;
+			}
+			if (pthread_msq_msg_send(bench->queue, &smsg, 0) != PTHREAD_MSQ_OK) {
+				free(payload);
+			}
+		} else if (bench->payload > 0) {
+			payload = pthread_msq_payload_alloc(bench->queue, bench->payload);
+			if (payload == NULL) {
+				// 受信側は送信数だけ受信するので、確保できなくても送信する
+				bench->allocFailed++;
+			} else {
+				memset(payload, i, bench->payload);
+			}
+			if (pthread_msq_msg_send_payload(bench->queue, &smsg, 0, payload) != PTHREAD_MSQ_OK) {
+				pthread_msq_payload_free(payload);
+			}
+		} else {
+			pthread_msq_msg_send(bench->queue, &smsg, 0);
+		}
+		if (bench->interval > 0) {
+			nanosleep(&interval, NULL);
+		}
+	}
+	return (NULL);
+}
+
+static int bench_queue_create(pthread_msq_id_t *queue, int type)
+{
+	pthread_msq_id_t init = PTHREAD_MSQ_ID_INITIALIZER;
+
+	memcpy(queue, &init, sizeof(pthread_msq_id_t));
+	return (pthread_msq_create_ex(queue, BENCH_QUEUE_SIZE, type));
+}
+
+static int bench_run(const char *name, int type, int count, int interval, int latency, size_t payload,
+					int payloadType, const GLV_BENCH_OPTION_t *option)
+{
+	GLV_BENCH_t bench;
+	pthread_msq_id_t queue;
+	pthread_t thread;
+	BENCH_ARG_t arg;
+	pthread_msq_msg_t rmsg;
+	struct timespec ts;
+	double batchStart = 0.0;
+	int i, rc;
+
+	if (glvBench_init(&bench, name, GLV_BENCH_RATE_ITEMS, count) != 0) return (-1);
+	if (bench_queue_create(&queue, type) != PTHREAD_MSQ_OK) {
+		fprintf(stderr, "bench_msq:Error: pthread_msq_create_ex() failed\n");
+		glvBench_finish(&bench);
+		return (-1);
+	}
+	arg.queue = &queue;
+	arg.count = count;
+	arg.interval = interval;
+	arg.payload = payload;
+	arg.payloadType = payloadType;
+	arg.allocFailed = 0;
+
+	glvBench_start(&bench);
+	batchStart = glvBench_now();
+	pthread_create(&thread, NULL, bench_producer, &arg);
+	for (i = 0; i < count; i++) {
+		pthread_msq_msg_receive(&queue, &rmsg);
+		pthread_msq_payload_free(pthread_msq_msg_payload(&rmsg));
+		free((void *)rmsg.data[2]);
+		if (latency == 1) {
+			clock_gettime(CLOCK_MONOTONIC, &ts);
+			glvBench_sample(&bench, (double)(ts.tv_sec - (time_t)rmsg.data[0]) * 1000.0
+									+ (double)(ts.tv_nsec - (long)rmsg.data[1]) / 1000000.0);
+		} else if (((i + 1) % BENCH_BATCH) == 0) {
+			double now = glvBench_now();
+			glvBench_sample(&bench, now - batchStart);
+			batchStart = now;
+		}
+	}
+	glvBench_addItems(&bench, count);
+	glvBench_stop(&bench);
+	pthread_join(thread, NULL);
+	pthread_msq_destroy(&queue);
+
+	rc = glvBench_report(&bench, option);
+	glvBench_finish(&bench);
+	if (arg.allocFailed > 0) {
+		// 可変長データ無しのメッセージが混ざったので計測結果は比較できない
+		fprintf(stderr, "bench_msq:Error: %s: payload allocation failed %d times\n", name, arg.allocFailed);
+		rc = -1;
+	}
+	return (rc);
+}
+
+int main(int argc, char *argv[])
+{
+	GLV_BENCH_OPTION_t option;
+	int count, latencyCount;
+	int rc = 0;
+
+	if (glvBench_parseOption(argc, argv, &option) < 0) return (2);
+	count = (option.count > 0) ? option.count : 1000000;
+	latencyCount = count / 100;
+	if (latencyCount < 1000) latencyCount = 1000;
+
+	rc |= bench_run("msq_mutex_throughput", PTHREAD_MSQ_TYPE_MUTEX, count, 0, 0, 0, BENCH_PAYLOAD_POOL, &option);
+	rc |= bench_run("msq_lockfree_throughput", PTHREAD_MSQ_TYPE_LOCKFREE, count, 0, 0, 0, BENCH_PAYLOAD_POOL, &option);
+	// テキスト入力(UTF-32の数文字分)程度の大きさ
+	rc |= bench_run("msq_lockfree_payload", PTHREAD_MSQ_TYPE_LOCKFREE, count, 0, 0, 40, BENCH_PAYLOAD_POOL, &option);
+	rc |= bench_run("msq_lockfree_payload_malloc", PTHREAD_MSQ_TYPE_LOCKFREE, count, 0, 0, 40, BENCH_PAYLOAD_MALLOC, &option);
+	// 受信側が待機状態に入るように間隔をあける
+	rc |= bench_run("msq_mutex_latency", PTHREAD_MSQ_TYPE_MUTEX, latencyCount, 20000, 1, 0, BENCH_PAYLOAD_POOL, &option);
+	rc |= bench_run("msq_lockfree_latency", PTHREAD_MSQ_TYPE_LOCKFREE, latencyCount, 20000, 1, 0, BENCH_PAYLOAD_POOL, &option);
+
+	return ((rc < 0) ? 2 : rc);
+}
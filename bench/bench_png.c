@@ -0,0 +1,155 @@
+/*
+ * Copyright © 2026 glview contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+// PNGデコードのベンチマーク
+// 合成したRGBA画像をメモリ上でPNGにエンコードし、glv_decodePngDataForMemory()で繰り返しデコードする
+//
+// usage: bench_png [-n 回数] [-b baseline] [-t tolerance%] [-w output]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <png.h>
+#include "glview.h"
+#include "glview_png.h"
+#include "glv_bench.h"
+
+#define BENCH_IMAGE_WIDTH	(512)
+#define BENCH_IMAGE_HEIGHT	(512)
+
+typedef struct _bench_png_buffer {
+	char	*data;
+	long	size;
+	long	max;
+} BENCH_PNG_BUFFER_t;
+
+static void bench_png_write(png_structp png_ptr, png_bytep data, png_size_t length)
+{
+	BENCH_PNG_BUFFER_t *buffer = png_get_io_ptr(png_ptr);
+	char *p;
+
+	if (buffer->size + (long)length > buffer->max) {
+		long max = (buffer->max * 2) + (long)length;
+		p = realloc(buffer->data, max);
+		if (p == NULL) {
+			png_error(png_ptr, "no memory");
+		}
+		buffer->data = p;
+		buffer->max = max;
+	}
+	memcpy(buffer->data + buffer->size, data, length);
+	buffer->size += length;
+}
+
+static void bench_png_flush(png_structp png_ptr)
+{
+	(void)png_ptr;
+}
+
+// グラデーションと格子模様の画像をPNGにエンコードする(圧縮率が実際のアイコン等に近くなるように)
+static int bench_png_encode(BENCH_PNG_BUFFER_t *buffer, int width, int height)
+{
+	png_structp png_ptr;
+	png_infop info_ptr;
+	png_bytep row;
+	int x, y;
+
+	memset(buffer, 0, sizeof(BENCH_PNG_BUFFER_t));
+	row = malloc(width * 4);
+	if (row == NULL) return (-1);
+	png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+	if (png_ptr == NULL) {
+		free(row);
+		return (-1);
+	}
+	info_ptr = png_create_info_struct(png_ptr);
+	if ((info_ptr == NULL) || setjmp(png_jmpbuf(png_ptr))) {
+		png_destroy_write_struct(&png_ptr, &info_ptr);
+		free(row);
+		free(buffer->data);
+		buffer->data = NULL;
+		return (-1);
+	}
+	png_set_write_fn(png_ptr, buffer, bench_png_write, bench_png_flush);
+	png_set_IHDR(png_ptr, info_ptr, width, height, 8, PNG_COLOR_TYPE_RGB_ALPHA,
+		PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+	png_write_info(png_ptr, info_ptr);
+	for (y = 0; y < height; y++) {
+		for (x = 0; x < width; x++) {
+			row[x * 4 + 0] = (png_byte)(x * 255 / width);
+			row[x * 4 + 1] = (png_byte)(y * 255 / height);
+			row[x * 4 + 2] = (((x / 16) + (y / 16)) & 1) ? 0xff : 0x40;
+			row[x * 4 + 3] = 0xff;
+		}
+		png_write_row(png_ptr, row);
+	}
+	png_write_end(png_ptr, info_ptr);
+	png_destroy_write_struct(&png_ptr, &info_ptr);
+	free(row);
+	return (0);
+}
+
+int main(int argc, char *argv[])
+{
+	GLV_BENCH_OPTION_t option;
+	GLV_BENCH_t bench;
+	BENCH_PNG_BUFFER_t buffer;
+	uint8_t *image;
+	double start;
+	int count, width, height, i, rc;
+
+	if (glvBench_parseOption(argc, argv, &option) < 0) return (2);
+	count = (option.count > 0) ? option.count : 200;
+
+	if (bench_png_encode(&buffer, BENCH_IMAGE_WIDTH, BENCH_IMAGE_HEIGHT) != 0) {
+		fprintf(stderr, "bench_png:Error: png encode failed\n");
+		return (2);
+	}
+	if (glvBench_init(&bench, "png_decode", GLV_BENCH_RATE_ITEMS, count) != 0) {
+		free(buffer.data);
+		return (2);
+	}
+
+	glvBench_start(&bench);
+	for (i = 0; i < count; i++) {
+		start = glvBench_now();
+		image = glv_decodePngDataForMemory(buffer.data, buffer.size, &width, &height);
+		glvBench_sample(&bench, glvBench_now() - start);
+		if ((image == NULL) || (width != BENCH_IMAGE_WIDTH) || (height != BENCH_IMAGE_HEIGHT)) {
+			fprintf(stderr, "bench_png:Error: glv_decodePngDataForMemory() failed\n");
+			free(image);
+			glvBench_finish(&bench);
+			free(buffer.data);
+			return (2);
+		}
+		free(image);
+	}
+	// 処理件数はデコードした画素数(Mpixel)とする
+	glvBench_addItems(&bench, (double)count * BENCH_IMAGE_WIDTH * BENCH_IMAGE_HEIGHT / 1000000.0);
+	glvBench_stop(&bench);
+
+	rc = glvBench_report(&bench, &option);
+	glvBench_finish(&bench);
+	free(buffer.data);
+	return (rc);
+}
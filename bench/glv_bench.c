@@ -0,0 +1,373 @@
+/*
+ * Copyright © 2026 glview contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "glv_bench.h"
+
+// メッセージ送信時などのメモリ確保回数を計測するため、mallocを横取りして数える
+// (glibcの場合のみ、それ以外は0を出力する)
+#ifdef __GLIBC__
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb,size_t size);
+extern void *__libc_realloc(void *ptr,size_t size);
+extern void __libc_free(void *ptr);
+
+static uint64_t _glvBench_allocs = 0;
+static uint64_t _glvBench_allocBytes = 0;
+
+void *malloc(size_t size)
+{
+	__atomic_add_fetch(&_glvBench_allocs,1,__ATOMIC_RELAXED);
+	__atomic_add_fetch(&_glvBench_allocBytes,size,__ATOMIC_RELAXED);
+	return (__libc_malloc(size));
+}
+
+void *calloc(size_t nmemb,size_t size)
+{
+	__atomic_add_fetch(&_glvBench_allocs,1,__ATOMIC_RELAXED);
+	__atomic_add_fetch(&_glvBench_allocBytes,nmemb * size,__ATOMIC_RELAXED);
+	return (__libc_calloc(nmemb,size));
+}
+
+void *realloc(void *ptr,size_t size)
+{
+	__atomic_add_fetch(&_glvBench_allocs,1,__ATOMIC_RELAXED);
+	__atomic_add_fetch(&_glvBench_allocBytes,size,__ATOMIC_RELAXED);
+	return (__libc_realloc(ptr,size));
+}
+
+void free(void *ptr)
+{
+	__libc_free(ptr);
+}
+
+static uint64_t _glvBench_getAllocs(void)
+{
+	return (__atomic_load_n(&_glvBench_allocs,__ATOMIC_RELAXED));
+}
+
+static uint64_t _glvBench_getAllocBytes(void)
+{
+	return (__atomic_load_n(&_glvBench_allocBytes,__ATOMIC_RELAXED));
+}
+#else
+static uint64_t _glvBench_getAllocs(void)
+{
+	return (0);
+}
+
+static uint64_t _glvBench_getAllocBytes(void)
+{
+	return (0);
+}
+#endif /* __GLIBC__ */
+
+static double _glvBench_clock(clockid_t clk_id)
+{
+	struct timespec ts;
+	clock_gettime(clk_id,&ts);
+	return ((double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1000000.0);
+}
+
+static int _glvBench_compare(const void *a,const void *b)
+{
+	double da = *(const double*)a;
+	double db = *(const double*)b;
+	if(da < db) return (-1);
+	if(da > db) return (1);
+	return (0);
+}
+
+// 整列済みの計測値からパーセンタイル値を求める(nearest-rank)
+static double _glvBench_percentile(const double *sorted,int count,int percent)
+{
+	int rank;
+	if(count <= 0) return (0.0);
+	rank = (count * percent + 99) / 100;
+	if(rank < 1) rank = 1;
+	if(rank > count) rank = count;
+	return (sorted[rank - 1]);
+}
+
+/**
+ * @brief ベンチマークの共通オプションを解析する
+ *
+ * @param[in] argc 引数の数
+ * @param[in] argv 引数
+ * @param[out] option 解析結果
+ * @retval 解析した後の最初の引数の位置
+ * @retval -1 不正なオプション
+ */
+int glvBench_parseOption(int argc,char *argv[],GLV_BENCH_OPTION_t *option)
+{
+	int opt;
+
+	memset(option,0,sizeof(GLV_BENCH_OPTION_t));
+	while((opt = getopt(argc,argv,"n:b:t:w:")) != -1){
+		switch(opt){
+		case 'n':
+			option->count = atoi(optarg);
+			break;
+		case 'b':
+			option->baseline = optarg;
+			break;
+		case 't':
+			option->tolerance = atof(optarg);
+			break;
+		case 'w':
+			option->output = optarg;
+			break;
+		default:
+			fprintf(stderr,"usage: %s [-n count] [-b baseline] [-t tolerance%%] [-w output]\n",argv[0]);
+			return (-1);
+		}
+	}
+	return (optind);
+}
+
+/**
+ * @brief 現在の時刻(CLOCK_MONOTONIC)をmsで返す
+ */
+double glvBench_now(void)
+{
+	return (_glvBench_clock(CLOCK_MONOTONIC));
+}
+
+/**
+ * @brief 計測を初期化する
+ *
+ * @param[in] bench 計測
+ * @param[in] name ベンチマーク名(ベースラインの検索に使用する)
+ * @param[in] rateType GLV_BENCH_RATE_FPS/GLV_BENCH_RATE_ITEMS
+ * @param[in] max 計測値の最大数
+ * @retval 0 正常
+ * @retval -1 メモリ不足
+ */
+int glvBench_init(GLV_BENCH_t *bench,const char *name,int rateType,int max)
+{
+	memset(bench,0,sizeof(GLV_BENCH_t));
+	bench->name = name;
+	bench->rateType = rateType;
+	bench->max = max;
+	bench->sample = malloc(sizeof(double) * max);
+	if(bench->sample == NULL){
+		fprintf(stderr,"glv_bench:Error: %s: no memory\n",name);
+		return (-1);
+	}
+	return (0);
+}
+
+/**
+ * @brief 計測を開始する
+ */
+void glvBench_start(GLV_BENCH_t *bench)
+{
+	bench->count = 0;
+	bench->items = 0.0;
+	bench->startAllocs = _glvBench_getAllocs();
+	bench->startAllocBytes = _glvBench_getAllocBytes();
+	bench->startCpu = _glvBench_clock(CLOCK_PROCESS_CPUTIME_ID);
+	bench->startTime = glvBench_now();
+	bench->lastTime = bench->startTime;
+}
+
+/**
+ * @brief 計測値(ms)を1つ追加する
+ */
+void glvBench_sample(GLV_BENCH_t *bench,double ms)
+{
+	if(bench->count < bench->max){
+		bench->sample[bench->count] = ms;
+		bench->count++;
+	}
+}
+
+/**
+ * @brief 前回の呼び出しからの経過時間を1フレームの時間として追加する
+ */
+void glvBench_frame(GLV_BENCH_t *bench)
+{
+	double now = glvBench_now();
+	glvBench_sample(bench,now - bench->lastTime);
+	bench->lastTime = now;
+}
+
+/**
+ * @brief 処理件数を加算する(GLV_BENCH_RATE_ITEMSのレートに使用する)
+ */
+void glvBench_addItems(GLV_BENCH_t *bench,double items)
+{
+	bench->items += items;
+}
+
+/**
+ * @brief 計測を終了する
+ */
+void glvBench_stop(GLV_BENCH_t *bench)
+{
+	bench->wall = glvBench_now() - bench->startTime;
+	bench->cpu = _glvBench_clock(CLOCK_PROCESS_CPUTIME_ID) - bench->startCpu;
+	bench->allocs = _glvBench_getAllocs() - bench->startAllocs;
+	bench->allocBytes = _glvBench_getAllocBytes() - bench->startAllocBytes;
+}
+
+// ベースラインから"name metric value"の行を探す
+// 値が"-"の行は未計測として扱う(戻り値 -1)
+static int _glvBench_lookup(const char *file,const char *name,const char *metric,double *value)
+{
+	FILE *fp;
+	char line[256];
+	char n[128],m[64],v[64];
+	int found = 0;
+
+	fp = fopen(file,"r");
+	if(fp == NULL){
+		return (0);
+	}
+	while(fgets(line,sizeof(line),fp) != NULL){
+		if(line[0] == '#') continue;
+		if(sscanf(line,"%127s %63s %63s",n,m,v) != 3) continue;
+		if((strcmp(n,name) == 0) && (strcmp(m,metric) == 0)){
+			// 後から追記された値を優先する
+			if(strcmp(v,"-") == 0){
+				found = -1;
+			}else if(sscanf(v,"%lf",value) == 1){
+				found = 1;
+			}
+		}
+	}
+	fclose(fp);
+	return (found);
+}
+
+// ベースラインと比較する
+// higherIsBetter: 1のときは値が小さくなることを劣化とする
+static int _glvBench_check(GLV_BENCH_t *bench,const GLV_BENCH_OPTION_t *option,
+						const char *metric,double value,int higherIsBetter)
+{
+	double base,diff;
+	int regression = 0;
+	int found;
+
+	if(option->baseline == NULL) return (0);
+	found = _glvBench_lookup(option->baseline,bench->name,metric,&base);
+	if(found != 1){
+		printf("  %-10s %12.3f  (%s)\n",metric,value,(found < 0) ? "baseline not measured" : "no baseline");
+		return (0);
+	}
+	if(base == 0.0){
+		diff = (value == 0.0) ? 0.0 : 100.0;
+	}else{
+		diff = (value - base) * 100.0 / base;
+	}
+	if(option->tolerance > 0.0){
+		if(higherIsBetter == 1){
+			regression = (-diff > option->tolerance) ? 1 : 0;
+		}else{
+			regression = (diff > option->tolerance) ? 1 : 0;
+		}
+	}
+	printf("  %-10s %12.3f  baseline %12.3f  %+7.1f%%%s\n",
+		metric,value,base,diff,(regression == 1) ? "  REGRESSION" : "");
+	return (regression);
+}
+
+/**
+ * @brief 計測結果を出力し、ベースラインと比較する
+ *
+ * @param[in] bench 計測
+ * @param[in] option 共通オプション
+ * @retval 0 正常
+ * @retval 1 許容範囲を超えた劣化あり
+ */
+int glvBench_report(GLV_BENCH_t *bench,const GLV_BENCH_OPTION_t *option)
+{
+	double *sorted;
+	double p50 = 0.0,p99 = 0.0,mean = 0.0,rate = 0.0;
+	int i,regression = 0;
+	FILE *fp;
+
+	if(bench->count > 0){
+		sorted = malloc(sizeof(double) * bench->count);
+		if(sorted != NULL){
+			memcpy(sorted,bench->sample,sizeof(double) * bench->count);
+			qsort(sorted,bench->count,sizeof(double),_glvBench_compare);
+			p50 = _glvBench_percentile(sorted,bench->count,50);
+			p99 = _glvBench_percentile(sorted,bench->count,99);
+			free(sorted);
+		}
+		for(i=0;i<bench->count;i++){
+			mean += bench->sample[i];
+		}
+		mean /= bench->count;
+	}
+	if(bench->wall > 0.0){
+		if(bench->rateType == GLV_BENCH_RATE_FPS){
+			rate = (double)bench->count * 1000.0 / bench->wall;
+		}else{
+			rate = bench->items * 1000.0 / bench->wall;
+		}
+	}
+
+	printf("%-24s %s %12.1f  p50 %8.3f ms  p99 %8.3f ms  mean %8.3f ms  cpu %8.1f ms  allocs %llu (%llu bytes)\n",
+		bench->name,
+		(bench->rateType == GLV_BENCH_RATE_FPS) ? "fps    " : "items/s",
+		rate,p50,p99,mean,bench->cpu,
+		(unsigned long long)bench->allocs,(unsigned long long)bench->allocBytes);
+
+	if(option->baseline != NULL){
+		regression |= _glvBench_check(bench,option,"rate",rate,1);
+		regression |= _glvBench_check(bench,option,"p50",p50,0);
+		regression |= _glvBench_check(bench,option,"p99",p99,0);
+		regression |= _glvBench_check(bench,option,"cpu",bench->cpu,0);
+		regression |= _glvBench_check(bench,option,"allocs",(double)bench->allocs,0);
+	}
+
+	if(option->output != NULL){
+		fp = fopen(option->output,"a");
+		if(fp == NULL){
+			fprintf(stderr,"glv_bench:Error: %s: can't open\n",option->output);
+		}else{
+			fprintf(fp,"%s rate %.3f\n",bench->name,rate);
+			fprintf(fp,"%s p50 %.6f\n",bench->name,p50);
+			fprintf(fp,"%s p99 %.6f\n",bench->name,p99);
+			fprintf(fp,"%s cpu %.3f\n",bench->name,bench->cpu);
+			fprintf(fp,"%s allocs %llu\n",bench->name,(unsigned long long)bench->allocs);
+			fclose(fp);
+		}
+	}
+	return (regression);
+}
+
+/**
+ * @brief 計測の後始末
+ */
+void glvBench_finish(GLV_BENCH_t *bench)
+{
+	free(bench->sample);
+	bench->sample = NULL;
+}
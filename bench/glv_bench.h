@@ -0,0 +1,87 @@
+/*
+ * Copyright © 2026 glview contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _GLV_BENCH_H
+#define _GLV_BENCH_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ベンチマーク共通処理
+// 1回毎の計測値(frame time/遅延)を集計し、レート,p50/p99,CPU時間,メモリ確保回数を出力する。
+// ベースラインのファイルが指定された場合は比較し、許容範囲を超えた劣化があれば失敗とする。
+//
+// 共通オプション
+//   -n <回数>        計測回数
+//   -b <ファイル>    比較するベースライン
+//   -t <%>           劣化の許容範囲(0:比較結果の表示のみ)
+//   -w <ファイル>    計測結果をベースラインの形式で追記する
+
+#define GLV_BENCH_RATE_FPS		(0)		// レートをframe/sで出力する
+#define GLV_BENCH_RATE_ITEMS	(1)		// レートを処理件数/sで出力する
+
+typedef struct _glv_bench_option {
+	int			count;				// 計測回数(0:各ベンチマークの既定値)
+	const char	*baseline;			// 比較するベースラインのファイル
+	double		tolerance;			// 劣化の許容範囲(%)
+	const char	*output;			// 計測結果の出力先
+} GLV_BENCH_OPTION_t;
+
+typedef struct _glv_bench {
+	const char	*name;
+	int			rateType;			// GLV_BENCH_RATE_FPS/GLV_BENCH_RATE_ITEMS
+	int			max;				// 計測値の格納数
+	int			count;				// 計測値の数
+	double		*sample;			// 計測値(ms)
+	double		items;				// 処理件数
+	double		lastTime;			// glvBench_frameで使用する前回の時刻(ms)
+	double		startTime;			// 計測開始時の時刻(ms)
+	double		startCpu;			// 計測開始時のCPU時間(ms)
+	uint64_t	startAllocs;		// 計測開始時のメモリ確保回数
+	uint64_t	startAllocBytes;	// 計測開始時のメモリ確保量
+	// 結果
+	double		wall;				// 経過時間(ms)
+	double		cpu;				// CPU時間(ms)
+	uint64_t	allocs;				// メモリ確保回数
+	uint64_t	allocBytes;			// メモリ確保量
+} GLV_BENCH_t;
+
+int glvBench_parseOption(int argc,char *argv[],GLV_BENCH_OPTION_t *option);
+double glvBench_now(void);
+int glvBench_init(GLV_BENCH_t *bench,const char *name,int rateType,int max);
+void glvBench_start(GLV_BENCH_t *bench);
+void glvBench_sample(GLV_BENCH_t *bench,double ms);
+void glvBench_frame(GLV_BENCH_t *bench);
+void glvBench_addItems(GLV_BENCH_t *bench,double items);
+void glvBench_stop(GLV_BENCH_t *bench);
+int glvBench_report(GLV_BENCH_t *bench,const GLV_BENCH_OPTION_t *option);
+void glvBench_finish(GLV_BENCH_t *bench);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _GLV_BENCH_H */
@@ -197,11 +197,22 @@ static int hmi_sheet_reshape2(glvWindow glv_win,glvSheet sheet,int window_width,
 	return(GLV_OK);
 }
 
+static int hmi_sheet_redraw2(glvWindow glv_win,glvSheet sheet,int drawStat)
+{
+	//printf("hmi_sheet_redraw2\n");
+
+	glvSheet_reqDrawWigets(sheet);
+	glvSheet_reqSwapBuffers(sheet);
+
+	return(GLV_OK);
+}
+
 static int hmi_sheet_update2(glvWindow glv_win,glvSheet sheet,int drawStat)
 {
 	//printf("hmi_sheet_update2\n");
 
-	glvSheet_reqDrawWigets(sheet);
+	// updateはslider barの再描画要求(glvWiget_reqDraw)で発生するので、
+	// 再描画要求されたwigetの範囲だけをglviewに再描画させる
 	glvSheet_reqSwapBuffers(sheet);
 
 	return(GLV_OK);
@@ -360,7 +371,7 @@ static int hmi_sheet_init2(glvWindow glv_win,glvSheet sheet,int window_width, in
 static const struct glv_sheet_listener _hmi2_sheet_listener = {
 	.init			= hmi_sheet_init2,
 	.reshape		= hmi_sheet_reshape2,
-	.redraw			= hmi_sheet_update2,
+	.redraw			= hmi_sheet_redraw2,
 	.update 		= hmi_sheet_update2,
 	.timer			= NULL,
 	.mousePointer	= NULL,
@@ -42,12 +42,9 @@
 //------------------------------------------------------------------------------
 // 定数
 //------------------------------------------------------------------------------
-#if 0
-/**
- * @brief		シェーダー：色をグローバル指定
- */
-#define VSHADER_VERTEX_ARRAY  "\
-	precision lowp float;\
+// 頂点シェーダ:色をグローバル指定
+#define VSHADER_FLAT  "\
+	precision highp float;\
 	attribute vec4 a_pos;\
 	uniform mat4 u_pmvMatrix;\
 	void main(void)\
@@ -55,20 +52,9 @@
 		gl_Position = u_pmvMatrix * a_pos;\
 	}"
 
-#define FSHADER_VERTEX_ARRAY  "\
-	precision lowp float;\
-	uniform vec4 u_color;\
-	void main (void)\
-	{\
-		gl_FragColor = u_color;\
-	}"
-
-
-/**
- * @brief		シェーダー：色を個別指定
- */
+// 頂点シェーダ:色を個別指定
 #define VSHADER_COLOR_ARRAY  "\
-	precision lowp float;\
+	precision highp float;\
 	attribute vec4 a_pos;\
 	attribute vec4 a_color;\
 	uniform mat4 u_pmvMatrix;\
@@ -79,87 +65,97 @@
 		v_color = a_color;\
 	}"
 
-#define FSHADER_COLOR_ARRAY  "\
-	precision lowp float;\
-	varying vec4 v_color;\
-	void main (void)\
+// 頂点シェーダ:テクスチャ
+#define VSHADER_TEXTURE_ARRAY  "\
+	precision highp float;\
+	attribute vec4 a_pos;\
+	attribute vec2 a_texture;\
+	uniform mat4 u_pmvMatrix;\
+	varying vec2 v_texcoord;\
+	void main(void)\
 	{\
-		gl_FragColor = v_color;\
+		gl_Position = u_pmvMatrix * a_pos;\
+		v_texcoord = a_texture;\
 	}"
 
-
-/**
- * @brief		シェーダー：テクスチャ用
- */
-#define VSHADER_TEXTURE_ARRAY  "\
-	precision lowp float;\
+// 頂点シェーダ:テクスチャ + 色を個別指定
+#define VSHADER_TEXTURE_COLOR_ARRAY  "\
+	precision highp float;\
 	attribute vec4 a_pos;\
+	attribute vec4 a_color;\
 	attribute vec2 a_texture;\
 	uniform mat4 u_pmvMatrix;\
+	varying vec4 v_color;\
 	varying vec2 v_texcoord;\
 	void main(void)\
 	{\
 		gl_Position = u_pmvMatrix * a_pos;\
+		v_color = a_color;\
 		v_texcoord = a_texture;\
 	}"
 
+// フラグメントシェーダ:グローバルカラー
+#define FSHADER_FLAT  "\
+	precision highp float;\
+	uniform vec4 u_color;\
+	void main (void)\
+	{\
+		gl_FragColor = u_color;\
+	}"
+
+// フラグメントシェーダ:頂点カラー
+#define FSHADER_COLOR_ARRAY  "\
+	precision highp float;\
+	varying vec4 v_color;\
+	void main (void)\
+	{\
+		gl_FragColor = v_color;\
+	}"
+
+// フラグメントシェーダ:テクスチャ(GL_REPLACE)
 #define FSHADER_TEXTURE_ARRAY  "\
-	precision lowp float;\
+	precision highp float;\
 	varying vec2 v_texcoord;\
 	uniform sampler2D texture0;\
 	void main (void)\
 	{\
 		gl_FragColor = texture2D(texture0, v_texcoord);\
 	}"
-#else
-#define VSHADER_VERTEX_ARRAY  "\
+
+// フラグメントシェーダ:テクスチャ * グローバルカラー(GL_MODULATE)
+#define FSHADER_TEXTURE_MODULATE  "\
 	precision highp float;\
-	attribute vec4 a_pos;\
-	attribute vec4 a_color;\
-	attribute vec2 a_texture;\
-	uniform mat4 u_pmvMatrix;\
-	uniform vec4 u_color;\
-	uniform bool u_color_arrey;\
-	uniform bool u_texture_arrey;\
-	varying vec4 v_color;\
 	varying vec2 v_texcoord;\
-	void main (void) \
+	uniform sampler2D texture0;\
+	uniform vec4 u_color;\
+	void main (void)\
 	{\
-		gl_Position = u_pmvMatrix * a_pos;\
-		if (u_texture_arrey) {\
-			v_texcoord = a_texture;\
-		} else {\
-			if (u_color_arrey) {\
-				v_color = a_color;\
-			} else {\
-				v_color = u_color;\
-			}\
-		}\
+		gl_FragColor = texture2D(texture0, v_texcoord) * u_color;\
 	}"
 
-#define FSHADER_VERTEX_ARRAY  "\
+// フラグメントシェーダ:テクスチャ * 頂点カラー(GL_MODULATE)
+#define FSHADER_TEXTURE_MODULATE_COLOR  "\
 	precision highp float;\
-	uniform bool u_texture_arrey;\
-	uniform sampler2D texture0;\
 	varying vec2 v_texcoord;\
 	varying vec4 v_color;\
+	uniform sampler2D texture0;\
 	void main (void)\
 	{\
-		if(u_texture_arrey) {\
-			gl_FragColor = texture2D(texture0, v_texcoord);\
-		} else {\
-			gl_FragColor = v_color;\
-		}\
+		gl_FragColor = texture2D(texture0, v_texcoord) * v_color;\
 	}"
-#endif
-// スタックサイズ
-#define STACK_SIZE					(10)
+
+// スタックサイズ(フレーム,子ウィンドウ,ウィジェットの入れ子分)
+#define STACK_SIZE					(32)
 
 // attributeインデックス
 #define ATTR_LOC_POS				(0)		// attribute vec4 a_pos;
 #define ATTR_LOC_COLOR				(1)		// attribute vec4 a_color;
 #define ATTR_LOC_TEXTURE			(2)		// attribute vec2 a_texture;
 
+// クライアントステート
+#define STATE_COLOR_ARRAY			(0x01)	// GL_COLOR_ARRAY
+#define STATE_TEXTURE_ARRAY			(0x02)	// GL_TEXTURE_COORD_ARRAY
+
 
 //------------------------------------------------------------------------------
 // 構造体
@@ -175,10 +171,19 @@ typedef struct {
 	GLint		uPMVMatrix;		// プロジェクション*モデルビューマトリクス
 	GLint		uColor;			// グローバルカラー
 	GLint		uTexture0;		// テクスチャー
-	GLint		uColorArrey;
-	GLint		uTextureArrey;
+
+	// 転送済みの状態(ES1PARAMSの更新番号と異なる場合に転送する)
+	GLuint		matrixSerial;
+	GLuint		colorSerial;
+	GLint		texture0Set;	// 1:texture0転送済み
 } PROGRAM_INFO;
 
+// シェーダソース
+typedef struct {
+	const char	*vshader;
+	const char	*fshader;
+} SHADER_SOURCE;
+
 // カラー情報
 typedef struct {
 	float		r;
@@ -191,6 +196,7 @@ typedef struct {
 typedef struct {
 	MPMatrix	mat[STACK_SIZE];			// スタック
 	GLint		sp;							// スタックポインタ
+	GLint		overflow;					// スタックに積めなかったPush数(Popと対応させる)
 	MPMatrix	cur;						// カレント
 } MATRIX_FILO;
 
@@ -201,8 +207,26 @@ typedef struct {
 	GLint			mode;						// マトリクスモード
 	MATRIX_FILO		filo[2];					// スタック [0]:モデルビュー、[1]プロジェクション
 	MPMatrix		*pMat;						// カレントマトリクス
+	GLint			texEnvMode;					// テクスチャ環境モード(GL_REPLACE/GL_MODULATE)
+	GLint			clientState;				// 有効なクライアントステート(STATE_XXX)
+	GLint			curProgram;					// 使用中のプログラム(-1:無し)
+	// ダーティ管理
+	GLuint			matrixSerial;				// マトリクス更新番号(モデルビュー,プロジェクションの変更毎)
+	GLuint			colorSerial;				// グローバルカラー更新番号
+	GLuint			pmvSerial;					// pmvを計算した時のマトリクス更新番号
+	MPMatrix		pmv;						// プロジェクション*モデルビュー
+	ES1EMU_STATISTICS	stat;					// 統計情報
 } ES1PARAMS;
 
+// クライアントステートの組み合わせ毎のシェーダ
+static const SHADER_SOURCE shaderSource[ES1EMU_PROGRAM_MAX] = {
+	{ VSHADER_FLAT,					FSHADER_FLAT					},	// ES1EMU_PROGRAM_VERTEX_ARRAY
+	{ VSHADER_COLOR_ARRAY,			FSHADER_COLOR_ARRAY				},	// ES1EMU_PROGRAM_COLOR_ARRAY
+	{ VSHADER_TEXTURE_ARRAY,		FSHADER_TEXTURE_ARRAY			},	// ES1EMU_PROGRAM_TEXTURE_ARRAY
+	{ VSHADER_TEXTURE_ARRAY,		FSHADER_TEXTURE_MODULATE		},	// ES1EMU_PROGRAM_TEXTURE_MODULATE
+	{ VSHADER_TEXTURE_COLOR_ARRAY,	FSHADER_TEXTURE_MODULATE_COLOR	},	// ES1EMU_PROGRAM_TEXTURE_MODULATE_COLOR
+};
+
 
 //------------------------------------------------------------------------------
 // 静的変数
@@ -221,6 +245,8 @@ static void buffer_key_alloc();
 static void threadBuffer_alloc(GLint size);
 static void initParams();
 static ES1PARAMS *getParams();
+static PROGRAM_INFO *createProgram(ES1PARAMS *param, int programType);
+static int selectProgram(ES1PARAMS *param);
 
 
 //------------------------------------------------------------------------------
@@ -271,9 +297,54 @@ static ES1PARAMS *getParams()
 #endif	// _GL_PTHREAD_SAFE
 }
 
-int es1emu_Init()
+// AttribLocationのindexを明示的に指定(リンク前にglBindAttribLocation())
+static void bindAttribLocation(GLuint programId)
+{
+	glBindAttribLocation(programId, ATTR_LOC_POS, "a_pos");
+	glBindAttribLocation(programId, ATTR_LOC_COLOR, "a_color");
+	glBindAttribLocation(programId, ATTR_LOC_TEXTURE, "a_texture");
+}
+
+// プログラムを生成する(初めて使用する組み合わせの時に生成)
+static PROGRAM_INFO *createProgram(ES1PARAMS *param, int programType)
 {
+	PROGRAM_INFO *program = &param->program[programType];
 	GLuint shaderProg;
+
+	if (program->programId != 0) {
+		return (program);
+	}
+
+	// シェーダプログラム生成(プログラムバイナリキャッシュにあればロード)
+	shaderProg = es1emu_CreateLinkedProgram(shaderSource[programType].vshader, shaderSource[programType].fshader, bindAttribLocation);
+	if (shaderProg == 0) {
+		fprintf(stderr,"es1emu_Init:es1emu_CreateLinkedProgram err\n");
+		return (NULL);
+	}
+
+	// 使用しないuniformのロケーションは-1となる
+	program->programId = shaderProg;
+	program->uPMVMatrix = glGetUniformLocation(shaderProg, "u_pmvMatrix");
+	program->uColor = glGetUniformLocation(shaderProg, "u_color");
+	program->uTexture0 = glGetUniformLocation(shaderProg, "texture0");
+
+	return (program);
+}
+
+// クライアントステートとテクスチャ環境から使用するプログラムを決める
+static int selectProgram(ES1PARAMS *param)
+{
+	if ((param->clientState & STATE_TEXTURE_ARRAY) == 0) {
+		return ((param->clientState & STATE_COLOR_ARRAY) ? ES1EMU_PROGRAM_COLOR_ARRAY : ES1EMU_PROGRAM_VERTEX_ARRAY);
+	}
+	if (param->texEnvMode != GL_MODULATE) {
+		return (ES1EMU_PROGRAM_TEXTURE_ARRAY);
+	}
+	return ((param->clientState & STATE_COLOR_ARRAY) ? ES1EMU_PROGRAM_TEXTURE_MODULATE_COLOR : ES1EMU_PROGRAM_TEXTURE_MODULATE);
+}
+
+int es1emu_Init()
+{
 	int ret = 1;
 
 	// パラメータ初期化
@@ -281,129 +352,34 @@ int es1emu_Init()
 
 	ES1PARAMS *param = getParams();
 
-	do {
-#if 0
-		// SHADER_VERTEX_ARRAY
-		{
-			// シェーダプログラム生成
-			shaderProg = es1emu_CreateProgram(VSHADER_VERTEX_ARRAY, FSHADER_VERTEX_ARRAY);
-			if (shaderProg == 0) {
-				ret = 0;
-				break;
-			}
-
-			// AttribLocationのindexを明示的に指定(リンク前にglBindAttribLocation())
-			glBindAttribLocation(shaderProg, ATTR_LOC_POS, "a_pos");
-
-			// シェーダプログラムリンク
-			shaderProg = es1emu_LinkShaderProgram(shaderProg);
-			if (shaderProg == 0) {
-				ret = 0;
-				break;
-			}
-
-			param->program[ES1EMU_PROGRAM_VERTEX_ARRAY].programId = shaderProg;
-			param->program[ES1EMU_PROGRAM_VERTEX_ARRAY].uPMVMatrix = glGetUniformLocation(shaderProg, "u_pmvMatrix");
-			param->program[ES1EMU_PROGRAM_VERTEX_ARRAY].uColor = glGetUniformLocation(shaderProg, "u_color");
-		}
-
-		// SHADER_COLOR_ARRAY
-		{
-			// シェーダプログラム生成
-			shaderProg = es1emu_CreateProgram(VSHADER_COLOR_ARRAY, FSHADER_COLOR_ARRAY);
-			if (shaderProg == 0) {
-				ret = 0;
-				break;
-			}
-
-			// AttribLocationのindexを明示的に指定(リンク前にglBindAttribLocation())
-			glBindAttribLocation(shaderProg, ATTR_LOC_POS, "a_pos");
-			glBindAttribLocation(shaderProg, ATTR_LOC_COLOR, "a_color");
-
-			// シェーダプログラムリンク
-			shaderProg = es1emu_LinkShaderProgram(shaderProg);
-			if (shaderProg == 0) {
-				ret = 0;
-				break;
-			}
-
-			param->program[ES1EMU_PROGRAM_COLOR_ARRAY].programId = shaderProg;
-			param->program[ES1EMU_PROGRAM_COLOR_ARRAY].uPMVMatrix = glGetUniformLocation(shaderProg, "u_pmvMatrix");
-		}
+	param->texEnvMode = GL_REPLACE;
+	param->curProgram = -1;
+	param->matrixSerial = 1;
+	param->colorSerial = 1;
 
-		// SHADER_TEXTURE_ARRAY
-		{
-			// シェーダプログラム生成
-			shaderProg = es1emu_CreateProgram(VSHADER_TEXTURE_ARRAY, FSHADER_TEXTURE_ARRAY);
-			if (shaderProg == 0) {
-				ret = 0;
-				break;
-			}
-			// AttribLocationのindexを明示的に指定(リンク前にglBindAttribLocation())
-			glBindAttribLocation(shaderProg, ATTR_LOC_POS, "a_pos");
-			glBindAttribLocation(shaderProg, ATTR_LOC_TEXTURE, "a_texture");
-
-			// シェーダプログラムリンク
-			shaderProg = es1emu_LinkShaderProgram(shaderProg);
-			if (shaderProg == 0) {
-				ret = 0;
-				break;
-			}
-
-			param->program[ES1EMU_PROGRAM_TEXTURE_ARRAY].programId = shaderProg;
-			param->program[ES1EMU_PROGRAM_TEXTURE_ARRAY].uPMVMatrix = glGetUniformLocation(shaderProg, "u_pmvMatrix");
-			param->program[ES1EMU_PROGRAM_TEXTURE_ARRAY].uTexture0 = glGetUniformLocation(shaderProg, "texture0");
-		}
-#else
-		// SHADER_VERTEX_ARRAY
-		{
-			// シェーダプログラム生成
-			shaderProg = es1emu_CreateProgram(VSHADER_VERTEX_ARRAY, FSHADER_VERTEX_ARRAY);
-			if (shaderProg == 0) {
-				fprintf(stderr,"es1emu_Init:es1emu_CreateProgram err\n");
-				ret = 0;
-				break;
-			}
-
-			// AttribLocationのindexを明示的に指定(リンク前にglBindAttribLocation())
-			glBindAttribLocation(shaderProg, ATTR_LOC_POS, "a_pos");
-			glBindAttribLocation(shaderProg, ATTR_LOC_COLOR, "a_color");
-			glBindAttribLocation(shaderProg, ATTR_LOC_TEXTURE, "a_texture");
-
-			// シェーダプログラムリンク
-			shaderProg = es1emu_LinkShaderProgram(shaderProg);
-			if (shaderProg == 0) {
-				fprintf(stderr,"es1emu_Init:es1emu_LinkShaderProgram err\n");
-				ret = 0;
-				break;
-			}
-
-			param->program[ES1EMU_PROGRAM_VERTEX_ARRAY].programId = shaderProg;
-			param->program[ES1EMU_PROGRAM_VERTEX_ARRAY].uPMVMatrix = glGetUniformLocation(shaderProg, "u_pmvMatrix");
-			param->program[ES1EMU_PROGRAM_VERTEX_ARRAY].uColor = glGetUniformLocation(shaderProg, "u_color");
-			param->program[ES1EMU_PROGRAM_VERTEX_ARRAY].uTexture0 = glGetUniformLocation(shaderProg, "texture0");
-			param->program[ES1EMU_PROGRAM_VERTEX_ARRAY].uColorArrey = glGetUniformLocation(shaderProg, "u_color_arrey");
-			param->program[ES1EMU_PROGRAM_VERTEX_ARRAY].uTextureArrey = glGetUniformLocation(shaderProg, "u_texture_arrey");
-		}
-
-		es1emu_UseProgram(0);
-#endif
-	} while (0);
+	// 基本のプログラムのみ生成し、その他は使用時に生成する
+	if (createProgram(param, ES1EMU_PROGRAM_VERTEX_ARRAY) == NULL) {
+		ret = 0;
+	} else {
+		es1emu_UseProgram(ES1EMU_PROGRAM_VERTEX_ARRAY);
+	}
 
 	return (ret);
 }
 
 int es1emu_Finish()
 {
-	GLuint shaderProg;
 	int ret = 1;
+	int i;
 	ES1PARAMS *param = getParams();
 
-	shaderProg = param->program[ES1EMU_PROGRAM_VERTEX_ARRAY].programId;
-
-	if(shaderProg != 0){
-		es1emu_DeleteProgram(shaderProg);
+	for (i=0; i<ES1EMU_PROGRAM_MAX; i++) {
+		if (param->program[i].programId != 0) {
+			es1emu_DeleteProgram(param->program[i].programId);
+			param->program[i].programId = 0;
+		}
 	}
+	param->curProgram = -1;
 
 	return (ret);
 }
@@ -411,76 +387,112 @@ int es1emu_Finish()
 void es1emu_UseProgram(int programType)
 {
 	ES1PARAMS *param = getParams();
+	PROGRAM_INFO* program = createProgram(param, programType);
 
-	PROGRAM_INFO* program = &param->program[programType];
+	if (program == NULL) {
+		return;
+	}
 
 	// シェーダプログラムを選択
 	glUseProgram(program->programId);
-#if 0
-	// プロジェクション*モデルビュー
-	MPMatrix mat;
-	es1emu_MultMatrix(&mat, &param->filo[1].cur, &param->filo[0].cur);
-
-	// マトリクスUniform転送
-	glUniformMatrix4fv(program->uPMVMatrix, 1, GL_FALSE, (GLfloat*)&mat);
-
-	// シェーダ毎のパラメータ転送
+	param->curProgram = programType;
+	param->stat.programSwitch++;
 
-	switch (programType)
-	{
-	case ES1EMU_PROGRAM_VERTEX_ARRAY:
-		glUniform4fv(program->uColor, 1, (GLfloat*)&param->color);
-		glEnableVertexAttribArray(ATTR_LOC_POS);
-		break;
-	case ES1EMU_PROGRAM_COLOR_ARRAY:
-		glEnableVertexAttribArray(ATTR_LOC_POS);
-		glEnableVertexAttribArray(ATTR_LOC_COLOR);
-		break;
-	case ES1EMU_PROGRAM_TEXTURE_ARRAY:
-		glEnableVertexAttribArray(ATTR_LOC_POS);
-		glEnableVertexAttribArray(ATTR_LOC_TEXTURE);
+	// テクスチャユニットは固定(GL_TEXTURE0)なので、プログラム毎に1回だけ転送する
+	if ((program->uTexture0 >= 0) && (program->texture0Set == 0)) {
 		glUniform1i(program->uTexture0, 0);
-		break;
-	default:
-		break;
+		program->texture0Set = 1;
 	}
-#else
-	glUniform1i(program->uTextureArrey, 0);
-	glUniform1i(program->uColorArrey, 0);
-	glUniform1i(program->uTexture0, 0);
 	glEnableVertexAttribArray(ATTR_LOC_POS);
-#endif
 }
 
 void es1emu_LoadMatrix()
 {
 	ES1PARAMS *param = getParams();
-	PROGRAM_INFO* program = &param->program[0];
+	int programType = selectProgram(param);
 
-	MPMatrix mat;
-	es1emu_MultMatrix(&mat, &param->filo[1].cur, &param->filo[0].cur);
+	// クライアントステートが変わった時だけプログラムを切り替える
+	if (programType != param->curProgram) {
+		es1emu_UseProgram(programType);
+		if (programType != param->curProgram) {
+			return;
+		}
+	}
+	PROGRAM_INFO* program = &param->program[param->curProgram];
 
-	// マトリクスUniform転送
-	glUniformMatrix4fv(program->uPMVMatrix, 1, GL_FALSE, (GLfloat*)&mat);
+	// 変更されたuniformだけを転送する
+	if (program->matrixSerial != param->matrixSerial) {
+		if (param->pmvSerial != param->matrixSerial) {
+			es1emu_MultMatrix(&param->pmv, &param->filo[1].cur, &param->filo[0].cur);
+			param->pmvSerial = param->matrixSerial;
+		}
+		// マトリクスUniform転送
+		glUniformMatrix4fv(program->uPMVMatrix, 1, GL_FALSE, (GLfloat*)&param->pmv);
+		program->matrixSerial = param->matrixSerial;
+		param->stat.matrixUpload++;
+	} else {
+		param->stat.matrixSkip++;
+	}
 
-	//glUniform4fv(program->uColor, 1, (GLfloat*)&param->color);
+	if (program->uColor >= 0) {
+		if (program->colorSerial != param->colorSerial) {
+			glUniform4fv(program->uColor, 1, (GLfloat*)&param->color);
+			program->colorSerial = param->colorSerial;
+			param->stat.colorUpload++;
+		} else {
+			param->stat.colorSkip++;
+		}
+	}
+}
+
+void es1emu_GetStatistics(ES1EMU_STATISTICS *stat, int reset)
+{
+	ES1PARAMS *param = getParams();
+
+	memcpy(stat, &param->stat, sizeof(ES1EMU_STATISTICS));
+	if (reset != 0) {
+		memset(&param->stat, 0, sizeof(ES1EMU_STATISTICS));
+	}
+}
+
+void es1emu_GetModelViewMatrix(float *m)
+{
+	ES1PARAMS *param = getParams();
+
+	memcpy(m, &param->filo[0].cur, sizeof(MPMatrix));
+}
+
+void es1emu_GetColor(float *rgba)
+{
+	ES1PARAMS *param = getParams();
+
+	rgba[0] = param->color.r;
+	rgba[1] = param->color.g;
+	rgba[2] = param->color.b;
+	rgba[3] = param->color.a;
+}
+
+GLint es1emu_GetMatrixMode(void)
+{
+	ES1PARAMS *param = getParams();
+
+	return((GLint)(GL_MODELVIEW^param->mode));
 }
 
 void GL_APIENTRY es1emu_glEnableClientState (GLenum array)
 {
 	ES1PARAMS* param = getParams();
-	PROGRAM_INFO* program = &param->program[0];
 
 	switch (array)
 	{
 	case GL_COLOR_ARRAY:			/* カラー配列。glColorPointer() を参照 */
-		glUniform1i(program->uColorArrey, 1);
+		param->clientState |= STATE_COLOR_ARRAY;
 		glEnableVertexAttribArray(ATTR_LOC_COLOR);
 		break;
 	case GL_NORMAL_ARRAY:			/* 法線配列。glNormalPointer() を参照 */
 		break;
 	case GL_TEXTURE_COORD_ARRAY:	/* テクスチャ座標配列。glTexCoordPointer() を参照 */
-		glUniform1i(program->uTextureArrey, 1);
+		param->clientState |= STATE_TEXTURE_ARRAY;
 		glEnableVertexAttribArray(ATTR_LOC_TEXTURE);
 		break;
 	case GL_VERTEX_ARRAY:			/* 頂点配列。glVertexPointer() を参照 */
@@ -493,18 +505,17 @@ void GL_APIENTRY es1emu_glEnableClientState (GLenum array)
 void GL_APIENTRY es1emu_glDisableClientState (GLenum array)
 {
 	ES1PARAMS* param = getParams();
-	PROGRAM_INFO* program = &param->program[0];
 
 	switch (array)
 	{
 	case GL_COLOR_ARRAY:			/* カラー配列。glColorPointer() を参照 */
-		glUniform1i(program->uColorArrey, 0);
+		param->clientState &= ~STATE_COLOR_ARRAY;
 		glDisableVertexAttribArray(ATTR_LOC_COLOR);
 		break;
 	case GL_NORMAL_ARRAY:			/* 法線配列。glNormalPointer() を参照 */
 		break;
 	case GL_TEXTURE_COORD_ARRAY:	/* テクスチャ座標配列。glTexCoordPointer() を参照 */
-		glUniform1i(program->uTextureArrey, 0);
+		param->clientState &= ~STATE_TEXTURE_ARRAY;
 		glDisableVertexAttribArray(ATTR_LOC_TEXTURE);
 		break;
 	case GL_VERTEX_ARRAY:			/* 頂点配列。glVertexPointer() を参照 */
@@ -518,14 +529,29 @@ void GL_APIENTRY es1emu_glDisableClientState (GLenum array)
 void GL_APIENTRY es1emu_glColor4f(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
 {
 	ES1PARAMS* param = getParams();
-	PROGRAM_INFO* program = &param->program[0];
 
+	if ((param->color.r == red) && (param->color.g == green) && (param->color.b == blue) && (param->color.a == alpha)) {
+		return;
+	}
 	param->color.r = red;
 	param->color.g = green;
 	param->color.b = blue;
 	param->color.a = alpha;
 
-	glUniform4fv(program->uColor, 1, (GLfloat*)&param->color);
+	// 描画時(es1emu_LoadMatrix)に転送する
+	param->colorSerial++;
+}
+
+void GL_APIENTRY es1emu_glTexEnvi(GLenum target, GLenum pname, GLint param)
+{
+	ES1PARAMS* es1param = getParams();
+
+	if((target != GL_TEXTURE_ENV) || (pname != GL_TEXTURE_ENV_MODE)){
+		return;
+	}
+	// GL_REPLACE:テクスチャ色をそのまま使用 , GL_MODULATE:テクスチャ色 * 頂点色
+	// 描画時(es1emu_LoadMatrix)にプログラムを切り替える
+	es1param->texEnvMode = param;
 }
 
 void GL_APIENTRY es1emu_glPushMatrix(void)
@@ -535,6 +561,11 @@ void GL_APIENTRY es1emu_glPushMatrix(void)
 
 	if (filo->sp < STACK_SIZE) {
 		memcpy(&filo->mat[(filo->sp)++], &filo->cur, sizeof(MPMatrix));
+	} else {
+		if (filo->overflow == 0) {
+			fprintf(stderr,"es1emu_glPushMatrix:stack overflow\n");
+		}
+		filo->overflow++;
 	}
 }
 
@@ -543,8 +574,12 @@ void GL_APIENTRY es1emu_glPopMatrix(void)
 	ES1PARAMS	*param = getParams();
 	MATRIX_FILO	*filo = &param->filo[param->mode];
 
-	if (filo->sp > 0) {
+	if (filo->overflow > 0) {
+		// 積めなかったPushに対応するPopは、他の階層を壊さないように何もしない
+		filo->overflow--;
+	} else if (filo->sp > 0) {
 		memcpy(&filo->cur, &filo->mat[--(filo->sp)], sizeof(MPMatrix));
+		param->matrixSerial++;
 	}
 }
 
@@ -558,27 +593,42 @@ void GL_APIENTRY es1emu_glMatrixMode(GLenum mode)
 
 void GL_APIENTRY es1emu_glLoadIdentity(void)
 {
-	es1emu_LoadIdentityMatrix(getParams()->pMat);
+	ES1PARAMS *param = getParams();
+
+	es1emu_LoadIdentityMatrix(param->pMat);
+	param->matrixSerial++;
 }
 
 void GL_APIENTRY es1emu_glOrthof(GLfloat left, GLfloat right, GLfloat bottom, GLfloat top, GLfloat zNear, GLfloat zFar)
 {
-	es1emu_OrthoMatrix(getParams()->pMat, left, right, bottom,top, zNear, zFar);
+	ES1PARAMS *param = getParams();
+
+	es1emu_OrthoMatrix(param->pMat, left, right, bottom,top, zNear, zFar);
+	param->matrixSerial++;
 }
 
 void GL_APIENTRY es1emu_glRotatef (GLfloat angle, GLfloat x, GLfloat y, GLfloat z)
 {
-	es1emu_RotateMatrix(getParams()->pMat, angle, x, y, z);
+	ES1PARAMS *param = getParams();
+
+	es1emu_RotateMatrix(param->pMat, angle, x, y, z);
+	param->matrixSerial++;
 }
 
 void GL_APIENTRY es1emu_glScalef (GLfloat x, GLfloat y, GLfloat z)
 {
-	es1emu_ScaleMatrix(getParams()->pMat, x, y, z);
+	ES1PARAMS *param = getParams();
+
+	es1emu_ScaleMatrix(param->pMat, x, y, z);
+	param->matrixSerial++;
 }
 
 void GL_APIENTRY es1emu_glTranslatef (GLfloat x, GLfloat y, GLfloat z)
 {
-	es1emu_TranslateMatrix(getParams()->pMat, x, y, z);
+	ES1PARAMS *param = getParams();
+
+	es1emu_TranslateMatrix(param->pMat, x, y, z);
+	param->matrixSerial++;
 }
 
 void GL_APIENTRY es1emu_glVertexPointer (GLint size, GLenum type, GLsizei stride, const GLvoid *pointer)
@@ -613,6 +663,11 @@ void GL_APIENTRY glColor4f(GLfloat red, GLfloat green, GLfloat blue, GLfloat alp
 	es1emu_glColor4f(red, green, blue, alpha);
 }
 
+void GL_APIENTRY glTexEnvi(GLenum target, GLenum pname, GLint param)
+{
+	es1emu_glTexEnvi(target, pname, param);
+}
+
 void GL_APIENTRY glPopMatrix(void)
 {
 	es1emu_glPopMatrix();
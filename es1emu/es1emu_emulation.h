@@ -36,14 +36,25 @@
 #ifdef _GLES1_EMULATION
 
 // シェーダ関連
-// シェーダ
+// シェーダ(有効なクライアントステートとテクスチャ環境の組み合わせ毎)
 enum {
-	ES1EMU_PROGRAM_VERTEX_ARRAY = 0,
-//	ES1EMU_PROGRAM_COLOR_ARRAY,
-//	ES1EMU_PROGRAM_TEXTURE_ARRAY,
+	ES1EMU_PROGRAM_VERTEX_ARRAY = 0,			// グローバルカラー
+	ES1EMU_PROGRAM_COLOR_ARRAY,					// 頂点カラー
+	ES1EMU_PROGRAM_TEXTURE_ARRAY,				// テクスチャ(GL_REPLACE)
+	ES1EMU_PROGRAM_TEXTURE_MODULATE,			// テクスチャ * グローバルカラー(GL_MODULATE)
+	ES1EMU_PROGRAM_TEXTURE_MODULATE_COLOR,		// テクスチャ * 頂点カラー(GL_MODULATE)
 	ES1EMU_PROGRAM_MAX
 };
 
+// 統計情報
+typedef struct {
+	unsigned long long	programSwitch;		// glUseProgram回数
+	unsigned long long	matrixUpload;		// マトリクス転送回数
+	unsigned long long	matrixSkip;			// マトリクス転送省略回数
+	unsigned long long	colorUpload;		// グローバルカラー転送回数
+	unsigned long long	colorSkip;			// グローバルカラー転送省略回数
+} ES1EMU_STATISTICS;
+
 /**
  * @brief	初期化
  */
@@ -56,10 +67,31 @@ int es1emu_Finish();
 
 /**
  * @brief	プログラム設定
+ * 			通常は描画時(es1emu_LoadMatrix)にクライアントステートから自動で選択する
  */
 void es1emu_UseProgram(int programType);
 void es1emu_LoadMatrix();
 
+/**
+ * @brief	現在のモデルビュー行列,グローバルカラーを取得
+ * 			(glGetFloatv(GL_MODELVIEW_MATRIX/GL_CURRENT_COLOR)相当)
+ */
+void es1emu_GetModelViewMatrix(float *m);
+void es1emu_GetColor(float *rgba);
+
+/**
+ * @brief	現在の行列モードを取得
+ * 			(glGetIntegerv(GL_MATRIX_MODE)相当)
+ */
+GLint es1emu_GetMatrixMode(void);
+
+/**
+ * @brief	uniform転送の統計情報を取得(呼び出しスレッドのコンテキスト)
+ * @param[out]	stat 統計情報
+ * @param[in]	reset 1:取得後にカウンタをクリアする
+ */
+void es1emu_GetStatistics(ES1EMU_STATISTICS *stat, int reset);
+
 /**
  * opengl es 1 emulation
  */
@@ -79,9 +111,15 @@ void es1emu_LoadMatrix();
 #define GL_COLOR_ARRAY                    0x8076
 #define GL_TEXTURE_COORD_ARRAY            0x8078
 
+/* TextureEnv */
+#define GL_TEXTURE_ENV                    0x2300
+#define GL_TEXTURE_ENV_MODE               0x2200
+#define GL_MODULATE                       0x2100
+
 GL_API void GL_APIENTRY es1emu_glEnableClientState (GLenum array);
 GL_API void GL_APIENTRY es1emu_glDisableClientState (GLenum array);
 GL_API void GL_APIENTRY es1emu_glColor4f (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+GL_API void GL_APIENTRY es1emu_glTexEnvi (GLenum target, GLenum pname, GLint param);
 GL_API void GL_APIENTRY es1emu_glPopMatrix (void);
 GL_API void GL_APIENTRY es1emu_glPushMatrix (void);
 GL_API void GL_APIENTRY es1emu_glMatrixMode (GLenum mode);
@@ -98,6 +136,7 @@ GL_API void GL_APIENTRY es1emu_glTexCoordPointer (GLint size, GLenum type, GLsiz
 GL_API void GL_APIENTRY glEnableClientState (GLenum array);
 GL_API void GL_APIENTRY glDisableClientState (GLenum array);
 GL_API void GL_APIENTRY glColor4f (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+GL_API void GL_APIENTRY glTexEnvi (GLenum target, GLenum pname, GLint param);
 GL_API void GL_APIENTRY glPopMatrix (void);
 GL_API void GL_APIENTRY glPushMatrix (void);
 GL_API void GL_APIENTRY glMatrixMode (GLenum mode);
@@ -25,6 +25,13 @@
 #include "config.h"
 #include <math.h>
 #include <string.h>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#define ES1EMU_MATRIX_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ES1EMU_MATRIX_NEON
+#endif
 #include <GLES2/gl2.h>
 //#include <GLES2/gl2ext.h>
 #include "es1emu_emulation.h"
@@ -59,7 +66,7 @@ void es1emu_CopyMatrix(MPMatrix *dst, const MPMatrix *src)
 	memcpy(dst, src, sizeof(MPMatrix));
 }
 
-void es1emu_MultMatrix(MPMatrix *dst, const MPMatrix *src1, const MPMatrix *src2)
+void es1emu_MultMatrixScalar(MPMatrix *dst, const MPMatrix *src1, const MPMatrix *src2)
 {
 	GLint x;
 	GLint y;
@@ -77,62 +84,138 @@ void es1emu_MultMatrix(MPMatrix *dst, const MPMatrix *src1, const MPMatrix *src2
 	memcpy(dst, &tmp, sizeof(MPMatrix));
 }
 
+void es1emu_MultMatrix(MPMatrix *dst, const MPMatrix *src1, const MPMatrix *src2)
+{
+#if defined(ES1EMU_MATRIX_SSE)
+	// 結果の列x = src1の列0..3 * src2->m[x][0..3] の和
+	__m128 c0 = _mm_loadu_ps(src1->m[0]);
+	__m128 c1 = _mm_loadu_ps(src1->m[1]);
+	__m128 c2 = _mm_loadu_ps(src1->m[2]);
+	__m128 c3 = _mm_loadu_ps(src1->m[3]);
+	__m128 r[4];
+	GLint x;
+
+	for (x=0; x<4; x++) {
+		r[x] = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(src2->m[x][0])), _mm_mul_ps(c1, _mm_set1_ps(src2->m[x][1]))),
+				_mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(src2->m[x][2])), _mm_mul_ps(c3, _mm_set1_ps(src2->m[x][3]))));
+	}
+	// dstがsrc1/src2と同じ場合があるので、全て計算してから書き込む
+	for (x=0; x<4; x++) {
+		_mm_storeu_ps(dst->m[x], r[x]);
+	}
+#elif defined(ES1EMU_MATRIX_NEON)
+	float32x4_t c0 = vld1q_f32(src1->m[0]);
+	float32x4_t c1 = vld1q_f32(src1->m[1]);
+	float32x4_t c2 = vld1q_f32(src1->m[2]);
+	float32x4_t c3 = vld1q_f32(src1->m[3]);
+	float32x4_t r[4];
+	GLint x;
+
+	for (x=0; x<4; x++) {
+		r[x] = vmulq_n_f32(c0, src2->m[x][0]);
+		r[x] = vmlaq_n_f32(r[x], c1, src2->m[x][1]);
+		r[x] = vmlaq_n_f32(r[x], c2, src2->m[x][2]);
+		r[x] = vmlaq_n_f32(r[x], c3, src2->m[x][3]);
+	}
+	for (x=0; x<4; x++) {
+		vst1q_f32(dst->m[x], r[x]);
+	}
+#else
+	es1emu_MultMatrixScalar(dst, src1, src2);
+#endif
+}
+
 void es1emu_RotateMatrix(MPMatrix *mat, const float angle, const float x, const float y, const float z)
 {
 	MPMatrix rotate;
-	float rad = ES1EMU_DEG_TO_RAD(angle);
-	float c = cosf(rad);
-	float s = sinf(rad);
-
-	es1emu_LoadIdentityMatrix(&rotate);
+	float rad;
+	float c,s,len,nx,ny,nz,ic;
+	float t0,t1;
+	GLint i;
 
-	// X軸回転
-	if (x>0.0f) {
-		rotate.m[1][1] = c;
-		rotate.m[1][2] = s;
-		rotate.m[2][1] = -s;
-		rotate.m[2][2] = c;
+	if (angle == 0.0f) {
+		return;
+	}
+	rad = ES1EMU_DEG_TO_RAD(angle);
+	c = cosf(rad);
+	s = sinf(rad);
+
+	// 座標軸回りの回転は、該当する2列だけを更新する
+	if ((x == 0.0f) && (y == 0.0f) && (z != 0.0f)) {
+		if (z < 0.0f) s = -s;
+		for (i=0; i<4; i++) {
+			t0 = mat->m[0][i];
+			t1 = mat->m[1][i];
+			mat->m[0][i] = t0 * c + t1 * s;
+			mat->m[1][i] = t1 * c - t0 * s;
+		}
+		return;
 	}
-	// Y軸回転
-	if (y>0.0f) {
-		rotate.m[0][0] = c;
-		rotate.m[0][2] = -s;
-		rotate.m[2][0] = s;
-		rotate.m[2][2] = c;
+	if ((x != 0.0f) && (y == 0.0f) && (z == 0.0f)) {
+		if (x < 0.0f) s = -s;
+		for (i=0; i<4; i++) {
+			t0 = mat->m[1][i];
+			t1 = mat->m[2][i];
+			mat->m[1][i] = t0 * c + t1 * s;
+			mat->m[2][i] = t1 * c - t0 * s;
+		}
+		return;
 	}
-	// Z軸回転
-	if (z>0.0f) {
-		rotate.m[0][0] = c;
-		rotate.m[0][1] = s;
-		rotate.m[1][0] = -s;
-		rotate.m[1][1] = c;
+	if ((x == 0.0f) && (y != 0.0f) && (z == 0.0f)) {
+		if (y < 0.0f) s = -s;
+		for (i=0; i<4; i++) {
+			t0 = mat->m[0][i];
+			t1 = mat->m[2][i];
+			mat->m[0][i] = t0 * c - t1 * s;
+			mat->m[2][i] = t1 * c + t0 * s;
+		}
+		return;
 	}
 
+	// 任意軸回転(glRotatefと同じ)
+	len = sqrtf(x * x + y * y + z * z);
+	if (len == 0.0f) {
+		return;
+	}
+	nx = x / len;
+	ny = y / len;
+	nz = z / len;
+	ic = 1.0f - c;
+
+	es1emu_LoadIdentityMatrix(&rotate);
+	rotate.m[0][0] = nx * nx * ic + c;
+	rotate.m[0][1] = ny * nx * ic + nz * s;
+	rotate.m[0][2] = nx * nz * ic - ny * s;
+	rotate.m[1][0] = nx * ny * ic - nz * s;
+	rotate.m[1][1] = ny * ny * ic + c;
+	rotate.m[1][2] = ny * nz * ic + nx * s;
+	rotate.m[2][0] = nx * nz * ic + ny * s;
+	rotate.m[2][1] = ny * nz * ic - nx * s;
+	rotate.m[2][2] = nz * nz * ic + c;
+
 	es1emu_MultMatrix(mat, mat, &rotate);
 }
 
 void es1emu_TranslateMatrix(MPMatrix *mat, const float x, const float y, const float z)
 {
-	MPMatrix translate;
-
-	es1emu_LoadIdentityMatrix(&translate);
-	translate.m[3][0] = x;
-	translate.m[3][1] = y;
-	translate.m[3][2] = z;
+	GLint i;
 
-	es1emu_MultMatrix(mat, mat, &translate);
+	// 列3 += 列0*x + 列1*y + 列2*z
+	for (i=0; i<4; i++) {
+		mat->m[3][i] += mat->m[0][i] * x + mat->m[1][i] * y + mat->m[2][i] * z;
+	}
 }
 
 void es1emu_ScaleMatrix(MPMatrix *mat, const float x, const float y, const float z)
 {
-	MPMatrix scale;
-
-	es1emu_LoadIdentityMatrix(&scale);
-	scale.m[0][0] = x;
-	scale.m[1][1] = y;
-	scale.m[2][2] = z;
+	GLint i;
 
-	es1emu_MultMatrix(mat, mat, &scale);
+	for (i=0; i<4; i++) {
+		mat->m[0][i] *= x;
+		mat->m[1][i] *= y;
+		mat->m[2][i] *= z;
+	}
 }
 
 void es1emu_OrthoMatrix(MPMatrix *mat, const float left, const float right, const float bottom, const float top, const float zNear, const float zFar)
@@ -60,7 +60,15 @@ void es1emu_CopyMatrix(MPMatrix *dst, const MPMatrix *src);
 void es1emu_MultMatrix(MPMatrix *dst, const MPMatrix *src1, const MPMatrix *src2);
 
 /**
- * @brief		現在の行列を回転した行列を算出
+ * @brief		現在の行列と指定した行列との積を算出(SIMDを使用しない実装)
+ * @param[out]	dst src1とsrc2の積
+ * @param[in]	src1 現在マトリクス
+ * @param[in]	src2 指定マトリクス
+ */
+void es1emu_MultMatrixScalar(MPMatrix *dst, const MPMatrix *src1, const MPMatrix *src2);
+
+/**
+ * @brief		現在の行列を回転した行列を算出(任意軸)
  * @param[io]	mat 現在のマトリクス→回転後のマトリクス
  * @param[in]	angle 角度
  * @param[in]	x X方向
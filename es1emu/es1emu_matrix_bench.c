@@ -0,0 +1,356 @@
+/*
+ * Copyright © 2026 glview contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * es1emu 行列演算のマイクロベンチマーク
+ *   従来の実装(4x4行列を生成してスカラーで乗算)と、
+ *   現在の実装(SIMD乗算,平行移動/拡大縮小/回転のインプレース処理)を比較する。
+ *   計測の前に両者の結果が一致することを確認し、一致しなければ終了コード1で終了する。
+ *
+ *   usage: es1emu_matrix_bench [loop count]
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <GLES2/gl2.h>
+#include "es1emu_emulation.h"
+#include "es1emu_matrix.h"
+
+#define BENCH_LOOP_DEFAULT		(2000000)
+#define BENCH_DEG_TO_RAD(_deg)	(float)((_deg) * M_PI / 180.0f)
+#define BENCH_VERIFY_EPSILON	(1.0e-4f)	// 結果の比較で許容する誤差(相対,1未満の値は絶対)
+#define BENCH_VERIFY_REPEAT		(64)		// 誤差の蓄積も確認するために繰り返す回数
+
+// 最適化で処理が削除されないように結果を蓄積する
+static volatile float bench_sink;
+
+//------------------------------------------------------------------------------
+// 従来の実装
+//------------------------------------------------------------------------------
+static void legacy_TranslateMatrix(MPMatrix *mat, const float x, const float y, const float z)
+{
+	MPMatrix translate;
+
+	es1emu_LoadIdentityMatrix(&translate);
+	translate.m[3][0] = x;
+	translate.m[3][1] = y;
+	translate.m[3][2] = z;
+
+	es1emu_MultMatrixScalar(mat, mat, &translate);
+}
+
+static void legacy_ScaleMatrix(MPMatrix *mat, const float x, const float y, const float z)
+{
+	MPMatrix scale;
+
+	es1emu_LoadIdentityMatrix(&scale);
+	scale.m[0][0] = x;
+	scale.m[1][1] = y;
+	scale.m[2][2] = z;
+
+	es1emu_MultMatrixScalar(mat, mat, &scale);
+}
+
+static void legacy_RotateMatrixZ(MPMatrix *mat, const float angle)
+{
+	MPMatrix rotate;
+	float rad = BENCH_DEG_TO_RAD(angle);
+	float c = cosf(rad);
+	float s = sinf(rad);
+
+	es1emu_LoadIdentityMatrix(&rotate);
+	rotate.m[0][0] = c;
+	rotate.m[0][1] = s;
+	rotate.m[1][0] = -s;
+	rotate.m[1][1] = c;
+
+	es1emu_MultMatrixScalar(mat, mat, &rotate);
+}
+
+// 任意軸回転(glRotatefの定義どおりに行列を生成してスカラーで乗算する)
+static void legacy_RotateMatrix(MPMatrix *mat, const float angle, const float x, const float y, const float z)
+{
+	MPMatrix rotate;
+	float rad = BENCH_DEG_TO_RAD(angle);
+	float c = cosf(rad);
+	float s = sinf(rad);
+	float ic = 1.0f - c;
+	float len = sqrtf(x * x + y * y + z * z);
+	float nx = x / len;
+	float ny = y / len;
+	float nz = z / len;
+
+	es1emu_LoadIdentityMatrix(&rotate);
+	rotate.m[0][0] = nx * nx * ic + c;
+	rotate.m[0][1] = ny * nx * ic + nz * s;
+	rotate.m[0][2] = nx * nz * ic - ny * s;
+	rotate.m[1][0] = nx * ny * ic - nz * s;
+	rotate.m[1][1] = ny * ny * ic + c;
+	rotate.m[1][2] = ny * nz * ic + nx * s;
+	rotate.m[2][0] = nx * nz * ic + ny * s;
+	rotate.m[2][1] = ny * nz * ic - nx * s;
+	rotate.m[2][2] = nz * nz * ic + c;
+
+	es1emu_MultMatrixScalar(mat, mat, &rotate);
+}
+
+//------------------------------------------------------------------------------
+// 計測
+//------------------------------------------------------------------------------
+static double bench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((double)ts.tv_sec * 1.0e9 + (double)ts.tv_nsec);
+}
+
+static void bench_init(MPMatrix *mat)
+{
+	es1emu_LoadIdentityMatrix(mat);
+	es1emu_OrthoMatrix(mat, 0.0f, 640.0f, 480.0f, 0.0f, -1.0f, 1.0f);
+}
+
+static void bench_sum(const MPMatrix *mat)
+{
+	bench_sink += mat->m[0][0] + mat->m[3][0] + mat->m[3][1];
+}
+
+static void bench_print(const char *name, double legacy, double current, long loop)
+{
+	printf("%-12s legacy %8.2f ns/op  current %8.2f ns/op  x%.2f\n",
+		name, legacy / loop, current / loop, (current > 0.0) ? (legacy / current) : 0.0);
+}
+
+//------------------------------------------------------------------------------
+// 検証
+//------------------------------------------------------------------------------
+static int bench_compare(const char *name, const MPMatrix *expect, const MPMatrix *actual)
+{
+	float diff, limit;
+	int i, j;
+
+	for (i=0; i<4; i++) {
+		for (j=0; j<4; j++) {
+			diff = fabsf(expect->m[i][j] - actual->m[i][j]);
+			limit = fabsf(expect->m[i][j]);
+			if (limit < 1.0f) limit = 1.0f;
+			if (!(diff <= limit * BENCH_VERIFY_EPSILON)) {
+				fprintf(stderr, "es1emu_matrix_bench: %s mismatch m[%d][%d] expect %.9g actual %.9g\n",
+					name, i, j, expect->m[i][j], actual->m[i][j]);
+				return (1);
+			}
+		}
+	}
+	return (0);
+}
+
+static void bench_verify_init(MPMatrix *mat)
+{
+	bench_init(mat);
+	es1emu_TranslateMatrix(mat, 12.5f, -7.25f, 0.5f);
+	legacy_RotateMatrix(mat, 33.0f, 0.3f, -0.5f, 0.8f);
+	legacy_ScaleMatrix(mat, 1.5f, 0.75f, 2.0f);
+}
+
+// 現在の実装の結果が従来の実装(スカラー)の結果と一致するかを確認する
+static int bench_verify(void)
+{
+	static const float axis[][3] = {
+		{ 0.0f, 0.0f, 1.0f}, { 0.0f, 0.0f,-2.0f},
+		{ 1.0f, 0.0f, 0.0f}, {-1.0f, 0.0f, 0.0f},
+		{ 0.0f, 1.0f, 0.0f}, { 0.0f,-3.0f, 0.0f},
+		{ 1.0f, 1.0f, 0.0f}, { 0.3f,-0.5f, 0.8f},
+	};
+	MPMatrix expect, actual, src, tmp;
+	char name[64];
+	int error = 0;
+	int i, k;
+
+	// 乗算(出力先と入力が別の場合と同じ場合)
+	bench_verify_init(&src);
+	bench_init(&expect);
+	legacy_RotateMatrix(&expect, 17.0f, 0.0f, 1.0f, 1.0f);
+	actual = expect;
+	es1emu_MultMatrixScalar(&tmp, &expect, &src);
+	es1emu_MultMatrix(&actual, &expect, &src);
+	error |= bench_compare("multiply", &tmp, &actual);
+	actual = expect;
+	for (i=0; i<BENCH_VERIFY_REPEAT; i++) {
+		es1emu_MultMatrixScalar(&expect, &expect, &src);
+		es1emu_MultMatrix(&actual, &actual, &src);
+		bench_verify_init(&src);
+		src.m[3][0] = (float)i * 0.01f;
+	}
+	error |= bench_compare("multiply(in place)", &expect, &actual);
+
+	// 平行移動
+	bench_verify_init(&expect);
+	actual = expect;
+	for (i=0; i<BENCH_VERIFY_REPEAT; i++) {
+		legacy_TranslateMatrix(&expect, 1.0f, -2.0f, 0.25f);
+		es1emu_TranslateMatrix(&actual, 1.0f, -2.0f, 0.25f);
+	}
+	error |= bench_compare("translate", &expect, &actual);
+
+	// 拡大縮小
+	bench_verify_init(&expect);
+	actual = expect;
+	for (i=0; i<BENCH_VERIFY_REPEAT; i++) {
+		legacy_ScaleMatrix(&expect, 1.001f, 0.999f, -1.0f);
+		es1emu_ScaleMatrix(&actual, 1.001f, 0.999f, -1.0f);
+	}
+	error |= bench_compare("scale", &expect, &actual);
+
+	// 回転(座標軸回りと任意軸)
+	for (k=0; k<(int)(sizeof(axis) / sizeof(axis[0])); k++) {
+		bench_verify_init(&expect);
+		actual = expect;
+		for (i=0; i<BENCH_VERIFY_REPEAT; i++) {
+			legacy_RotateMatrix(&expect, 1.5f, axis[k][0], axis[k][1], axis[k][2]);
+			es1emu_RotateMatrix(&actual, 1.5f, axis[k][0], axis[k][1], axis[k][2]);
+		}
+		snprintf(name, sizeof(name), "rotate(%g,%g,%g)", axis[k][0], axis[k][1], axis[k][2]);
+		error |= bench_compare(name, &expect, &actual);
+	}
+
+	// 従来のZ軸回転
+	bench_verify_init(&expect);
+	actual = expect;
+	for (i=0; i<BENCH_VERIFY_REPEAT; i++) {
+		legacy_RotateMatrixZ(&expect, 1.5f);
+		es1emu_RotateMatrix(&actual, 1.5f, 0.0f, 0.0f, 1.0f);
+	}
+	error |= bench_compare("rotate(z)", &expect, &actual);
+
+	return (error);
+}
+
+int main(int argc, char *argv[])
+{
+	MPMatrix mat, src;
+	double t0, legacy, current;
+	long loop = BENCH_LOOP_DEFAULT;
+	long i;
+
+	if (argc > 1) {
+		loop = atol(argv[1]);
+		if (loop <= 0) loop = BENCH_LOOP_DEFAULT;
+	}
+
+#if defined(__SSE__)
+	printf("es1emu matrix benchmark (SSE) loop = %ld\n", loop);
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	printf("es1emu matrix benchmark (NEON) loop = %ld\n", loop);
+#else
+	printf("es1emu matrix benchmark (scalar) loop = %ld\n", loop);
+#endif
+
+	if (bench_verify() != 0) {
+		fprintf(stderr, "es1emu_matrix_bench: results differ from the scalar implementation\n");
+		return (1);
+	}
+
+	// 乗算
+	bench_init(&src);
+	es1emu_TranslateMatrix(&src, 0.001f, 0.002f, 0.0f);
+	bench_init(&mat);
+	t0 = bench_now();
+	for (i=0; i<loop; i++) {
+		es1emu_MultMatrixScalar(&mat, &mat, &src);
+		if ((i & 0xff) == 0) bench_init(&mat);
+	}
+	legacy = bench_now() - t0;
+	bench_sum(&mat);
+	bench_init(&mat);
+	t0 = bench_now();
+	for (i=0; i<loop; i++) {
+		es1emu_MultMatrix(&mat, &mat, &src);
+		if ((i & 0xff) == 0) bench_init(&mat);
+	}
+	current = bench_now() - t0;
+	bench_sum(&mat);
+	bench_print("multiply", legacy, current, loop);
+
+	// 平行移動
+	bench_init(&mat);
+	t0 = bench_now();
+	for (i=0; i<loop; i++) {
+		legacy_TranslateMatrix(&mat, 1.0f, 2.0f, 0.0f);
+		if ((i & 0xff) == 0) bench_init(&mat);
+	}
+	legacy = bench_now() - t0;
+	bench_sum(&mat);
+	bench_init(&mat);
+	t0 = bench_now();
+	for (i=0; i<loop; i++) {
+		es1emu_TranslateMatrix(&mat, 1.0f, 2.0f, 0.0f);
+		if ((i & 0xff) == 0) bench_init(&mat);
+	}
+	current = bench_now() - t0;
+	bench_sum(&mat);
+	bench_print("translate", legacy, current, loop);
+
+	// 拡大縮小
+	bench_init(&mat);
+	t0 = bench_now();
+	for (i=0; i<loop; i++) {
+		legacy_ScaleMatrix(&mat, 1.001f, 0.999f, 1.0f);
+		if ((i & 0xff) == 0) bench_init(&mat);
+	}
+	legacy = bench_now() - t0;
+	bench_sum(&mat);
+	bench_init(&mat);
+	t0 = bench_now();
+	for (i=0; i<loop; i++) {
+		es1emu_ScaleMatrix(&mat, 1.001f, 0.999f, 1.0f);
+		if ((i & 0xff) == 0) bench_init(&mat);
+	}
+	current = bench_now() - t0;
+	bench_sum(&mat);
+	bench_print("scale", legacy, current, loop);
+
+	// Z軸回転
+	bench_init(&mat);
+	t0 = bench_now();
+	for (i=0; i<loop; i++) {
+		legacy_RotateMatrixZ(&mat, 1.5f);
+		if ((i & 0xff) == 0) bench_init(&mat);
+	}
+	legacy = bench_now() - t0;
+	bench_sum(&mat);
+	bench_init(&mat);
+	t0 = bench_now();
+	for (i=0; i<loop; i++) {
+		es1emu_RotateMatrix(&mat, 1.5f, 0.0f, 0.0f, 1.0f);
+		if ((i & 0xff) == 0) bench_init(&mat);
+	}
+	current = bench_now() - t0;
+	bench_sum(&mat);
+	bench_print("rotate", legacy, current, loop);
+
+	return (0);
+}
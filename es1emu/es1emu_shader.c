@@ -24,6 +24,13 @@
 
 #include "config.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <EGL/egl.h>
 #include <GLES2/gl2.h>
 //#include <GLES2/gl2ext.h>
 #include "es1emu_emulation.h"
@@ -31,6 +38,55 @@
 
 #ifdef _GLES1_EMULATION
 
+//------------------------------------------------------------------------------
+// プログラムバイナリキャッシュ
+//   リンク済みプログラムのバイナリ(GL_OES_get_program_binary)をプロセス内と
+//   ディスクに保存し、2回目以降(他のウィンドウスレッド,次回起動)はコンパイルと
+//   リンクを省略する。ドライバ(GL_VENDOR,GL_RENDERER,GL_VERSION)が異なる場合や
+//   バイナリのロードに失敗した場合は、ソースからコンパイルする。
+//------------------------------------------------------------------------------
+#define ES1EMU_USE_PROGRAM_BINARY_CACHE
+
+#ifndef GL_PROGRAM_BINARY_LENGTH_OES
+#define GL_PROGRAM_BINARY_LENGTH_OES		0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS_OES
+#define GL_NUM_PROGRAM_BINARY_FORMATS_OES	0x87FE
+#endif
+
+#define PROGRAM_CACHE_MAGIC			"E1PB"
+#define PROGRAM_CACHE_VERSION		(1)
+#define PROGRAM_CACHE_PATH_MAX		(1024)
+#define PROGRAM_CACHE_DRIVER_MAX	(1024)
+
+typedef void (GL_APIENTRY *PFN_GET_PROGRAM_BINARY)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+typedef void (GL_APIENTRY *PFN_PROGRAM_BINARY)(GLuint program, GLenum binaryFormat, const void *binary, GLint length);
+
+// キャッシュ(プロセス内)
+typedef struct _program_cache_entry {
+	struct _program_cache_entry	*next;
+	uint64_t	key;				// ソースのハッシュ
+	char		*driver;			// 作成したドライバ
+	GLenum		format;
+	GLint		length;
+	void		*binary;
+} PROGRAM_CACHE_ENTRY;
+
+// ディスクのファイルヘッダ(後ろにドライバ文字列,バイナリが続く)
+typedef struct {
+	char		magic[4];
+	uint32_t	version;
+	uint32_t	driverLength;
+	uint32_t	format;
+	uint32_t	length;
+} PROGRAM_CACHE_FILE_HEADER;
+
+static pthread_mutex_t		programCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+static PROGRAM_CACHE_ENTRY	*programCacheList = NULL;
+static pthread_once_t		programCacheOnce = PTHREAD_ONCE_INIT;
+static PFN_GET_PROGRAM_BINARY	pfnGetProgramBinary = NULL;
+static PFN_PROGRAM_BINARY		pfnProgramBinary = NULL;
+
 //------------------------------------------------------------------------------
 // 内部関数プロトタイプ
 //------------------------------------------------------------------------------
@@ -42,6 +98,17 @@
  */
 static GLuint MP_CompileShaderProgram(GLint type, const char *pProgram);
 
+/**
+ * @brief		プログラムバイナリキャッシュ内部処理
+ */
+static void MP_ProgramCacheInit(void);
+static int MP_ProgramCacheSupported(void);
+static uint64_t MP_ProgramCacheKey(const char* pVShader, const char* pFShader);
+static void MP_ProgramCacheDriver(char *driver, size_t size);
+static void MP_ProgramCachePath(uint64_t key, char *path, size_t size);
+static GLuint MP_ProgramCacheLoad(uint64_t key, const char *driver);
+static void MP_ProgramCacheStore(uint64_t key, const char *driver, GLuint programId);
+
 //------------------------------------------------------------------------------
 // 関数
 //------------------------------------------------------------------------------
@@ -129,4 +196,305 @@ void es1emu_DeleteProgram(const GLuint programId)
 	glDeleteProgram(programId);
 }
 
+GLuint es1emu_CreateLinkedProgram(const char* pVShader, const char* pFShader, void (*pBindAttrib)(GLuint programId))
+{
+	GLuint programId;
+#ifdef ES1EMU_USE_PROGRAM_BINARY_CACHE
+	char driver[PROGRAM_CACHE_DRIVER_MAX];
+	uint64_t key = 0;
+	int useCache;
+
+	useCache = MP_ProgramCacheSupported();
+	if (useCache == 1) {
+		key = MP_ProgramCacheKey(pVShader, pFShader);
+		MP_ProgramCacheDriver(driver, sizeof(driver));
+		programId = MP_ProgramCacheLoad(key, driver);
+		if (programId != 0) {
+			return (programId);
+		}
+	}
+#endif
+
+	// ソースからコンパイル
+	programId = es1emu_CreateProgram(pVShader, pFShader);
+	if (programId == 0) {
+		return (0);
+	}
+	if (pBindAttrib != NULL) {
+		pBindAttrib(programId);
+	}
+	programId = es1emu_LinkShaderProgram(programId);
+	if (programId == 0) {
+		return (0);
+	}
+
+#ifdef ES1EMU_USE_PROGRAM_BINARY_CACHE
+	if (useCache == 1) {
+		MP_ProgramCacheStore(key, driver, programId);
+	}
+#endif
+	return (programId);
+}
+
+#ifdef ES1EMU_USE_PROGRAM_BINARY_CACHE
+static void MP_ProgramCacheInit(void)
+{
+	pfnGetProgramBinary = (PFN_GET_PROGRAM_BINARY)eglGetProcAddress("glGetProgramBinaryOES");
+	pfnProgramBinary = (PFN_PROGRAM_BINARY)eglGetProcAddress("glProgramBinaryOES");
+}
+
+static int MP_ProgramCacheSupported(void)
+{
+	const char *ext;
+	GLint formats = 0;
+
+	pthread_once(&programCacheOnce, MP_ProgramCacheInit);
+	if ((pfnGetProgramBinary == NULL) || (pfnProgramBinary == NULL)) {
+		return (0);
+	}
+	ext = (const char*)glGetString(GL_EXTENSIONS);
+	if ((ext == NULL) || (strstr(ext, "GL_OES_get_program_binary") == NULL)) {
+		return (0);
+	}
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS_OES, &formats);
+	return ((formats > 0) ? 1 : 0);
+}
+
+static uint64_t MP_ProgramCacheKey(const char* pVShader, const char* pFShader)
+{
+	uint64_t h = 14695981039346656037ULL;
+	const char *p;
+
+	// FNV-1a (頂点シェーダ + '\0' + フラグメントシェーダ)
+	for (p=pVShader; *p != 0; p++) {
+		h = (h ^ (unsigned char)*p) * 1099511628211ULL;
+	}
+	h = h * 1099511628211ULL;
+	for (p=pFShader; *p != 0; p++) {
+		h = (h ^ (unsigned char)*p) * 1099511628211ULL;
+	}
+	return (h);
+}
+
+static void MP_ProgramCacheDriver(char *driver, size_t size)
+{
+	const char *vendor   = (const char*)glGetString(GL_VENDOR);
+	const char *renderer = (const char*)glGetString(GL_RENDERER);
+	const char *version  = (const char*)glGetString(GL_VERSION);
+
+	snprintf(driver, size, "%s|%s|%s",
+		(vendor != NULL) ? vendor : "", (renderer != NULL) ? renderer : "", (version != NULL) ? version : "");
+}
+
+// $GLVIEW_SHADER_CACHE_DIR , $XDG_CACHE_HOME/glview , $HOME/.cache/glview の順
+// パスが長すぎる場合は path を空にする(キャッシュを使用しない)
+static void MP_ProgramCachePath(uint64_t key, char *path, size_t size)
+{
+	char dir[PROGRAM_CACHE_PATH_MAX];
+	const char *env;
+	int n;
+
+	path[0] = 0;
+	if ((env = getenv("GLVIEW_SHADER_CACHE_DIR")) != NULL) {
+		n = snprintf(dir, sizeof(dir), "%s", env);
+	} else if ((env = getenv("XDG_CACHE_HOME")) != NULL) {
+		mkdir(env, 0700);
+		n = snprintf(dir, sizeof(dir), "%s/glview", env);
+	} else if ((env = getenv("HOME")) != NULL) {
+		n = snprintf(dir, sizeof(dir), "%s/.cache", env);
+		if ((n < 0) || ((size_t)n >= sizeof(dir))) {
+			return;
+		}
+		mkdir(dir, 0700);
+		n = snprintf(dir, sizeof(dir), "%s/.cache/glview", env);
+	} else {
+		return;
+	}
+	if ((n <= 0) || ((size_t)n >= sizeof(dir))) {
+		return;
+	}
+	mkdir(dir, 0700);
+	n = snprintf(path, size, "%s/es1emu_%016llx.bin", dir, (unsigned long long)key);
+	if ((n < 0) || ((size_t)n >= size)) {
+		path[0] = 0;
+	}
+}
+
+// バイナリからプログラムを生成する
+static GLuint MP_ProgramCacheCreate(GLenum format, const void *binary, GLint length)
+{
+	GLuint programId;
+	GLint bLinked = 0;
+
+	programId = glCreateProgram();
+	pfnProgramBinary(programId, format, binary, length);
+	glGetProgramiv(programId, GL_LINK_STATUS, &bLinked);
+	if (!bLinked) {
+		glDeleteProgram(programId);
+		return (0);
+	}
+	return (programId);
+}
+
+static PROGRAM_CACHE_ENTRY *MP_ProgramCacheAdd(uint64_t key, const char *driver, GLenum format, void *binary, GLint length)
+{
+	PROGRAM_CACHE_ENTRY *entry;
+
+	entry = (PROGRAM_CACHE_ENTRY*)calloc(1, sizeof(PROGRAM_CACHE_ENTRY));
+	if (entry == NULL) {
+		free(binary);
+		return (NULL);
+	}
+	entry->key    = key;
+	entry->driver = strdup(driver);
+	entry->format = format;
+	entry->length = length;
+	entry->binary = binary;
+
+	pthread_mutex_lock(&programCacheMutex);
+	entry->next = programCacheList;
+	programCacheList = entry;
+	pthread_mutex_unlock(&programCacheMutex);
+	return (entry);
+}
+
+static GLuint MP_ProgramCacheLoad(uint64_t key, const char *driver)
+{
+	PROGRAM_CACHE_ENTRY *entry;
+	PROGRAM_CACHE_FILE_HEADER header;
+	char path[PROGRAM_CACHE_PATH_MAX];
+	char fileDriver[PROGRAM_CACHE_DRIVER_MAX];
+	void *binary = NULL;
+	GLuint programId = 0;
+	struct stat st;
+	FILE *fp;
+
+	// プロセス内
+	pthread_mutex_lock(&programCacheMutex);
+	for (entry=programCacheList; entry != NULL; entry=entry->next) {
+		if ((entry->key == key) && (strcmp(entry->driver, driver) == 0)) {
+			programId = MP_ProgramCacheCreate(entry->format, entry->binary, entry->length);
+			break;
+		}
+	}
+	pthread_mutex_unlock(&programCacheMutex);
+	if (programId != 0) {
+		return (programId);
+	}
+	if (entry != NULL) {
+		// ロードできないバイナリは使用しない(コンパイル後に再登録する)
+		return (0);
+	}
+
+	// ディスク
+	MP_ProgramCachePath(key, path, sizeof(path));
+	if (path[0] == 0) {
+		return (0);
+	}
+	fp = fopen(path, "rb");
+	if (fp == NULL) {
+		return (0);
+	}
+	do {
+		if (fstat(fileno(fp), &st) != 0) break;
+		if (fread(&header, sizeof(header), 1, fp) != 1) break;
+		if ((memcmp(header.magic, PROGRAM_CACHE_MAGIC, 4) != 0) || (header.version != PROGRAM_CACHE_VERSION)) break;
+		if ((header.driverLength >= sizeof(fileDriver)) || (header.length == 0)) break;
+		if (fread(fileDriver, header.driverLength, 1, fp) != 1) break;
+		// 壊れたヘッダで過大な確保をしないように、ファイルの残りサイズを超える長さは不正とする
+		if ((uint64_t)header.length > (uint64_t)st.st_size - sizeof(header) - header.driverLength) break;
+		fileDriver[header.driverLength] = 0;
+		if (strcmp(fileDriver, driver) != 0) break;
+		binary = malloc(header.length);
+		if (binary == NULL) break;
+		if (fread(binary, header.length, 1, fp) != 1) break;
+		programId = MP_ProgramCacheCreate((GLenum)header.format, binary, (GLint)header.length);
+		if (programId != 0) {
+			MP_ProgramCacheAdd(key, driver, (GLenum)header.format, binary, (GLint)header.length);
+			binary = NULL;
+		}
+	} while (0);
+	fclose(fp);
+	free(binary);
+
+	return (programId);
+}
+
+static void MP_ProgramCacheStore(uint64_t key, const char *driver, GLuint programId)
+{
+	PROGRAM_CACHE_ENTRY *entry, **link;
+	PROGRAM_CACHE_FILE_HEADER header;
+	char path[PROGRAM_CACHE_PATH_MAX];
+	char tmpPath[PROGRAM_CACHE_PATH_MAX + 32];
+	GLint length = 0;
+	GLsizei written = 0;
+	GLenum format = 0;
+	void *binary;
+	FILE *fp;
+	int fd;
+	int ok;
+
+	glGetProgramiv(programId, GL_PROGRAM_BINARY_LENGTH_OES, &length);
+	if (length <= 0) {
+		return;
+	}
+	binary = malloc(length);
+	if (binary == NULL) {
+		return;
+	}
+	pfnGetProgramBinary(programId, length, &written, &format, binary);
+	if (written <= 0) {
+		free(binary);
+		return;
+	}
+
+	// ディスク(一時ファイルに書き込んでから置き換える)
+	// binaryはプロセス内のリストに登録すると他スレッドのStoreで解放され得るので、登録前に書き込む
+	MP_ProgramCachePath(key, path, sizeof(path));
+	if (path[0] != 0) {
+		snprintf(tmpPath, sizeof(tmpPath), "%s.XXXXXX", path);
+		fd = mkstemp(tmpPath);
+		fp = (fd < 0)?(NULL):(fdopen(fd, "wb"));
+		if (fp != NULL) {
+			memcpy(header.magic, PROGRAM_CACHE_MAGIC, 4);
+			header.version      = PROGRAM_CACHE_VERSION;
+			header.driverLength = strlen(driver);
+			header.format       = format;
+			header.length       = written;
+			ok = (fwrite(&header, sizeof(header), 1, fp) == 1);
+			ok = ok && (fwrite(driver, header.driverLength, 1, fp) == 1);
+			ok = ok && (fwrite(binary, written, 1, fp) == 1);
+			if (fclose(fp) != 0) {
+				ok = 0;
+			}
+			if (ok) {
+				rename(tmpPath, path);
+			} else {
+				unlink(tmpPath);
+			}
+		} else if (fd >= 0) {
+			close(fd);
+			unlink(tmpPath);
+		}
+	}
+
+	// 同じキーの古いエントリを削除してから登録する
+	pthread_mutex_lock(&programCacheMutex);
+	for (link=&programCacheList; *link != NULL; ) {
+		entry = *link;
+		if ((entry->key == key) && (strcmp(entry->driver, driver) == 0)) {
+			*link = entry->next;
+			free(entry->driver);
+			free(entry->binary);
+			free(entry);
+		} else {
+			link = &entry->next;
+		}
+	}
+	pthread_mutex_unlock(&programCacheMutex);
+	// 登録後はbinaryに触らない
+	MP_ProgramCacheAdd(key, driver, format, binary, written);
+}
+#endif // ES1EMU_USE_PROGRAM_BINARY_CACHE
+
 #endif // _GLES1_EMULATION
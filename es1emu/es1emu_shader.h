@@ -56,6 +56,16 @@ GLuint es1emu_LinkShaderProgram(const GLuint programId);
  */
 void es1emu_DeleteProgram(const GLuint programId);
 
+/**
+ * @brief		リンク済みシェーダプログラム生成
+ * 				プログラムバイナリキャッシュにあればロードし、無ければコンパイル,リンクしてキャッシュに登録する
+ * @param[in]	pVShader 頂点シェーダプログラム
+ * @param[in]	pFShader フラグメントシェーダプログラム
+ * @param[in]	pBindAttrib リンク前に呼び出す関数(glBindAttribLocation用 , NULL:無し)
+ * @return		プログラムID / 失敗時は0を返却
+ */
+GLuint es1emu_CreateLinkedProgram(const char* pVShader, const char* pFShader, void (*pBindAttrib)(GLuint programId));
+
 #endif // _GLES1_EMULATION
 
 #endif	// _ES1EMU_SHADER_H
@@ -44,8 +44,6 @@ static int _usr_msg_ok_send_count=0;
 static int _usr_msg_ng_receive_count=0;
 static int _usr_msg_ng_send_count=0;
 
-static int _glv_debug_flag = GLV_DEBUG_OFF;
-
 static int _glv_debug_flag_validity_list[] = {
 	GLV_DEBUG_VERSION,
 	//GLV_DEBUG_MSG,
@@ -78,23 +76,323 @@ void glvSetDebugFlag(int flag){
 			new_flag |= _glv_debug_flag_validity_list[i];
 		}
 	}
-	_glv_debug_flag = new_flag;
+	glvLog_setLevel(GLV_LOG_ALL,GLV_LOG_LEVEL_WARN);
+	glvLog_setLevel(new_flag,GLV_LOG_LEVEL_DEBUG);
 }
 
 int glvCheckDebugFlag(int flag){
-	return(_glv_debug_flag & flag);
+	return(_glv_log_filter[GLV_LOG_LEVEL_DEBUG] & flag);
+}
+
+#ifdef GLV_INSTANCE_ID_MAP
+// -----------------------------------------------------------------------------------------------
+// インスタンスIDからインスタンス(window,sheet,wiget)を検索するハッシュテーブル
+// 登録・削除は_glv_id_map_mutexを取得して行い、検索はロックを取得せずに行う
+// IDは再利用されないため、削除はinstanceをNULLにしたスロット(tombstone)を残す
+// テーブルの再構築時、旧テーブルはどのスレッドも検索に使用していなくなってから解放する
+// 検索中のテーブルはスレッド毎の領域(reader)に記録する(共有変数への書き込みは行わない)
+// -----------------------------------------------------------------------------------------------
+typedef struct _glv_id_map_entry {
+	glvInstanceId		Id;				// 0:未使用
+	_GLV_INSTANCE_t		*instance;		// NULL:削除済み
+} GLV_ID_MAP_ENTRY_t;
+
+typedef struct _glv_id_map_table {
+	size_t						mask;
+	size_t						used;		// 使用中のスロット数(削除済みを含む)
+	size_t						count;		// 登録中のインスタンス数
+	struct _glv_id_map_table	*retired;	// 解放待ちの旧テーブル
+	GLV_ID_MAP_ENTRY_t			entry[];
+} GLV_ID_MAP_TABLE_t;
+
+typedef struct _glv_id_map_reader {
+	GLV_ID_MAP_TABLE_t			*table;		// 検索中のテーブル(NULL:検索していない)
+	int							used;		// 1:スレッドが使用中(0:終了したスレッドの領域で再利用できる)
+	struct _glv_id_map_reader	*next;
+} GLV_ID_MAP_READER_t;
+
+static GLV_ID_MAP_TABLE_t	*_glv_id_map = NULL;
+static GLV_ID_MAP_TABLE_t	*_glv_id_map_retired = NULL;
+static GLV_ID_MAP_READER_t	*_glv_id_map_readers = NULL;	// 追加のみ(解放しない)
+static pthread_mutex_t		_glv_id_map_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t		_glv_id_map_once = PTHREAD_ONCE_INIT;
+static pthread_key_t		_glv_id_map_key;
+static __thread GLV_ID_MAP_READER_t *_glv_id_map_reader = NULL;
+
+static size_t _glv_id_map_hash(glvInstanceId Id)
+{
+	uint64_t h = (uint64_t)Id;
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	return((size_t)h);
+}
+
+static GLV_ID_MAP_TABLE_t *_glv_id_map_alloc_table(size_t size)
+{
+	GLV_ID_MAP_TABLE_t *table;
+
+	table = calloc(1,sizeof(GLV_ID_MAP_TABLE_t) + sizeof(GLV_ID_MAP_ENTRY_t) * size);
+	if(table == NULL) return(NULL);
+	table->mask = size - 1;
+	return(table);
+}
+
+static void _glv_id_map_put(GLV_ID_MAP_TABLE_t *table,glvInstanceId Id,_GLV_INSTANCE_t *instance)
+{
+	size_t i = _glv_id_map_hash(Id) & table->mask;
+
+	while(table->entry[i].Id != 0){
+		i = (i + 1) & table->mask;
+	}
+	// instanceを書き込んでからIdを公開する
+	__atomic_store_n(&table->entry[i].instance,instance,__ATOMIC_RELAXED);
+	__atomic_store_n(&table->entry[i].Id,Id,__ATOMIC_RELEASE);
+	table->used++;
+	table->count++;
+}
+
+// スレッド終了時にreaderを解放する(他のスレッドが再利用する)
+static void _glv_id_map_reader_destructor(void *arg)
+{
+	GLV_ID_MAP_READER_t *reader = arg;
+
+	__atomic_store_n(&reader->table,NULL,__ATOMIC_RELEASE);
+	__atomic_store_n(&reader->used,0,__ATOMIC_RELEASE);
+}
+
+static void _glv_id_map_reader_once(void)
+{
+	pthread_key_create(&_glv_id_map_key,_glv_id_map_reader_destructor);
+}
+
+// 呼び出したスレッドのreaderを取得する
+static GLV_ID_MAP_READER_t *_glv_id_map_get_reader(void)
+{
+	GLV_ID_MAP_READER_t *reader;
+
+	if(_glv_id_map_reader != NULL){
+		return(_glv_id_map_reader);
+	}
+	pthread_once(&_glv_id_map_once,_glv_id_map_reader_once);
+
+	pthread_mutex_lock(&_glv_id_map_mutex);				// id map
+	for(reader=_glv_id_map_readers;reader != NULL;reader=reader->next){
+		if(__atomic_load_n(&reader->used,__ATOMIC_ACQUIRE) == 0){
+			break;
+		}
+	}
+	if(reader == NULL){
+		reader = calloc(1,sizeof(GLV_ID_MAP_READER_t));
+		if(reader != NULL){
+			reader->next = _glv_id_map_readers;
+			__atomic_store_n(&_glv_id_map_readers,reader,__ATOMIC_RELEASE);
+		}
+	}
+	if(reader != NULL){
+		reader->used = 1;
+	}
+	pthread_mutex_unlock(&_glv_id_map_mutex);			// id map
+
+	if(reader != NULL){
+		pthread_setspecific(_glv_id_map_key,reader);
+		_glv_id_map_reader = reader;
+	}
+	return(reader);
+}
+
+// どのスレッドも検索に使用していない旧テーブルを解放する(_glv_id_map_mutexを取得した状態で呼ぶこと)
+static void _glv_id_map_reclaim(void)
+{
+	GLV_ID_MAP_TABLE_t *table,**link;
+	GLV_ID_MAP_READER_t *reader;
+
+	if(_glv_id_map_retired == NULL) return;
+
+	// テーブルの切り替え(_glv_id_map)とreaderの読み出しの順序を保証する
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	for(link=&_glv_id_map_retired;*link != NULL;){
+		table = *link;
+		for(reader=_glv_id_map_readers;reader != NULL;reader=reader->next){
+			if(__atomic_load_n(&reader->table,__ATOMIC_ACQUIRE) == table){
+				break;
+			}
+		}
+		if(reader == NULL){
+			*link = table->retired;
+			free(table);
+		}else{
+			link = &table->retired;
+		}
+	}
 }
 
+// 削除済みスロットを除いてテーブルを作り直す(使用率が1/2以下になるようにする)
+static int _glv_id_map_rebuild(void)
+{
+	GLV_ID_MAP_TABLE_t *old_table = _glv_id_map;
+	GLV_ID_MAP_TABLE_t *new_table;
+	size_t size = GLV_INSTANCE_ID_MAP_INIT_SIZE;
+	size_t i;
+
+	if(old_table != NULL){
+		while(size < (old_table->count + 1) * 4){
+			size <<= 1;
+		}
+	}
+	new_table = _glv_id_map_alloc_table(size);
+	if(new_table == NULL) return(GLV_ERROR);
+
+	if(old_table != NULL){
+		for(i=0;i<=old_table->mask;i++){
+			if((old_table->entry[i].Id != 0) && (old_table->entry[i].instance != NULL)){
+				_glv_id_map_put(new_table,old_table->entry[i].Id,old_table->entry[i].instance);
+			}
+		}
+	}
+	__atomic_store_n(&_glv_id_map,new_table,__ATOMIC_SEQ_CST);
+
+	if(old_table != NULL){
+		old_table->retired = _glv_id_map_retired;
+		_glv_id_map_retired = old_table;
+	}
+	_glv_id_map_reclaim();
+	return(GLV_OK);
+}
+
+static int _glvIdMapInsert(_GLV_INSTANCE_t *instance)
+{
+	int rc = GLV_OK;
+
+	pthread_mutex_lock(&_glv_id_map_mutex);				// id map
+	if((_glv_id_map == NULL) || ((_glv_id_map->used + 1) * 2 > _glv_id_map->mask + 1)){
+		rc = _glv_id_map_rebuild();
+	}
+	if(rc == GLV_OK){
+		_glv_id_map_put(_glv_id_map,instance->Id,instance);
+	}
+	pthread_mutex_unlock(&_glv_id_map_mutex);			// id map
+	return(rc);
+}
+
+static void _glvIdMapRemove(glvInstanceId Id)
+{
+	GLV_ID_MAP_TABLE_t *table;
+	size_t i;
+
+	pthread_mutex_lock(&_glv_id_map_mutex);				// id map
+	table = _glv_id_map;
+	if(table != NULL){
+		i = _glv_id_map_hash(Id) & table->mask;
+		while(table->entry[i].Id != 0){
+			if(table->entry[i].Id == Id){
+				if(table->entry[i].instance != NULL){
+					__atomic_store_n(&table->entry[i].instance,NULL,__ATOMIC_RELEASE);
+					table->count--;
+				}
+				break;
+			}
+			i = (i + 1) & table->mask;
+		}
+		_glv_id_map_reclaim();
+	}
+	pthread_mutex_unlock(&_glv_id_map_mutex);			// id map
+}
+
+/**
+ * @brief インスタンスIDからインスタンスを検索する
+ *
+ * ロックを取得せずに検索する。
+ * 
+ * @param[in]	Id				インスタンスID
+ * @param[in]	instanceType	インスタンスの種類(GLV_INSTANCE_TYPE_WINDOW等)
+ * @retval	NULL以外	インスタンス
+ * @retval	NULL		見つからない(削除済み、種類が異なる)
+ */
+void *_glvGetInstanceFromId(glvInstanceId Id,int instanceType)
+{
+	GLV_ID_MAP_READER_t *reader;
+	GLV_ID_MAP_TABLE_t *table;
+	_GLV_INSTANCE_t *instance = NULL;
+	glvInstanceId entryId;
+	size_t i;
+
+	if(Id == 0) return(NULL);
+
+	reader = _glv_id_map_get_reader();
+	if(reader == NULL){
+		// readerを確保できない場合はロックを取得して検索する
+		pthread_mutex_lock(&_glv_id_map_mutex);			// id map
+		table = _glv_id_map;
+	}else{
+		// 使用するテーブルを記録してから、そのテーブルがまだ最新であることを確認する
+		do{
+			table = __atomic_load_n(&_glv_id_map,__ATOMIC_ACQUIRE);
+			__atomic_store_n(&reader->table,table,__ATOMIC_RELAXED);
+			__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		}while(table != __atomic_load_n(&_glv_id_map,__ATOMIC_ACQUIRE));
+	}
+	if(table != NULL){
+		i = _glv_id_map_hash(Id) & table->mask;
+		while((entryId = __atomic_load_n(&table->entry[i].Id,__ATOMIC_ACQUIRE)) != 0){
+			if(entryId == Id){
+				instance = __atomic_load_n(&table->entry[i].instance,__ATOMIC_ACQUIRE);
+				break;
+			}
+			i = (i + 1) & table->mask;
+		}
+	}
+	if(reader == NULL){
+		pthread_mutex_unlock(&_glv_id_map_mutex);		// id map
+	}else{
+		__atomic_store_n(&reader->table,NULL,__ATOMIC_RELEASE);
+	}
+
+	if(instance == NULL) return(NULL);
+	if(instance->instanceType != instanceType) return(NULL);
+	if(instance->alive != GLV_INSTANCE_ALIVE) return(NULL);
+	return(instance);
+}
+
+// テーブルを解放する(glvCloseDisplayで全てのウィンドウを削除した後に呼ぶ)
+// readerはスレッドが参照しているので解放しない(次のglvOpenDisplayでも使用する)
+static void _glvIdMapTerm(void)
+{
+	GLV_ID_MAP_TABLE_t *table;
+
+	pthread_mutex_lock(&_glv_id_map_mutex);				// id map
+	table = _glv_id_map;
+	__atomic_store_n(&_glv_id_map,NULL,__ATOMIC_SEQ_CST);
+	if(table != NULL){
+		table->retired = _glv_id_map_retired;
+		_glv_id_map_retired = table;
+	}
+	_glv_id_map_reclaim();
+	if(_glv_id_map_retired != NULL){
+		GLV_LOG_WARN(GLV_DEBUG_INSTANCE,"glvCloseDisplay:instance id map is still in use\n");
+	}
+	pthread_mutex_unlock(&_glv_id_map_mutex);			// id map
+}
+#endif /* GLV_INSTANCE_ID_MAP */
+
 int _glvInitInstance(_GLV_INSTANCE_t *instance,int instanceType)
 {
 	instance->oneself		= instance;
-	instance->Id			= ++_glv_instance_Id;
+	instance->Id			= __atomic_add_fetch(&_glv_instance_Id,1,__ATOMIC_RELAXED);
 	instance->instanceType	= instanceType;
 	instance->alive			= GLV_INSTANCE_ALIVE;
 	instance->user_data		= NULL;
 	instance->resource		= NULL;
 	instance->resource_run	= 0;
 	pthread_mutex_init(&instance->resource_mutex,NULL);
+#ifdef GLV_INSTANCE_ID_MAP
+	if((instanceType == GLV_INSTANCE_TYPE_WINDOW) || (instanceType == GLV_INSTANCE_TYPE_SHEET) || (instanceType == GLV_INSTANCE_TYPE_WIGET)){
+		if(_glvIdMapInsert(instance) != GLV_OK){
+			fprintf(stderr,"_glvInitInstance:id map insert error\n");
+		}
+	}
+#endif /* GLV_INSTANCE_ID_MAP */
 	return(GLV_OK);
 }
 
@@ -116,6 +414,11 @@ void glvDestroyResource(glvResource res)
 	int instanceType = instance->instanceType;
 
 	instance->alive = GLV_INSTANCE_DEAD;
+#ifdef GLV_INSTANCE_ID_MAP
+	if(instanceType != GLV_INSTANCE_TYPE_RESOURCE){
+		_glvIdMapRemove(instance->Id);
+	}
+#endif /* GLV_INSTANCE_ID_MAP */
 
 	if(instance->user_data != NULL){
 		free(instance->user_data);
@@ -134,6 +437,18 @@ void glvDestroyResource(glvResource res)
 }
 
 /* ---------------------------------------------------------- */
+static void _glvSetConfigAttrib(EGLint *attribs,EGLint name,EGLint value)
+{
+	int i;
+
+	for(i=0;attribs[i] != EGL_NONE;i+=2){
+		if(attribs[i] == name){
+			attribs[i + 1] = value;
+			return;
+		}
+	}
+}
+
 glvDisplay glvOpenDisplay(char *dpyName)
 {
 	EGLDisplay egl_dpy;
@@ -143,7 +458,8 @@ glvDisplay glvOpenDisplay(char *dpyName)
 	EGLint num_configs;
 	EGLContext	egl_ctx;
 
-	static EGLint attribs_normal[] = {
+	EGLint surface_type;
+	EGLint attribs_normal[] = {
 		EGL_RENDERABLE_TYPE,GLV_EGL_RENDERABLE_TYPE,
 		EGL_RED_SIZE, 8,
 		EGL_GREEN_SIZE, 8,
@@ -153,7 +469,7 @@ glvDisplay glvOpenDisplay(char *dpyName)
 		EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
 		EGL_NONE
 	};
-	static EGLint attribs_beauty[] = {
+	EGLint attribs_beauty[] = {
 		EGL_RENDERABLE_TYPE,GLV_EGL_RENDERABLE_TYPE,
 		EGL_RED_SIZE, 8,
 		EGL_GREEN_SIZE, 8,
@@ -170,8 +486,11 @@ glvDisplay glvOpenDisplay(char *dpyName)
 	// ex.
 	// GLVIEW_DEBUG=1 ./a.out		_glv_debug_flag_validity_list に設定されているglview内のデバック情報を出力する
 	// GLVIEW_DEBUG=2 ./a.out		glview内の全てのデバック情報を出力する
+	// GLVIEW_DEBUG=msg,font:trace ./a.out	カテゴリ[:レベル]を指定してデバック情報を出力する(glview_log.c参照)
 	// GLVIEW_WAYLAND=1 ./a.out		waylandのデバック情報(WAYLAND_DEBUG=1)を出力する
 	// GLVIEW_WAYLAND=1 GLVIEW_DEBUG=2 ./a.out		全てのデバック情報を出力する	
+	// GLVIEW_BACKEND=headless ./a.out	コンポジターを使用しないheadlessバックエンドで起動する
+	// GLVIEW_TRACE=trace.json ./a.out	メッセージ処理とフレームのタイミングを記録し、終了時にtrace.jsonに出力する
 	{
 		char *env;
 		env = getenv("GLVIEW_DEBUG");
@@ -179,20 +498,27 @@ glvDisplay glvOpenDisplay(char *dpyName)
 			if(strcmp(env, "1") == 0) {
 				glvSetDebugFlag(GLV_DEBUG_ON);
 			}else if(strcmp(env, "2") == 0) {
-				_glv_debug_flag = 0x7fffffff;
+				glvLog_setLevel(GLV_LOG_ALL,GLV_LOG_LEVEL_DEBUG);
+			}else{
+				glvLog_setFilter(env);
 			}
 		}
 		env = getenv("GLVIEW_WAYLAND");
 		if(env != NULL){
 			if(strcmp(env, "1") == 0) {
 				setenv("WAYLAND_DEBUG","1",0);
-				_glv_debug_flag |= GLV_DEBUG_VERSION;
+				if(!glvCheckDebugFlag(GLV_DEBUG_VERSION)){
+					glvLog_setLevel(GLV_DEBUG_VERSION,GLV_LOG_LEVEL_DEBUG);
+				}
 			}
 		}
+#ifdef GLV_TRACE
+		_glvTraceInit();
+#endif /* GLV_TRACE */
 	}
 
-	GLV_IF_DEBUG_VERSION printf("--------------------------------------------------------------------------\n");
-	GLV_IF_DEBUG_VERSION printf("glview:version %d.%d.%d " "(" __DATE__ ")\n",GLV_VERSION_MAJOR,GLV_VERSION_MINOR,GLV_VERSION_PATCH);
+	GLV_LOG_DEBUG(GLV_DEBUG_VERSION,"--------------------------------------------------------------------------\n");
+	GLV_LOG_DEBUG(GLV_DEBUG_VERSION,"glview:version %d.%d.%d " "(" __DATE__ ")\n",GLV_VERSION_MAJOR,GLV_VERSION_MINOR,GLV_VERSION_PATCH);
 
 	glvGl_thread_safe_init();
 	glvFont_thread_safe_init();
@@ -221,12 +547,17 @@ glvDisplay glvOpenDisplay(char *dpyName)
 		free(glv_dpy);
 		return(0);
 	}
-	egl_dpy = eglGetDisplay(glv_dpy->native_dpy);
+	egl_dpy = _glvGetNativeEglDisplay(glv_dpy);
 	if(!egl_dpy){
 		free(glv_dpy);
 		return(0);
 	}
 
+	// バックエンドに合わせてsurfaceの種類(window/pbuffer)を選択する
+	surface_type = _glvGetNativeSurfaceType(glv_dpy);
+	_glvSetConfigAttrib(attribs_normal,EGL_SURFACE_TYPE,surface_type);
+	_glvSetConfigAttrib(attribs_beauty,EGL_SURFACE_TYPE,surface_type);
+
 	rc = eglInitialize(egl_dpy, &egl_major, &egl_minor);
 	if(!rc){
 		eglTerminate(egl_dpy);
@@ -290,6 +621,7 @@ glvDisplay glvOpenDisplay(char *dpyName)
 	glv_dpy->egl_dpy = egl_dpy;
 	glv_dpy->egl_major = egl_major;
 	glv_dpy->egl_minor = egl_minor;
+	_glvInitSwapDamage(glv_dpy);
 
 	// ---------------------------------------------------------------------------
 	{
@@ -325,10 +657,10 @@ glvDisplay glvOpenDisplay(char *dpyName)
 	es1emu_Init();
 #endif
 
-	GLV_IF_DEBUG_VERSION printf("glview:EGL_VERSION   = %d.%d\n", egl_major, egl_minor);
-	GLV_IF_DEBUG_VERSION printf("glview:GL_RENDERER   = %s\n", (char *) glGetString(GL_RENDERER));
-	GLV_IF_DEBUG_VERSION printf("glview:GL_VERSION    = %s\n", (char *) glGetString(GL_VERSION));
-	GLV_IF_DEBUG_VERSION printf("glview:SL_VERSION    = %s\n", (char *) glGetString(GL_SHADING_LANGUAGE_VERSION));
+	GLV_LOG_DEBUG(GLV_DEBUG_VERSION,"glview:EGL_VERSION   = %d.%d\n", egl_major, egl_minor);
+	GLV_LOG_DEBUG(GLV_DEBUG_VERSION,"glview:GL_RENDERER   = %s\n", (char *) glGetString(GL_RENDERER));
+	GLV_LOG_DEBUG(GLV_DEBUG_VERSION,"glview:GL_VERSION    = %s\n", (char *) glGetString(GL_VERSION));
+	GLV_LOG_DEBUG(GLV_DEBUG_VERSION,"glview:SL_VERSION    = %s\n", (char *) glGetString(GL_SHADING_LANGUAGE_VERSION));
 	//printf("glview:GL_VENDOR     = %s\n", (char *) glGetString(GL_VENDOR));
 	//printf("glview:GL_EXTENSIONS = %s\n", (char *) glGetString(GL_EXTENSIONS));
 
@@ -353,6 +685,12 @@ int glvCloseDisplay(glvDisplay display)
 		glvTerminateTimer();
 		while(_glvGcGarbageBox());
 		_glvDestroyGarbageBox();
+#ifdef GLV_INSTANCE_ID_MAP
+		_glvIdMapTerm();
+#endif /* GLV_INSTANCE_ID_MAP */
+#ifdef GLV_TRACE
+		_glvTraceTerm();
+#endif /* GLV_TRACE */
 	}
 	glv_dpy->instance.alive	= GLV_INSTANCE_DEAD;
 
@@ -362,16 +700,20 @@ int glvCloseDisplay(glvDisplay display)
 
 	glvDestroyResource(&glv_dpy->instance);
 
+	// テクスチャ・バッファ・プログラムはeglTerminateの前に削除する
+	glvFont_thread_safe_finish();
+	glvGl_thread_safe_finish();
+#ifdef _GLES1_EMULATION
+	es1emu_Finish();
+#endif
 	eglTerminate(glv_dpy->egl_dpy);
 	_glvCloseNativeDisplay(glv_dpy);
 	pthread_mutex_destroy(&glv_dpy->display_mutex);
 
-#ifdef _GLES1_EMULATION
-   es1emu_Finish();
-#endif
-
 	free(glv_dpy);
 
+	glvLog_flush();
+
 	return(GLV_OK);
 }
 
@@ -898,7 +1240,7 @@ void *glvExecMsg(GLV_WINDOW_t *glv_window,pthread_msq_msg_t *rmsg)
 	switch(event){
 		case GLV_ON_INIT: // for GLV_TYPE_CHILD_WINDOW
 			/* 初期化 */
-			GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_INIT(%d,%d)\n"GLV_DEBUG_END_COLOR,glv_window->name,(int)rmsg->data[4],(int)rmsg->data[5]);
+			GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_INIT(%d,%d)\n"GLV_DEBUG_END_COLOR,glv_window->name,(int)rmsg->data[4],(int)rmsg->data[5]);
 			if(glv_window->eventFunc._new != NULL){
 				int rc;
 				rc = (glv_window->eventFunc._new)(glv_window);
@@ -916,10 +1258,11 @@ void *glvExecMsg(GLV_WINDOW_t *glv_window,pthread_msq_msg_t *rmsg)
 			break;		
 		case GLV_ON_CONFIGURE:
 			if(glv_window->configure_serial > (uint32_t)rmsg->data[6]){
-				GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_CONFIGURE(%d,%d) sirial(%d > %d)\n"GLV_DEBUG_END_COLOR,glv_window->name,(int)rmsg->data[4],(int)rmsg->data[5],glv_window->configure_serial,(uint32_t)rmsg->data[6]);
+				GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_CONFIGURE(%d,%d) sirial(%d > %d)\n"GLV_DEBUG_END_COLOR,glv_window->name,(int)rmsg->data[4],(int)rmsg->data[5],glv_window->configure_serial,(uint32_t)rmsg->data[6]);
 				break;
 			}
-			GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_CONFIGURE(%d,%d)\n"GLV_DEBUG_END_COLOR,glv_window->name,(int)rmsg->data[4],(int)rmsg->data[5]);
+			GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_CONFIGURE(%d,%d)\n"GLV_DEBUG_END_COLOR,glv_window->name,(int)rmsg->data[4],(int)rmsg->data[5]);
+			glvWindow_addDamageFull(glv_window);		// サイズ変更は全体を更新する
 			/* 描画サイズ変更 */
 			_glvResizeWindow(glv_window,rmsg->data[2],rmsg->data[3],rmsg->data[4],rmsg->data[5]);
 			//wl_egl_window_resize(glv_window->egl_window,rmsg->data[4],rmsg->data[5],0,0);
@@ -949,11 +1292,12 @@ void *glvExecMsg(GLV_WINDOW_t *glv_window,pthread_msq_msg_t *rmsg)
 		case GLV_ON_RESHAPE:
 #if 1
 			if(glv_window->resharp_serial > (uint32_t)rmsg->data[6]){
-				GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_RESHAPE(%d,%d) sirial(%d > %d)\n"GLV_DEBUG_END_COLOR,glv_window->name,(int)rmsg->data[4],(int)rmsg->data[5],glv_window->resharp_serial,(uint32_t)rmsg->data[6]);
+				GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_RESHAPE(%d,%d) sirial(%d > %d)\n"GLV_DEBUG_END_COLOR,glv_window->name,(int)rmsg->data[4],(int)rmsg->data[5],glv_window->resharp_serial,(uint32_t)rmsg->data[6]);
 				break;
 			}
 #endif
-			GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_RESHAPE(%d,%d)\n"GLV_DEBUG_END_COLOR,glv_window->name,(int)rmsg->data[4],(int)rmsg->data[5]);
+			GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_RESHAPE(%d,%d)\n"GLV_DEBUG_END_COLOR,glv_window->name,(int)rmsg->data[4],(int)rmsg->data[5]);
+			glvWindow_addDamageFull(glv_window);		// サイズ変更は全体を更新する
 			/* 描画サイズ変更 */
 			_glvResizeWindow(glv_window,rmsg->data[2],rmsg->data[3],rmsg->data[4],rmsg->data[5]);
 			//wl_egl_window_resize(glv_window->egl_window,rmsg->data[4],rmsg->data[5],0,0);
@@ -967,13 +1311,14 @@ void *glvExecMsg(GLV_WINDOW_t *glv_window,pthread_msq_msg_t *rmsg)
 			_glv_sheet_with_wiget_reshape_cb(glv_window);
 			break;
 		case GLV_ON_REDRAW:
-#ifdef GLV_TEST__THIN_OUT_DRAWING
+#if defined(GLV_TEST__THIN_OUT_DRAWING) && !defined(GLV_FRAME_SCHEDULER)
 			if(glv_window->draw_serial > (uint32_t)rmsg->data[6]){
-				GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_REDRAW cancel sirial(%d > %d)\n"GLV_DEBUG_END_COLOR,glv_window->name,glv_window->draw_serial,(uint32_t)rmsg->data[6]);
+				GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_REDRAW cancel sirial(%d > %d)\n"GLV_DEBUG_END_COLOR,glv_window->name,glv_window->draw_serial,(uint32_t)rmsg->data[6]);
 				break;
 			}
-#endif /* GLV_TEST__THIN_OUT_DRAWING */
-			GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_REDRAW   count = %d\n"GLV_DEBUG_END_COLOR,glv_window->name,glv_window->drawCount);
+#endif /* GLV_TEST__THIN_OUT_DRAWING && !GLV_FRAME_SCHEDULER */
+			GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_REDRAW   count = %d\n"GLV_DEBUG_END_COLOR,glv_window->name,glv_window->drawCount);
+			glvWindow_addDamageFull(glv_window);		// REDRAWは全体を描画する
 			/* 描画 */
 			if(glv_window->eventFunc.redraw != NULL){
 				int rc;
@@ -993,13 +1338,15 @@ void *glvExecMsg(GLV_WINDOW_t *glv_window,pthread_msq_msg_t *rmsg)
 			_glv_sheet_with_wiget_redraw_cb(glv_window);
 			break;
 		case GLV_ON_UPDATE:
-#ifdef GLV_TEST__THIN_OUT_DRAWING
+#if defined(GLV_TEST__THIN_OUT_DRAWING) && !defined(GLV_FRAME_SCHEDULER)
 			if(glv_window->draw_serial > (uint32_t)rmsg->data[6]){
-				GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_UPDATE cancel sirial(%d > %d)\n"GLV_DEBUG_END_COLOR,glv_window->name,glv_window->draw_serial,(uint32_t)rmsg->data[6]);
+				GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_UPDATE cancel sirial(%d > %d)\n"GLV_DEBUG_END_COLOR,glv_window->name,glv_window->draw_serial,(uint32_t)rmsg->data[6]);
 				break;
 			}
-#endif /* GLV_TEST__THIN_OUT_DRAWING */
-			GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_UPDATE   count = %d\n"GLV_DEBUG_END_COLOR,glv_window->name,glv_window->drawCount);
+#endif /* GLV_TEST__THIN_OUT_DRAWING && !GLV_FRAME_SCHEDULER */
+			GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_UPDATE   count = %d\n"GLV_DEBUG_END_COLOR,glv_window->name,glv_window->drawCount);
+			// 再描画要求されたwigetだけの場合は、ウィンドウ・シートの描画から再描画が必要な領域に制限する
+			_glv_sheet_begin_dirty_update(glv_window);
 			/* 描画 */
 			if(glv_window->eventFunc.update != NULL){
 				int rc;
@@ -1011,6 +1358,7 @@ void *glvExecMsg(GLV_WINDOW_t *glv_window,pthread_msq_msg_t *rmsg)
 			if(glv_window->eventFunc.redraw != NULL){
 				int rc;
 				glv_window->reqSwapBuffersFlag = 1;	// REDRAWは、必ず描画するので強制SwapBuffersを実行する
+				glvWindow_addDamageFull(glv_window);	// REDRAWは全体を描画する
 				rc = (glv_window->eventFunc.redraw)(glv_window,GLV_STAT_DRAW_REDRAW);
 				if(rc != GLV_OK){
 					fprintf(stderr,"[%s] glv_window->eventFunc.redraw error\n",glv_window->name);
@@ -1019,9 +1367,10 @@ void *glvExecMsg(GLV_WINDOW_t *glv_window,pthread_msq_msg_t *rmsg)
 			_glv_sheet_with_wiget_update_cb(glv_window);
 			break;
 		case GLV_ON_TIMER:
-			GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_TIMER\n"GLV_DEBUG_END_COLOR,glv_window->name);
+			GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_TIMER\n"GLV_DEBUG_END_COLOR,glv_window->name);
 			if(glvCheckTimer(glv_window,rmsg->data[3],rmsg->data[4]) == GLV_OK){
 				//fprintf(stdout,"[%s] GLV_ON_TIMER id = %d OK\n",rmsg->data[3],glv_window->name);
+				glv_window->timer_missed = rmsg->data[5];	// glvWindow_getTimerMissedCount()で取得する
 				if(glv_window->eventFunc.timer != NULL){
 					int rc;
 					rc = (glv_window->eventFunc.timer)(glv_window,rmsg->data[2],rmsg->data[3]);
@@ -1029,12 +1378,13 @@ void *glvExecMsg(GLV_WINDOW_t *glv_window,pthread_msq_msg_t *rmsg)
 						fprintf(stderr,"[%s] glv_window->eventFunc.timer error\n",glv_window->name);
 					}
 				}
+				glv_window->timer_missed = 0;
 			}else{
 				//fprintf(stderr,"[%s] GLV_ON_TIMER id = %d IGNORE\n",rmsg->data[3],glv_window->name);
 			}
 			break;
 		case GLV_ON_GESTURE:
-			GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_GESTURE\n"GLV_DEBUG_END_COLOR,glv_window->name);
+			GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_GESTURE\n"GLV_DEBUG_END_COLOR,glv_window->name);
 			if(glv_window->eventFunc.gesture != NULL){
 				int rc;
 				rc = (glv_window->eventFunc.gesture)(glv_window,
@@ -1046,18 +1396,18 @@ void *glvExecMsg(GLV_WINDOW_t *glv_window,pthread_msq_msg_t *rmsg)
 			break;
 		case GLV_ON_ACTIVATE:
 			// GLV_ON_ACTIVATE: unimplemented msg
-			GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_ACTIVATE\n"GLV_DEBUG_END_COLOR,glv_window->name);
+			GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_ACTIVATE\n"GLV_DEBUG_END_COLOR,glv_window->name);
 			break;
 		case GLV_ON_TERMINATE:
-			GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_TERMINATE %ld\n"GLV_DEBUG_END_COLOR,glv_window->name,glv_window->instance.Id);
+			GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_TERMINATE %ld\n"GLV_DEBUG_END_COLOR,glv_window->name,glv_window->instance.Id);
 			break;
 		case GLV_ON_USER_MSG:
-			GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_USER_MSG\n"GLV_DEBUG_END_COLOR,glv_window->name);
+			GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_USER_MSG\n"GLV_DEBUG_END_COLOR,glv_window->name);
 			{
 				int kind;
 				void *data;
 				kind = (int)rmsg->data[2];
-				data = (void *)rmsg->data[3];
+				data = pthread_msq_msg_payload(rmsg);
 				if(glv_window->eventFunc.userMsg != NULL){
 					int rc;
 					rc = (glv_window->eventFunc.userMsg)(glv_window,kind,data);
@@ -1071,7 +1421,7 @@ void *glvExecMsg(GLV_WINDOW_t *glv_window,pthread_msq_msg_t *rmsg)
 			}
 			break;
 		case GLV_ON_MOUSE_POINTER:
-			GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_MOUSE_POINTER\n"GLV_DEBUG_END_COLOR,glv_window->name);
+			GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_MOUSE_POINTER\n"GLV_DEBUG_END_COLOR,glv_window->name);
 			//printf("GLV_ON_MOUSE_POINTER\n");
 			if((rmsg->data[2] == 0) && (rmsg->data[3] == 0)){
 				if(glv_window->eventFunc.mousePointer != NULL){
@@ -1088,7 +1438,7 @@ void *glvExecMsg(GLV_WINDOW_t *glv_window,pthread_msq_msg_t *rmsg)
 			}
 			break;
 		case GLV_ON_MOUSE_BUTTON:
-			GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_MOUSE_BUTTON\n"GLV_DEBUG_END_COLOR,glv_window->name);
+			GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_MOUSE_BUTTON\n"GLV_DEBUG_END_COLOR,glv_window->name);
 			//printf("GLV_ON_MOUSE_BUTTON\n");
 			if((rmsg->data[2] == 0) && (rmsg->data[3] == 0)){
 				if(glv_window->eventFunc.mouseButton != NULL){
@@ -1105,7 +1455,7 @@ void *glvExecMsg(GLV_WINDOW_t *glv_window,pthread_msq_msg_t *rmsg)
 			}
 			break;
 		case GLV_ON_MOUSE_AXIS:
-			GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_MOUSE_AXIS\n"GLV_DEBUG_END_COLOR,glv_window->name);
+			GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_MOUSE_AXIS\n"GLV_DEBUG_END_COLOR,glv_window->name);
 			//printf("GLV_ON_MOUSE_AXIS\n");
 			if((rmsg->data[2] == 0) && (rmsg->data[3] == 0)){
 				if(glv_window->eventFunc.mouseAxis != NULL){
@@ -1122,7 +1472,7 @@ void *glvExecMsg(GLV_WINDOW_t *glv_window,pthread_msq_msg_t *rmsg)
 			}
 			break;
 		case GLV_ON_ACTION:
-			GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_ACTION\n"GLV_DEBUG_END_COLOR,glv_window->name);
+			GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_ACTION\n"GLV_DEBUG_END_COLOR,glv_window->name);
 			//printf("GLV_ON_ACTION\n");
 			if((rmsg->data[2] != 0) && (rmsg->data[3] == 0)){
 				_glv_sheet_action_cb(glv_window,rmsg->data[2],rmsg->data[3],rmsg->data[4],rmsg->data[5]);
@@ -1139,7 +1489,7 @@ void *glvExecMsg(GLV_WINDOW_t *glv_window,pthread_msq_msg_t *rmsg)
 			}
 			break;
 		case GLV_ON_KEY:
-			GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_KEY\n"GLV_DEBUG_END_COLOR,glv_window->name);
+			GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_KEY\n"GLV_DEBUG_END_COLOR,glv_window->name);
 			//printf("GLV_ON_KEY\n");
 			if(glv_window->eventFunc.key != NULL){
 				int rc;
@@ -1150,23 +1500,27 @@ void *glvExecMsg(GLV_WINDOW_t *glv_window,pthread_msq_msg_t *rmsg)
 			}
 			break;
 		case GLV_ON_KEY_INPUT:
-			GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_KEY_INPUT\n"GLV_DEBUG_END_COLOR,glv_window->name);
+			GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_KEY_INPUT\n"GLV_DEBUG_END_COLOR,glv_window->name);
 			//printf("[%s] GLV_ON_KEY_INPUT\n",glv_window->name);
 			{
-				_glv_wiget_key_input_cb(glv_window,rmsg->data[2],rmsg->data[3],rmsg->data[4],rmsg->data[5],rmsg->data[6],(int *)rmsg->data[7],(uint8_t*)rmsg->data[8],rmsg->data[9]);
-				//if(rmsg->data[7] != 0) free((void *)rmsg->data[7]);
-				//if(rmsg->data[8] != 0) free((void *)rmsg->data[8]);
+				// payloadはutf32[length],attr[length]の順に格納されている(data[7],data[8]:有無)
+				uint8_t *payload = pthread_msq_msg_payload(rmsg);
+				int *utf32 = NULL;
+				uint8_t *attr = NULL;
+				if(rmsg->data[7] != 0) utf32 = (int *)payload;
+				if(rmsg->data[8] != 0) attr = payload + ((rmsg->data[7] != 0) ? (rmsg->data[9] * sizeof(int)) : 0);
+				_glv_wiget_key_input_cb(glv_window,rmsg->data[2],rmsg->data[3],rmsg->data[4],rmsg->data[5],rmsg->data[6],utf32,attr,rmsg->data[9]);
 			}
 			break;
 		case GLV_ON_FOCUS:
-			GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_FOCUS\n"GLV_DEBUG_END_COLOR,glv_window->name);
+			GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_FOCUS\n"GLV_DEBUG_END_COLOR,glv_window->name);
 			//printf("[%s] GLV_ON_FOCUS\n",glv_window->name);
 			{
 				_glv_wiget_focus_cb(glv_window,rmsg->data[2],rmsg->data[3],rmsg->data[4],rmsg->data[5],rmsg->data[6],rmsg->data[7]);
 			}
 			break;
 		case GLV_ON_END_DRAW:
-			GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_END_DRAW\n"GLV_DEBUG_END_COLOR,glv_window->name);
+			GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"[%s] GLV_ON_END_DRAW\n"GLV_DEBUG_END_COLOR,glv_window->name);
 			//printf("[%s] GLV_ON_END_DRAW\n",glv_window->name);
 			if(glv_window->eventFunc.endDraw != NULL){
 				int rc;
@@ -1182,6 +1536,158 @@ void *glvExecMsg(GLV_WINDOW_t *glv_window,pthread_msq_msg_t *rmsg)
 	return NULL;
 }
 
+#ifdef GLV_FRAME_SCHEDULER
+static uint64_t _glvFrameNow(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return((uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+// 描画メッセージを送信する(window_mutexを保持していない状態で呼ぶこと)
+static int _glvFrameSendMsg(GLV_WINDOW_t *glv_window,int req)
+{
+	GLV_WINDOW_t *teamLeader;
+	pthread_msq_msg_t smsg;
+
+	teamLeader = glv_window->teamLeader;
+	if(teamLeader == NULL){
+		return (GLV_OK);
+	}
+
+	if(req & GLV_FRAME_REQ_REDRAW){
+		smsg.data[0] = GLV_ON_REDRAW;
+	}else{
+		smsg.data[0] = GLV_ON_UPDATE;
+	}
+	smsg.data[1] = glv_window->instance.Id;
+	smsg.data[2] = GLV_FRAME_MSG_SCHEDULED;		// frame_pendingの解除対象
+	smsg.data[3] = 0;
+	smsg.data[6] = glv_window->draw_serial;
+
+	pthread_msq_msg_send(&teamLeader->ctx.queue,&smsg,0);
+	return (GLV_OK);
+}
+
+// 描画要求を登録する
+// 未処理の描画メッセージが無く、frame callback待ちでもない場合のみメッセージを送信する
+// それ以外の要求はframe_reqに集約し、描画後またはframe callbackで送信する
+static int _glvFrameRequest(GLV_WINDOW_t *glv_window,int req)
+{
+	int send = 0;
+
+	pthread_mutex_lock(&glv_window->window_mutex);			// window
+	glv_window->frame_req |= req;
+	if(glv_window->frame_pending == 0){
+		if((glv_window->frame_inflight == 1) &&
+			((_glvFrameNow() - glv_window->frame_inflight_time) > GLV_FRAME_CALLBACK_TIMEOUT)){
+			// frame callbackが返ってこない(非表示など)場合は描画を許可する
+			glv_window->frame_inflight = 0;
+		}
+		if(glv_window->frame_inflight == 0){
+			glv_window->frame_pending = 1;
+			send = glv_window->frame_req;
+		}
+	}
+	if(send == 0){
+		glv_window->frame_merged++;
+	}
+	pthread_mutex_unlock(&glv_window->window_mutex);		// window
+
+	if(send != 0){
+		return (_glvFrameSendMsg(glv_window,send));
+	}
+	return (GLV_OK);
+}
+
+// 描画メッセージの受信時に集約した描画要求を取り出す
+// redrawの要求が含まれていればGLV_ON_REDRAWとして処理する
+static void _glvFrameTake(GLV_WINDOW_t *glv_window,pthread_msq_msg_t *rmsg)
+{
+	int req;
+
+	pthread_mutex_lock(&glv_window->window_mutex);			// window
+	req = glv_window->frame_req;
+	glv_window->frame_req = 0;
+	pthread_mutex_unlock(&glv_window->window_mutex);		// window
+
+	if(req & GLV_FRAME_REQ_REDRAW){
+		rmsg->data[0] = GLV_ON_REDRAW;
+	}else if(req & GLV_FRAME_REQ_UPDATE){
+		rmsg->data[0] = GLV_ON_UPDATE;
+	}
+}
+
+// 描画メッセージの処理後
+// SwapBuffersしなかった場合は、処理中に来た描画要求をすぐに送信する
+static void _glvFrameEnd(GLV_WINDOW_t *glv_window)
+{
+	int send = 0;
+
+	pthread_mutex_lock(&glv_window->window_mutex);			// window
+	glv_window->frame_pending = 0;
+	if((glv_window->frame_inflight == 0) && (glv_window->frame_req != 0)){
+		glv_window->frame_pending = 1;
+		send = glv_window->frame_req;
+	}
+	pthread_mutex_unlock(&glv_window->window_mutex);		// window
+
+	if(send != 0){
+		_glvFrameSendMsg(glv_window,send);
+	}
+}
+
+// SwapBuffers(frame callback要求)時
+void _glvFrameBegin(GLV_WINDOW_t *glv_window)
+{
+	pthread_mutex_lock(&glv_window->window_mutex);			// window
+	glv_window->frame_inflight = 1;
+	glv_window->frame_inflight_time = _glvFrameNow();
+	pthread_mutex_unlock(&glv_window->window_mutex);		// window
+}
+
+// frame callback受信時(表示スレッド)
+// frame中に集約した描画要求があれば送信する
+void _glvOnFrameDone(GLV_WINDOW_t *glv_window)
+{
+	int send = 0;
+
+	if(glv_window->instance.alive != GLV_INSTANCE_ALIVE){
+		return;
+	}
+
+	pthread_mutex_lock(&glv_window->window_mutex);			// window
+	glv_window->frame_inflight = 0;
+	if((glv_window->frame_pending == 0) && (glv_window->frame_req != 0)){
+		glv_window->frame_pending = 1;
+		send = glv_window->frame_req;
+	}
+	pthread_mutex_unlock(&glv_window->window_mutex);		// window
+
+	if(send != 0){
+		_glvFrameSendMsg(glv_window,send);
+	}
+}
+#endif /* GLV_FRAME_SCHEDULER */
+
+#ifdef GLV_LAZY_MAKE_CURRENT
+// 描画を行うメッセージ(ハンドラ呼び出し前に描画先を選択し、glViewportを設定する)
+static int _glvIsDrawingMsg(int event)
+{
+	switch(event){
+		case GLV_ON_INIT:
+		case GLV_ON_CONFIGURE:
+		case GLV_ON_RESHAPE:
+		case GLV_ON_REDRAW:
+		case GLV_ON_UPDATE:
+			return(1);
+		default:
+			break;
+	}
+	return(0);
+}
+#endif /* GLV_LAZY_MAKE_CURRENT */
+
 int glvMsgHandler(GLV_WINDOW_t *glv_window,pthread_msq_msg_t *rmsg)
 {
 	GLV_WINDOW_t *target_window;
@@ -1197,37 +1703,77 @@ int glvMsgHandler(GLV_WINDOW_t *glv_window,pthread_msq_msg_t *rmsg)
 			if(rmsg->data[0] == GLV_ON_FOCUS){
 				// GLV_ON_FOCUSはエラーとしない
 			}else{
-				printf("==========================================================================================\n");
-				printf("glvMsgHandler:window is not found. msg = %ld , data[1-3] = %ld,%ld,%ld\n",rmsg->data[0],rmsg->data[1],rmsg->data[2],rmsg->data[3]);
-				printf("==========================================================================================\n");
+				GLV_LOG_WARN(GLV_DEBUG_MSG,"glvMsgHandler:window is not found. msg = %ld , data[1-3] = %ld,%ld,%ld\n",rmsg->data[0],rmsg->data[1],rmsg->data[2],rmsg->data[3]);
 			}
+			pthread_msq_payload_free(pthread_msq_msg_payload(rmsg));
 			return(rc);
 		}
 	}
 
 	if(target_window->instance.alive == GLV_INSTANCE_ALIVE){
+#ifdef GLV_FRAME_SCHEDULER
+		// _glvFrameSendMsgが送信したメッセージのみ集約した要求を取り出す
+		// (それ以外から届いたGLV_ON_REDRAW/UPDATEでframe_pendingを解除しない)
+		int frameMsg = (((rmsg->data[0] == GLV_ON_REDRAW) || (rmsg->data[0] == GLV_ON_UPDATE)) &&
+						(rmsg->data[2] == GLV_FRAME_MSG_SCHEDULED));
+		if(frameMsg){
+			_glvFrameTake(target_window,rmsg);
+		}
+#endif /* GLV_FRAME_SCHEDULER */
+#ifdef GLV_LAZY_MAKE_CURRENT
+		if(_glvIsDrawingMsg(rmsg->data[0])){
+			glvSelectDrawingWindow((glvWindow)target_window);
+		}else{
+			// 描画しないメッセージはsurfaceが切り替わる場合のみカレントにする(glViewportも省略する)
+			if(glvGl_MakeCurrent(target_window->ctx.egl_surf,target_window->instance.Id) == GLV_ERROR){
+				fprintf(stderr,"glvMsgHandler:Error: eglMakeCurrent() failed %s\n",target_window->name);
+			}
+		}
+#else
 		glvSelectDrawingWindow((glvWindow)target_window);
+#endif /* GLV_LAZY_MAKE_CURRENT */
 		target_window->reqSwapBuffersFlag = 0;
 
+#ifdef GLV_TRACE
+		uint64_t trace_start = 0;
+		if(GLV_TRACE_ON){
+			trace_start = _glvTraceNow();
+			_glvTraceInput(target_window,rmsg->data[0],trace_start);
+		}
+#endif /* GLV_TRACE */
 		glvExecMsg(target_window,rmsg);
+#ifdef GLV_TRACE
+		if(GLV_TRACE_ON && (trace_start != 0)){
+			_glvTraceComplete(_glvTraceMsgName(rmsg->data[0]),"handler",trace_start,target_window->instance.Id,target_window->name);
+		}
+#endif /* GLV_TRACE */
 		if(target_window->reqSwapBuffersFlag == 1){
 			target_window->reqSwapBuffersFlag = 0;
+#ifdef GLV_LAZY_MAKE_CURRENT
+			// ハンドラ内で他のウインドウを描画した場合に備えて描画先を戻す
+			if(glvGl_MakeCurrent(target_window->ctx.egl_surf,target_window->instance.Id) == GLV_ERROR){
+				fprintf(stderr,"glvMsgHandler:Error: eglMakeCurrent() failed %s\n",target_window->name);
+			}
+#endif /* GLV_LAZY_MAKE_CURRENT */
 			glvSwapBuffers(target_window);
 		}
+#ifdef GLV_FRAME_SCHEDULER
+		if(frameMsg){
+			_glvFrameEnd(target_window);
+		}
+#endif /* GLV_FRAME_SCHEDULER */
 	}
 
+	// 可変長データ(GLV_ON_USER_MSG,GLV_ON_KEY_INPUT)を送信先のプールに戻す
+	pthread_msq_payload_free(pthread_msq_msg_payload(rmsg));
+
 	switch(rmsg->data[0]){
 		case GLV_ON_REDRAW:
 			target_window->reqSwapBuffersFlag = 1;	// REDRAWは、必ず描画するので強制SwapBuffersを実行する
 			break;
 		case GLV_ON_USER_MSG:
-			if(rmsg->data[3] != 0) free((void *)rmsg->data[3]);
 			_usr_msg_ok_receive_count++;
 			break;
-		case GLV_ON_KEY_INPUT:
-			if(rmsg->data[7] != 0) free((void *)rmsg->data[7]);
-			if(rmsg->data[8] != 0) free((void *)rmsg->data[8]);
-			break;
 		case GLV_ON_TERMINATE:
 			rc = 0;
 			break;
@@ -1247,6 +1793,9 @@ void *glvSurfaceViewMsgHandler(GLV_WINDOW_t *glv_window)
 		// メッセージ初期化
 		memset(&rmsg, 0, sizeof(pthread_msq_msg_t));
 
+		// 待ちに入る前に溜まっているログを出力する
+		glvLog_flush();
+
 		// メッセージ受信
 		rc = pthread_msq_msg_receive(&glv_window->ctx.queue, &rmsg);
 		if (PTHREAD_MSQ_OK != rc) {
@@ -1324,7 +1873,7 @@ void *glvSurfaceViewProc(void *param)
 	}
 	glvGl_setEglContextInfo(egl_dpy,egl_ctx);
 
-   if (!eglMakeCurrent(glvGl_GetEglDisplay(), glv_window->ctx.egl_surf, glv_window->ctx.egl_surf,glvGl_GetEglContext())) {
+   if (glvGl_MakeCurrent(glv_window->ctx.egl_surf,glv_window->instance.Id) == GLV_ERROR) {
       fprintf(stderr,"glvSurfaceViewProc:Error: eglMakeCurrent() failed\n");
       exit(-1);
    }
@@ -1364,6 +1913,23 @@ void *glvSurfaceViewProc(void *param)
 			fprintf(stderr,"glv_window->eventFunc.start error\n");
 		}
 	}
+#ifdef GLV_HEADLESS_BACKEND
+	if((glv_window->glv_dpy->headless == 1) && (glv_window->windowType == GLV_TYPE_THREAD_FRAME)){
+		// headlessの場合も、surfaceのconfigureが通知されないので、ここで起動処理を実行する
+		pthread_mutex_lock(&glv_window->serialize_mutex);				// window serialize_mutex
+		if(glv_window->flag_surface_configure == 0){
+			glv_window->flag_surface_configure = 1;
+			if(glv_window->eventFunc.start != NULL){
+				int rc;
+				rc = (glv_window->eventFunc.start)(glv_window,glv_window->frameInfo.inner_width,glv_window->frameInfo.inner_height);
+				if(rc != GLV_OK){
+					fprintf(stderr,"[%s] glv_window->eventFunc.start error\n",glv_window->name);
+				}
+			}
+		}
+		pthread_mutex_unlock(&glv_window->serialize_mutex);				// window serialize_mutex
+	}
+#endif /* GLV_HEADLESS_BACKEND */
 
 	//printf("sem_post(&glv_window->initSync); post [%s]\n",glv_window->name);
 	// glvCreateThreadSurfaceViewとの待ち合わせ
@@ -1383,7 +1949,7 @@ void *glvSurfaceViewProc(void *param)
 	pthread_msq_stop(&glv_window->ctx.queue);	// メッセージ受信を停止する
 
 	// 受信済みの未処理メッセージの後処理
-	// freeが必要なメッセージを処理する
+	// 可変長データはキューを破壊する前に解放する
 	while(1){
 		int rc;
 		// メッセージ初期化
@@ -1394,15 +1960,11 @@ void *glvSurfaceViewProc(void *param)
 			// メッセージ無し
 			break;
 		}
+		pthread_msq_payload_free(pthread_msq_msg_payload(&rmsg));
 		switch(rmsg.data[0]){
 			case GLV_ON_USER_MSG:
-				if(rmsg.data[3] != 0) free((void *)rmsg.data[3]);
 				_usr_msg_ng_receive_count++;
 				break;
-			case GLV_ON_KEY_INPUT:
-				if(rmsg.data[7] != 0) free((void *)rmsg.data[7]);
-				if(rmsg.data[8] != 0) free((void *)rmsg.data[8]);
-				break;
 			default:
 				break;
 		}
@@ -1410,12 +1972,16 @@ void *glvSurfaceViewProc(void *param)
 	//printf("glvSurfaceViewProc:msg queue enpty %s\n",glv_window->name);
 
 	pthread_msq_destroy(&glv_window->ctx.queue);
-	glvSelectDrawingWindow(NULL);
-	eglDestroyContext(egl_dpy, egl_ctx);
 
+	// テクスチャ・バッファ・プログラムはコンテキストがカレントの間に削除する
+	glvSelectDrawingWindow((glvWindow)glv_window);
+	glvFont_thread_safe_finish();
+	glvGl_thread_safe_finish();
 #ifdef _GLES1_EMULATION
 	es1emu_Finish();
 #endif
+	glvSelectDrawingWindow(NULL);
+	eglDestroyContext(egl_dpy, egl_ctx);
 
 	if(glv_window->ctx.endReason == GLV_END_REASON__INTERNAL){
 		pthread_mutex_destroy(&glv_window->window_mutex);
@@ -1431,6 +1997,7 @@ glvWindow glvCreateThreadSurfaceView(glvWindow glv_win)
 	pthread_t 	threadId;
 	GLV_WINDOW_t *glv_window = (GLV_WINDOW_t *)glv_win;
 	pthread_msq_id_t queue = PTHREAD_MSQ_ID_INITIALIZER;
+	int			queueType = PTHREAD_MSQ_TYPE_MUTEX;
 
 	if(!glv_window){
 		return(NULL);
@@ -1439,7 +2006,10 @@ glvWindow glvCreateThreadSurfaceView(glvWindow glv_win)
 	memcpy(&glv_window->ctx.queue,&queue,sizeof(pthread_msq_id_t));
 
 	// メッセージキュー生成
-	if (0 != pthread_msq_create(&glv_window->ctx.queue, 100)) {
+	if(glv_window->attr & GLV_WINDOW_ATTR_LOCKFREE_QUEUE){
+		queueType = PTHREAD_MSQ_TYPE_LOCKFREE;
+	}
+	if (0 != pthread_msq_create_ex(&glv_window->ctx.queue, 100, queueType)) {
 		fprintf(stderr,"glvSurfaceViewProc:Error: pthread_msq_create() failed\n");
 		exit(-1);
 	}
@@ -1573,7 +2143,7 @@ int _glvOnInit_for_childWindow(glvWindow glv_win,int width, int height)
 	smsg.data[3] = 0;
 	smsg.data[4] = width;
 	smsg.data[5] = height;
-	GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"_glvOnInit_for_childWindow  INIT %d,%d\n"GLV_DEBUG_END_COLOR,width,height);
+	GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"_glvOnInit_for_childWindow  INIT %d,%d\n"GLV_DEBUG_END_COLOR,width,height);
 
 	pthread_msq_msg_send(&teamLeader->ctx.queue,&smsg,0);
 	return (GLV_OK);
@@ -1608,7 +2178,7 @@ int _glvOnConfigure(glvWindow glv_win,int width, int height)
 	smsg.data[4] = width;
 	smsg.data[5] = height;
 	smsg.data[6] = glv_window->configure_serial;
-	GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"_glvOnConfigure  RESHAPE %d,%d\n"GLV_DEBUG_END_COLOR,width,height);
+	GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"_glvOnConfigure  RESHAPE %d,%d\n"GLV_DEBUG_END_COLOR,width,height);
 
 	pthread_msq_msg_send(&teamLeader->ctx.queue,&smsg,0);
 	return (GLV_OK);
@@ -1656,7 +2226,7 @@ int glvOnReShape(glvWindow glv_win,int x, int y,int width, int height)
 	smsg.data[4] = width;
 	smsg.data[5] = height;
 	smsg.data[6] = glv_window->resharp_serial;
-	GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"glvOnReShape  RESHAPE %d,%d\n"GLV_DEBUG_END_COLOR,width,height);
+	GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"glvOnReShape  RESHAPE %d,%d\n"GLV_DEBUG_END_COLOR,width,height);
 
 	pthread_msq_msg_send(&teamLeader->ctx.queue,&smsg,0);
 	return (GLV_OK);
@@ -1684,15 +2254,19 @@ int glvOnReDraw(glvWindow glv_win)
 
 	glv_window->draw_serial++;
 
+#ifdef GLV_FRAME_SCHEDULER
+	return (_glvFrameRequest(glv_window,GLV_FRAME_REQ_REDRAW));
+#else
 	smsg.data[0] = GLV_ON_REDRAW;
 	smsg.data[1] = glv_window->instance.Id;
 	smsg.data[2] = 0;
 	smsg.data[3] = 0;
 	smsg.data[6] = glv_window->draw_serial;
 
-	//GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"glvOnReDraw \n"GLV_DEBUG_END_COLOR);
+	//GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"glvOnReDraw \n"GLV_DEBUG_END_COLOR);
 	pthread_msq_msg_send(&teamLeader->ctx.queue,&smsg,0);
 	return (GLV_OK);
+#endif /* GLV_FRAME_SCHEDULER */
 }
 
 int glvOnUpdate(glvWindow glv_win)
@@ -1717,15 +2291,19 @@ int glvOnUpdate(glvWindow glv_win)
 
 	glv_window->draw_serial++;
 
+#ifdef GLV_FRAME_SCHEDULER
+	return (_glvFrameRequest(glv_window,GLV_FRAME_REQ_UPDATE));
+#else
 	smsg.data[0] = GLV_ON_UPDATE;
 	smsg.data[1] = glv_window->instance.Id;
 	smsg.data[2] = 0;
 	smsg.data[3] = 0;
 	smsg.data[6] = glv_window->draw_serial;
 
-	//GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"glvOnUpdate \n"GLV_DEBUG_END_COLOR);
+	//GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"glvOnUpdate \n"GLV_DEBUG_END_COLOR);
 	pthread_msq_msg_send(&teamLeader->ctx.queue,&smsg,0);
 	return (GLV_OK);
+#endif /* GLV_FRAME_SCHEDULER */
 }
 
 int glvOnGesture(glvWindow glv_win,int eventType,int x,int y,int distance_x,int distance_y,int velocity_x,int velocity_y)
@@ -1757,7 +2335,7 @@ int glvOnGesture(glvWindow glv_win,int eventType,int x,int y,int distance_x,int
 	smsg.data[6] = distance_y;
 	smsg.data[7] = velocity_x;
 	smsg.data[8] = velocity_y;
-	//GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"glvOnGesture \n"GLV_DEBUG_END_COLOR);
+	//GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"glvOnGesture \n"GLV_DEBUG_END_COLOR);
 	pthread_msq_msg_send(&teamLeader->ctx.queue,&smsg,0);
 	return (GLV_OK);
 }
@@ -1786,58 +2364,92 @@ int glvOnActivate(glvWindow glv_win)
 	smsg.data[1] = glv_window->instance.Id;
 	smsg.data[2] = 0;
 	smsg.data[3] = 0;
-	//GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"GLV_ON_ACTIVE \n"GLV_DEBUG_END_COLOR);
+	//GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"GLV_ON_ACTIVE \n"GLV_DEBUG_END_COLOR);
 	pthread_msq_msg_send(&teamLeader->ctx.queue,&smsg,0);
 	return (GLV_OK);
 }
 
-int glvOnUserMsg(glvWindow glv_win,int kind,void *data,size_t size)
+/**
+ * @brief ユーザーメッセージのデータ領域を送信先ウインドウのメッセージキューから確保する
+ *
+ * 確保した領域に直接書き込み、glvUserMsg_send()で送信する(コピー無しで受信側に渡る)。
+ * 送信しなかった場合はglvUserMsg_free()で解放する(ウインドウの破壊後に解放してもよい)。
+ *
+ * @param[in] glv_win 送信先のウインドウ
+ * @param[in] size 大きさ
+ * @retval NULL以外 データ領域
+ * @retval NULL 確保できない
+ */
+void *glvUserMsg_alloc(glvWindow glv_win,size_t size)
+{
+	GLV_WINDOW_t *glv_window = (GLV_WINDOW_t*)glv_win;
+
+	if((glv_window == NULL) || (glv_window->teamLeader == NULL)){
+		return(pthread_msq_payload_alloc(NULL,size));
+	}
+	return(pthread_msq_payload_alloc(&glv_window->teamLeader->ctx.queue,size));
+}
+
+/**
+ * @brief 送信しなかったユーザーメッセージのデータ領域を解放する
+ */
+void glvUserMsg_free(void *data)
+{
+	pthread_msq_payload_free(data);
+}
+
+/**
+ * @brief glvUserMsg_alloc()で確保したデータ領域をユーザーメッセージとして送信する
+ *
+ * dataの所有権は受信側に移る(userMsgハンドラから戻った後に解放される)。
+ * 送信できなかった場合もdataは解放される。
+ *
+ * @param[in] glv_win 送信先のウインドウ
+ * @param[in] kind 種別
+ * @param[in] data glvUserMsg_alloc()で確保したデータ領域(NULL可)
+ * @retval GLV_OK 正常
+ * @retval GLV_ERROR エラー
+ */
+int glvUserMsg_send(glvWindow glv_win,int kind,void *data)
 {
 	GLV_WINDOW_t *glv_window = (GLV_WINDOW_t*)glv_win;
 	GLV_WINDOW_t *teamLeader;
 	pthread_msq_msg_t smsg;
-	void *memory=NULL;
 	int rc;
 
 	if(glv_window == NULL){
+		pthread_msq_payload_free(data);
 		return (GLV_ERROR);
 	}
 
 	if(glv_window->instance.alive != GLV_INSTANCE_ALIVE){
+		pthread_msq_payload_free(data);
 		_usr_msg_ng_send_count++;
 		return (GLV_ERROR);
 	}
 
 	if(glv_window->teamLeader == NULL){
 		// 関数コール
+		pthread_msq_payload_free(data);
 		return (GLV_OK);
 	}
 	teamLeader = glv_window->teamLeader;
 
-	if(size > 0){
-		memory = malloc(size);
-		if(memory == NULL){
-			_usr_msg_ng_send_count++;
-			return(GLV_ERROR);
-		}
-		memcpy(memory,data,size);
-	}
-
 	smsg.data[0] = GLV_ON_USER_MSG;
 	smsg.data[1] = glv_window->instance.Id;
 	smsg.data[2] = kind;
-	smsg.data[3] = (size_t)memory;
+	smsg.data[3] = pthread_msq_payload_size(data);
 	smsg.data[4] = 0;
 	smsg.data[5] = 0;
 	smsg.data[6] = 0;
 	smsg.data[7] = 0;
 
-	//GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"glvOnUserMsg \n"GLV_DEBUG_END_COLOR);
+	//GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"glvOnUserMsg \n"GLV_DEBUG_END_COLOR);
 	//printf("glvOnUserMsg\n");
-	rc = pthread_msq_msg_send(&teamLeader->ctx.queue,&smsg,0);
+	rc = pthread_msq_msg_send_payload(&teamLeader->ctx.queue,&smsg,0,data);
 	if(rc == PTHREAD_MSQ_ERROR){
 		//printf("glvOnUserMsg:pthread_msq_msg_send error\n");
-		if(memory != NULL) free(memory);
+		pthread_msq_payload_free(data);
 		_usr_msg_ng_send_count++;
 		return(GLV_ERROR);
 	}
@@ -1845,6 +2457,36 @@ int glvOnUserMsg(glvWindow glv_win,int kind,void *data,size_t size)
 	return (GLV_OK);
 }
 
+int glvOnUserMsg(glvWindow glv_win,int kind,void *data,size_t size)
+{
+	GLV_WINDOW_t *glv_window = (GLV_WINDOW_t*)glv_win;
+	void *memory=NULL;
+
+	if(glv_window == NULL){
+		return (GLV_ERROR);
+	}
+
+	if(glv_window->instance.alive != GLV_INSTANCE_ALIVE){
+		_usr_msg_ng_send_count++;
+		return (GLV_ERROR);
+	}
+
+	if(glv_window->teamLeader == NULL){
+		// 関数コール
+		return (GLV_OK);
+	}
+
+	if(size > 0){
+		memory = glvUserMsg_alloc(glv_win,size);
+		if(memory == NULL){
+			_usr_msg_ng_send_count++;
+			return(GLV_ERROR);
+		}
+		memcpy(memory,data,size);
+	}
+	return (glvUserMsg_send(glv_win,kind,memory));
+}
+
 int _glvOnMousePointer(void *glv_instance,int type,glvTime time,int x,int y,int pointer_left_stat)
 {
 	GLV_WINDOW_t *glv_window;
@@ -1874,7 +2516,7 @@ int _glvOnMousePointer(void *glv_instance,int type,glvTime time,int x,int y,int
 		glv_sheet = glv_wiget->glv_sheet;
 		glv_window = glv_sheet->glv_window;
 	}else{
-		printf("_glvOnMousePointer:bad instance type %08x\n",instanceType);
+		GLV_LOG_ERROR(GLV_DEBUG_API,"_glvOnMousePointer:bad instance type %08x\n",instanceType);
 		return(GLV_ERROR);
 	}
 
@@ -1903,8 +2545,13 @@ int _glvOnMousePointer(void *glv_instance,int type,glvTime time,int x,int y,int
 	smsg.data[6] = x;
 	smsg.data[7] = y;
 	smsg.data[8] = pointer_left_stat;
-	//GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"GLV_ON_MOUSE_POINTER \n"GLV_DEBUG_END_COLOR);
+	//GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"GLV_ON_MOUSE_POINTER \n"GLV_DEBUG_END_COLOR);
+#ifdef GLV_COALESCE_POINTER_EVENT
+	// 同じ通知先(window,sheet,wiget,type)の未処理の移動メッセージは最新の位置で置き換える
+	pthread_msq_msg_send_coalesce(&teamLeader->ctx.queue,&smsg,0,5,PTHREAD_MSQ_COALESCE_REPLACE);
+#else
 	pthread_msq_msg_send(&teamLeader->ctx.queue,&smsg,0);
+#endif /* GLV_COALESCE_POINTER_EVENT */
 	return (GLV_OK);
 }
 
@@ -1937,7 +2584,7 @@ int _glvOnMouseButton(void *glv_instance,int type,glvTime time,int x,int y,int p
 		glv_sheet = glv_wiget->glv_sheet;
 		glv_window = glv_sheet->glv_window;
 	}else{
-		printf("_glvOnMouseButton:bad instance type %08x\n",instanceType);
+		GLV_LOG_ERROR(GLV_DEBUG_API,"_glvOnMouseButton:bad instance type %08x\n",instanceType);
 		return(GLV_ERROR);
 	}
 
@@ -1967,7 +2614,7 @@ int _glvOnMouseButton(void *glv_instance,int type,glvTime time,int x,int y,int p
 	smsg.data[6] = x;
 	smsg.data[7] = y;
 	smsg.data[8] = pointer_stat;
-	//GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"GLV_ON_MOUSE_BUTTON \n"GLV_DEBUG_END_COLOR);
+	//GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"GLV_ON_MOUSE_BUTTON \n"GLV_DEBUG_END_COLOR);
 	pthread_msq_msg_send(&teamLeader->ctx.queue,&smsg,0);
 	return (GLV_OK);
 }
@@ -2001,7 +2648,7 @@ int _glvOnMouseAxis(void *glv_instance,int type,glvTime time,int value)
 		glv_sheet = glv_wiget->glv_sheet;
 		glv_window = glv_sheet->glv_window;
 	}else{
-		printf("_glvOnMouseAxis:bad instance type %08x\n",instanceType);
+		GLV_LOG_ERROR(GLV_DEBUG_API,"_glvOnMouseAxis:bad instance type %08x\n",instanceType);
 		return(GLV_ERROR);
 	}
 
@@ -2029,8 +2676,13 @@ int _glvOnMouseAxis(void *glv_instance,int type,glvTime time,int value)
 	smsg.data[4] = type;
 	smsg.data[5] = time;
 	smsg.data[6] = value;
-	//GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"GLV_ON_MOUSE_AXIS \n"GLV_DEBUG_END_COLOR);
+	//GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"GLV_ON_MOUSE_AXIS \n"GLV_DEBUG_END_COLOR);
+#ifdef GLV_COALESCE_POINTER_EVENT
+	// 同じ通知先(window,sheet,wiget,type)の未処理のホイールメッセージは移動量(data[6])を加算する
+	pthread_msq_msg_send_coalesce(&teamLeader->ctx.queue,&smsg,0,5,6);
+#else
 	pthread_msq_msg_send(&teamLeader->ctx.queue,&smsg,0);
+#endif /* GLV_COALESCE_POINTER_EVENT */
 	return (GLV_OK);
 }
 
@@ -2063,7 +2715,7 @@ int glvOnAction(void *glv_instance,int action,glvInstanceId selectId)
 		glv_sheet = glv_wiget->glv_sheet;
 		glv_window = glv_sheet->glv_window;
 	}else{
-		printf("glvOnAction:bad instance type %08x\n",instanceType);
+		GLV_LOG_ERROR(GLV_DEBUG_API,"glvOnAction:bad instance type %08x\n",instanceType);
 		return(GLV_ERROR);
 	}
 
@@ -2089,7 +2741,7 @@ int glvOnAction(void *glv_instance,int action,glvInstanceId selectId)
 	smsg.data[3] = wigetId;
 	smsg.data[4] = action;
 	smsg.data[5] = selectId;
-	//GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"GLV_ON_ACTION \n"GLV_DEBUG_END_COLOR);
+	//GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"GLV_ON_ACTION \n"GLV_DEBUG_END_COLOR);
 	pthread_msq_msg_send(&teamLeader->ctx.queue,&smsg,0);
 	return (GLV_OK);
 }
@@ -2119,7 +2771,7 @@ int _glvOnKey(glvWindow glv_win,unsigned int key,unsigned int modifiers,unsigned
 	smsg.data[2] = key;
 	smsg.data[3] = modifiers;
 	smsg.data[4] = state;
-	//GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"GLV_ON_KEY \n"GLV_DEBUG_END_COLOR);
+	//GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"GLV_ON_KEY \n"GLV_DEBUG_END_COLOR);
 	pthread_msq_msg_send(&teamLeader->ctx.queue,&smsg,0);
 	return (GLV_OK);
 }
@@ -2133,8 +2785,7 @@ int _glvOnTextInput(glvDisplay glv_dpy,int kind,int state,uint32_t kyesym,int *u
 	glvInstanceId	windowId = 0;
 	glvInstanceId	sheetId = 0;
 	glvInstanceId	wigetId = 0;
-	void *utf32_text=NULL;
-	void *utf32_attr=NULL;
+	uint8_t *payload=NULL;
 	int rc,size;
 
 	windowId = glv_display->kb_input_windowId;
@@ -2157,25 +2808,22 @@ int _glvOnTextInput(glvDisplay glv_dpy,int kind,int state,uint32_t kyesym,int *u
 	}
 	teamLeader = glv_window->teamLeader;
 
-	if(utf32 != NULL){
-		size = length * sizeof(int);
-		if(size > 0){
-			utf32_text = malloc(size);
-			if(utf32_text == NULL){
-				return(GLV_ERROR);
-			}
-			memcpy(utf32_text,utf32,size);
+	// utf32[length],attr[length]の順に1つのデータ領域に格納して受信側に渡す
+	size = 0;
+	if(utf32 != NULL) size += length * sizeof(int);
+	if(attr != NULL)  size += length * sizeof(uint8_t);
+	if(size > 0){
+		payload = pthread_msq_payload_alloc(&teamLeader->ctx.queue,size);
+		if(payload == NULL){
+			return(GLV_ERROR);
 		}
-	}
-	if(attr != NULL){
-		size = length * sizeof(uint8_t);
-		if(size > 0){
-			utf32_attr = malloc(size);
-			if(utf32_attr == NULL){
-				if(utf32_text != NULL) free(utf32_text);
-				return(GLV_ERROR);
-			}
-			memcpy(utf32_attr,attr,size);
+		size = 0;
+		if(utf32 != NULL){
+			memcpy(payload,utf32,length * sizeof(int));
+			size += length * sizeof(int);
+		}
+		if(attr != NULL){
+			memcpy(payload + size,attr,length * sizeof(uint8_t));
 		}
 	}
 
@@ -2186,17 +2834,16 @@ int _glvOnTextInput(glvDisplay glv_dpy,int kind,int state,uint32_t kyesym,int *u
 	smsg.data[4] = kind;
 	smsg.data[5] = state;
 	smsg.data[6] = kyesym;
-	smsg.data[7] = (size_t)utf32_text;
-	smsg.data[8] = (size_t)utf32_attr;
+	smsg.data[7] = ((utf32 != NULL) && (payload != NULL));
+	smsg.data[8] = ((attr != NULL) && (payload != NULL));
 	smsg.data[9] = length;
 
-	//GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"_glvOnTextInput\n"GLV_DEBUG_END_COLOR);
+	//GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"_glvOnTextInput\n"GLV_DEBUG_END_COLOR);
 	//printf("_glvOnTextInput\n");
-	rc = pthread_msq_msg_send(&teamLeader->ctx.queue,&smsg,0);
+	rc = pthread_msq_msg_send_payload(&teamLeader->ctx.queue,&smsg,0,payload);
 	if(rc == PTHREAD_MSQ_ERROR){
-		printf("_glvOnTextInput:pthread_msq_msg_send error\n");
-		if(utf32_text != NULL) free(utf32_text);
-		if(utf32_attr != NULL) free(utf32_attr);
+		GLV_LOG_ERROR(GLV_DEBUG_API,"_glvOnTextInput:pthread_msq_msg_send error\n");
+		pthread_msq_payload_free(payload);
 		return(GLV_ERROR);
 	}
 	return (GLV_OK);
@@ -2253,11 +2900,11 @@ int _glvOnFocus(glvDisplay glv_dpy,int focus_stat,glvWiget in_Wiget)
 	smsg.data[6] = in_sheetId;
 	smsg.data[7] = in_wigetId;
 
-	//GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"_glvOnFocus\n"GLV_DEBUG_END_COLOR);
+	//GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"_glvOnFocus\n"GLV_DEBUG_END_COLOR);
 	//printf("_glvOnFocus\n");
 	rc = pthread_msq_msg_send(&teamLeader->ctx.queue,&smsg,0);
 	if(rc == PTHREAD_MSQ_ERROR){
-		printf("_glvOnFocus:pthread_msq_msg_send error\n");
+		GLV_LOG_ERROR(GLV_DEBUG_API,"_glvOnFocus:pthread_msq_msg_send error\n");
 		return(GLV_ERROR);
 	}
 	return (GLV_OK);
@@ -2287,7 +2934,7 @@ int _glvOnEndDraw(glvWindow glv_win,glvTime time)
 	smsg.data[1] = glv_window->instance.Id;
 	smsg.data[2] = time;
 
-	//GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"_glvOnEndDraw \n"GLV_DEBUG_END_COLOR);
+	//GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"_glvOnEndDraw \n"GLV_DEBUG_END_COLOR);
 	pthread_msq_msg_send(&teamLeader->ctx.queue,&smsg,0);
 	return (GLV_OK);
 }
@@ -2314,14 +2961,14 @@ int glvTerminateThreadSurfaceView(glvWindow glv_win)
 	}
 
 	if(glv_window->ctx.runThread != 1){
-		printf("glvTerminateThreadSurfaceView: thread is not runninng. %s\n",glv_window->name);
+		GLV_LOG_WARN(GLV_DEBUG_API,"glvTerminateThreadSurfaceView: thread is not runninng. %s\n",glv_window->name);
 		return (GLV_ERROR);
 	}
 	smsg.data[0] = GLV_ON_TERMINATE;
 	smsg.data[1] = glv_window->instance.Id;
 	smsg.data[2] = 0;
 	smsg.data[3] = 0;
-	//GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"glvTerminateThreadSurfaceView \n"GLV_DEBUG_END_COLOR);
+	//GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"glvTerminateThreadSurfaceView \n"GLV_DEBUG_END_COLOR);
 	pthread_msq_msg_send(&glv_window->ctx.queue,&smsg,0);
 
 	if(pthread_equal(glv_window->ctx.threadId,pthread_self())){
@@ -2331,7 +2978,7 @@ int glvTerminateThreadSurfaceView(glvWindow glv_win)
 		glv_window->ctx.endReason = GLV_END_REASON__EXTERNAL;
 		rc = pthread_join(glv_window->ctx.threadId,NULL);
 		if(rc != 0){
-			printf("glvTerminateThreadSurfaceView:pthread_join error %d\n",rc);
+			GLV_LOG_ERROR(GLV_DEBUG_API,"glvTerminateThreadSurfaceView:pthread_join error %d\n",rc);
 		}
 	}
 
@@ -2404,6 +3051,41 @@ int glvStopTimer(glvWindow glv_win,int id)
 	return(rc);
 }
 
+/**
+ * @brief 繰り返しタイマーの満了に間に合わなかった場合の扱いを設定する
+ *
+ * 繰り返しタイマーは起動時刻からの周期で満了し、処理の遅れは次の満了時刻に持ち越さない。
+ * 
+ * @param[in]	glv_win	ウインドウ
+ * @param[in]	id		タイマーID
+ * @param[in]	policy	GLV_TIMER_MISSED_COALESCE/GLV_TIMER_MISSED_SKIP/GLV_TIMER_MISSED_CATCHUP
+ * @retval	GLV_OK		成功
+ * @retval	GLV_ERROR	タイマーが無い、policyが不正
+ */
+int glvSetTimerMissedPolicy(glvWindow glv_win,int id,int policy)
+{
+	GLV_WINDOW_t *glv_window;
+	glv_window = (GLV_WINDOW_t*)glv_win;
+	int rc;
+	rc = pthreadSetMissedPolicy(glv_window->ctx.threadId,id,policy);
+	return(rc);
+}
+
+/**
+ * @brief 処理中のタイマーの通知までに逃した回数を取得する
+ *
+ * timerハンドラ内で呼び出す。GLV_TIMER_MISSED_COALESCEの場合、
+ * 前回の通知を処理している間に満了した回数が返る。
+ * 
+ * @param[in]	glv_win	ウインドウ
+ * @retval	逃した回数
+ */
+int glvWindow_getTimerMissedCount(glvWindow glv_win)
+{
+	GLV_WINDOW_t *glv_window = (GLV_WINDOW_t*)glv_win;
+	return(glv_window->timer_missed);
+}
+
 int glvReqSwapBuffers(glvWindow glv_win)
 {
 	GLV_WINDOW_t *glv_window = (GLV_WINDOW_t*)glv_win;
@@ -2415,18 +3097,19 @@ int glvReqSwapBuffers(glvWindow glv_win)
 int glvSelectDrawingWindow(glvWindow glv_win)
 {
 	GLV_WINDOW_t *glv_window = (GLV_WINDOW_t*)glv_win;
-	EGLBoolean	rc;
+	int	rc;
 
+	// スレッドでカレントのsurfaceと同じ場合、eglMakeCurrentは省略される
 	if(glv_window != NULL){
-		rc = eglMakeCurrent(glvGl_GetEglDisplay(), glv_window->ctx.egl_surf, glv_window->ctx.egl_surf,glvGl_GetEglContext());
-		if(rc == 0) {
+		rc = glvGl_MakeCurrent(glv_window->ctx.egl_surf,glv_window->instance.Id);
+		if(rc == GLV_ERROR) {
     		fprintf(stderr,"glvSelectDrawingWindow:Error: eglMakeCurrent() failed %s\n",glv_window->name);
     		return(GLV_ERROR);
    		}
 		glvWindow_setViewport(glv_win,glv_window->width,glv_window->height);
 	}else{
-		rc = eglMakeCurrent(glvGl_GetEglDisplay(), EGL_NO_SURFACE, EGL_NO_SURFACE,glvGl_GetEglContext());
-		if(rc == 0) {
+		rc = glvGl_MakeCurrent(EGL_NO_SURFACE,0);
+		if(rc == GLV_ERROR) {
     		fprintf(stderr,"glvSelectDrawingWindow:Error: eglMakeCurrent() failed\n");
     		return(GLV_ERROR);
    		}
@@ -2569,7 +3252,7 @@ int glv_isInsertMode(void *glv_instance)
 	GLV_WIGET_t	*wiget;
 	int ins_mode=1;
 	if(glv_instance == NULL){
-		printf("glv_isInsertMode:instance is NULL\n");
+		GLV_LOG_ERROR(GLV_DEBUG_API,"glv_isInsertMode:instance is NULL\n");
 		return(ins_mode);
 	}
 	switch(instance->instanceType){
@@ -2606,7 +3289,7 @@ int glv_isPullDownMenu(void *glv_instance)
 	GLV_WINDOW_t *myFrame=NULL;
 	int menu=0;
 	if(glv_instance == NULL){
-		printf("glv_isPullDownMenu:instance is NULL\n");
+		GLV_LOG_ERROR(GLV_DEBUG_API,"glv_isPullDownMenu:instance is NULL\n");
 		return(menu);
 	}
 	switch(instance->instanceType){
@@ -2642,7 +3325,7 @@ int glv_isCmdMenu(void *glv_instance)
 	GLV_WINDOW_t *myFrame=NULL;
 	int menu=0;
 	if(glv_instance == NULL){
-		printf("glv_isCmdMenu:instance is NULL\n");
+		GLV_LOG_ERROR(GLV_DEBUG_API,"glv_isCmdMenu:instance is NULL\n");
 		return(menu);
 	}
 	switch(instance->instanceType){
@@ -2677,7 +3360,7 @@ glvDisplay glv_getDisplay(void *glv_instance)
 	GLV_SHEET_t	*sheet;
 	GLV_WIGET_t	*wiget;
 	if(glv_instance == NULL){
-		printf("glv_getDisplay:instance is NULL\n");
+		GLV_LOG_ERROR(GLV_DEBUG_API,"glv_getDisplay:instance is NULL\n");
 		return(NULL);
 	}
 	switch(instance->instanceType){
@@ -2711,7 +3394,7 @@ glvWindow glv_getWindow(void *glv_instance)
 	GLV_SHEET_t	*sheet;
 	GLV_WIGET_t	*wiget;
 	if(glv_instance == NULL){
-		printf("glv_getWindow:instance is NULL\n");
+		GLV_LOG_ERROR(GLV_DEBUG_API,"glv_getWindow:instance is NULL\n");
 		return(NULL);
 	}
 	switch(instance->instanceType){
@@ -2740,7 +3423,7 @@ glvWindow glv_getFrameWindow(void *glv_instance)
 	GLV_WIGET_t	*wiget;
 	GLV_WINDOW_t *myFrame=NULL;
 	if(glv_instance == NULL){
-		printf("glv_getFrameWindow:instance is NULL\n");
+		GLV_LOG_ERROR(GLV_DEBUG_API,"glv_getFrameWindow:instance is NULL\n");
 		return(NULL);
 	}
 	switch(instance->instanceType){
@@ -2772,7 +3455,7 @@ int glv_getWindowType(void *glv_instance)
 	GLV_WIGET_t	*wiget;
 	int windowType=0;
 	if(glv_instance == NULL){
-		printf("glv_getWindowType:instance is NULL\n");
+		GLV_LOG_ERROR(GLV_DEBUG_API,"glv_getWindowType:instance is NULL\n");
 		return(windowType);
 	}
 	switch(instance->instanceType){
@@ -2804,7 +3487,7 @@ int glv_getFrameInfo(void *glv_instance,GLV_FRAME_INFO_t *frameInfo)
 	GLV_SHEET_t	*sheet;
 	GLV_WIGET_t	*wiget;
 	if(glv_instance == NULL){
-		printf("glv_getFrameInfo:instance is NULL\n");
+		GLV_LOG_ERROR(GLV_DEBUG_API,"glv_getFrameInfo:instance is NULL\n");
 		return(rc);
 	}
 	switch(instance->instanceType){
@@ -2995,7 +3678,7 @@ int glv_r_set_value(struct _glv_r_value **link,void *instance,char *key,char *ty
 			}
 		}
 		if(rc == 1){
-			printf("glv_r_set_value:too many arguments (%d). [%s] (\"%s\"). up to %d arguments can be set.\n",length,key,type_string,_GLV_R_VALUE_MAX);
+			GLV_LOG_ERROR(GLV_DEBUG_API,"glv_r_set_value:too many arguments (%d). [%s] (\"%s\"). up to %d arguments can be set.\n",length,key,type_string,_GLV_R_VALUE_MAX);
 			length = _GLV_R_VALUE_MAX;
 		}
 	}
@@ -3019,10 +3702,10 @@ int glv_r_set_value(struct _glv_r_value **link,void *instance,char *key,char *ty
 	for(index=0;index<length;index++){
 		rc = glv_r_is_typeChar2typeNo(type_string[index],&type);
 		if(rc == 0){
-			printf("glv_r_set_value:type not found. [%s] arg %d (\"%c\")\n",key,index+1,type_string[index]);
+			GLV_LOG_ERROR(GLV_DEBUG_API,"glv_r_set_value:type not found. [%s] arg %d (\"%c\")\n",key,index+1,type_string[index]);
 		}
 		if((findFlag == 1) && (fp->n[index].type != GLV_R_VALUE_TYPE__NOTHING) && (fp->n[index].type != type)){
-			printf("glv_r_set_value:type unmach. [%s] arg %d (%d != %d)\n",key,index+1,fp->n[index].type,type);
+			GLV_LOG_ERROR(GLV_DEBUG_API,"glv_r_set_value:type unmach. [%s] arg %d (%d != %d)\n",key,index+1,fp->n[index].type,type);
 			return(GLV_ERROR);
 		}
 		/*
@@ -3093,7 +3776,7 @@ int glv_r_set_value(struct _glv_r_value **link,void *instance,char *key,char *ty
 	if(fp->func != NULL){
 		rc = (fp->func)(GLV_R_VALUE_IO_SET,fp);
 		if(rc == GLV_ERROR){
-			printf("glv_r_set_value:triger function call error return [%s].\n",key);
+			GLV_LOG_ERROR(GLV_DEBUG_API,"glv_r_set_value:triger function call error return [%s].\n",key);
 			return(GLV_ERROR);
 		}
 	}
@@ -3116,7 +3799,7 @@ int glv_r_get_value(struct _glv_r_value **link,void *instance,char *key,char *ty
 
 	int length = strlen(type_string);
 	if(length > _GLV_R_VALUE_MAX){
-		printf("glv_r_get_value:too many arguments (%d). [%s] (\"%s\"). up to %d arguments can be set.\n",length,key,type_string,_GLV_R_VALUE_MAX);
+		GLV_LOG_ERROR(GLV_DEBUG_API,"glv_r_get_value:too many arguments (%d). [%s] (\"%s\"). up to %d arguments can be set.\n",length,key,type_string,_GLV_R_VALUE_MAX);
 		length = _GLV_R_VALUE_MAX;
 	}
 
@@ -3132,23 +3815,23 @@ int glv_r_get_value(struct _glv_r_value **link,void *instance,char *key,char *ty
 		fp = fp->link;
 	}
 	if(rc == GLV_ERROR){
-		printf("glv_r_get_value:triger function call error return [%s].\n",key);
+		GLV_LOG_ERROR(GLV_DEBUG_API,"glv_r_get_value:triger function call error return [%s].\n",key);
 		return(GLV_ERROR);
 	}
 	if(fp == NULL){
-		printf("glv_r_get_value:kye[%s] not found.\n",key);
+		GLV_LOG_ERROR(GLV_DEBUG_API,"glv_r_get_value:kye[%s] not found.\n",key);
 		return(GLV_ERROR);
 	}
 	for(index=0;index<length;index++){
 		rc = glv_r_is_typeChar2typeNo(type_string[index],&type);
 		if(rc == 0){
-			printf("glv_r_get_value:type not found. [%s] arg %d (\"%c\")\n",key,index+1,type_string[index]);
+			GLV_LOG_ERROR(GLV_DEBUG_API,"glv_r_get_value:type not found. [%s] arg %d (\"%c\")\n",key,index+1,type_string[index]);
 		}
 		if(type == GLV_R_VALUE_TYPE__FUNCTION){
-			printf("glv_r_get_value:bad type. [%s] arg %d (%d != %d)\n",key,index+1,fp->n[index].type,type);
+			GLV_LOG_ERROR(GLV_DEBUG_API,"glv_r_get_value:bad type. [%s] arg %d (%d != %d)\n",key,index+1,fp->n[index].type,type);
 		}
 		if(fp->n[index].type != type){
-			printf("glv_r_get_value:type unmach. [%s] arg %d (%d != %d)\n",key,index+1,fp->n[index].type,type);
+			GLV_LOG_ERROR(GLV_DEBUG_API,"glv_r_get_value:type unmach. [%s] arg %d (%d != %d)\n",key,index+1,fp->n[index].type,type);
 			//return(GLV_ERROR);
 		}
 		/*
@@ -3234,17 +3917,17 @@ int glv_setValue(void *glv_instance,char *key,char *type_string,...)
 	int instanceType;
 
 	if(glv_instance == NULL){
-		printf("glv_setValue:instance is NULL\n");
+		GLV_LOG_ERROR(GLV_DEBUG_API,"glv_setValue:instance is NULL\n");
 		return(GLV_ERROR);
 	}
 
 	instanceType = glv_getInstanceType(glv_instance);
 	if(instanceType == 0){
-		printf("glv_setValue:bad instance\n");
+		GLV_LOG_ERROR(GLV_DEBUG_API,"glv_setValue:bad instance\n");
 		return(GLV_ERROR);
 	}
 	if(instance->resource_run == 1){
-		printf("glv_setValue:cannot call glv_setValue inside a callback function.\n");
+		GLV_LOG_ERROR(GLV_DEBUG_API,"glv_setValue:cannot call glv_setValue inside a callback function.\n");
 		return(GLV_ERROR);
 	}
 
@@ -3268,17 +3951,17 @@ int glv_getValue(void *glv_instance,char *key,char *type_string,...)
 	int instanceType;
 
 	if(glv_instance == NULL){
-		printf("glv_getValue:instance is NULL\n");
+		GLV_LOG_ERROR(GLV_DEBUG_API,"glv_getValue:instance is NULL\n");
 		return(GLV_ERROR);
 	}
 
 	instanceType = glv_getInstanceType(glv_instance);
 	if(instanceType == 0){
-		printf("glv_getValue:bad instance\n");
+		GLV_LOG_ERROR(GLV_DEBUG_API,"glv_getValue:bad instance\n");
 		return(GLV_ERROR);
 	}
 	if(instance->resource_run == 1){
-		printf("glv_getValue:cannot call glv_getValue inside a callback function.\n");
+		GLV_LOG_ERROR(GLV_DEBUG_API,"glv_getValue:cannot call glv_getValue inside a callback function.\n");
 		return(GLV_ERROR);
 	}
 	
@@ -3316,7 +3999,7 @@ int glv_r_set_abstract(struct _glv_r_value **link,void *instance,char *key,char
 			}
 		}
 		if(rc == 1){
-			printf("glv_r_set_abstract:too many arguments (%d). [%s] (\"%s\"). up to %d arguments can be set.\n",length,key,type_string,_GLV_R_VALUE_MAX);
+			GLV_LOG_ERROR(GLV_DEBUG_API,"glv_r_set_abstract:too many arguments (%d). [%s] (\"%s\"). up to %d arguments can be set.\n",length,key,type_string,_GLV_R_VALUE_MAX);
 			length = _GLV_R_VALUE_MAX;
 		}
 	}
@@ -3343,10 +4026,10 @@ int glv_r_set_abstract(struct _glv_r_value **link,void *instance,char *key,char
 	for(index=0;index<length;index++){
 		rc = glv_r_is_typeChar2typeNo(type_string[index],&type);
 		if(rc == 0){
-			printf("glv_r_set_abstract:type not found. [%s] arg %d (\"%c\")\n",key,index+1,type_string[index]);
+			GLV_LOG_ERROR(GLV_DEBUG_API,"glv_r_set_abstract:type not found. [%s] arg %d (\"%c\")\n",key,index+1,type_string[index]);
 		}
 		if((findFlag == 1) && (fp->n[index].type != GLV_R_VALUE_TYPE__NOTHING) && (fp->n[index].type != type)){
-			printf("glv_r_set_abstract:type unmach. [%s] arg %d (%d != %d)\n",key,index+1,fp->n[index].type,type);
+			GLV_LOG_ERROR(GLV_DEBUG_API,"glv_r_set_abstract:type unmach. [%s] arg %d (%d != %d)\n",key,index+1,fp->n[index].type,type);
 			return(GLV_ERROR);
 		}
 		if(fp->n[index].abstract != NULL){
@@ -3395,13 +4078,13 @@ int glv_setAbstract(void *glv_instance,char *key,char *abstract,char *type_strin
 	int instanceType;
 
 	if(glv_instance == NULL){
-		printf("glv_setAbstract:instance is NULL\n");
+		GLV_LOG_ERROR(GLV_DEBUG_API,"glv_setAbstract:instance is NULL\n");
 		return(GLV_ERROR);
 	}
 
 	instanceType = glv_getInstanceType(glv_instance);
 	if(instanceType == 0){
-		printf("glv_setAbstract:bad instance\n");
+		GLV_LOG_ERROR(GLV_DEBUG_API,"glv_setAbstract:bad instance\n");
 		return(GLV_ERROR);
 	}
 
@@ -3653,13 +4336,13 @@ void glv_printValue(void *glv_instance,char *note)
 	char	*instance_string;
 
 	if(glv_instance == NULL){
-		printf("glv_printValue:note[%s] instance is NULL\n",note);
+		GLV_LOG_ERROR(GLV_DEBUG_API,"glv_printValue:note[%s] instance is NULL\n",note);
 		return;
 	}
 
 	instanceType = glv_getInstanceType(glv_instance);
 	if(instanceType == 0){
-		printf("glv_printValue:note[%s] bad instance\n",note);
+		GLV_LOG_ERROR(GLV_DEBUG_API,"glv_printValue:note[%s] bad instance\n",note);
 		return;
 	}
 
@@ -3712,7 +4395,7 @@ int glv_allocUserData(void *glv_instance,size_t size)
 
 	instanceType = glv_getInstanceType(glv_instance);
 	if(instanceType == 0){
-		printf("glv_allocUserData:bad instance\n");
+		GLV_LOG_ERROR(GLV_DEBUG_API,"glv_allocUserData:bad instance\n");
 		return(GLV_ERROR);
 	}
 
@@ -3736,7 +4419,7 @@ void *glv_getUserData(void *glv_instance)
 
 	instanceType = glv_getInstanceType(glv_instance);
 	if(instanceType == 0){
-		printf("glv_getUserData:bad instance\n");
+		GLV_LOG_ERROR(GLV_DEBUG_API,"glv_getUserData:bad instance\n");
 		return(GLV_ERROR);
 	}
 
@@ -3783,7 +4466,7 @@ void *glv_realloc(void *ptr, size_t size)
 
 void glv_free(void *ptr)
 {
-	printf("glv_free %p\n",ptr);
+	GLV_LOG_TRACE(GLV_DEBUG_MEMORY,"glv_free %p\n",ptr);
 	free(ptr);
 }
 
@@ -64,22 +64,51 @@ extern "C" {
 #define GLV_DEBUG_IME_INPUT 	(32)
 #define GLV_DEBUG_WIGET			(64)
 #define GLV_DEBUG_DATA_DEVICE	(128)
+#define GLV_DEBUG_FONT			(256)
+#define GLV_DEBUG_MEMORY		(512)
+#define GLV_DEBUG_API			(1024)
 
-#define GLV_DEBUG_ON		(GLV_DEBUG_VERSION | GLV_DEBUG_MSG | GLV_DEBUG_INSTANCE | GLV_DEBUG_KB_INPUT | GLV_DEBUG_IME_INPUT | GLV_DEBUG_WIGET | GLV_DEBUG_DATA_DEVICE)
+#define GLV_DEBUG_ON		(GLV_DEBUG_VERSION | GLV_DEBUG_MSG | GLV_DEBUG_INSTANCE | GLV_DEBUG_KB_INPUT | GLV_DEBUG_IME_INPUT | GLV_DEBUG_WIGET | GLV_DEBUG_DATA_DEVICE | GLV_DEBUG_FONT | GLV_DEBUG_MEMORY | GLV_DEBUG_API)
 
-#define GLV_IF_DEBUG_VERSION		if(glvCheckDebugFlag(GLV_DEBUG_VERSION))
-#define GLV_IF_DEBUG_MSG			if(glvCheckDebugFlag(GLV_DEBUG_MSG))
-#define GLV_IF_DEBUG_INSTANCE		if(glvCheckDebugFlag(GLV_DEBUG_INSTANCE))
-#define GLV_IF_DEBUG_KB_INPUT		if(glvCheckDebugFlag(GLV_DEBUG_KB_INPUT))
-#define GLV_IF_DEBUG_IME_INPUT		if(glvCheckDebugFlag(GLV_DEBUG_IME_INPUT))
-#define GLV_IF_DEBUG_WIGET			if(glvCheckDebugFlag(GLV_DEBUG_WIGET))
-#define GLV_IF_DEBUG_DATA_DEVICE	if(glvCheckDebugFlag(GLV_DEBUG_DATA_DEVICE))
+#define GLV_IF_DEBUG_VERSION		if(GLV_LOG_ENABLED(GLV_LOG_LEVEL_DEBUG,GLV_DEBUG_VERSION))
+#define GLV_IF_DEBUG_MSG			if(GLV_LOG_ENABLED(GLV_LOG_LEVEL_DEBUG,GLV_DEBUG_MSG))
+#define GLV_IF_DEBUG_INSTANCE		if(GLV_LOG_ENABLED(GLV_LOG_LEVEL_DEBUG,GLV_DEBUG_INSTANCE))
+#define GLV_IF_DEBUG_KB_INPUT		if(GLV_LOG_ENABLED(GLV_LOG_LEVEL_DEBUG,GLV_DEBUG_KB_INPUT))
+#define GLV_IF_DEBUG_IME_INPUT		if(GLV_LOG_ENABLED(GLV_LOG_LEVEL_DEBUG,GLV_DEBUG_IME_INPUT))
+#define GLV_IF_DEBUG_WIGET			if(GLV_LOG_ENABLED(GLV_LOG_LEVEL_DEBUG,GLV_DEBUG_WIGET))
+#define GLV_IF_DEBUG_DATA_DEVICE	if(GLV_LOG_ENABLED(GLV_LOG_LEVEL_DEBUG,GLV_DEBUG_DATA_DEVICE))
 
 #define GLV_DEBUG_MSG_COLOR			GLV_C_RED
 #define GLV_DEBUG_INSTANCE_COLOR	GLV_C_YELLOW
 #define GLV_DEBUG_KB_INPUT_COLOR	GLV_C_GREEN
 #define GLV_DEBUG_END_COLOR			GLV_C_END
 
+// ログ (カテゴリはGLV_DEBUG_xxx)
+#define GLV_LOG_LEVEL_ERROR		(1)
+#define GLV_LOG_LEVEL_WARN		(2)
+#define GLV_LOG_LEVEL_INFO		(3)
+#define GLV_LOG_LEVEL_DEBUG		(4)
+#define GLV_LOG_LEVEL_TRACE		(5)
+#define GLV_LOG_LEVEL_NUM		(6)
+
+#define GLV_LOG_ALL				(0x7fffffff)
+
+// このレベルより詳細なログはコンパイル時に削除する(ex. -DGLV_LOG_COMPILE_LEVEL=GLV_LOG_LEVEL_WARN)
+#ifndef GLV_LOG_COMPILE_LEVEL
+#define GLV_LOG_COMPILE_LEVEL	GLV_LOG_LEVEL_DEBUG
+#endif
+
+extern unsigned int _glv_log_filter[GLV_LOG_LEVEL_NUM];
+
+#define GLV_LOG_ENABLED(level,category)	(((level) <= GLV_LOG_COMPILE_LEVEL) && __builtin_expect((_glv_log_filter[(level)] & (category)) != 0,0))
+
+#define GLV_LOG(level,category,...)		do { if(GLV_LOG_ENABLED(level,category)) glvLog_write((level),(category),__VA_ARGS__); } while(0)
+#define GLV_LOG_ERROR(category,...)		GLV_LOG(GLV_LOG_LEVEL_ERROR,category,__VA_ARGS__)
+#define GLV_LOG_WARN(category,...)		GLV_LOG(GLV_LOG_LEVEL_WARN,category,__VA_ARGS__)
+#define GLV_LOG_INFO(category,...)		GLV_LOG(GLV_LOG_LEVEL_INFO,category,__VA_ARGS__)
+#define GLV_LOG_DEBUG(category,...)		GLV_LOG(GLV_LOG_LEVEL_DEBUG,category,__VA_ARGS__)
+#define GLV_LOG_TRACE(category,...)		GLV_LOG(GLV_LOG_LEVEL_TRACE,category,__VA_ARGS__)
+
 //-------------------------------------------------------------------------------------
 
 #define GLV_TYPE_THREAD_FRAME		(1)
@@ -107,6 +136,10 @@ extern "C" {
 #define GLV_TIMER_ONLY_ONCE		PTHREAD_TIMER_ONLY_ONCE
 #define GLV_TIMER_REPEAT		PTHREAD_TIMER_REPEAT
 
+#define GLV_TIMER_MISSED_COALESCE	PTHREAD_TIMER_MISSED_COALESCE	// 逃した分を1回にまとめて通知する(既定)
+#define GLV_TIMER_MISSED_SKIP		PTHREAD_TIMER_MISSED_SKIP		// 逃した分は通知しない
+#define GLV_TIMER_MISSED_CATCHUP	PTHREAD_TIMER_MISSED_CATCHUP	// 逃した分を続けて通知する
+
 //#define GLV_GESTURE_EVENT_MOTION		(0)
 #define GLV_GESTURE_EVENT_DOWN			(1)
 #define GLV_GESTURE_EVENT_SINGLE_UP		(2)
@@ -145,6 +178,8 @@ extern "C" {
 #define GLV_WINDOW_ATTR_NON_TRANSPARENT			(1)	// ウィンドウを不透明にする
 #define GLV_WINDOW_ATTR_DISABLE_POINTER_EVENT	(2)	// ポインターイベントを受け取らない
 #define GLV_WINDOW_ATTR_POINTER_MOTION			(4)	// 左マウスボタン押下していない場合でもマウス移動位置を通知する
+#define GLV_WINDOW_ATTR_LOCKFREE_QUEUE			(8)	// メッセージキューにロックフリーキューを使う(Linuxのみ)
+#define GLV_WINDOW_ATTR_DAMAGE_SWAP				(16)	// 更新領域(damage)だけを表示に反映する(glvWindow_addDamage)
 
 #define GLV_WIGET_ATTR_NO_OPTIONS		(0)
 #define GLV_WIGET_ATTR_PUSH_ACTION		(1)		// 左マウスボタン押下を通知する
@@ -202,6 +237,21 @@ typedef struct glv_wiget_geometry_t {
 	glvInstanceId		windowId;	// get only
 } GLV_WIGET_GEOMETRY_t;
 
+typedef struct glv_rect_t {
+	int			x;
+	int			y;
+	int			width;
+	int			height;
+} GLV_RECT_t;
+
+#define GLV_DAMAGE_RECT_MAX		(16)	// 保持する更新領域の最大数(超えた場合は外接矩形にまとめる)
+
+typedef struct glv_damage_t {
+	int			full;		// 1:ウィンドウ全体
+	int			num;		// rectの数
+	GLV_RECT_t	rect[GLV_DAMAGE_RECT_MAX];	// ウィンドウ座標(左上原点)
+} GLV_DAMAGE_t;
+
 typedef struct glv_wiget_status_t {
 	glvInstanceId		focusId;
 	glvInstanceId		selectId;
@@ -464,6 +514,11 @@ void	glvGetVersion(int *major,int *minor,int *patch);
 void	glvSetDebugFlag(int flag);
 int		glvCheckDebugFlag(int flag);
 
+void	glvLog_write(int level,unsigned int category,const char *fmt,...) __attribute__((format(printf,3,4)));
+void	glvLog_flush(void);
+void	glvLog_setLevel(unsigned int category,int level);
+int		glvLog_setFilter(const char *spec);
+
 glvResource glvCreateResource(void);
 void glvDestroyResource(glvResource res);
 
@@ -473,6 +528,24 @@ int			glvCloseDisplay(glvDisplay glv_dpy);
 void glvEnterEventLoop(glvDisplay glv_dpy);
 void glvEscapeEventLoop(void *glv_instance);
 
+// headlessバックエンド (glvOpenDisplay(GLV_HEADLESS_DISPLAY_NAME) または 環境変数GLVIEW_BACKEND=headless)
+#define GLV_HEADLESS_DISPLAY_NAME	"headless"
+int glvDisplay_isHeadless(glvDisplay glv_dpy);
+int glvHeadless_configure(glvWindow glv_frame,int width,int height);
+int glvHeadless_pointerEnter(glvWindow glv_win,int x,int y);
+int glvHeadless_pointerLeave(glvDisplay glv_dpy);
+int glvHeadless_pointerMotion(glvDisplay glv_dpy,int x,int y);
+int glvHeadless_pointerButton(glvDisplay glv_dpy,uint32_t button,int state);
+int glvHeadless_pointerAxis(glvDisplay glv_dpy,int axis,int value);
+int glvHeadless_keyboardModifiers(glvDisplay glv_dpy,uint32_t mods_depressed,uint32_t mods_latched,uint32_t mods_locked,uint32_t group);
+int glvHeadless_keyboardKey(glvDisplay glv_dpy,uint32_t key,int state);
+
+// トレース (chrome://tracing, Perfetto UIで表示できるJSONを出力する)
+// 環境変数GLVIEW_TRACE=<file>を指定した場合はglvOpenDisplayからglvCloseDisplayまでを記録する
+int glvTrace_start(void);
+int glvTrace_stop(void);
+int glvTrace_dump(const char *path);
+
 glvWindow glvCreateFrameWindow(void *glv_instance,const struct glv_frame_listener *listener,char *name,char *title,int width, int height,glvInstanceId *id);
 glvWindow glvCreateWindow(glvWindow parent,const struct glv_window_listener *listener,char *name,int x, int y, int width, int height,int attr,glvInstanceId *id);
 glvWindow glvCreateThreadWindow(glvWindow parent,const struct glv_window_listener *listener,char *name,int x, int y, int width, int height,int attr,glvInstanceId *id);
@@ -485,6 +558,10 @@ int glvWindow_isAliveWindow(void *glv_instance,glvInstanceId windowId);
 glvTime glvWindow_getLastTime(glvWindow glv_win);
 char *glvWindow_getWindowName(glvWindow glv_win);
 int glvReqSwapBuffers(glvWindow glv_win);
+int glvWindow_addDamage(glvWindow glv_win,int x,int y,int width,int height);
+int glvWindow_addDamageFull(glvWindow glv_win);
+int glvWindow_getDamage(glvWindow glv_win,GLV_DAMAGE_t *damage);
+int glvWindow_getRepaintDamage(glvWindow glv_win,GLV_DAMAGE_t *damage);
 
 int glvWindow_setTitle(glvWindow glv_win,const char *title);
 int glvWindow_setInnerSize(glvWindow glv_win,int width, int height);
@@ -494,11 +571,17 @@ int glvOnUpdate(glvWindow glv_win);
 int glvOnGesture(glvWindow glv_win,int eventType,int x,int y,int distance_x,int distance_y,int velocity_x,int velocity_y);
 int glvOnAction(void *glv_instance,int action,glvInstanceId selectId);
 int glvOnUserMsg(glvWindow glv_win,int kind,void *data,size_t size);
+// コピー無しのユーザーメッセージ(glvUserMsg_allocで確保した領域に書き込み、glvUserMsg_sendで所有権ごと送信する)
+void *glvUserMsg_alloc(glvWindow glv_win,size_t size);
+int glvUserMsg_send(glvWindow glv_win,int kind,void *data);
+void glvUserMsg_free(void *data);
 
 int glvCreate_mTimer(glvWindow glv_win,int group,int id,int type,int mTime);
 int glvCreate_uTimer(glvWindow glv_win,int group,int id,int type,int64_t tv_sec,int64_t tv_nsec);
 int glvStartTimer(glvWindow glv_win,int id);
 int glvStopTimer(glvWindow glv_win,int id);
+int glvSetTimerMissedPolicy(glvWindow glv_win,int id,int policy);
+int glvWindow_getTimerMissedCount(glvWindow glv_win);
 
 void glvSheet_setHandler_init(glvSheet sheet,GLV_SHEET_EVENT_FUNC_init_t init);
 void glvSheet_setHandler_reshape(glvSheet sheet,GLV_SHEET_EVENT_FUNC_reshape_t reshape);
@@ -534,6 +617,8 @@ int glvWiget_setIMECandidatePotition(glvWiget wiget,int candidate_pos_x,int cand
 
 int glvSheet_reqSwapBuffers(glvSheet sheet);
 int glvSheet_reqDrawWigets(glvSheet sheet);
+int glvWiget_reqDraw(glvWiget wiget);
+int glvWiget_setPaintMargin(glvWiget wiget,int margin);
 int glvSheet_getSelectWigetStatus(glvSheet sheet,GLV_WIGET_STATUS_t *wigetStatus);
 int glvWiget_kindSelectWigetStatus(glvWiget wiget,GLV_WIGET_STATUS_t *wigetStatus);
 
@@ -38,6 +38,16 @@
 // 現時点では、対策しない。
 #define TEST_2021_05_09_002
 
+// グリフアトラス
+// ラスタライズ済みのグリフを長寿命のテクスチャに詰め込んで再利用する。
+// 無効にすると、描画毎に文字列全体のテクスチャを生成する従来の処理となる。
+#define GLV_FONT_USE_GLYPH_ATLAS
+
+// テキストランキャッシュ(GLV_FONT_USE_GLYPH_ATLAS 必須)
+// glvFont_DrawUTF8Stringでレイアウト済みの文字列(改行位置,頂点)を再利用する。
+#ifdef GLV_FONT_USE_GLYPH_ATLAS
+#define GLV_FONT_USE_RUN_CACHE
+#endif
 
 #define GLV_GL_PRINTF_FONT_SIZE	(18)
 
@@ -69,6 +79,145 @@ typedef struct _FONT_INFO {
 	int			lineBreak;		// 改行指定
 } T_FONT_INFO;
 
+// グリフアトラス
+#define GLV_FONT_ATLAS_PAGE_SIZE	(512)		// テクスチャサイズ(幅,高さ)
+#define GLV_FONT_ATLAS_PAGE_MAX		(4)			// テクスチャ数
+#define GLV_FONT_ATLAS_GLYPH_MAX	(2048)		// 登録グリフ数
+#define GLV_FONT_ATLAS_HASH_SIZE	(1024)		// ハッシュテーブルサイズ(2のべき乗)
+#define GLV_FONT_ATLAS_PADDING		(1)			// グリフ間の余白
+
+// テキストランキャッシュ
+#define GLV_FONT_RUN_HASH_SIZE		(256)			// ハッシュテーブルサイズ(2のべき乗)
+#define GLV_FONT_RUN_CACHE_MAX		(512)			// 登録ラン数
+#define GLV_FONT_RUN_CACHE_SIZE		(512*1024)		// 登録ランの合計メモリサイズ(byte)
+
+// フォントレジストリ
+#define GLV_FONT_SHARED_HASH_SIZE	(1024)		// 共有グリフハッシュテーブルサイズ(2のべき乗)
+#define GLV_FONT_SHARED_GLYPH_MAX	(4096)		// フェイス毎の共有グリフ数
+
+// 共有グリフ(メトリクス + 濃度ビットマップ)
+typedef struct _SHARED_GLYPH {
+	struct _SHARED_GLYPH	*next;		// 同一ハッシュの次のグリフ
+	uint32_t	lastUse;
+	int			codepoint;
+	int16_t		size;
+	int16_t		mono;
+	int16_t		width;
+	int16_t		height;
+	int16_t		left;
+	int16_t		top;				// ベースライン補正済み
+	int16_t		advance;
+	uint8_t		*coverage;			// width * height (0..255)
+} T_SHARED_GLYPH;
+
+// 共有フォントフェイス
+// 全スレッドで1つのFT_Faceを共有する。FT_Faceの操作はmutexで排他する。
+typedef struct _FONT_FACE {
+	struct _FONT_FACE	*next;
+	char				*path;
+	int					refCount;
+	FT_Face				face;
+	int					faceSize;		// FT_Set_Pixel_Sizes設定済みサイズ
+	pthread_mutex_t		mutex;
+	uint32_t			clock;
+	int					glyphNum;
+	T_SHARED_GLYPH		*hash[GLV_FONT_SHARED_HASH_SIZE];
+} T_FONT_FACE;
+
+// アトラス登録グリフ
+typedef struct _ATLAS_GLYPH {
+	int			used;			// 1:使用中
+	int			hashNext;		// 同一ハッシュの次のグリフ(index+1 , 0:終端)
+	uint32_t	lastUse;		// 最終使用スタンプ
+	int			codepoint;		// キー:文字コード(UTF32)
+	int16_t		fontKey;		// キー:フォント番号 | (モノクロ << 8)
+	int16_t		size;			// キー:ピクセルサイズ
+	int16_t		page;			// 格納テクスチャ(-1:描画ピクセル無し)
+	int16_t		tx;				// テクスチャ内位置
+	int16_t		ty;
+	int16_t		width;			// ビットマップサイズ
+	int16_t		height;
+	int16_t		left;			// 描画位置オフセット(ベースライン補正済み)
+	int16_t		top;
+	int16_t		advance;		// 送り幅
+} T_ATLAS_GLYPH;
+
+// アトラステクスチャ
+typedef struct _ATLAS_PAGE {
+	uint32_t	textureId;
+	int			shelfX;			// 現在の棚の空き位置
+	int			shelfY;			// 現在の棚の位置
+	int			shelfHeight;	// 現在の棚の高さ
+	int			glyphNum;		// 格納グリフ数
+	uint32_t	lastUse;		// 最終使用スタンプ
+} T_ATLAS_PAGE;
+
+// グリフアトラス(スレッド=EGLコンテキスト毎)
+typedef struct _GLYPH_ATLAS {
+	T_ATLAS_PAGE	page[GLV_FONT_ATLAS_PAGE_MAX];
+	T_ATLAS_GLYPH	glyph[GLV_FONT_ATLAS_GLYPH_MAX];
+	int				hash[GLV_FONT_ATLAS_HASH_SIZE];	// 先頭グリフ(index+1 , 0:無し)
+	int				glyphNum;
+	uint32_t		stamp;			// 文字列描画毎に更新
+	uint32_t		generation;		// グリフを破棄する毎に更新(テキストランの有効性確認)
+	// 作業バッファ
+	int				workSize;
+	int				*workGlyph;		// 文字毎のグリフindex
+	int				*workX;			// 文字毎の描画位置
+	GLV_T_POINT_t	*workPos;
+	GLV_T_POINT_t	*workCoord;
+	GLV_T_Color_t	*workColor;
+	uint8_t			*workBitmap;
+	int				workBitmapSize;
+	GLV_FONT_ATLAS_STAT_t	stat;
+} T_GLYPH_ATLAS;
+
+// テキストラン 行情報
+typedef struct _TEXT_RUN_LINE {
+	int			strWidth;
+	int			strHeight;
+	int			lineBreak;							// 1:改行で終わる行
+	int			first[GLV_FONT_ATLAS_PAGE_MAX];		// テクスチャ毎の頂点範囲
+	int			count[GLV_FONT_ATLAS_PAGE_MAX];
+} T_TEXT_RUN_LINE;
+
+// テキストラン(レイアウト済み文字列)
+typedef struct _TEXT_RUN {
+	struct _TEXT_RUN	*hashNext;
+	struct _TEXT_RUN	*lruPrev;
+	struct _TEXT_RUN	*lruNext;
+	// キー
+	unsigned int	hash;
+	char			*utf8;
+	int				utf8Length;
+	int				fontNum;
+	int				size;
+	int				mono;
+	int				center;
+	int				baseHeight;
+	unsigned int	gColor;
+	unsigned int	gBkgdColor;
+	// レイアウト
+	uint32_t		generation;		// 作成時のアトラス世代
+	int				lineNum;
+	T_TEXT_RUN_LINE	*line;
+	int				vertexNum;
+	GLV_T_POINT_t	*pos;
+	GLV_T_POINT_t	*coord;
+	GLV_T_Color_t	*color;
+	int				memSize;
+} T_TEXT_RUN;
+
+// テキストランキャッシュ(スレッド毎)
+typedef struct _TEXT_RUN_CACHE {
+	T_TEXT_RUN		*hash[GLV_FONT_RUN_HASH_SIZE];
+	T_TEXT_RUN		*lruHead;		// 最近使用
+	T_TEXT_RUN		*lruTail;		// 最も古い
+	int				runNum;
+	int				memSize;
+	GLV_FONT_RUN_STAT_t	stat;
+} T_TEXT_RUN_CACHE;
+
 // =============================================================================
 // thread safe buffer 確保処理
 // 
@@ -80,8 +229,9 @@ typedef struct _FONT_INFO {
 typedef struct _thread_safe_buffer{
 	// 確保する領域を下記に記述してください
 	int				initFlag;
-	FT_Library		library;
-	FT_Face			face[GLV_FONT_NAME_MAX];
+	T_FONT_FACE		*face[GLV_FONT_NAME_MAX];		// フォントレジストリから借用
+	T_GLYPH_ATLAS	*atlas;
+	T_TEXT_RUN_CACHE	*runCache;
 	//
 	unsigned int	gColor;
 	unsigned int	gOutLineColor;
@@ -102,6 +252,236 @@ typedef struct _thread_safe_buffer{
 #define FONT_PATH_SIZE		(256)
 static char font_path[FONT_PATH_SIZE]={};
 
+// =============================================================================
+// フォントレジストリ
+//   フォントファイル毎にFT_Faceをプロセスで1つだけ開き、参照カウントで管理する。
+//   ウィンドウスレッドはフェイスを借用し、ラスタライズ結果(メトリクス,濃度)も共有する。
+// =============================================================================
+static pthread_mutex_t	font_registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+static FT_Library		font_registry_library;
+static int				font_registry_initFlag = 0;
+static T_FONT_FACE		*font_registry_list = NULL;
+
+static T_FONT_FACE *glvFont_acquireFace(char *fontPath)
+{
+	T_FONT_FACE *fontFace;
+	FT_Error err;
+
+	pthread_mutex_lock(&font_registry_mutex);
+
+	for(fontFace=font_registry_list;fontFace!=NULL;fontFace=fontFace->next){
+		if(strcmp(fontFace->path,fontPath) == 0){
+			fontFace->refCount++;
+			pthread_mutex_unlock(&font_registry_mutex);
+			return(fontFace);
+		}
+	}
+
+	if(font_registry_initFlag == 0){
+		err = FT_Init_FreeType(&font_registry_library);
+		if (err) {
+			GLV_LOG_ERROR(GLV_DEBUG_FONT,"glv_createBitmapFont:FT_Init_FreeType error\n");
+			pthread_mutex_unlock(&font_registry_mutex);
+			return(NULL);
+		}
+		font_registry_initFlag = 1;
+	}
+
+	fontFace = (T_FONT_FACE*)calloc(1,sizeof(T_FONT_FACE));
+	if(fontFace == NULL){
+		pthread_mutex_unlock(&font_registry_mutex);
+		return(NULL);
+	}
+	// FT_New_Face,FT_Done_Faceはライブラリ単位で排他が必要
+	err = FT_New_Face(font_registry_library, fontPath, 0, &fontFace->face);
+	if (err) {
+		GLV_LOG_ERROR(GLV_DEBUG_FONT,"glv_createBitmapFont:FT_New_Face error\n");
+		free(fontFace);
+		pthread_mutex_unlock(&font_registry_mutex);
+		return(NULL);
+	}
+	fontFace->path = strdup(fontPath);
+	fontFace->refCount = 1;
+	pthread_mutex_init(&fontFace->mutex,NULL);
+
+	fontFace->next = font_registry_list;
+	font_registry_list = fontFace;
+
+	pthread_mutex_unlock(&font_registry_mutex);
+	return(fontFace);
+}
+
+static void glvFont_releaseFace(T_FONT_FACE *fontFace)
+{
+	T_FONT_FACE **link;
+	T_SHARED_GLYPH *sg,*next;
+	int i;
+
+	pthread_mutex_lock(&font_registry_mutex);
+
+	if(--fontFace->refCount > 0){
+		pthread_mutex_unlock(&font_registry_mutex);
+		return;
+	}
+	for(link=&font_registry_list;*link!=NULL;link=&(*link)->next){
+		if(*link == fontFace){
+			*link = fontFace->next;
+			break;
+		}
+	}
+	FT_Done_Face(fontFace->face);
+	if(font_registry_list == NULL){
+		FT_Done_FreeType(font_registry_library);
+		font_registry_initFlag = 0;
+	}
+
+	pthread_mutex_unlock(&font_registry_mutex);
+
+	for(i=0;i<GLV_FONT_SHARED_HASH_SIZE;i++){
+		for(sg=fontFace->hash[i];sg!=NULL;sg=next){
+			next = sg->next;
+			free(sg->coverage);
+			free(sg);
+		}
+	}
+	pthread_mutex_destroy(&fontFace->mutex);
+	free(fontFace->path);
+	free(fontFace);
+}
+
+// fontFace->mutexをロックして呼び出すこと
+static void glvFont_setPixelSize(T_FONT_FACE *fontFace,int size)
+{
+	FT_Error err;
+
+	if(fontFace->faceSize == size){
+		return;
+	}
+	err = FT_Set_Pixel_Sizes(fontFace->face, size, size);
+	if (err) { GLV_LOG_ERROR(GLV_DEBUG_FONT,"glv_createBitmapFont:FT_Set_Pixel_Sizes\n"); }
+	fontFace->faceSize = size;
+}
+
+static unsigned int glvFont_sharedHash(int mono,int size,int codepoint)
+{
+	unsigned int h;
+	h = (unsigned int)codepoint * 2654435761u;
+	h ^= ((unsigned int)size << 16) ^ ((unsigned int)mono << 8);
+	return(h & (GLV_FONT_SHARED_HASH_SIZE - 1));
+}
+
+// 最も長く使われていない共有グリフを捨てる
+static void glvFont_sharedEvict(T_FONT_FACE *fontFace)
+{
+	T_SHARED_GLYPH **link,**victim=NULL;
+	int i;
+
+	for(i=0;i<GLV_FONT_SHARED_HASH_SIZE;i++){
+		for(link=&fontFace->hash[i];*link!=NULL;link=&(*link)->next){
+			if((victim == NULL) || ((*link)->lastUse < (*victim)->lastUse)){
+				victim = link;
+			}
+		}
+	}
+	if(victim != NULL){
+		T_SHARED_GLYPH *sg = *victim;
+		*victim = sg->next;
+		free(sg->coverage);
+		free(sg);
+		fontFace->glyphNum--;
+	}
+}
+
+/**
+ * @brief		共有グリフの取得(未登録ならラスタライズして登録する)
+ * 				fontFace->mutexをロックして呼び出すこと
+ * 				戻り値は、ロックを解放するまで有効
+ * @param[out]	shared 1:他スレッドのラスタライズ結果を使用した
+ */
+static T_SHARED_GLYPH *glvFont_sharedGlyph(T_FONT_FACE *fontFace,int mono,int size,int codepoint,int *shared)
+{
+	FT_Face face = fontFace->face;
+	FT_GlyphSlot g;
+	FT_Bitmap *bm;
+	FT_Error err;
+	T_SHARED_GLYPH *sg;
+	unsigned int h;
+	int baseline,row,col;
+
+	h = glvFont_sharedHash(mono,size,codepoint);
+	for(sg=fontFace->hash[h];sg!=NULL;sg=sg->next){
+		if((sg->codepoint == codepoint) && (sg->size == size) && (sg->mono == mono)){
+			sg->lastUse = ++fontFace->clock;
+			*shared = 1;
+			return(sg);
+		}
+	}
+	*shared = 0;
+
+	glvFont_setPixelSize(fontFace,size);
+
+	err = FT_Load_Char(face, codepoint, 0);
+	if (err) { GLV_LOG_ERROR(GLV_DEBUG_FONT,"glv_createBitmapFont:FT_Load_Char\n"); return(NULL); }
+	err = FT_Render_Glyph(face->glyph, (mono != 0)?(FT_RENDER_MODE_MONO):(FT_RENDER_MODE_NORMAL));
+	if (err) { GLV_LOG_ERROR(GLV_DEBUG_FONT,"glv_createBitmapFont:FT_Render_Glyph error\n"); return(NULL); }
+
+	g  = face->glyph;
+	bm = &g->bitmap;
+
+	if(fontFace->glyphNum >= GLV_FONT_SHARED_GLYPH_MAX){
+		glvFont_sharedEvict(fontFace);
+	}
+	sg = (T_SHARED_GLYPH*)calloc(1,sizeof(T_SHARED_GLYPH));
+	if(sg == NULL){
+		return(NULL);
+	}
+	if((bm->width > 0) && (bm->rows > 0)){
+		sg->coverage = (uint8_t*)malloc(bm->width * bm->rows);
+		if(sg->coverage == NULL){
+			free(sg);
+			return(NULL);
+		}
+		for (row = 0; row < (int)bm->rows; row ++) {
+			for (col = 0; col < (int)bm->width; col ++) {
+				if(mono != 0){
+					sg->coverage[bm->width * row + col] = ((bm->buffer[bm->pitch * row + (col >> 3)] >> (7 - (col & 7))) & 1)?(0xff):(0x00);
+				}else{
+					sg->coverage[bm->width * row + col] = bm->buffer[bm->pitch * row + col];
+				}
+			}
+		}
+		sg->width  = bm->width;
+		sg->height = bm->rows;
+	}
+
+	// glvFont_createBitmapFontと同じ基準で配置する
+	if(mono != 0){
+		baseline = (face->height + face->descender) * (double)face->size->metrics.y_ppem / (double)face->units_per_EM;
+	}else{
+		baseline = (face->height + face->descender) * face->size->metrics.y_ppem / face->units_per_EM;
+		baseline += 1;
+	}
+	if(g->advance.x == 0){
+		sg->advance = (g->bitmap_left + bm->width);
+		if((g->bitmap_left + bm->width) == 0){
+			// draw space
+			sg->advance += (size*0.3);	// 見た目で設定
+		}
+	}else{
+		sg->advance = (g->advance.x >> 6);
+	}
+	sg->codepoint	= codepoint;
+	sg->size		= size;
+	sg->mono		= mono;
+	sg->left		= g->bitmap_left;
+	sg->top			= baseline - g->bitmap_top;
+	sg->lastUse		= ++fontFace->clock;
+	sg->next		= fontFace->hash[h];
+	fontFace->hash[h] = sg;
+	fontFace->glyphNum++;
+	return(sg);
+}
+
 void glvFont_thread_safe_init(void)
 {
 	THREAD_SAFE_BUFFER_t	*font_draw_info;
@@ -124,6 +504,43 @@ void glvFont_thread_safe_init(void)
 	glvFont_LoadFont(GLV_FONT_NAME_TYPE1 ,file_path);
 }
 
+void glvFont_thread_safe_finish(void)
+{
+	THREAD_SAFE_BUFFER_t	*font_draw_info = get_thread_safe_buffer();
+	T_GLYPH_ATLAS			*atlas;
+	int i;
+
+	if(font_draw_info == NULL){
+		return;
+	}
+	glvFont_clearRunCache();
+	free(font_draw_info->runCache);
+	font_draw_info->runCache = NULL;
+	atlas = font_draw_info->atlas;
+	if(atlas != NULL){
+		for(i=0;i<GLV_FONT_ATLAS_PAGE_MAX;i++){
+			if(atlas->page[i].textureId != 0){
+				glvGl_DeleteTextures(&atlas->page[i].textureId);
+			}
+		}
+		free(atlas->workGlyph);
+		free(atlas->workX);
+		free(atlas->workPos);
+		free(atlas->workCoord);
+		free(atlas->workColor);
+		free(atlas->workBitmap);
+		free(atlas);
+		font_draw_info->atlas = NULL;
+	}
+	for(i=0;i<GLV_FONT_NAME_MAX;i++){
+		if(font_draw_info->face[i] != NULL){
+			glvFont_releaseFace(font_draw_info->face[i]);
+			font_draw_info->face[i] = NULL;
+		}
+	}
+	font_draw_info->initFlag = 0;
+}
+
 void glvFont_setDefaultFontPath(char *path)
 {
 	strcat(font_path,path);
@@ -262,32 +679,27 @@ void glvFont_DefaultStyle(void)
 int glvFont_LoadFont(int font,char *fontPath)
 {
 	THREAD_SAFE_BUFFER_t	*font_draw_info = get_thread_safe_buffer();
-	FT_Face face;
-	FT_Error err;
+	T_FONT_FACE *fontFace;
 
 	if(font >= GLV_FONT_NAME_MAX){
 		return(GLV_ERROR);
 	}
-	if(font_draw_info->initFlag == 0){
-		err = FT_Init_FreeType(&font_draw_info->library);
-		if (err) {printf("glv_createBitmapFont:FT_Init_FreeType error\n"); }
-		font_draw_info->initFlag = 1;
-	}
+
+	// 同じフォントファイルは、他のスレッドで開いたフェイスを借用する
+	fontFace = glvFont_acquireFace(fontPath);
 
 	if(font_draw_info->face[font] != NULL){
-		FT_Done_Face(font_draw_info->face[font]);
+		glvFont_releaseFace(font_draw_info->face[font]);
 		font_draw_info->face[font] = NULL;
 	}
+	// 差し替え前のフォントのグリフを破棄
+	glvFont_clearAtlas();
 
-	err = FT_New_Face(font_draw_info->library, fontPath, 0, &face);
-
-	if (err) { printf("glv_createBitmapFont:FT_New_Face error\n"); }
-	if(err){
-		font_draw_info->face[font] = NULL;
+	if(fontFace == NULL){
 		return(GLV_ERROR);
 	}
-
-	font_draw_info->face[font] = face;
+	font_draw_info->initFlag = 1;
+	font_draw_info->face[font] = fontFace;
 	return(GLV_OK);
 }
 
@@ -480,6 +892,890 @@ int glvFont_utf32_to_string(int *utf32_string,int str_size,char *str,int max_cha
 	return(n);
 }
 
+// =============================================================================
+// グリフアトラス
+//   キー(フォント,ピクセルサイズ,文字コード)毎にラスタライズ結果をテクスチャへ格納し、
+//   文字列はアトラスを参照する四角形の集合として描画する。
+//   グリフの置き換えは、最後に使われてから最も時間の経ったもの(LRU)から行う。
+// =============================================================================
+static unsigned int glvFont_atlasHash(int fontKey,int size,int codepoint)
+{
+	unsigned int h;
+	h = (unsigned int)codepoint * 2654435761u;
+	h ^= ((unsigned int)size << 16) ^ ((unsigned int)fontKey << 8);
+	return(h & (GLV_FONT_ATLAS_HASH_SIZE - 1));
+}
+
+static int glvFont_atlasLookup(T_GLYPH_ATLAS *atlas,int fontKey,int size,int codepoint)
+{
+	T_ATLAS_GLYPH *g;
+	int index;
+
+	index = atlas->hash[glvFont_atlasHash(fontKey,size,codepoint)];
+	while(index != 0){
+		g = &atlas->glyph[index-1];
+		if((g->codepoint == codepoint) && (g->size == size) && (g->fontKey == fontKey)){
+			return(index-1);
+		}
+		index = g->hashNext;
+	}
+	return(-1);
+}
+
+static void glvFont_atlasRemoveGlyph(T_GLYPH_ATLAS *atlas,int index)
+{
+	T_ATLAS_GLYPH *g = &atlas->glyph[index];
+	int *link;
+
+	link = &atlas->hash[glvFont_atlasHash(g->fontKey,g->size,g->codepoint)];
+	while(*link != 0){
+		if(*link == (index+1)){
+			*link = g->hashNext;
+			break;
+		}
+		link = &atlas->glyph[*link-1].hashNext;
+	}
+	if(g->page >= 0){
+		atlas->page[g->page].glyphNum--;
+	}
+	memset(g,0,sizeof(T_ATLAS_GLYPH));
+	atlas->glyphNum--;
+	atlas->generation++;
+}
+
+static void glvFont_atlasResetPage(T_GLYPH_ATLAS *atlas,int page)
+{
+	int i;
+	for(i=0;i<GLV_FONT_ATLAS_GLYPH_MAX;i++){
+		if((atlas->glyph[i].used != 0) && (atlas->glyph[i].page == page)){
+			glvFont_atlasRemoveGlyph(atlas,i);
+			atlas->stat.evictGlyph++;
+		}
+	}
+	atlas->page[page].shelfX = 0;
+	atlas->page[page].shelfY = 0;
+	atlas->page[page].shelfHeight = 0;
+	atlas->page[page].glyphNum = 0;
+	atlas->stat.evictPage++;
+}
+
+static int glvFont_atlasPlace(T_ATLAS_PAGE *page,int width,int height,int *x,int *y)
+{
+	int shelfX = page->shelfX;
+	int shelfY = page->shelfY;
+	int shelfHeight = page->shelfHeight;
+
+	if(shelfX + width > GLV_FONT_ATLAS_PAGE_SIZE){
+		// 次の棚へ
+		shelfY += shelfHeight;
+		shelfX = 0;
+		shelfHeight = 0;
+	}
+	if((width > GLV_FONT_ATLAS_PAGE_SIZE) || (shelfY + height > GLV_FONT_ATLAS_PAGE_SIZE)){
+		return(GLV_ERROR);
+	}
+	*x = shelfX;
+	*y = shelfY;
+	page->shelfX = shelfX + width;
+	page->shelfY = shelfY;
+	page->shelfHeight = (shelfHeight >= height)?(shelfHeight):(height);
+	return(GLV_OK);
+}
+
+static int glvFont_atlasAllocRect(T_GLYPH_ATLAS *atlas,int width,int height,int *x,int *y)
+{
+	int i,victim=-1;
+	uint8_t *clear;
+
+	for(i=0;i<GLV_FONT_ATLAS_PAGE_MAX;i++){
+		if(atlas->page[i].textureId == 0){
+			continue;
+		}
+		if(glvFont_atlasPlace(&atlas->page[i],width,height,x,y) == GLV_OK){
+			return(i);
+		}
+	}
+	// 未使用のテクスチャを生成
+	for(i=0;i<GLV_FONT_ATLAS_PAGE_MAX;i++){
+		if(atlas->page[i].textureId == 0){
+			clear = (uint8_t*)calloc(GLV_FONT_ATLAS_PAGE_SIZE*GLV_FONT_ATLAS_PAGE_SIZE,4);
+			if(clear == NULL){
+				return(-1);
+			}
+			atlas->page[i].textureId = glvGl_GenTextures(clear,GLV_FONT_ATLAS_PAGE_SIZE,GLV_FONT_ATLAS_PAGE_SIZE);
+			free(clear);
+			if(atlas->page[i].textureId == 0){
+				return(-1);
+			}
+			if(glvFont_atlasPlace(&atlas->page[i],width,height,x,y) == GLV_OK){
+				return(i);
+			}
+			return(-1);
+		}
+	}
+	// 描画中の文字列で使用していない最も古いテクスチャを空ける
+	for(i=0;i<GLV_FONT_ATLAS_PAGE_MAX;i++){
+		if(atlas->page[i].lastUse == atlas->stamp){
+			continue;
+		}
+		if((victim < 0) || (atlas->page[i].lastUse < atlas->page[victim].lastUse)){
+			victim = i;
+		}
+	}
+	if(victim < 0){
+		return(-1);
+	}
+	glvFont_atlasResetPage(atlas,victim);
+	if(glvFont_atlasPlace(&atlas->page[victim],width,height,x,y) == GLV_OK){
+		return(victim);
+	}
+	return(-1);
+}
+
+static int glvFont_atlasAllocGlyph(T_GLYPH_ATLAS *atlas)
+{
+	int i,victim=-1;
+
+	if(atlas->glyphNum < GLV_FONT_ATLAS_GLYPH_MAX){
+		for(i=0;i<GLV_FONT_ATLAS_GLYPH_MAX;i++){
+			if(atlas->glyph[i].used == 0){
+				return(i);
+			}
+		}
+	}
+	// 描画中の文字列で使用していない最も古いグリフを捨てる
+	for(i=0;i<GLV_FONT_ATLAS_GLYPH_MAX;i++){
+		if(atlas->glyph[i].lastUse == atlas->stamp){
+			continue;
+		}
+		if((victim < 0) || (atlas->glyph[i].lastUse < atlas->glyph[victim].lastUse)){
+			victim = i;
+		}
+	}
+	if(victim < 0){
+		return(-1);
+	}
+	glvFont_atlasRemoveGlyph(atlas,victim);
+	atlas->stat.evictGlyph++;
+	return(victim);
+}
+
+static int glvFont_atlasInsert(THREAD_SAFE_BUFFER_t *font_draw_info,int fontNum,int mono,int size,int codepoint)
+{
+	T_GLYPH_ATLAS *atlas = font_draw_info->atlas;
+	T_FONT_FACE *fontFace = font_draw_info->face[fontNum];
+	T_SHARED_GLYPH *sg;
+	T_ATLAS_GLYPH *glyph;
+	T_ATLAS_GLYPH metrics;
+	int i,n,page=-1,x=0,y=0,index,shared;
+	uint8_t *out;
+
+	pthread_mutex_lock(&fontFace->mutex);
+
+	sg = glvFont_sharedGlyph(fontFace,mono,size,codepoint,&shared);
+	if(sg == NULL){
+		pthread_mutex_unlock(&fontFace->mutex);
+		return(-1);
+	}
+	if(shared != 0){
+		atlas->stat.sharedHit++;
+	}
+	metrics.width	= sg->width;
+	metrics.height	= sg->height;
+	metrics.left	= sg->left;
+	metrics.top		= sg->top;
+	metrics.advance	= sg->advance;
+
+	n = sg->width * sg->height;
+	if(n > 0){
+		if(atlas->workBitmapSize < (n * 4)){
+			free(atlas->workBitmap);
+			atlas->workBitmapSize = n * 4;
+			atlas->workBitmap = (uint8_t*)malloc(atlas->workBitmapSize);
+			if(atlas->workBitmap == NULL){
+				atlas->workBitmapSize = 0;
+				pthread_mutex_unlock(&fontFace->mutex);
+				return(-1);
+			}
+		}
+		// 白 + 濃度(アルファ)で格納し、描画時に文字色を乗算する
+		out = atlas->workBitmap;
+		for(i=0;i<n;i++){
+			out[0] = 0xff;
+			out[1] = 0xff;
+			out[2] = 0xff;
+			out[3] = sg->coverage[i];
+			out += 4;
+		}
+	}
+
+	pthread_mutex_unlock(&fontFace->mutex);
+
+	// 棚の領域は戻せないので、グリフの登録先を先に確保してから領域を確保する
+	index = glvFont_atlasAllocGlyph(atlas);
+	if(index < 0){
+		return(-1);
+	}
+	if(n > 0){
+		page = glvFont_atlasAllocRect(atlas,metrics.width + GLV_FONT_ATLAS_PADDING,metrics.height + GLV_FONT_ATLAS_PADDING,&x,&y);
+		if(page < 0){
+			return(-1);
+		}
+		glvGl_TexSubImage(atlas->page[page].textureId,x,y,metrics.width,metrics.height,atlas->workBitmap);
+	}
+
+	glyph = &atlas->glyph[index];
+	glyph->used			= 1;
+	glyph->codepoint	= codepoint;
+	glyph->fontKey		= fontNum | (mono << 8);
+	glyph->size			= size;
+	glyph->page			= page;
+	glyph->tx			= x;
+	glyph->ty			= y;
+	glyph->width		= (page >= 0)?(metrics.width):(0);
+	glyph->height		= (page >= 0)?(metrics.height):(0);
+	glyph->left			= metrics.left;
+	glyph->top			= metrics.top;
+	glyph->advance		= metrics.advance;
+	glyph->lastUse		= atlas->stamp;
+	glyph->hashNext		= atlas->hash[glvFont_atlasHash(glyph->fontKey,size,codepoint)];
+	atlas->hash[glvFont_atlasHash(glyph->fontKey,size,codepoint)] = index + 1;
+	if(page >= 0){
+		atlas->page[page].glyphNum++;
+	}
+	atlas->glyphNum++;
+	return(index);
+}
+
+static int glvFont_atlasReserve(T_GLYPH_ATLAS *atlas,int utf32_length)
+{
+	int size;
+
+	if(atlas->workSize >= utf32_length){
+		return(GLV_OK);
+	}
+	size = (utf32_length + 63) & ~63;
+	free(atlas->workGlyph);
+	free(atlas->workX);
+	free(atlas->workPos);
+	free(atlas->workCoord);
+	free(atlas->workColor);
+	atlas->workGlyph	= (int*)malloc(sizeof(int) * size);
+	atlas->workX		= (int*)malloc(sizeof(int) * size);
+	atlas->workPos		= (GLV_T_POINT_t*)malloc(sizeof(GLV_T_POINT_t) * size * 6);
+	atlas->workCoord	= (GLV_T_POINT_t*)malloc(sizeof(GLV_T_POINT_t) * size * 6);
+	atlas->workColor	= (GLV_T_Color_t*)malloc(sizeof(GLV_T_Color_t) * size * 6);
+	if((atlas->workGlyph == NULL) || (atlas->workX == NULL) || (atlas->workPos == NULL) || (atlas->workCoord == NULL) || (atlas->workColor == NULL)){
+		atlas->workSize = 0;
+		return(GLV_ERROR);
+	}
+	atlas->workSize = size;
+	return(GLV_OK);
+}
+
+/**
+ * @brief		アトラスを使用した文字列のレイアウト
+ * 				必要なグリフをアトラスに登録し、送り幅と文字列サイズを求める
+ * @return		GLV_OK:アトラスで描画可能 , GLV_ERROR:従来の処理で描画する
+ */
+static int glvFont_atlasLayout(THREAD_SAFE_BUFFER_t *font_draw_info,int *utf32_string,int utf32_length,int16_t *advance_x)
+{
+	T_GLYPH_ATLAS *atlas;
+	T_ATLAS_GLYPH *g;
+	int fontNum,mono,size,fontKey,i,index;
+	int xOffset=0,max_height=0,strHeight;
+
+	if(font_draw_info->initFlag == 0){
+		return(GLV_ERROR);
+	}
+	fontNum = font_draw_info->fontInfo.fontNum;
+	if(font_draw_info->face[fontNum] == NULL){
+		return(GLV_ERROR);
+	}
+	if(font_draw_info->atlas == NULL){
+		font_draw_info->atlas = (T_GLYPH_ATLAS*)calloc(1,sizeof(T_GLYPH_ATLAS));
+		if(font_draw_info->atlas == NULL){
+			return(GLV_ERROR);
+		}
+	}
+	atlas = font_draw_info->atlas;
+	if(glvFont_atlasReserve(atlas,utf32_length) != GLV_OK){
+		return(GLV_ERROR);
+	}
+
+	atlas->stamp++;
+	mono	= (font_draw_info->fontInfo.outLineFlg == 0)?(1):(0);
+	size	= font_draw_info->fontInfo.fontSize;
+	fontKey	= fontNum | (mono << 8);
+
+	if(advance_x != NULL) advance_x[0] = 0;
+	for(i=0;i<utf32_length;i++){
+		index = glvFont_atlasLookup(atlas,fontKey,size,utf32_string[i]);
+		if(index >= 0){
+			atlas->stat.hit++;
+		}else{
+			atlas->stat.miss++;
+			index = glvFont_atlasInsert(font_draw_info,fontNum,mono,size,utf32_string[i]);
+			if(index < 0){
+				atlas->stat.fallback++;
+				return(GLV_ERROR);
+			}
+		}
+		g = &atlas->glyph[index];
+		g->lastUse = atlas->stamp;
+		if(g->page >= 0){
+			atlas->page[g->page].lastUse = atlas->stamp;
+			if(max_height < (g->top + g->height)){
+				max_height = g->top + g->height;
+			}
+		}
+		atlas->workGlyph[i]	= index;
+		atlas->workX[i]		= xOffset;
+		xOffset += g->advance;
+		if(advance_x != NULL) advance_x[i+1] = xOffset;
+	}
+
+	if(font_draw_info->baseHeight > max_height){
+		strHeight = font_draw_info->baseHeight;
+	}else{
+		strHeight = max_height;
+	}
+	font_draw_info->bitmapFont.pBitMap		= NULL;
+	font_draw_info->bitmapFont.strWidth		= xOffset;
+	font_draw_info->bitmapFont.strHeight	= strHeight;
+	font_draw_info->bitmapFont.width		= xOffset;
+	font_draw_info->bitmapFont.height		= strHeight;
+	return(GLV_OK);
+}
+
+/**
+ * @brief		文字列描画開始(座標変換,背景色描画)
+ */
+static void glvFont_atlasBeginString(THREAD_SAFE_BUFFER_t *font_draw_info,int strWidth,int strHeight,float spotX,float spotY)
+{
+	GLV_T_POINT_t rect[4];
+	GLV_T_Color_t rectColor[4];
+	int i;
+
+	glvGl_PushMatrix();
+
+	// 指定座標に移動
+	glvGl_Translatef(font_draw_info->x_ofs, font_draw_info->y_ofs, 0.0);
+	glvGl_Rotatef(font_draw_info->fontInfo.rotation, 0.0, 0.0, 1.0);
+
+	// スポットにオフセット
+	if(0 != spotX || 0 != spotY) {
+		glvGl_Translatef(-spotX, -spotY, 0.0);
+	}
+
+	// 背景色を描画
+	if(GLV_GET_A(font_draw_info->gBkgdColor) != 0){
+		for(i=0;i<4;i++){
+			rectColor[i].r = GLV_GET_R(font_draw_info->gBkgdColor);
+			rectColor[i].g = GLV_GET_G(font_draw_info->gBkgdColor);
+			rectColor[i].b = GLV_GET_B(font_draw_info->gBkgdColor);
+			rectColor[i].a = GLV_GET_A(font_draw_info->gBkgdColor);
+		}
+		rect[0].x = 0;			rect[0].y = 0;
+		rect[1].x = 0;			rect[1].y = strHeight;
+		rect[2].x = strWidth;	rect[2].y = 0;
+		rect[3].x = strWidth;	rect[3].y = strHeight;
+		glvGl_drawColor(GL_TRIANGLE_STRIP, rect, rectColor, 4);
+	}
+}
+
+/**
+ * @brief		文字列描画終了
+ */
+static void glvFont_atlasEndString(void)
+{
+	glvGl_PopMatrix();
+}
+
+/**
+ * @brief		glvFont_atlasLayoutの結果から、指定テクスチャのグリフの頂点を生成する
+ * @return		頂点数
+ */
+static int glvFont_atlasBuildVertices(THREAD_SAFE_BUFFER_t *font_draw_info,int utf32_length,int page,GLV_T_POINT_t *pos,GLV_T_POINT_t *coord,GLV_T_Color_t *col)
+{
+	T_GLYPH_ATLAS *atlas = font_draw_info->atlas;
+	T_ATLAS_GLYPH *g;
+	GLV_T_Color_t color;
+	float x0,y0,x1,y1,u0,v0,u1,v1;
+	int i,n=0;
+	const float scale = 1.0f / (float)GLV_FONT_ATLAS_PAGE_SIZE;
+
+	if(atlas->page[page].lastUse != atlas->stamp){
+		return(0);
+	}
+
+	color.r = GLV_GET_R(font_draw_info->gColor);
+	color.g = GLV_GET_G(font_draw_info->gColor);
+	color.b = GLV_GET_B(font_draw_info->gColor);
+	color.a = GLV_GET_A(font_draw_info->gColor);
+
+	for(i=0;i<utf32_length;i++){
+		g = &atlas->glyph[atlas->workGlyph[i]];
+		if(g->page != page){
+			continue;
+		}
+		x0 = atlas->workX[i] + g->left;
+		y0 = g->top;
+		x1 = x0 + g->width;
+		y1 = y0 + g->height;
+		u0 = g->tx * scale;
+		v0 = g->ty * scale;
+		u1 = (g->tx + g->width) * scale;
+		v1 = (g->ty + g->height) * scale;
+
+		pos[n+0].x = x0;	pos[n+0].y = y0;	coord[n+0].x = u0;	coord[n+0].y = v0;
+		pos[n+1].x = x1;	pos[n+1].y = y0;	coord[n+1].x = u1;	coord[n+1].y = v0;
+		pos[n+2].x = x0;	pos[n+2].y = y1;	coord[n+2].x = u0;	coord[n+2].y = v1;
+		pos[n+3].x = x1;	pos[n+3].y = y0;	coord[n+3].x = u1;	coord[n+3].y = v0;
+		pos[n+4].x = x1;	pos[n+4].y = y1;	coord[n+4].x = u1;	coord[n+4].y = v1;
+		pos[n+5].x = x0;	pos[n+5].y = y1;	coord[n+5].x = u0;	coord[n+5].y = v1;
+		col[n+0] = color;
+		col[n+1] = color;
+		col[n+2] = color;
+		col[n+3] = color;
+		col[n+4] = color;
+		col[n+5] = color;
+		n += 6;
+	}
+	return(n);
+}
+
+/**
+ * @brief		アトラスを使用した文字列の描画
+ * 				glvFont_atlasLayoutの結果を、テクスチャ毎に1回のglDrawArraysで描画する
+ */
+static void glvFont_atlasDraw(THREAD_SAFE_BUFFER_t *font_draw_info,int utf32_length,float spotX,float spotY)
+{
+	T_GLYPH_ATLAS *atlas = font_draw_info->atlas;
+	int page,n;
+
+	glvFont_atlasBeginString(font_draw_info,font_draw_info->bitmapFont.strWidth,font_draw_info->bitmapFont.strHeight,spotX,spotY);
+
+	for(page=0;page<GLV_FONT_ATLAS_PAGE_MAX;page++){
+		n = glvFont_atlasBuildVertices(font_draw_info,utf32_length,page,atlas->workPos,atlas->workCoord,atlas->workColor);
+		glvGl_DrawTexturesArray(atlas->page[page].textureId, GL_TRIANGLES, atlas->workPos, atlas->workCoord, atlas->workColor, n);
+	}
+
+	glvFont_atlasEndString();
+}
+
+// =============================================================================
+// テキストランキャッシュ
+//   キー(UTF-8文字列,フォント,サイズ,色,配置)毎に、改行位置と頂点を保持する。
+//   アトラスのグリフが破棄されると(世代の変化)、次の描画で作り直す。
+// =============================================================================
+static unsigned int glvFont_runHash(THREAD_SAFE_BUFFER_t *font_draw_info,char *utf8,int utf8Length)
+{
+	unsigned int h = 2166136261u;
+	int i;
+
+	// FNV-1a
+	for(i=0;i<utf8Length;i++){
+		h = (h ^ (unsigned char)utf8[i]) * 16777619u;
+	}
+	h ^= font_draw_info->fontInfo.fontNum * 31 + (int)font_draw_info->fontInfo.fontSize;
+	h ^= font_draw_info->gColor * 16777619u;
+	return(h);
+}
+
+static int glvFont_runMatch(THREAD_SAFE_BUFFER_t *font_draw_info,T_TEXT_RUN *run,unsigned int hash,char *utf8,int utf8Length)
+{
+	if((run->hash != hash) || (run->utf8Length != utf8Length)) return(0);
+	if(run->fontNum		!= font_draw_info->fontInfo.fontNum) return(0);
+	if(run->size		!= (int)font_draw_info->fontInfo.fontSize) return(0);
+	if(run->mono		!= ((font_draw_info->fontInfo.outLineFlg == 0)?(1):(0))) return(0);
+	if(run->center		!= font_draw_info->fontInfo.center) return(0);
+	if(run->baseHeight	!= font_draw_info->baseHeight) return(0);
+	if(run->gColor		!= font_draw_info->gColor) return(0);
+	if(run->gBkgdColor	!= font_draw_info->gBkgdColor) return(0);
+	if(memcmp(run->utf8,utf8,utf8Length) != 0) return(0);
+	return(1);
+}
+
+static void glvFont_runFree(T_TEXT_RUN *run)
+{
+	free(run->utf8);
+	free(run->line);
+	free(run->pos);
+	free(run->coord);
+	free(run->color);
+	free(run);
+}
+
+static void glvFont_runUnlink(T_TEXT_RUN_CACHE *cache,T_TEXT_RUN *run)
+{
+	T_TEXT_RUN **link;
+
+	for(link=&cache->hash[run->hash & (GLV_FONT_RUN_HASH_SIZE - 1)];*link!=NULL;link=&(*link)->hashNext){
+		if(*link == run){
+			*link = run->hashNext;
+			break;
+		}
+	}
+	if(run->lruPrev != NULL) run->lruPrev->lruNext = run->lruNext;
+	else cache->lruHead = run->lruNext;
+	if(run->lruNext != NULL) run->lruNext->lruPrev = run->lruPrev;
+	else cache->lruTail = run->lruPrev;
+	cache->runNum--;
+	cache->memSize -= run->memSize;
+}
+
+static void glvFont_runLinkHead(T_TEXT_RUN_CACHE *cache,T_TEXT_RUN *run)
+{
+	run->lruPrev = NULL;
+	run->lruNext = cache->lruHead;
+	if(cache->lruHead != NULL) cache->lruHead->lruPrev = run;
+	cache->lruHead = run;
+	if(cache->lruTail == NULL) cache->lruTail = run;
+}
+
+static T_TEXT_RUN *glvFont_runLookup(THREAD_SAFE_BUFFER_t *font_draw_info,unsigned int hash,char *utf8,int utf8Length)
+{
+	T_TEXT_RUN_CACHE *cache = font_draw_info->runCache;
+	T_TEXT_RUN *run;
+
+	for(run=cache->hash[hash & (GLV_FONT_RUN_HASH_SIZE - 1)];run!=NULL;run=run->hashNext){
+		if(glvFont_runMatch(font_draw_info,run,hash,utf8,utf8Length) == 1){
+			// LRUの先頭へ
+			if(cache->lruHead != run){
+				if(run->lruPrev != NULL) run->lruPrev->lruNext = run->lruNext;
+				if(run->lruNext != NULL) run->lruNext->lruPrev = run->lruPrev;
+				else cache->lruTail = run->lruPrev;
+				glvFont_runLinkHead(cache,run);
+			}
+			return(run);
+		}
+	}
+	return(NULL);
+}
+
+static void glvFont_runInsert(THREAD_SAFE_BUFFER_t *font_draw_info,T_TEXT_RUN *run)
+{
+	T_TEXT_RUN_CACHE *cache = font_draw_info->runCache;
+	T_TEXT_RUN *victim;
+	unsigned int index = run->hash & (GLV_FONT_RUN_HASH_SIZE - 1);
+
+	// 上限を超える場合は古いものから破棄
+	while((cache->lruTail != NULL) &&
+		((cache->runNum >= GLV_FONT_RUN_CACHE_MAX) || (cache->memSize + run->memSize > GLV_FONT_RUN_CACHE_SIZE))){
+		victim = cache->lruTail;
+		glvFont_runUnlink(cache,victim);
+		glvFont_runFree(victim);
+		cache->stat.evict++;
+	}
+	run->hashNext = cache->hash[index];
+	cache->hash[index] = run;
+	glvFont_runLinkHead(cache,run);
+	cache->runNum++;
+	cache->memSize += run->memSize;
+}
+
+/**
+ * @brief		テキストランの作成
+ * 				glvFont_DrawUTF8Stringと同じ規則で行に分割してレイアウトする
+ * @return		NULL:アトラスで描画できない(従来の処理で描画する)
+ */
+static T_TEXT_RUN *glvFont_runBuild(THREAD_SAFE_BUFFER_t *font_draw_info,unsigned int hash,char *pStr,int utf8Length)
+{
+	T_GLYPH_ATLAS *atlas;
+	T_TEXT_RUN *run;
+	T_TEXT_RUN_LINE *line;
+	int strLength,n,start,page,count,lineMax,vertexMax;
+	int *utf32_string;
+	int utf32_length;
+	uint32_t generation=0;
+
+	run = (T_TEXT_RUN*)calloc(1,sizeof(T_TEXT_RUN));
+	if(run == NULL){
+		return(NULL);
+	}
+	run->hash		= hash;
+	run->utf8Length	= utf8Length;
+	run->utf8		= (char*)malloc(utf8Length + 1);
+	run->fontNum	= font_draw_info->fontInfo.fontNum;
+	run->size		= (int)font_draw_info->fontInfo.fontSize;
+	run->mono		= (font_draw_info->fontInfo.outLineFlg == 0)?(1):(0);
+	run->center		= font_draw_info->fontInfo.center;
+	run->baseHeight	= font_draw_info->baseHeight;
+	run->gColor		= font_draw_info->gColor;
+	run->gBkgdColor	= font_draw_info->gBkgdColor;
+
+	// 行数,頂点数の上限
+	lineMax = 1;
+	for(n=0;n<utf8Length;n++){
+		if(pStr[n] == '\n') lineMax++;
+	}
+	vertexMax = utf8Length * 6;
+	run->line	= (T_TEXT_RUN_LINE*)calloc(lineMax,sizeof(T_TEXT_RUN_LINE));
+	run->pos	= (GLV_T_POINT_t*)malloc(sizeof(GLV_T_POINT_t) * (vertexMax + 1));
+	run->coord	= (GLV_T_POINT_t*)malloc(sizeof(GLV_T_POINT_t) * (vertexMax + 1));
+	run->color	= (GLV_T_Color_t*)malloc(sizeof(GLV_T_Color_t) * (vertexMax + 1));
+	utf32_string = (int*)malloc(sizeof(int) * (utf8Length + 1));
+	if((run->utf8 == NULL) || (run->line == NULL) || (run->pos == NULL) || (run->coord == NULL) || (run->color == NULL) || (utf32_string == NULL)){
+		free(utf32_string);
+		glvFont_runFree(run);
+		return(NULL);
+	}
+	memcpy(run->utf8,pStr,utf8Length);
+	run->utf8[utf8Length] = 0;
+
+	strLength = utf8Length + 1;
+	start = 0;
+	for(n=0;n<strLength;n++){
+		if((n < utf8Length) && (pStr[n] != '\n')){
+			continue;
+		}
+		if((n - start) == 0){
+			break;
+		}
+		utf32_length = glvFont_string_to_utf32(pStr + start,n - start,utf32_string,n - start);
+		if(utf32_length == 0){
+			break;
+		}
+		if(glvFont_atlasLayout(font_draw_info,utf32_string,utf32_length,NULL) != GLV_OK){
+			free(utf32_string);
+			glvFont_runFree(run);
+			return(NULL);
+		}
+		atlas = font_draw_info->atlas;
+		if(run->lineNum == 0){
+			generation = atlas->generation;
+		}
+		line = &run->line[run->lineNum++];
+		line->strWidth	= font_draw_info->bitmapFont.strWidth;
+		line->strHeight	= font_draw_info->bitmapFont.strHeight;
+		line->lineBreak	= (n < utf8Length)?(1):(0);
+		for(page=0;page<GLV_FONT_ATLAS_PAGE_MAX;page++){
+			count = glvFont_atlasBuildVertices(font_draw_info,utf32_length,page,
+						run->pos + run->vertexNum,run->coord + run->vertexNum,run->color + run->vertexNum);
+			line->first[page] = run->vertexNum;
+			line->count[page] = count;
+			run->vertexNum += count;
+		}
+		start = n + 1;
+	}
+	free(utf32_string);
+
+	if((run->lineNum > 0) && (font_draw_info->atlas->generation != generation)){
+		// レイアウト中に前の行のグリフが破棄された
+		glvFont_runFree(run);
+		return(NULL);
+	}
+	run->generation = generation;
+	run->memSize = sizeof(T_TEXT_RUN) + utf8Length + 1 + sizeof(T_TEXT_RUN_LINE) * lineMax
+				 + (sizeof(GLV_T_POINT_t) * 2 + sizeof(GLV_T_Color_t)) * (vertexMax + 1);
+	return(run);
+}
+
+/**
+ * @brief		テキストランの描画
+ * @return		glvFont_DrawUTF8Stringと同じ
+ */
+static int glvFont_runDraw(THREAD_SAFE_BUFFER_t *font_draw_info,T_TEXT_RUN *run)
+{
+	T_GLYPH_ATLAS *atlas = font_draw_info->atlas;
+	T_TEXT_RUN_LINE *line;
+	float spotX,spotY;
+	int i,page;
+
+	glvGl_BeginBlend();
+
+	for(i=0;i<run->lineNum;i++){
+		line = &run->line[i];
+		// 表示位置
+		if (GLV_GL_PRINTF_CENTER == run->center) {
+			spotX = (float)line->strWidth/2.0;
+			spotY = (float)line->strHeight/2.0;
+		}else{
+			spotX = 0.0f;
+			spotY = 0.0f;
+		}
+		glvFont_atlasBeginString(font_draw_info,line->strWidth,line->strHeight,spotX,spotY);
+		for(page=0;page<GLV_FONT_ATLAS_PAGE_MAX;page++){
+			glvGl_DrawTexturesArray(atlas->page[page].textureId, GL_TRIANGLES,
+				run->pos + line->first[page], run->coord + line->first[page], run->color + line->first[page], line->count[page]);
+		}
+		glvFont_atlasEndString();
+
+		font_draw_info->bitmapFont.strWidth  = line->strWidth;
+		font_draw_info->bitmapFont.strHeight = line->strHeight;
+		if(line->lineBreak == 1){
+			font_draw_info->x_ofs = font_draw_info->x_pos;
+			font_draw_info->y_ofs += (line->strHeight + font_draw_info->fontInfo.lineSpace);
+		}else{
+			font_draw_info->x_ofs += line->strWidth;
+		}
+	}
+
+	glvGl_EndBlend();
+	return (font_draw_info->bitmapFont.strHeight + font_draw_info->fontInfo.lineSpace);
+}
+
+/**
+ * @brief		キャッシュを使用した文字列描画
+ * @return		-1:キャッシュを使用できない(従来の処理で描画する)
+ */
+static int glvFont_runDrawUTF8String(THREAD_SAFE_BUFFER_t *font_draw_info,char *pStr)
+{
+	T_TEXT_RUN_CACHE *cache;
+	T_TEXT_RUN *run;
+	unsigned int hash;
+	int utf8Length,rc;
+
+	if(font_draw_info->runCache == NULL){
+		font_draw_info->runCache = (T_TEXT_RUN_CACHE*)calloc(1,sizeof(T_TEXT_RUN_CACHE));
+		if(font_draw_info->runCache == NULL){
+			return(-1);
+		}
+	}
+	cache = font_draw_info->runCache;
+
+	utf8Length = strlen(pStr);
+	hash = glvFont_runHash(font_draw_info,pStr,utf8Length);
+
+	run = glvFont_runLookup(font_draw_info,hash,pStr,utf8Length);
+	if(run != NULL){
+		if((font_draw_info->atlas != NULL) && (run->generation == font_draw_info->atlas->generation)){
+			cache->stat.hit++;
+			return(glvFont_runDraw(font_draw_info,run));
+		}
+		// アトラスのグリフが入れ替わったので作り直す
+		glvFont_runUnlink(cache,run);
+		glvFont_runFree(run);
+		cache->stat.rebuild++;
+	}
+	cache->stat.miss++;
+
+	run = glvFont_runBuild(font_draw_info,hash,pStr,utf8Length);
+	if(run == NULL){
+		return(-1);
+	}
+	rc = glvFont_runDraw(font_draw_info,run);
+	if(run->memSize <= GLV_FONT_RUN_CACHE_SIZE){
+		glvFont_runInsert(font_draw_info,run);
+	}else{
+		glvFont_runFree(run);
+	}
+	return(rc);
+}
+
+/**
+ * @brief		テキストランキャッシュを破棄する(呼び出しスレッドのキャッシュ)
+ */
+void glvFont_clearRunCache(void)
+{
+	THREAD_SAFE_BUFFER_t	*font_draw_info = get_thread_safe_buffer();
+	T_TEXT_RUN_CACHE		*cache;
+	T_TEXT_RUN				*run;
+
+	if(font_draw_info == NULL){
+		return;
+	}
+	cache = font_draw_info->runCache;
+	if(cache == NULL){
+		return;
+	}
+	while((run = cache->lruHead) != NULL){
+		glvFont_runUnlink(cache,run);
+		glvFont_runFree(run);
+	}
+}
+
+/**
+ * @brief		テキストランキャッシュの統計情報を取得する(呼び出しスレッドのキャッシュ)
+ * @param[out]	stat 統計情報
+ * @param[in]	reset 1:取得後にカウンタをクリアする
+ */
+int glvFont_getRunCacheStatistics(GLV_FONT_RUN_STAT_t *stat,int reset)
+{
+	THREAD_SAFE_BUFFER_t	*font_draw_info = get_thread_safe_buffer();
+	T_TEXT_RUN_CACHE		*cache;
+
+	memset(stat,0,sizeof(GLV_FONT_RUN_STAT_t));
+	if(font_draw_info == NULL){
+		return(GLV_ERROR);
+	}
+	cache = font_draw_info->runCache;
+	if(cache == NULL){
+		return(GLV_OK);
+	}
+	memcpy(stat,&cache->stat,sizeof(GLV_FONT_RUN_STAT_t));
+	stat->runNum = cache->runNum;
+	stat->memSize = cache->memSize;
+	if(reset != 0){
+		memset(&cache->stat,0,sizeof(GLV_FONT_RUN_STAT_t));
+	}
+	return(GLV_OK);
+}
+
+/**
+ * @brief		グリフアトラスの全グリフを破棄する(テクスチャは再利用する)
+ */
+void glvFont_clearAtlas(void)
+{
+	THREAD_SAFE_BUFFER_t	*font_draw_info = get_thread_safe_buffer();
+	T_GLYPH_ATLAS			*atlas;
+	int i;
+
+	if(font_draw_info == NULL){
+		return;
+	}
+	atlas = font_draw_info->atlas;
+	if(atlas == NULL){
+		return;
+	}
+	for(i=0;i<GLV_FONT_ATLAS_PAGE_MAX;i++){
+		if(atlas->page[i].textureId != 0){
+			glvFont_atlasResetPage(atlas,i);
+		}
+	}
+	// テクスチャに格納されていないグリフ(空白)
+	for(i=0;i<GLV_FONT_ATLAS_GLYPH_MAX;i++){
+		if(atlas->glyph[i].used != 0){
+			glvFont_atlasRemoveGlyph(atlas,i);
+			atlas->stat.evictGlyph++;
+		}
+	}
+}
+
+/**
+ * @brief		グリフアトラスの統計情報を取得する(呼び出しスレッドのアトラス)
+ * @param[out]	stat 統計情報
+ * @param[in]	reset 1:取得後にカウンタをクリアする
+ */
+int glvFont_getAtlasStatistics(GLV_FONT_ATLAS_STAT_t *stat,int reset)
+{
+	THREAD_SAFE_BUFFER_t	*font_draw_info = get_thread_safe_buffer();
+	T_GLYPH_ATLAS			*atlas;
+	int i;
+
+	memset(stat,0,sizeof(GLV_FONT_ATLAS_STAT_t));
+	if(font_draw_info == NULL){
+		return(GLV_ERROR);
+	}
+	atlas = font_draw_info->atlas;
+	if(atlas == NULL){
+		return(GLV_OK);
+	}
+	memcpy(stat,&atlas->stat,sizeof(GLV_FONT_ATLAS_STAT_t));
+	stat->glyphNum = atlas->glyphNum;
+	stat->pageNum = 0;
+	for(i=0;i<GLV_FONT_ATLAS_PAGE_MAX;i++){
+		if(atlas->page[i].textureId != 0){
+			stat->pageNum++;
+		}
+	}
+	if(reset != 0){
+		memset(&atlas->stat,0,sizeof(GLV_FONT_ATLAS_STAT_t));
+	}
+	return(GLV_OK);
+}
+
 int glvFont_createBitmapFont(int *utf32_string,int utf32_length,int16_t *advance_x)
 {
 	THREAD_SAFE_BUFFER_t	*font_draw_info = get_thread_safe_buffer();	
@@ -492,6 +1788,7 @@ int glvFont_createBitmapFont(int *utf32_string,int utf32_length,int16_t *advance
 	int width;
 	int height;
 	int i;
+	T_FONT_FACE *fontFace;
 	FT_Face face;
 	FT_Error err;
 	int max_height=0;
@@ -538,17 +1835,22 @@ int glvFont_createBitmapFont(int *utf32_string,int utf32_length,int16_t *advance
 	unsigned char *buffer = (unsigned char*)calloc(bufferSize,1);
 
 	if(font_draw_info->initFlag == 0){
-		printf("glv_createBitmapFont: not initalized library\n");
+		GLV_LOG_ERROR(GLV_DEBUG_FONT,"glv_createBitmapFont: not initalized library\n");
 		return(0);
 	}
 
-	face = font_draw_info->face[font_draw_info->fontInfo.fontNum];
-	if(face == NULL){
-		printf("glv_createBitmapFont:face[%d] == NULL\n",font_draw_info->fontInfo.fontNum);
+	fontFace = font_draw_info->face[font_draw_info->fontInfo.fontNum];
+	if(fontFace == NULL){
+		GLV_LOG_ERROR(GLV_DEBUG_FONT,"glv_createBitmapFont:face[%d] == NULL\n",font_draw_info->fontInfo.fontNum);
+		free(buffer);
+		return(0);
 	}
+	face = fontFace->face;
+
+	// 共有フェイスを他スレッドと排他して使用する
+	pthread_mutex_lock(&fontFace->mutex);
 
-	err = FT_Set_Pixel_Sizes(face, fontSize, fontSize);
-	if (err) { printf("glv_createBitmapFont:FT_Set_Pixel_Sizes\n"); }
+	glvFont_setPixelSize(fontFace,fontSize);
 
 	int xOffset = 0;
 	if(advance_x != NULL) advance_x[0] = xOffset;
@@ -556,16 +1858,16 @@ int glvFont_createBitmapFont(int *utf32_string,int utf32_length,int16_t *advance
 		if(outLineFlg == 0){
 			/* モノクロビットマップ */
 			err = FT_Load_Char(face, utf32_string[i], 0);
-			if (err) { printf("glv_createBitmapFont:FT_Load_Char\n"); }
+			if (err) { GLV_LOG_ERROR(GLV_DEBUG_FONT,"glv_createBitmapFont:FT_Load_Char\n"); }
 
-			printf("face->size->metrics.y_ppem / face->units_per_EM  = %f\n",(double)face->size->metrics.y_ppem / (double)face->units_per_EM);
-			printf("face->height = %d , face->descender = %d\n",face->height,face->descender);
+			GLV_LOG_TRACE(GLV_DEBUG_FONT,"face->size->metrics.y_ppem / face->units_per_EM  = %f\n",(double)face->size->metrics.y_ppem / (double)face->units_per_EM);
+			GLV_LOG_TRACE(GLV_DEBUG_FONT,"face->height = %d , face->descender = %d\n",face->height,face->descender);
 			int	baseline = (face->height + face->descender) * (double)face->size->metrics.y_ppem / (double)face->units_per_EM;
 			//baseline += (FONT_MARGIN_HEIGHT/2);
 			//printf("1 baseline = %d\n",baseline);
 
 			err = FT_Render_Glyph(face->glyph, FT_RENDER_MODE_MONO);
-			if (err) { printf("glv_createBitmapFont:FT_Render_Glyph\n"); }
+			if (err) { GLV_LOG_ERROR(GLV_DEBUG_FONT,"glv_createBitmapFont:FT_Render_Glyph\n"); }
 
 			FT_Bitmap *bm = &face->glyph->bitmap;
 			FT_GlyphSlot g = face->glyph;
@@ -586,7 +1888,7 @@ int glvFont_createBitmapFont(int *utf32_string,int utf32_length,int16_t *advance
 						if (((c >> bit) & 1) == 1){
 							index = g->bitmap_left + (buffer_width * (row + baseline - g->bitmap_top)) + (col * 8 + 7 - bit)+ xOffset;
 							if((index < 0) || (index >= bufferSize)){
-								printf("glv_createBitmapFont: buffer size over %d  (%d:%x)\n",index,i,utf32_string[i]);
+								GLV_LOG_ERROR(GLV_DEBUG_FONT,"glv_createBitmapFont: buffer size over %d  (%d:%x)\n",index,i,utf32_string[i]);
 							}else{
 								*(buffer + index) = 0xff;
 								draw_height = (index + buffer_width)/buffer_width;
@@ -610,13 +1912,13 @@ int glvFont_createBitmapFont(int *utf32_string,int utf32_length,int16_t *advance
 #if 1
 			/* ノーマルフォント */
 			err = FT_Load_Char(face, utf32_string[i],0);
-			if (err) { printf("FT_Load_Char\n"); }
+			if (err) { GLV_LOG_ERROR(GLV_DEBUG_FONT,"FT_Load_Char\n"); }
 #else
 			/* ボールド */
 			err = FT_Load_Char(face, utf32_string[i], FT_LOAD_DEFAULT | FT_LOAD_NO_BITMAP);
-			if (err) { printf("FT_Load_Char\n"); }
+			if (err) { GLV_LOG_ERROR(GLV_DEBUG_FONT,"FT_Load_Char\n"); }
 			if(face->glyph->format != FT_GLYPH_FORMAT_OUTLINE){
-			    printf("glv_createBitmapFont: FT_Load_Char format != FT_GLYPH_FORMAT_OUTLINE\n"); // エラー！ アウトラインでなければならない
+			    GLV_LOG_ERROR(GLV_DEBUG_FONT,"glv_createBitmapFont: FT_Load_Char format != FT_GLYPH_FORMAT_OUTLINE\n"); // エラー！ アウトラインでなければならない
 			}
 			int strength = 1 << 6;    // 適当な太さ
 			FT_Outline_Embolden(&face->glyph->outline, strength);
@@ -631,7 +1933,7 @@ int glvFont_createBitmapFont(int *utf32_string,int utf32_length,int16_t *advance
 			//printf("3-2 baseline = %d\n",baseline);
 
 			err = FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL);
-			if (err) { printf("glv_createBitmapFont:FT_Render_Glyph error\n"); }
+			if (err) { GLV_LOG_ERROR(GLV_DEBUG_FONT,"glv_createBitmapFont:FT_Render_Glyph error\n"); }
 
 			FT_Bitmap *bm = &face->glyph->bitmap;
 			FT_GlyphSlot g = face->glyph;
@@ -649,7 +1951,7 @@ int glvFont_createBitmapFont(int *utf32_string,int utf32_length,int16_t *advance
 					if(c > 0){
 						index = g->bitmap_left + (buffer_width * (row + baseline - g->bitmap_top)) + col + xOffset;
 						if((index < 0) || (index >= bufferSize)){
-							printf("glv_createBitmapFont: buffer size over %d  (%d:%x)\n",index,i,utf32_string[i]);
+							GLV_LOG_ERROR(GLV_DEBUG_FONT,"glv_createBitmapFont: buffer size over %d  (%d:%x)\n",index,i,utf32_string[i]);
 						}else{
 							*(buffer + index) = c;
 							draw_height = (index + buffer_width)/buffer_width;
@@ -672,6 +1974,8 @@ int glvFont_createBitmapFont(int *utf32_string,int utf32_length,int16_t *advance
 	}
 	//printf("buffer_height = %d , max_height = %d\n",buffer_height,max_height);
 
+	pthread_mutex_unlock(&fontFace->mutex);
+
     strWidth = xOffset;
     //strHeight = buffer_height;
 	if(font_draw_info->baseHeight == 0){
@@ -848,6 +2152,17 @@ int glvFont_DrawUTF32String(int *utf32_string,int utf32_length,int16_t *advance_
 		return(0);
 	}
 
+#ifdef GLV_FONT_USE_GLYPH_ATLAS
+	if(glvFont_atlasLayout(font_draw_info,utf32_string,utf32_length,advance_x) == GLV_OK){
+		glvFont_atlasDraw(font_draw_info,utf32_length,0.0f,0.0f);
+
+		font_draw_info->x_ofs += font_draw_info->bitmapFont.strWidth;
+
+		glvGl_EndBlend();
+		return(font_draw_info->bitmapFont.strHeight + font_draw_info->fontInfo.lineSpace);
+	}
+#endif
+
 	// ビットマップフォント生成
 	glvFont_createBitmapFont(utf32_string,utf32_length,advance_x);
 
@@ -882,6 +2197,15 @@ int glvFont_DrawUTF8String(char* pStr)
 	int		utf32_length;
 	char	*draw_String;
 	int		draw_length;
+	int		useAtlas;
+#ifdef GLV_FONT_USE_RUN_CACHE
+	int		rc;
+
+	rc = glvFont_runDrawUTF8String(font_draw_info,pStr);
+	if(rc >= 0){
+		return(rc);
+	}
+#endif
 
 	glvGl_BeginBlend();
 
@@ -947,7 +2271,15 @@ int glvFont_DrawUTF8String(char* pStr)
 		//printf(" start = %d , length = %d\n",start,draw_length);
 		// ビットマップフォント生成
 		advance_x = malloc(sizeof(int16_t) * (draw_length + 2));
-		glvFont_createBitmapFont(utf32_string,utf32_length,advance_x);
+		useAtlas = 0;
+#ifdef GLV_FONT_USE_GLYPH_ATLAS
+		if(glvFont_atlasLayout(font_draw_info,utf32_string,utf32_length,advance_x) == GLV_OK){
+			useAtlas = 1;
+		}
+#endif
+		if(useAtlas == 0){
+			glvFont_createBitmapFont(utf32_string,utf32_length,advance_x);
+		}
 
 #if 0
 		printf("advance_x(%d):",utf32_length);
@@ -969,8 +2301,12 @@ int glvFont_DrawUTF8String(char* pStr)
 			spotY = (float)font_draw_info->bitmapFont.strHeight/2.0;
 		}
 
-		glvFont_DrawTexture(spotX,spotY);
-		glvFont_deleteBitmapFont();
+		if(useAtlas == 1){
+			glvFont_atlasDraw(font_draw_info,utf32_length,spotX,spotY);
+		}else{
+			glvFont_DrawTexture(spotX,spotY);
+			glvFont_deleteBitmapFont();
+		}
 
 		if(lineBreak == 1){
 			font_draw_info->x_ofs = font_draw_info->x_pos;
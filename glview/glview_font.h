@@ -45,7 +45,34 @@ enum {
 #define GLV_FONT_ANGLE      (1<<5)
 #define GLV_FONT_LINE_SPACE (1<<6)
 
+// グリフアトラス統計情報
+typedef struct _glv_font_atlas_stat {
+	uint64_t	hit;			// アトラス登録済み
+	uint64_t	miss;			// アトラス未登録
+	uint64_t	sharedHit;		// 未登録のうち、他スレッドのラスタライズ結果を使用した数
+	uint64_t	evictGlyph;		// 破棄したグリフ数
+	uint64_t	evictPage;		// 再利用したテクスチャ数
+	uint64_t	fallback;		// アトラスを使用できずに従来の処理で描画した文字列数
+	int			glyphNum;		// 登録グリフ数
+	int			pageNum;		// テクスチャ数
+} GLV_FONT_ATLAS_STAT_t;
+
+// テキストランキャッシュ統計情報
+typedef struct _glv_font_run_stat {
+	uint64_t	hit;			// レイアウト済み文字列を再利用
+	uint64_t	miss;			// レイアウト実行
+	uint64_t	rebuild;		// アトラスのグリフ入れ替えによる再作成
+	uint64_t	evict;			// 上限超過で破棄した数
+	int			runNum;			// 登録数
+	int			memSize;		// 使用メモリ(byte)
+} GLV_FONT_RUN_STAT_t;
+
 void glvFont_thread_safe_init(void);
+void glvFont_thread_safe_finish(void);
+void glvFont_clearAtlas(void);
+int glvFont_getAtlasStatistics(GLV_FONT_ATLAS_STAT_t *stat,int reset);
+void glvFont_clearRunCache(void);
+int glvFont_getRunCacheStatistics(GLV_FONT_RUN_STAT_t *stat,int reset);
 void glvFont_setDefaultFontPath(char *path);
 void glvFont_SetPosition(int x_ofs,int y_ofs);
 void glvFont_GetPosition(int *x_ofs,int *y_ofs);
@@ -64,6 +91,7 @@ void glvFont_lineSpace(int n);
 void glvFont_SetlineSpace(int n);
 void glvFont_SetBaseHeight(int n);
 int glvFont_printf(char * fmt,...);
+int glvFont_DrawUTF8String(char* pStr);
 
 int glvFont_string_to_utf32(char *str,int str_size,int *utf32_string,int max_chars);
 int glvFont_utf32_to_string(int *utf32_string,int str_size,char *str,int max_chars);
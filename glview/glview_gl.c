@@ -41,6 +41,14 @@
 #define GLV_GL_LINE_OFF_SIZE	(4)
 #define GLV_GL_DRAW_POINT		(1000)
 #define GLV_GL_BUF_SIZE			(GLV_GL_LINE_OFF_SIZE*GLV_GL_DRAW_POINT)
+#define GLV_GL_BATCH_VERTEX_MAX	(3*4096)		// バッチ描画 頂点バッファサイズ(三角形頂点数)
+#define GLV_GL_STREAM_SIZE		(1024*1024)		// ストリーミングVBOのサイズ(byte)
+
+// ストリーミングVBO
+// 動的な頂点配列をクライアントメモリから直接描画せず、コンテキスト毎のVBOに
+// 順に書き込んで描画する。満杯になった時はバッファを破棄(orphan)して先頭から使用する。
+// 実行時にglvGl_setVertexStreamModeで従来のクライアント配列に切り替えられる。
+#define GLV_GL_USE_STREAM_VBO
 
 //------------------------------------------------------------------------------
 // マクロ
@@ -66,6 +74,25 @@ typedef struct _thread_safe_buffer{
 	EGLDisplay		egl_dpy;
 	EGLContext		egl_ctx;
 	GLV_T_POINT_t	glv_gPointBuf[GLV_GL_BUF_SIZE];
+	// バッチ描画
+	int				batchMode;			// 1:バッチ描画有効
+	int				blend;				// glvGl_BeginBlend/glvGl_EndBlendの状態
+	int32_t			batchVertexNum;
+	int32_t			batchPrimitive;		// 蓄積中のプリミティブ(GL_TRIANGLES/GL_LINES)
+	float			batchLineWidth;		// 蓄積中の線の太さ(GL_LINES)
+	GLV_T_POINT_t	batchPos[GLV_GL_BATCH_VERTEX_MAX];		// 座標変換済み頂点
+	GLV_T_Color_t	batchColor[GLV_GL_BATCH_VERTEX_MAX];
+	GLV_GL_BATCH_STAT_t	batchStat;
+	// ストリーミングVBO
+	int				streamMode;			// GLV_GL_VERTEX_CLIENT_ARRAY/GLV_GL_VERTEX_STREAM_VBO
+	GLuint			streamVbo;
+	int32_t			streamOffset;		// 次の書き込み位置
+	GLV_GL_STREAM_STAT_t	streamStat;
+	// カレントのsurface
+	int				currentValid;		// 1:currentSurf,currentSurfaceIdが有効
+	EGLSurface		currentSurf;
+	size_t			currentSurfaceId;
+	GLV_GL_MAKE_CURRENT_STAT_t	makeCurrentStat;
 	//
 } THREAD_SAFE_BUFFER_t;
 #include "glview_thread_safe.h"
@@ -80,14 +107,42 @@ typedef struct _thread_safe_buffer{
  */
 void glvGl_thread_safe_init(void)
 {
+	THREAD_SAFE_BUFFER_t *thread_buffer;
+
 	init_thread_safe_buffer();
+
+	thread_buffer = get_thread_safe_buffer();
+#ifdef GLV_GL_USE_STREAM_VBO
+	thread_buffer->streamMode = GLV_GL_VERTEX_STREAM_VBO;
+#else
+	thread_buffer->streamMode = GLV_GL_VERTEX_CLIENT_ARRAY;
+#endif
+}
+
+/**
+ * @brief		終了:コンテキストを破棄する前に呼び出してください
+ */
+void glvGl_thread_safe_finish(void)
+{
+	THREAD_SAFE_BUFFER_t *thread_buffer = get_thread_safe_buffer();
+
+	if(thread_buffer == NULL){
+		return;
+	}
+	if(thread_buffer->streamVbo != 0){
+		glDeleteBuffers(1, &thread_buffer->streamVbo);
+		thread_buffer->streamVbo = 0;
+	}
 }
 
+static void glvGl_batchFlush(THREAD_SAFE_BUFFER_t *thread_buffer);
+
 void glvGl_setEglContextInfo(EGLDisplay egl_dpy,EGLContext egl_ctx)
 {
 	THREAD_SAFE_BUFFER_t *thread_buffer = get_thread_safe_buffer();
 	thread_buffer->egl_dpy = egl_dpy;
 	thread_buffer->egl_ctx = egl_ctx;
+	thread_buffer->currentValid = 0;		// コンテキストが変わるのでカレントのsurfaceは不明
 }
 
 EGLContext glvGl_GetEglContext(void)
@@ -102,6 +157,391 @@ EGLDisplay glvGl_GetEglDisplay(void)
 	return(thread_buffer->egl_dpy);
 }
 
+/**
+ * @brief		描画先のsurfaceをカレントにする
+ *
+ * スレッドでカレントのsurfaceと同じ場合はeglMakeCurrentを省略する。
+ * surfaceを切り替える場合は、切り替える前にバッチ描画の蓄積分を描画する。
+ * 
+ * @param[in]	egl_surf	描画先のsurface(EGL_NO_SURFACE:描画先を解除)
+ * @param[in]	surfaceId	surfaceの識別子(破棄したsurfaceと同じハンドルが再利用された場合に区別する)
+ * @retval	1	eglMakeCurrentを実行した
+ * @retval	0	カレントのsurfaceと同じため省略した
+ * @retval	GLV_ERROR	eglMakeCurrentに失敗した
+ */
+int glvGl_MakeCurrent(EGLSurface egl_surf,size_t surfaceId)
+{
+	THREAD_SAFE_BUFFER_t *thread_buffer = get_thread_safe_buffer();
+
+	if((thread_buffer->currentValid == 1) && (thread_buffer->currentSurf == egl_surf) && (thread_buffer->currentSurfaceId == surfaceId)){
+		thread_buffer->makeCurrentStat.skip++;
+		return(0);
+	}
+
+	glvGl_batchFlush(thread_buffer);		// 描画先を切り替える前にバッチ描画の蓄積分を描画
+
+	thread_buffer->makeCurrentStat.call++;
+	if(eglMakeCurrent(thread_buffer->egl_dpy, egl_surf, egl_surf, thread_buffer->egl_ctx) == EGL_FALSE){
+		thread_buffer->currentValid = 0;
+		return(GLV_ERROR);
+	}
+	thread_buffer->currentValid		= 1;
+	thread_buffer->currentSurf		= egl_surf;
+	thread_buffer->currentSurfaceId	= surfaceId;
+	return(1);
+}
+
+/**
+ * @brief		eglMakeCurrentの統計情報を取得する
+ * @param[out]	stat 統計情報
+ * @param[in]	reset 1:取得後にカウンタをクリアする
+ */
+int glvGl_getMakeCurrentStatistics(GLV_GL_MAKE_CURRENT_STAT_t *stat, int reset)
+{
+	THREAD_SAFE_BUFFER_t *thread_buffer = get_thread_safe_buffer();
+
+	if(thread_buffer == NULL){
+		memset(stat, 0, sizeof(GLV_GL_MAKE_CURRENT_STAT_t));
+		return(GLV_ERROR);
+	}
+	memcpy(stat, &thread_buffer->makeCurrentStat, sizeof(GLV_GL_MAKE_CURRENT_STAT_t));
+	if(reset != 0){
+		memset(&thread_buffer->makeCurrentStat, 0, sizeof(GLV_GL_MAKE_CURRENT_STAT_t));
+	}
+	return(GLV_OK);
+}
+
+// =============================================================================
+// ストリーミングVBO
+// =============================================================================
+/**
+ * @brief		頂点配列をストリーミングVBOに書き込む
+ * 				全ての配列を連続した領域に書き込み、glXXXPointerに指定する値をpPtrに返す。
+ * 				クライアント配列モードまたは書き込めない場合は、元のアドレスをそのまま返す。
+ * @param[in]	pData 頂点配列
+ * @param[in]	pSize 頂点配列のサイズ(byte)
+ * @param[in]	num 頂点配列数
+ * @param[out]	pPtr glXXXPointerに指定する値
+ * @return		1:VBOをバインドした(描画後にglvGl_streamEndを呼び出す) 0:クライアント配列
+ */
+static int glvGl_streamBegin(THREAD_SAFE_BUFFER_t *thread_buffer, const void *pData[], const int32_t pSize[], int num, const GLvoid *pPtr[])
+{
+	int32_t total = 0;
+	int32_t offset;
+	int i;
+
+	for(i=0;i<num;i++){
+		pPtr[i] = pData[i];
+		total += (pSize[i] + 3) & ~3;
+	}
+	if((thread_buffer->streamMode != GLV_GL_VERTEX_STREAM_VBO) || (total > GLV_GL_STREAM_SIZE)){
+		return(0);
+	}
+
+	if(thread_buffer->streamVbo == 0){
+		glGenBuffers(1, &thread_buffer->streamVbo);
+		glBindBuffer(GL_ARRAY_BUFFER, thread_buffer->streamVbo);
+		glBufferData(GL_ARRAY_BUFFER, GLV_GL_STREAM_SIZE, NULL, GL_STREAM_DRAW);
+		thread_buffer->streamOffset = 0;
+	}else{
+		glBindBuffer(GL_ARRAY_BUFFER, thread_buffer->streamVbo);
+	}
+
+	if((thread_buffer->streamOffset + total) > GLV_GL_STREAM_SIZE){
+		// 使用中の領域を待たないように、バッファを破棄(orphan)して先頭から使用する
+		glBufferData(GL_ARRAY_BUFFER, GLV_GL_STREAM_SIZE, NULL, GL_STREAM_DRAW);
+		thread_buffer->streamOffset = 0;
+		thread_buffer->streamStat.orphan++;
+	}
+
+	offset = thread_buffer->streamOffset;
+	for(i=0;i<num;i++){
+		if(NULL == pData[i]){
+			continue;
+		}
+		glBufferSubData(GL_ARRAY_BUFFER, offset, pSize[i], pData[i]);
+		pPtr[i] = (const GLvoid*)(intptr_t)offset;
+		offset += (pSize[i] + 3) & ~3;
+	}
+	thread_buffer->streamOffset = offset;
+	thread_buffer->streamStat.upload++;
+	thread_buffer->streamStat.bytes += total;
+
+	return(1);
+}
+
+static void glvGl_streamEnd(int bound)
+{
+	if(bound == 1){
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+}
+
+/**
+ * @brief		動的な頂点配列の描画方法を設定する(呼び出しスレッドのコンテキスト)
+ * @param[in]	mode GLV_GL_VERTEX_CLIENT_ARRAY:クライアント配列 GLV_GL_VERTEX_STREAM_VBO:ストリーミングVBO
+ */
+void glvGl_setVertexStreamMode(int mode)
+{
+	THREAD_SAFE_BUFFER_t *thread_buffer = get_thread_safe_buffer();
+
+	glvGl_batchFlush(thread_buffer);
+	thread_buffer->streamMode = mode;
+}
+
+/**
+ * @brief		ストリーミングVBOの統計情報を取得する
+ * @param[out]	stat 統計情報
+ * @param[in]	reset 1:取得後にカウンタをクリアする
+ */
+int glvGl_getStreamStatistics(GLV_GL_STREAM_STAT_t *stat, int reset)
+{
+	THREAD_SAFE_BUFFER_t *thread_buffer = get_thread_safe_buffer();
+
+	if(thread_buffer == NULL){
+		memset(stat, 0, sizeof(GLV_GL_STREAM_STAT_t));
+		return(GLV_ERROR);
+	}
+	memcpy(stat, &thread_buffer->streamStat, sizeof(GLV_GL_STREAM_STAT_t));
+	if(reset != 0){
+		memset(&thread_buffer->streamStat, 0, sizeof(GLV_GL_STREAM_STAT_t));
+	}
+	return(GLV_OK);
+}
+
+// =============================================================================
+// バッチ描画
+//   glvGl_drawXXXの三角形プリミティブと線プリミティブを、現在のモデルビュー行列で
+//   座標変換した頂点と頂点色に展開して蓄積し、状態が変わる時またはglvSwapBuffersで
+//   まとめて1回のglDrawArrays(GL_TRIANGLES/GL_LINES)で描画する。
+//   線はGL_LINE_STRIP/GL_LINE_LOOPも線分の組に展開してGL_LINESとして蓄積する。
+//   三角形と線が切り替わる時、線の太さが変わる時は蓄積分を描画する。
+//   GL_POINTSはバッチ対象外で、蓄積分を描画してから直接描画する。
+//   蓄積中に直接GL APIで状態(ブレンド,シザー等)を変更する場合は、
+//   先にglvGl_FlushBatchを呼び出すこと。
+// =============================================================================
+static void glvGl_batchFlush(THREAD_SAFE_BUFFER_t *thread_buffer)
+{
+	const void *data[2];
+	int32_t size[2];
+	const GLvoid *ptr[2];
+	int bound;
+	GLint matrixMode;
+	GLfloat lineWidth = 1.0f;
+
+	if(thread_buffer->batchVertexNum == 0){
+		return;
+	}
+
+	// 頂点は座標変換済みなので、モデルビュー行列は単位行列で描画する
+	// (呼び出し元の行列モードに関わらずモデルビュー行列を操作し、後で戻す)
+#ifdef _GLES1_EMULATION
+	matrixMode = es1emu_GetMatrixMode();
+#else
+	glGetIntegerv(GL_MATRIX_MODE, &matrixMode);
+#endif
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+
+	if(thread_buffer->batchPrimitive == GL_LINES){
+		glGetFloatv(GL_LINE_WIDTH, &lineWidth);
+		glLineWidth(thread_buffer->batchLineWidth);
+	}
+
+	glEnableClientState(GL_COLOR_ARRAY);
+
+	data[0] = thread_buffer->batchPos;		size[0] = sizeof(GLV_T_POINT_t) * thread_buffer->batchVertexNum;
+	data[1] = thread_buffer->batchColor;	size[1] = sizeof(GLV_T_Color_t) * thread_buffer->batchVertexNum;
+	bound = glvGl_streamBegin(thread_buffer, data, size, 2, ptr);
+
+	glVertexPointer(2, GL_FLOAT, 0, ptr[0]);
+	glColorPointer(4, GL_UNSIGNED_BYTE, 0, ptr[1]);
+
+#ifdef _GLES1_EMULATION
+	es1emu_LoadMatrix();
+#endif
+
+	glDrawArrays(thread_buffer->batchPrimitive, 0, thread_buffer->batchVertexNum);
+
+	glvGl_streamEnd(bound);
+
+	glDisableClientState(GL_COLOR_ARRAY);
+
+	if(thread_buffer->batchPrimitive == GL_LINES){
+		glLineWidth(lineWidth);
+	}
+
+	glPopMatrix();
+	glMatrixMode((GLenum)matrixMode);
+
+	thread_buffer->batchStat.flush++;
+	thread_buffer->batchVertexNum = 0;
+}
+
+static int glvGl_batchIsTriangles(const int32_t mode)
+{
+	return(((mode == GL_TRIANGLES) || (mode == GL_TRIANGLE_STRIP) || (mode == GL_TRIANGLE_FAN))?(1):(0));
+}
+
+static int glvGl_batchIsLines(const int32_t mode)
+{
+	return(((mode == GL_LINES) || (mode == GL_LINE_STRIP) || (mode == GL_LINE_LOOP))?(1):(0));
+}
+
+/**
+ * @brief		三角形プリミティブ,線プリミティブをバッチに追加
+ * @param[in]	mode 描画モード(GL_TRIANGLES/GL_TRIANGLE_STRIP/GL_TRIANGLE_FAN/GL_LINES/GL_LINE_STRIP/GL_LINE_LOOP)
+ * @param[in]	pPos 頂点座標
+ * @param[in]	pColor 頂点に対応した色(NULL:現在の色)
+ * @param[in]	cnt 頂点座標数
+ * @param[in]	lineWidth 線の太さ(線プリミティブのみ)
+ */
+static void glvGl_batchAdd(THREAD_SAFE_BUFFER_t *thread_buffer, const int32_t mode, const GLV_T_POINT_t* pPos, const GLV_T_Color_t* pColor, int32_t cnt, float lineWidth)
+{
+	float m[16];
+	float rgba[4];
+	GLV_T_Color_t color;
+	int32_t primitive,vertexNum,primNum,i,k,index[MP_TRIANGLE_CNT];
+	GLV_T_POINT_t *pOut;
+	GLV_T_Color_t *pOutColor;
+
+	if(glvGl_batchIsTriangles(mode) == 1){
+		primitive = GL_TRIANGLES;
+		vertexNum = MP_TRIANGLE_CNT;
+		if(cnt < MP_TRIANGLE_CNT){
+			return;
+		}
+		primNum = (mode == GL_TRIANGLES)?(cnt / MP_TRIANGLE_CNT):(cnt - 2);
+	}else{
+		primitive = GL_LINES;
+		vertexNum = 2;
+		if(cnt < 2){
+			return;
+		}
+		if(mode == GL_LINES){
+			primNum = cnt / 2;
+		}else if(mode == GL_LINE_STRIP){
+			primNum = cnt - 1;
+		}else{
+			// GL_LINE_LOOP
+			primNum = cnt;
+		}
+	}
+
+	if(thread_buffer->batchVertexNum > 0){
+		if((thread_buffer->batchPrimitive != primitive) ||
+			((primitive == GL_LINES) && (thread_buffer->batchLineWidth != lineWidth))){
+			glvGl_batchFlush(thread_buffer);
+		}
+	}
+	thread_buffer->batchPrimitive = primitive;
+	thread_buffer->batchLineWidth = lineWidth;
+
+#ifdef _GLES1_EMULATION
+	es1emu_GetModelViewMatrix(m);
+	if(NULL == pColor){
+		es1emu_GetColor(rgba);
+	}
+#else
+	glGetFloatv(GL_MODELVIEW_MATRIX, m);
+	if(NULL == pColor){
+		glGetFloatv(GL_CURRENT_COLOR, rgba);
+	}
+#endif
+	if(NULL == pColor){
+		color.r = (uint8_t)(rgba[0] * 255.0f + 0.5f);
+		color.g = (uint8_t)(rgba[1] * 255.0f + 0.5f);
+		color.b = (uint8_t)(rgba[2] * 255.0f + 0.5f);
+		color.a = (uint8_t)(rgba[3] * 255.0f + 0.5f);
+	}
+
+	for(i=0;i<primNum;i++){
+		if((thread_buffer->batchVertexNum + vertexNum) > GLV_GL_BATCH_VERTEX_MAX){
+			glvGl_batchFlush(thread_buffer);
+		}
+		if(mode == GL_LINES){
+			index[0] = i * 2;
+			index[1] = i * 2 + 1;
+		}else if(mode == GL_LINE_STRIP){
+			index[0] = i;
+			index[1] = i + 1;
+		}else if(mode == GL_LINE_LOOP){
+			index[0] = i;
+			index[1] = (i + 1) % cnt;
+		}else if(mode == GL_TRIANGLES){
+			index[0] = i * 3;
+			index[1] = i * 3 + 1;
+			index[2] = i * 3 + 2;
+		}else if(mode == GL_TRIANGLE_STRIP){
+			index[0] = i;
+			index[1] = i + 1;
+			index[2] = i + 2;
+		}else{
+			// GL_TRIANGLE_FAN
+			index[0] = 0;
+			index[1] = i + 1;
+			index[2] = i + 2;
+		}
+		pOut		= &thread_buffer->batchPos[thread_buffer->batchVertexNum];
+		pOutColor	= &thread_buffer->batchColor[thread_buffer->batchVertexNum];
+		for(k=0;k<vertexNum;k++){
+			// 列優先(m[列*4+行])
+			pOut[k].x = m[0] * pPos[index[k]].x + m[4] * pPos[index[k]].y + m[12];
+			pOut[k].y = m[1] * pPos[index[k]].x + m[5] * pPos[index[k]].y + m[13];
+			pOutColor[k] = (NULL == pColor)?(color):(pColor[index[k]]);
+		}
+		thread_buffer->batchVertexNum += vertexNum;
+	}
+	thread_buffer->batchStat.primitive++;
+	thread_buffer->batchStat.vertex += primNum * vertexNum;
+}
+
+/**
+ * @brief		バッチ描画の有効/無効を設定する(呼び出しスレッドのコンテキスト)
+ * @param[in]	enable 1:有効 0:無効(蓄積分は描画する)
+ */
+void glvGl_setBatchMode(int enable)
+{
+	THREAD_SAFE_BUFFER_t *thread_buffer = get_thread_safe_buffer();
+
+	glvGl_batchFlush(thread_buffer);
+	thread_buffer->batchMode = (enable != 0)?(1):(0);
+}
+
+/**
+ * @brief		バッチ描画の蓄積分を描画する
+ */
+void glvGl_FlushBatch(void)
+{
+	THREAD_SAFE_BUFFER_t *thread_buffer = get_thread_safe_buffer();
+
+	if(thread_buffer == NULL){
+		return;
+	}
+	glvGl_batchFlush(thread_buffer);
+}
+
+/**
+ * @brief		バッチ描画の統計情報を取得する
+ * @param[out]	stat 統計情報
+ * @param[in]	reset 1:取得後にカウンタをクリアする
+ */
+int glvGl_getBatchStatistics(GLV_GL_BATCH_STAT_t *stat, int reset)
+{
+	THREAD_SAFE_BUFFER_t *thread_buffer = get_thread_safe_buffer();
+
+	if(thread_buffer == NULL){
+		memset(stat, 0, sizeof(GLV_GL_BATCH_STAT_t));
+		return(GLV_ERROR);
+	}
+	memcpy(stat, &thread_buffer->batchStat, sizeof(GLV_GL_BATCH_STAT_t));
+	if(reset != 0){
+		memset(&thread_buffer->batchStat, 0, sizeof(GLV_GL_BATCH_STAT_t));
+	}
+	return(GLV_OK);
+}
+
 /**
  * @brief		初期化
  */
@@ -286,13 +726,39 @@ float glvGl_degree(const GLV_T_POINT_t *v0, const GLV_T_POINT_t *v1)
  */
 void glvGl_draw(const int32_t mode, const GLV_T_POINT_t* pPos, int32_t cnt)
 {
-	glVertexPointer(2, GL_FLOAT, 0, pPos);
+	THREAD_SAFE_BUFFER_t *thread_buffer = get_thread_safe_buffer();
+	const void *data[1];
+	int32_t size[1];
+	const GLvoid *ptr[1];
+	int bound;
+
+	GLfloat lineWidth = 1.0f;
+
+	if(thread_buffer->batchMode == 1){
+		if(glvGl_batchIsTriangles(mode) == 1){
+			glvGl_batchAdd(thread_buffer, mode, pPos, NULL, cnt, lineWidth);
+			return;
+		}
+		if(glvGl_batchIsLines(mode) == 1){
+			glGetFloatv(GL_LINE_WIDTH, &lineWidth);
+			glvGl_batchAdd(thread_buffer, mode, pPos, NULL, cnt, lineWidth);
+			return;
+		}
+		glvGl_batchFlush(thread_buffer);
+	}
+
+	data[0] = pPos;		size[0] = sizeof(GLV_T_POINT_t) * cnt;
+	bound = glvGl_streamBegin(thread_buffer, data, size, 1, ptr);
+
+	glVertexPointer(2, GL_FLOAT, 0, ptr[0]);
 
 #ifdef _GLES1_EMULATION
 	es1emu_LoadMatrix();
 #endif
 
 	glDrawArrays(mode, 0, cnt);
+
+	glvGl_streamEnd(bound);
 }
 
 /**
@@ -303,6 +769,13 @@ void glvGl_draw(const int32_t mode, const GLV_T_POINT_t* pPos, int32_t cnt)
  */
 void glvGl_drawLineStrip(const GLV_T_POINT_t* pPos, int32_t cnt, float width)
 {
+	THREAD_SAFE_BUFFER_t *thread_buffer = get_thread_safe_buffer();
+
+	if(thread_buffer->batchMode == 1){
+		glvGl_batchAdd(thread_buffer, GL_LINE_STRIP, pPos, NULL, cnt, width);
+		return;
+	}
+
 	glLineWidth(width);
 	glvGl_draw(GL_LINE_STRIP, pPos, cnt);
 }
@@ -673,10 +1146,35 @@ void glvGl_degenerateTriangleShift(const GLV_T_POINT_t* pPos, int32_t pointCnt,
  */
 void glvGl_drawColor(const int32_t mode, const GLV_T_POINT_t* pPos, const GLV_T_Color_t* pColor, int32_t cnt)
 {
+	THREAD_SAFE_BUFFER_t *thread_buffer = get_thread_safe_buffer();
+	const void *data[2];
+	int32_t size[2];
+	const GLvoid *ptr[2];
+	int bound;
+
+	GLfloat lineWidth = 1.0f;
+
+	if(thread_buffer->batchMode == 1){
+		if(glvGl_batchIsTriangles(mode) == 1){
+			glvGl_batchAdd(thread_buffer, mode, pPos, pColor, cnt, lineWidth);
+			return;
+		}
+		if(glvGl_batchIsLines(mode) == 1){
+			glGetFloatv(GL_LINE_WIDTH, &lineWidth);
+			glvGl_batchAdd(thread_buffer, mode, pPos, pColor, cnt, lineWidth);
+			return;
+		}
+		glvGl_batchFlush(thread_buffer);
+	}
+
 	glEnableClientState(GL_COLOR_ARRAY);
 
-	glVertexPointer(2, GL_FLOAT, 0, pPos);
-	glColorPointer(4, GL_UNSIGNED_BYTE, 0, pColor);
+	data[0] = pPos;		size[0] = sizeof(GLV_T_POINT_t) * cnt;
+	data[1] = pColor;	size[1] = sizeof(GLV_T_Color_t) * cnt;
+	bound = glvGl_streamBegin(thread_buffer, data, size, 2, ptr);
+
+	glVertexPointer(2, GL_FLOAT, 0, ptr[0]);
+	glColorPointer(4, GL_UNSIGNED_BYTE, 0, ptr[1]);
 
 #ifdef _GLES1_EMULATION
 	es1emu_LoadMatrix();
@@ -684,6 +1182,8 @@ void glvGl_drawColor(const int32_t mode, const GLV_T_POINT_t* pPos, const GLV_T_
 
 	glDrawArrays(mode, 0, cnt);
 
+	glvGl_streamEnd(bound);
+
 	glDisableClientState(GL_COLOR_ARRAY);
 }
 
@@ -745,10 +1245,28 @@ int glvGl_SetVBO(GLV_T_VBO_INFO_t *pVbo, const GLV_T_POINT_t *pPoint, const GLV_
 
 	pVbo->type = GL_TRIANGLES;
 
+	if((GLV_GL_VBO_DYNAMIC == pVbo->usage) && (0 != pVbo->vboID)){
+		// 動的更新:既存のバッファを再利用する
+		glBindBuffer(GL_ARRAY_BUFFER, pVbo->vboID);
+		if(pVbo->pointCnt > pVbo->capacity){
+			pVbo->capacity = pVbo->pointCnt;
+		}
+		// 描画中のデータを待たないように、バッファを破棄(orphan)してから書き込む
+		pointSize = sizeof(GLV_T_POINT_t) * pVbo->capacity;
+		colorSize = sizeof(GLV_T_Color_t) * pVbo->pointCnt;
+		glBufferData(GL_ARRAY_BUFFER, (pointSize + sizeof(GLV_T_Color_t) * pVbo->capacity), NULL, GL_DYNAMIC_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0,         sizeof(GLV_T_POINT_t) * pVbo->pointCnt, pPoint);	// 頂点
+		glBufferSubData(GL_ARRAY_BUFFER, pointSize, colorSize, pColor);							// 色
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		return (1);
+	}
+
+	pVbo->capacity = pVbo->pointCnt;
+
 	glGenBuffers(1, &pVbo->vboID);
 	glBindBuffer(GL_ARRAY_BUFFER, pVbo->vboID);
 
-	glBufferData(GL_ARRAY_BUFFER, (pointSize + colorSize), NULL, GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, (pointSize + colorSize), NULL, (GLV_GL_VBO_DYNAMIC == pVbo->usage)?(GL_DYNAMIC_DRAW):(GL_STATIC_DRAW));
 	glBufferSubData(GL_ARRAY_BUFFER, 0,         pointSize, pPoint);	// 頂点
 	glBufferSubData(GL_ARRAY_BUFFER, pointSize, colorSize, pColor);	// 色
 
@@ -767,6 +1285,7 @@ int glvGl_DeleteVBO(GLV_T_VBO_INFO_t *pVbo)
 	glDeleteBuffers(1, &pVbo->vboID);
 	pVbo->vboID = 0;
 	pVbo->pointCnt = 0;
+	pVbo->capacity = 0;
 	pVbo->type = 0;
 
 	return (1);
@@ -779,6 +1298,8 @@ int glvGl_DeleteVBO(GLV_T_VBO_INFO_t *pVbo)
  */
 int glvGl_DrawVBO(const GLV_T_VBO_INFO_t *pVbo)
 {
+	glvGl_FlushBatch();
+
 	if (0 == pVbo->vboID){
 		return (0);
 	}
@@ -788,7 +1309,7 @@ int glvGl_DrawVBO(const GLV_T_VBO_INFO_t *pVbo)
 	glBindBuffer(GL_ARRAY_BUFFER, pVbo->vboID);
 
 	glVertexPointer(2, GL_FLOAT, 0, 0);
-	glColorPointer(4, GL_UNSIGNED_BYTE, 0, (void*)(sizeof(GLV_T_POINT_t) * pVbo->pointCnt));
+	glColorPointer(4, GL_UNSIGNED_BYTE, 0, (void*)(sizeof(GLV_T_POINT_t) * pVbo->capacity));
 
 #ifdef _GLES1_EMULATION
 	es1emu_LoadMatrix();
@@ -836,6 +1357,29 @@ uint32_t glvGl_GenTextures(const uint8_t* pByteArray, int32_t width, int32_t hei
 	return ((uint32_t)textureID);
 }
 
+/**
+ * @brief		テクスチャ部分更新
+ * @param[in]	textureId テクスチャID
+ * @param[in]	x 更新領域X座標
+ * @param[in]	y 更新領域Y座標
+ * @param[in]	width 更新領域幅
+ * @param[in]	height 更新領域高さ
+ * @param[in]	pByteArray RGBA画素
+ */
+void glvGl_TexSubImage(uint32_t textureId, int32_t x, int32_t y, int32_t width, int32_t height, const uint8_t* pByteArray)
+{
+	if((0 == textureId) || (NULL == pByteArray)) {
+		return;
+	}
+
+#ifdef _GLES1_EMULATION
+	glActiveTexture(GL_TEXTURE0);
+#endif
+
+	glBindTexture(GL_TEXTURE_2D, textureId);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, (GLint)x, (GLint)y, (GLsizei)width, (GLsizei)height, GL_RGBA, GL_UNSIGNED_BYTE, (GLvoid*)pByteArray);
+}
+
 /**
  * @brief		テクスチャ解放
  */
@@ -857,6 +1401,8 @@ void glvGl_DrawTextures(uint32_t pTextureID, const GLV_T_POINT_t *pSquares)
 		{1.0f, 1.0f}
 	};
 
+	glvGl_FlushBatch();
+
 	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 
 	glEnable(GL_TEXTURE_2D);
@@ -877,6 +1423,68 @@ void glvGl_DrawTextures(uint32_t pTextureID, const GLV_T_POINT_t *pSquares)
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 }
 
+/**
+ * @brief		テクスチャ描画(頂点配列指定)
+ * 				pColorを指定した場合は、テクスチャ色と頂点色を乗算(GL_MODULATE)する
+ * @param[in]	textureId テクスチャID
+ * @param[in]	mode 描画モード
+ * @param[in]	pPos 頂点座標
+ * @param[in]	pCoords テクスチャ座標
+ * @param[in]	pColor 頂点に対応した色(NULL:テクスチャ色をそのまま使用)
+ * @param[in]	cnt 頂点座標数
+ */
+void glvGl_DrawTexturesArray(uint32_t textureId, const int32_t mode, const GLV_T_POINT_t *pPos, const GLV_T_POINT_t *pCoords, const GLV_T_Color_t *pColor, int32_t cnt)
+{
+	THREAD_SAFE_BUFFER_t *thread_buffer = get_thread_safe_buffer();
+	const void *data[3];
+	int32_t size[3];
+	const GLvoid *ptr[3];
+	int bound;
+
+	if(cnt <= 0){
+		return;
+	}
+
+	glvGl_FlushBatch();
+
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	if(NULL != pColor){
+		glEnableClientState(GL_COLOR_ARRAY);
+		glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+	}
+
+	glEnable(GL_TEXTURE_2D);
+
+	glBindTexture(GL_TEXTURE_2D, textureId);
+
+	data[0] = pPos;		size[0] = sizeof(GLV_T_POINT_t) * cnt;
+	data[1] = pCoords;	size[1] = sizeof(GLV_T_POINT_t) * cnt;
+	data[2] = pColor;	size[2] = (NULL != pColor)?(sizeof(GLV_T_Color_t) * cnt):(0);
+	bound = glvGl_streamBegin(thread_buffer, data, size, 3, ptr);
+
+	glVertexPointer(2, GL_FLOAT, 0, ptr[0]);
+	glTexCoordPointer(2, GL_FLOAT, 0, ptr[1]);
+	if(NULL != pColor){
+		glColorPointer(4, GL_UNSIGNED_BYTE, 0, ptr[2]);
+	}
+
+#ifdef _GLES1_EMULATION
+	es1emu_LoadMatrix();
+#endif
+
+	glDrawArrays(mode, 0, cnt);
+
+	glvGl_streamEnd(bound);
+
+	glDisable(GL_TEXTURE_2D);
+
+	if(NULL != pColor){
+		glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+		glDisableClientState(GL_COLOR_ARRAY);
+	}
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+}
+
 void glvGl_DrawTexturesEx(uint32_t textureId,float x, float y, float width, float height, float spot_x, float spot_y, float rotation)
 {
 	GLV_T_POINT_t squares[4] = {
@@ -915,6 +1523,8 @@ void glvGl_LoadIdentity()
  */
 void glvGl_Viewport(int32_t x, int32_t y, int32_t width, int32_t height)
 {
+	glvGl_FlushBatch();
+
 	glViewport(x, y, width, height);
 }
 
@@ -931,6 +1541,8 @@ void glvGl_ClearColor(float r, float g, float b, float a)
  */
 void glvGl_Clear(uint32_t mask)
 {
+	glvGl_FlushBatch();
+
 	glClear(mask);
 }
 
@@ -965,6 +1577,12 @@ void glvGl_ColorRGBATrans(GLV_RGBACOLOR rgba, float a)
  */
 void glvGl_BeginBlend()
 {
+	THREAD_SAFE_BUFFER_t *thread_buffer = get_thread_safe_buffer();
+
+	if(thread_buffer->blend != 1){
+		glvGl_batchFlush(thread_buffer);
+		thread_buffer->blend = 1;
+	}
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
@@ -974,6 +1592,12 @@ void glvGl_BeginBlend()
  */
 void glvGl_EndBlend()
 {
+	THREAD_SAFE_BUFFER_t *thread_buffer = get_thread_safe_buffer();
+
+	if(thread_buffer->blend != 0){
+		glvGl_batchFlush(thread_buffer);
+		thread_buffer->blend = 0;
+	}
 	glDisable(GL_BLEND);
 }
 
@@ -1022,6 +1646,8 @@ void glvGl_Scalef(float x, float y, float z)
  */
 void glvGl_MatrixProjection()
 {
+	glvGl_FlushBatch();
+
 	// プロジェクション行列の設定
 	glMatrixMode(GL_PROJECTION);
 	glLoadIdentity();
@@ -1042,6 +1668,8 @@ void glvGl_MatrixModelView()
  */
 void glvGl_Flush()
 {
+	glvGl_FlushBatch();
+
 	glFlush();
 }
 
@@ -1050,6 +1678,8 @@ void glvGl_Flush()
  */
 void glvGl_Orthof(float left, float right, float bottom, float top, float zNear, float zFar)
 {
+	glvGl_FlushBatch();
+
 #ifdef _GLES1_EMULATION
 	glOrthof(left, right, bottom, top, zNear, zFar);
 #else
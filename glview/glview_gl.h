@@ -51,8 +51,37 @@ typedef struct glv_VBO_INFO {
 	uint32_t	vboID;			// VBO ID
 	uint32_t	type;			// 頂点タイプ(GL_TRIANGLES, GL_TRIANGLE_STRIP)
 	int32_t	pointCnt;		// 頂点座標数
+	int32_t	usage;			// GLV_GL_VBO_STATIC/GLV_GL_VBO_DYNAMIC(glvGl_SetVBOで既存のVBOを更新する)
+	int32_t	capacity;		// 確保済み頂点座標数
 } GLV_T_VBO_INFO_t;
 
+#define GLV_GL_VBO_STATIC			(0)
+#define GLV_GL_VBO_DYNAMIC			(1)
+
+// 動的な頂点配列の描画方法
+#define GLV_GL_VERTEX_CLIENT_ARRAY	(0)		// クライアント配列
+#define GLV_GL_VERTEX_STREAM_VBO	(1)		// ストリーミングVBO
+
+// ストリーミングVBO統計情報
+typedef struct glv_GL_STREAM_STAT {
+	uint64_t	upload;			// 書き込み回数
+	uint64_t	bytes;			// 書き込みサイズ(byte)
+	uint64_t	orphan;			// バッファ破棄回数
+} GLV_GL_STREAM_STAT_t;
+
+// バッチ描画統計情報
+typedef struct glv_GL_BATCH_STAT {
+	uint64_t	primitive;		// 蓄積したプリミティブ数
+	uint64_t	vertex;			// 蓄積した頂点数
+	uint64_t	flush;			// 描画(glDrawArrays)回数
+} GLV_GL_BATCH_STAT_t;
+
+// eglMakeCurrent統計情報
+typedef struct glv_GL_MAKE_CURRENT_STAT {
+	uint64_t	call;			// eglMakeCurrent実行回数
+	uint64_t	skip;			// カレントのsurfaceと同じため省略した回数
+} GLV_GL_MAKE_CURRENT_STAT_t;
+
 // カラー
 typedef uint32_t				GLV_RGBACOLOR;	// カラーRGBA値
 
@@ -109,12 +138,21 @@ int glvGl_DeleteVBO(GLV_T_VBO_INFO_t *pVbo);
 int glvGl_DrawVBO(const GLV_T_VBO_INFO_t *pVbo);
 
 uint32_t glvGl_GenTextures(const uint8_t* pByteArray, int32_t width, int32_t height);
+void glvGl_TexSubImage(uint32_t textureId, int32_t x, int32_t y, int32_t width, int32_t height, const uint8_t* pByteArray);
 void glvGl_DeleteTextures(uint32_t *pTextureID);
 void glvGl_DrawTextures(uint32_t textureId, const GLV_T_POINT_t *pSquares);
+void glvGl_DrawTexturesArray(uint32_t textureId, const int32_t mode, const GLV_T_POINT_t *pPos, const GLV_T_POINT_t *pCoords, const GLV_T_Color_t *pColor, int32_t cnt);
 void glvGl_DrawTexturesEx(uint32_t textureId,float x, float y, float width, float height, float spot_x, float spot_y, float rotation);
 
 void glvGl_thread_safe_init(void);
 
+void glvGl_thread_safe_finish(void);
+void glvGl_setVertexStreamMode(int mode);
+int glvGl_getStreamStatistics(GLV_GL_STREAM_STAT_t *stat, int reset);
+void glvGl_setBatchMode(int enable);
+void glvGl_FlushBatch(void);
+int glvGl_getBatchStatistics(GLV_GL_BATCH_STAT_t *stat, int reset);
+
 void glvGl_init(void);
 void glvGl_ColorRGBA(GLV_RGBACOLOR rgba);
 void glvGl_ColorRGBATrans(GLV_RGBACOLOR rgba, float a);
@@ -139,6 +177,8 @@ void glvGl_Translatef(float x, float y, float z);
 void glvGl_setEglContextInfo(EGLDisplay egl_dpy,EGLContext egl_ctx);
 EGLContext glvGl_GetEglContext(void);
 EGLDisplay glvGl_GetEglDisplay(void);
+int glvGl_MakeCurrent(EGLSurface egl_surf,size_t surfaceId);
+int glvGl_getMakeCurrentStatistics(GLV_GL_MAKE_CURRENT_STAT_t *stat, int reset);
 
 #ifdef __cplusplus
 }
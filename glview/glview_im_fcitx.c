@@ -208,11 +208,10 @@ static void commit_string(FcitxClient *client, char *str, void *data)
 	fcitx_text_len = strlen(str); // バイト数
 
 	if(fcitx_text_len == 0){
-		GLV_IF_DEBUG_IME_INPUT printf("hide_preedit_text do nothing\n");
+		GLV_LOG_DEBUG(GLV_DEBUG_IME_INPUT,"hide_preedit_text do nothing\n");
 		/* do nothing */
 	}else{
-		GLV_IF_DEBUG_IME_INPUT printf("commit_text = [%s] length = %ld\n",str,strlen(str));
-		printf("commit_text = [%s] length = %ld\n",str,strlen(str));
+		GLV_LOG_DEBUG(GLV_DEBUG_IME_INPUT,"commit_text = [%s] length = %ld\n",str,strlen(str));
 
 		utf32_string = malloc(sizeof(int) * (fcitx_text_len + 1));
 		utf32_length = glvFont_string_to_utf32(str,strlen(str),utf32_string,fcitx_text_len);
@@ -367,8 +366,7 @@ static void close_im(FcitxClient *client, void *data) { disconnected(client, dat
 
 static void forward_key(FcitxClient *client, guint keyval, guint state, gint type, void *data)
 {
-	GLV_IF_DEBUG_IME_INPUT printf("forward_key_event state = %x , keyval = %d\n",state,keyval + 8);
-	printf("forward_key_event state = %x , keyval = %d\n",state,keyval + 8);
+	GLV_LOG_DEBUG(GLV_DEBUG_IME_INPUT,"forward_key_event state = %x , keyval = %d\n",state,keyval + 8);
 }
 
 int glv_ime_setIMECandidatePotition(int candidate_pos_x,int candidate_pos_y)
@@ -461,8 +459,7 @@ int glv_ime_startFcitx(struct _glvinput *glv_input)
 	glv_input->ime_key_modifiers = glv_ime_key_modifiers;
 	glv_input->glv_dpy->ime_setCandidatePotition = glv_ime_setIMECandidatePotition;
 
-	GLV_IF_DEBUG_IME_INPUT printf("glv_ime_startFcitx:start.\n");
-	printf("glv_ime_startFcitx:start.\n");
+	GLV_LOG_DEBUG(GLV_DEBUG_IME_INPUT,"glv_ime_startFcitx:start.\n");
 
     //fcitx_client_enable_ic(fcitx->client);
 	//fcitx_client_focus_in(fcitx->client);
@@ -62,7 +62,7 @@ static void update_preedit_text(IBusInputContext *context, IBusText *text, gint
 	//printf("update_preedit_text: len = %d %ld\n",len,strlen(text->text));
 
 	utf32_length = glvFont_string_to_utf32(text->text,strlen(text->text),utf32_string,ibus_text_len);
-	GLV_IF_DEBUG_IME_INPUT printf("update_preedit_text: ibus = %d strlen = %ld utf32 = %d\n",ibus_text_len,strlen(text->text),utf32_length);
+	GLV_LOG_DEBUG(GLV_DEBUG_IME_INPUT,"update_preedit_text: ibus = %d strlen = %ld utf32 = %d\n",ibus_text_len,strlen(text->text),utf32_length);
 	if(utf32_length != ibus_text_len){
 		printf("update_preedit_text:utf32の文字数が異常 len = %d %d\n",ibus_text_len,utf32_length);
 	}
@@ -85,7 +85,7 @@ static void update_preedit_text(IBusInputContext *context, IBusText *text, gint
 	utf32_attr[index] = is_underlined + is_reverse_color;
   }
 
-	GLV_IF_DEBUG_IME_INPUT printf("update_preedit_text = [%s]\n",text->text);
+	GLV_LOG_DEBUG(GLV_DEBUG_IME_INPUT,"update_preedit_text = [%s]\n",text->text);
 	ibus_im_preedit_filled_len = ibus_text_len;
 	glv_input->im_state = GLV_KEY_STATE_IM_PREEDIT;
 	_glvOnTextInput((glvDisplay)glv_input->glv_dpy,GLV_KEY_KIND_IM,GLV_KEY_STATE_IM_PREEDIT,0,utf32_string,utf32_attr,utf32_length);
@@ -96,7 +96,7 @@ static void update_preedit_text(IBusInputContext *context, IBusText *text, gint
 static void hide_preedit_text(IBusInputContext *context, gpointer data)
 {
 	struct _glvinput *glv_input = data;
-	GLV_IF_DEBUG_IME_INPUT printf("hide_preedit_text\n");
+	GLV_LOG_DEBUG(GLV_DEBUG_IME_INPUT,"hide_preedit_text\n");
 	ibus_im_preedit_filled_len = 0;
 	glv_input->im_state = GLV_KEY_STATE_IM_HIDE;
 	_glvOnTextInput((glvDisplay)glv_input->glv_dpy,GLV_KEY_KIND_IM,GLV_KEY_STATE_IM_PREEDIT,0,NULL,NULL,0);
@@ -114,10 +114,10 @@ static void commit_text(IBusInputContext *context, IBusText *text, gpointer data
 	ibus_text_len = ibus_text_get_length(text); // バイト数ではなく、文字数
 
 	if(ibus_text_len == 0){
-		GLV_IF_DEBUG_IME_INPUT printf("hide_preedit_text do nothing\n");
+		GLV_LOG_DEBUG(GLV_DEBUG_IME_INPUT,"hide_preedit_text do nothing\n");
 		/* do nothing */
 	}else{
-		GLV_IF_DEBUG_IME_INPUT printf("commit_text = [%s] length = %ld\n",text->text,strlen(text->text));
+		GLV_LOG_DEBUG(GLV_DEBUG_IME_INPUT,"commit_text = [%s] length = %ld\n",text->text,strlen(text->text));
 		//printf("commit_text = [%02x][%02x][%02x] length = %d\n",text->text[0],text->text[1],text->text[2],strlen(text->text));
 
 		utf32_string = malloc(sizeof(int) * (ibus_text_len + 1));
@@ -130,7 +130,7 @@ static void commit_text(IBusInputContext *context, IBusText *text, gpointer data
 
 static void forward_key_event(IBusInputContext *context, guint keyval, guint keycode, guint state,gpointer data)
 {
-	GLV_IF_DEBUG_IME_INPUT printf("forward_key_event state = %x , keycode = %d\n",state,keycode);
+	GLV_LOG_DEBUG(GLV_DEBUG_IME_INPUT,"forward_key_event state = %x , keycode = %d\n",state,keycode);
 }
 
 static void connection_handler(struct task *task, uint32_t events)
@@ -245,7 +245,7 @@ static int glv_ime_key_event(struct _glvinput *glv_input,int keycode, int ksym,
 static void set_engine(IBusInputContext *context, gchar *name)
 {
 
-	GLV_IF_DEBUG_IME_INPUT printf("iBus engine %s -> %s\n",ibus_engine_desc_get_name(ibus_input_context_get_engine(context)), name);
+	GLV_LOG_DEBUG(GLV_DEBUG_IME_INPUT,"iBus engine %s -> %s\n",ibus_engine_desc_get_name(ibus_input_context_get_engine(context)), name);
 	ibus_input_context_set_engine(context, name);
 }
 
@@ -268,7 +268,7 @@ static IBusInputContext *context_new(struct _glvinput *glv_input,im_ibus_t *ibus
 		set_engine(context, engine);
 	}
 
-	GLV_IF_DEBUG_IME_INPUT printf("Engine is %s in context_new()\n",ibus_engine_desc_get_name(ibus_input_context_get_engine(context)));
+	GLV_LOG_DEBUG(GLV_DEBUG_IME_INPUT,"Engine is %s in context_new()\n",ibus_engine_desc_get_name(ibus_input_context_get_engine(context)));
 
 	//printf("Engine is %s in context_new()\n",ibus_engine_desc_get_name(ibus_input_context_get_engine(context)));
 
@@ -362,7 +362,7 @@ int glv_ime_startIbus(struct _glvinput *glv_input)
 
  	glv_list_insert_head(ibus_list, ibus);
 
-	GLV_IF_DEBUG_IME_INPUT printf("glv_ime_startIbus:start.\n");
+	GLV_LOG_DEBUG(GLV_DEBUG_IME_INPUT,"glv_ime_startIbus:start.\n");
 
 	return(GLV_OK);
 }
@@ -30,6 +30,26 @@ extern "C" {
 
 #define GLV_TEST__THIN_OUT_DRAWING		// 描画要求を連続に要求されている場合、その描画を間引く
 #define GLV_PTHREAD_MUTEX_RECURSIVE		// リソースの排他制御のリカーシブコールを有効とする
+#define GLV_COALESCE_POINTER_EVENT		// 未処理のマウス移動・ホイールのメッセージを集約する
+#define GLV_FRAME_SCHEDULER				// 描画要求を集約し、frame callback毎に最大1回描画する
+#define GLV_INSTANCE_ID_MAP				// インスタンスIDからの検索にハッシュテーブルを使用する
+#define GLV_LAZY_MAKE_CURRENT			// 描画しないメッセージではsurfaceが切り替わる場合のみeglMakeCurrentする
+#define GLV_HEADLESS_BACKEND			// コンポジターを使用しないheadlessバックエンド(pbuffer)を選択可能にする
+#define GLV_TRACE						// メッセージ処理とフレームのタイミングを記録可能にする(GLVIEW_TRACE=<file>で有効)
+
+#define GLV_FRAME_REQ_UPDATE			(1)		// 描画要求:update
+#define GLV_FRAME_REQ_REDRAW			(2)		// 描画要求:redraw
+#define GLV_FRAME_MSG_SCHEDULED			(1)		// スケジューラが送信した描画メッセージ(data[2])
+#define GLV_FRAME_CALLBACK_TIMEOUT		(500)	// frame callbackが返ってこない場合に次の描画を許可するまでの時間(ms)
+
+#define GLV_INSTANCE_ID_MAP_INIT_SIZE	(256)	// インスタンスIDのハッシュテーブルの初期サイズ(2のべき乗)
+
+#define GLV_DAMAGE_HISTORY_NUM			(4)		// buffer ageで参照する過去フレームの更新領域の数
+#define GLV_DAMAGE_MERGE_WASTE			(25)	// 外接矩形で増える面積が元の面積のこの割合(%)以下なら矩形をまとめる
+
+#define GLV_TRACE_RING_SIZE				(16384)	// トレースを記録するスレッド毎のリングバッファのイベント数
+
+typedef EGLBoolean (*GLV_EGL_SWAP_BUFFERS_WITH_DAMAGE_t)(EGLDisplay dpy,EGLSurface surface,EGLint *rects,EGLint n_rects);
 
 #define GLV_INSTANCE_TYPE_DISPLAY	(0x10102020)
 #define GLV_INSTANCE_TYPE_WINDOW	(0x30304040)
@@ -155,6 +175,8 @@ typedef struct _glv_display {
 	EGLConfig				egl_config_normal;
 	EGLConfig				egl_config_beauty;
 	EGLint					vid;
+	GLV_EGL_SWAP_BUFFERS_WITH_DAMAGE_t	egl_swapBuffersWithDamage;	// EGL_KHR/EXT_swap_buffers_with_damage
+	int						egl_bufferAge;			// 1:EGL_EXT_buffer_ageに対応
 	WL_DISPLAY_t			wl_dpy;
 	struct wl_list			window_list;
 	struct _glv_window		*rootWindow;
@@ -165,8 +187,13 @@ typedef struct _glv_display {
 	uint32_t				display_fd_events;
 	struct task				display_task;
 	int						epoll_fd;
+	int						root_queue_fd;			// rootWindowのメッセージキューのeventfd(-1:未使用)
+	struct task				root_queue_task;
 	int						running;
 	// ------------------------------------
+	int						headless;				// 1:headlessバックエンド(waylandを使用しない)
+	struct _glvinput		*headless_input;		// headlessバックエンドの入力注入用
+	// ------------------------------------
 	glvInstanceId			kb_input_windowId;
 	glvInstanceId			kb_input_sheetId;
 	glvInstanceId			kb_input_wigetId;
@@ -247,7 +274,20 @@ typedef struct _glv_window {
 	uint32_t			configure_serial;
 	uint32_t			resharp_serial;
 	uint32_t			draw_serial;
+	int					frame_req;				// 未処理の描画要求(GLV_FRAME_REQ_xxx)
+	int					frame_pending;			// 1:描画メッセージを送信済み(未処理)
+	int					frame_inflight;			// 1:SwapBuffers済みでframe callback待ち
+	uint64_t			frame_inflight_time;	// frame callback待ちを開始した時間(ms)
+	uint32_t			frame_merged;			// 集約した描画要求の数
+	int					timer_missed;			// 処理中のGLV_ON_TIMERの前に逃したタイマーの回数
+	GLV_DAMAGE_t		damage;					// 次のSwapBuffersまでに蓄積した更新領域
+	GLV_DAMAGE_t		damageHistory[GLV_DAMAGE_HISTORY_NUM];	// 過去フレームの更新領域
+	int					damageHistoryIndex;		// 次に書き込むdamageHistoryの位置
 	int					edges;
+#ifdef GLV_TRACE
+	uint64_t			trace_input_time;		// 描画に反映されていない最初の入力の処理開始時刻(ns)
+	uint64_t			trace_present_input;	// SwapBuffersした入力の処理開始時刻(ns) frame callbackで記録する
+#endif /* GLV_TRACE */
 	/* --------------------------- */
 	sem_t				initSync;
 	pthread_mutex_t		window_mutex;
@@ -255,6 +295,24 @@ typedef struct _glv_window {
 	struct wl_list link;
 }GLV_WINDOW_t;
 
+#define GLV_WIGET_GRID_CELL_SIZE		(64)	// wiget検索用グリッドのセルのサイズ(pixel)
+#define GLV_WIGET_GRID_HASH_SIZE		(256)	// セルを格納するハッシュテーブルのサイズ
+#define GLV_WIGET_GRID_MAX_CELLS		(64)	// これより多くのセルにかかるwigetはlargeで管理する
+
+struct _glv_wiget;
+
+typedef struct _glv_wiget_grid_cell {
+	int					num;
+	int					max;
+	struct _glv_wiget	**wiget;
+} GLV_WIGET_GRID_CELL_t;
+
+// wigetの矩形を検索するための一様グリッド
+typedef struct _glv_wiget_grid {
+	GLV_WIGET_GRID_CELL_t	cell[GLV_WIGET_GRID_HASH_SIZE];
+	GLV_WIGET_GRID_CELL_t	large;
+} GLV_WIGET_GRID_t;
+
 typedef struct _glv_sheet {
 	struct _glv_instance	instance;
 	GLV_DISPLAY_t		*glv_dpy;
@@ -268,11 +326,16 @@ typedef struct _glv_sheet {
 	int					select_wiget_button_status;
 	int					initialized;
 	int					reqDrawWigetsFlag;
+	int					reqDirtyWigetsFlag;		// 1:再描画要求(glvWiget_reqDraw)されたwigetがある
+	int					dirtyUpdate;			// 1:再描画が必要な領域に制限してupdateを処理中
+	GLV_RECT_t			dirtyRect;				// dirtyUpdateで描画する範囲(ウィンドウ座標)
 	GLV_SHEET_EVENT_FUNC_t	eventFunc;
 	/* --------------------------- */
     char 	*name;
 	/* --------------------------- */
 	struct wl_list		wiget_list;
+	GLV_WIGET_GRID_t	wiget_grid;			// 表示中のwigetの検索用グリッド
+	uint32_t			wiget_zorder;		// 最後に作成したwigetの重なり順
 	/* --------------------------- */
 	pthread_mutex_t		sheet_mutex;
 	struct wl_list		link;
@@ -288,6 +351,12 @@ typedef struct _glv_wiget {
 	int			visible;
 	int			width,height;
 	float		scale;
+	int			dirty;			// 1:再描画要求(glvWiget_reqDraw)あり
+	int			paint_margin;	// 矩形の外側に描画する幅(glvWiget_setPaintMargin)
+	uint32_t	zorder;			// 重なり順(大きい方が上)
+	int			grid_indexed;	// 1:wiget_gridに登録済み
+	int			grid_large;		// 1:wiget_grid.largeに登録
+	int			grid_x0,grid_y0,grid_x1,grid_y1;	// 登録したセルの範囲
 	// ------------------------------------
 	//int			ibus_candidate_x;
 	//int			ibus_candidate_y;
@@ -373,8 +442,11 @@ typedef struct _glv_garbage_box {
 } GLV_GARBAGE_BOX_t;
 
 int _glvInitInstance(_GLV_INSTANCE_t *instance,int instanceType);
+void *_glvGetInstanceFromId(glvInstanceId Id,int instanceType);
 GLV_DISPLAY_t *_glvInitNativeDisplay(GLV_DISPLAY_t *glv_dpy);
 GLV_DISPLAY_t *_glvOpenNativeDisplay(GLV_DISPLAY_t *glv_dpy);
+EGLDisplay _glvGetNativeEglDisplay(GLV_DISPLAY_t *glv_dpy);
+EGLint _glvGetNativeSurfaceType(GLV_DISPLAY_t *glv_dpy);
 void _glvCloseNativeDisplay(GLV_DISPLAY_t *glv_dpy);
 int glvTerminateThreadSurfaceView(glvWindow glv_win);
 EGLNativeDisplayType glvGetNativeDisplay(glvDisplay glv_dpy);
@@ -404,6 +476,25 @@ int _glvOnKey(glvWindow glv_win,unsigned int key,unsigned int modifiers,unsigned
 int _glvOnTextInput(glvDisplay glv_dpy,int kind,int state,uint32_t kyesym,int *utf32,uint8_t *attr,int length);
 int _glvOnFocus(glvDisplay glv_dpy,int focus_stat,glvWiget in_Wiget);
 int _glvOnEndDraw(glvWindow glv_win,glvTime time);
+void _glvFrameBegin(GLV_WINDOW_t *glv_window);
+void _glvInitSwapDamage(GLV_DISPLAY_t *glv_dpy);
+void _glvOnFrameDone(GLV_WINDOW_t *glv_window);
+
+#ifdef GLV_TRACE
+extern int _glv_trace_enabled;
+#define GLV_TRACE_ON	(__builtin_expect(__atomic_load_n(&_glv_trace_enabled,__ATOMIC_RELAXED),0))
+uint64_t _glvTraceNow(void);
+const char *_glvTraceMsgName(int event);
+void _glvTraceComplete(const char *name,const char *cat,uint64_t start,uint64_t id,const char *label);
+void _glvTraceInstant(const char *name,const char *cat,uint64_t id,int64_t arg,const char *label);
+void _glvTraceCounter(const char *name,uint64_t id,int64_t value);
+void _glvTraceAsync(const char *name,const char *cat,uint64_t id,uint64_t start,uint64_t end);
+void _glvTraceInput(GLV_WINDOW_t *glv_window,int event,uint64_t now);
+void _glvTraceSwap(GLV_WINDOW_t *glv_window);
+void _glvTracePresent(GLV_WINDOW_t *glv_window);
+void _glvTraceInit(void);
+void _glvTraceTerm(void);
+#endif /* GLV_TRACE */
 
 int glvCheckTimer(glvWindow glv_win,int id,int count);
 void glvInitializeTimer(void);
@@ -412,6 +503,7 @@ void glvTerminateTimer(void);
 void _glv_sheet_initialize_cb(GLV_WINDOW_t *glv_window);
 void _glv_sheet_with_wiget_reshape_cb(GLV_WINDOW_t *glv_window);
 void _glv_sheet_with_wiget_redraw_cb(GLV_WINDOW_t *glv_window);
+int _glv_sheet_begin_dirty_update(GLV_WINDOW_t *glv_window);
 void _glv_sheet_with_wiget_update_cb(GLV_WINDOW_t *glv_window);
 void _glv_sheet_userMsg_cb(GLV_WINDOW_t *glv_window,int kind,void *data);
 void _glv_sheet_action_front(GLV_WINDOW_t *glv_window);
@@ -460,6 +552,7 @@ void weston_client_window__create_cursors(WL_DISPLAY_t *display);
 void weston_client_window__display_watch_fd(struct _glv_display *display,int fd, uint32_t events, struct task *task);
 void weston_client_window__display_unwatch_fd(struct _glv_display *display, int fd);
 void weston_client_window__display_exit(struct _glv_display *display);
+void weston_client_window__display_wakeup(struct _glv_display *display);
 void weston_client_window__display_create(struct _glv_display *display);
 void weston_client_window__display_destroy(struct _glv_display *display);
 void weston_client_window__display_run(struct _glv_display *display);
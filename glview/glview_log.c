@@ -0,0 +1,319 @@
+/*
+ * Copyright © 2026 glview contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "config.h"
+#include "glview.h"
+
+// ログ出力
+//
+// カテゴリ(GLV_DEBUG_xxx)とレベル(GLV_LOG_LEVEL_xxx)毎に出力の有無を判定する。
+// INFO以下の出力はスレッド毎のバッファに溜め、以下の時に1回のwrite()でまとめて標準出力に出力する
+// (ロックは使用しない)。WARN以上のログは溜めずに標準エラー出力に出力する。
+//   - WARN以上のログ(溜めていた分を先に出力する)
+//   - バッファの空きが1行分より少なくなった時
+//   - glvLog_flush() (メッセージ待ちに入る前,glvCloseDisplay,スレッド終了時)
+//
+// GLVIEW_DEBUG=<カテゴリ>[:<レベル>],... で出力するカテゴリとレベルを指定する(レベルの既定はdebug)
+//   ex. GLVIEW_DEBUG=msg,font:trace	GLVIEW_DEBUG=all:info
+//   カテゴリ : version,msg,instance,kb,ime,wiget,data,font,memory,api,all
+//   レベル   : error,warn,info,debug,trace
+// GLVIEW_DEBUG=1,2 は従来どおり(glvSetDebugFlag(GLV_DEBUG_ON),全てのカテゴリのdebug)
+
+#define GLV_LOG_BUFFER_SIZE		(8192)	// スレッド毎のバッファの大きさ
+#define GLV_LOG_LINE_MAX		(1024)	// 1行の最大長(超えた分は切り捨てる)
+
+typedef struct _glv_log_buffer {
+	size_t	length;
+	pid_t	tid;
+	char	data[GLV_LOG_BUFFER_SIZE];
+} GLV_LOG_BUFFER_t;
+
+// レベル毎に出力するカテゴリ(ERROR,WARNは全てのカテゴリを出力する)
+unsigned int _glv_log_filter[GLV_LOG_LEVEL_NUM] = {
+	0,					// 未使用
+	GLV_LOG_ALL,		// GLV_LOG_LEVEL_ERROR
+	GLV_LOG_ALL,		// GLV_LOG_LEVEL_WARN
+	0,					// GLV_LOG_LEVEL_INFO
+	0,					// GLV_LOG_LEVEL_DEBUG
+	0,					// GLV_LOG_LEVEL_TRACE
+};
+
+static pthread_once_t	_glv_log_once = PTHREAD_ONCE_INIT;
+static pthread_key_t	_glv_log_key;
+static struct timespec	_glv_log_start;
+
+static __thread GLV_LOG_BUFFER_t *_glv_log_buffer = NULL;
+
+static const struct {
+	const char		*name;
+	unsigned int	category;
+} _glv_log_category_name[] = {
+	{"version",		GLV_DEBUG_VERSION},
+	{"msg",			GLV_DEBUG_MSG},
+	{"instance",	GLV_DEBUG_INSTANCE},
+	{"kb",			GLV_DEBUG_KB_INPUT},
+	{"ime",			GLV_DEBUG_IME_INPUT},
+	{"wiget",		GLV_DEBUG_WIGET},
+	{"data",		GLV_DEBUG_DATA_DEVICE},
+	{"font",		GLV_DEBUG_FONT},
+	{"memory",		GLV_DEBUG_MEMORY},
+	{"api",			GLV_DEBUG_API},
+	{"all",			GLV_LOG_ALL},
+};
+#define GLV_LOG_CATEGORY_NAME_NUM	((int)(sizeof(_glv_log_category_name) / sizeof(_glv_log_category_name[0])))
+
+static const char *_glv_log_level_name[GLV_LOG_LEVEL_NUM] = {
+	"", "error", "warn", "info", "debug", "trace"
+};
+
+static void _glvLogWrite(int fd,const char *data,size_t length)
+{
+	ssize_t rc;
+
+	while(length > 0){
+		rc = write(fd,data,length);
+		if(rc <= 0){
+			return;
+		}
+		data	+= rc;
+		length	-= rc;
+	}
+}
+
+static void _glvLogFlushBuffer(GLV_LOG_BUFFER_t *buffer)
+{
+	if(buffer->length > 0){
+		fflush(stdout);		// printfで出力済みの分を先に出す
+		_glvLogWrite(STDOUT_FILENO,buffer->data,buffer->length);
+		buffer->length = 0;
+	}
+}
+
+// スレッド終了時にバッファを出力して解放する
+static void _glvLogDestructor(void *arg)
+{
+	GLV_LOG_BUFFER_t *buffer = arg;
+
+	_glvLogFlushBuffer(buffer);
+	free(buffer);
+}
+
+static void _glvLogOnce(void)
+{
+	clock_gettime(CLOCK_MONOTONIC,&_glv_log_start);
+	pthread_key_create(&_glv_log_key,_glvLogDestructor);
+}
+
+static GLV_LOG_BUFFER_t *_glvLogGetBuffer(void)
+{
+	GLV_LOG_BUFFER_t *buffer;
+
+	if(_glv_log_buffer != NULL){
+		return(_glv_log_buffer);
+	}
+	pthread_once(&_glv_log_once,_glvLogOnce);
+	buffer = malloc(sizeof(GLV_LOG_BUFFER_t));
+	if(buffer == NULL){
+		return(NULL);
+	}
+	buffer->length = 0;
+	buffer->tid = (pid_t)syscall(SYS_gettid);
+	pthread_setspecific(_glv_log_key,buffer);
+	_glv_log_buffer = buffer;
+	return(buffer);
+}
+
+static const char *_glvLogCategoryName(unsigned int category)
+{
+	int i;
+	for(i=0;i<GLV_LOG_CATEGORY_NAME_NUM - 1;i++){
+		if(category & _glv_log_category_name[i].category){
+			return(_glv_log_category_name[i].name);
+		}
+	}
+	return("-");
+}
+
+/**
+ * @brief ログを出力する(GLV_LOG_xxxマクロから呼ばれる)
+ *
+ * @param[in] level GLV_LOG_LEVEL_xxx
+ * @param[in] category GLV_DEBUG_xxx
+ * @param[in] fmt 書式(末尾の改行は省略可)
+ */
+void glvLog_write(int level,unsigned int category,const char *fmt,...)
+{
+	GLV_LOG_BUFFER_t *buffer;
+	struct timespec ts;
+	va_list args;
+	char line[GLV_LOG_LINE_MAX];
+	char *out;
+	size_t size;
+	int n,m;
+
+	buffer = _glvLogGetBuffer();
+	if((buffer != NULL) && (level > GLV_LOG_LEVEL_WARN)){
+		if((GLV_LOG_BUFFER_SIZE - buffer->length) < GLV_LOG_LINE_MAX){
+			_glvLogFlushBuffer(buffer);
+		}
+		out = buffer->data + buffer->length;
+	}else{
+		out = line;
+	}
+	size = GLV_LOG_LINE_MAX - 1;	// 改行を追加する分を残す
+
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	ts.tv_sec -= _glv_log_start.tv_sec;
+	ts.tv_nsec -= _glv_log_start.tv_nsec;
+	if(ts.tv_nsec < 0){
+		ts.tv_sec--;
+		ts.tv_nsec += 1000000000L;
+	}
+	n = snprintf(out,size,"[%5ld.%06ld][%d][%s:%s] ",(long)ts.tv_sec,ts.tv_nsec / 1000,
+			(buffer != NULL) ? (int)buffer->tid : 0,_glvLogCategoryName(category),
+			((level > 0) && (level < GLV_LOG_LEVEL_NUM)) ? _glv_log_level_name[level] : "?");
+	if((n < 0) || ((size_t)n >= size)) n = 0;
+
+	va_start(args,fmt);
+	m = vsnprintf(out + n,size - n,fmt,args);
+	va_end(args);
+	if(m < 0) m = 0;
+	n += m;
+	if((size_t)n >= size) n = size - 1;	// 切り捨てた
+	if((n == 0) || (out[n - 1] != '\n')){
+		out[n++] = '\n';
+	}
+
+	if(level <= GLV_LOG_LEVEL_WARN){
+		// 溜めていた分を先に出力してから標準エラー出力に出力する
+		if(buffer != NULL){
+			_glvLogFlushBuffer(buffer);
+		}
+		fflush(stderr);		// fprintf(stderr)で出力済みの分を先に出す
+		_glvLogWrite(STDERR_FILENO,line,n);
+		return;
+	}
+	if(buffer == NULL){
+		_glvLogWrite(STDOUT_FILENO,line,n);
+		return;
+	}
+	buffer->length += n;
+}
+
+/**
+ * @brief 呼び出したスレッドのバッファに溜まっているログを出力する
+ */
+void glvLog_flush(void)
+{
+	if((_glv_log_buffer != NULL) && (_glv_log_buffer->length > 0)){
+		_glvLogFlushBuffer(_glv_log_buffer);
+	}
+}
+
+static int _glvLogLevelFromName(const char *name,size_t length)
+{
+	int level;
+	for(level=GLV_LOG_LEVEL_ERROR;level<GLV_LOG_LEVEL_NUM;level++){
+		if((strlen(_glv_log_level_name[level]) == length) &&
+		   (strncasecmp(name,_glv_log_level_name[level],length) == 0)){
+			return(level);
+		}
+	}
+	return(0);
+}
+
+static unsigned int _glvLogCategoryFromName(const char *name,size_t length)
+{
+	int i;
+	for(i=0;i<GLV_LOG_CATEGORY_NAME_NUM;i++){
+		if((strlen(_glv_log_category_name[i].name) == length) &&
+		   (strncasecmp(name,_glv_log_category_name[i].name,length) == 0)){
+			return(_glv_log_category_name[i].category);
+		}
+	}
+	return(0);
+}
+
+/**
+ * @brief カテゴリを指定したレベル以下のログで出力するようにする
+ */
+void glvLog_setLevel(unsigned int category,int level)
+{
+	int i;
+	for(i=GLV_LOG_LEVEL_INFO;i<GLV_LOG_LEVEL_NUM;i++){
+		if(i <= level){
+			_glv_log_filter[i] |= category;
+		}else{
+			_glv_log_filter[i] &= ~category;
+		}
+	}
+}
+
+/**
+ * @brief 出力するカテゴリとレベルを文字列で指定する
+ *
+ * @param[in] spec <カテゴリ>[:<レベル>],... (ex. "msg,font:trace")
+ * @retval GLV_OK 正常
+ * @retval GLV_ERROR 不明なカテゴリ・レベルがある(それ以外は設定する)
+ */
+int glvLog_setFilter(const char *spec)
+{
+	const char *p,*end,*colon;
+	unsigned int category;
+	int level;
+	int rc = GLV_OK;
+
+	p = spec;
+	while(*p != '\0'){
+		end = strchr(p,',');
+		if(end == NULL) end = p + strlen(p);
+		colon = memchr(p,':',end - p);
+		if(colon == NULL){
+			category = _glvLogCategoryFromName(p,end - p);
+			level = GLV_LOG_LEVEL_DEBUG;
+		}else{
+			category = _glvLogCategoryFromName(p,colon - p);
+			level = _glvLogLevelFromName(colon + 1,end - (colon + 1));
+		}
+		if((category == 0) || (level == 0)){
+			fprintf(stderr,"glview:Error: GLVIEW_DEBUG unknown [%.*s]\n",(int)(end - p),p);
+			rc = GLV_ERROR;
+		}else{
+			glvLog_setLevel(category,level);
+		}
+		p = (*end == ',') ? (end + 1) : end;
+	}
+	return(rc);
+}
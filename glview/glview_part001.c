@@ -52,7 +52,7 @@ static int wiget_text_input_text_focus(glvWindow glv_win,glvSheet sheet,glvWiget
 {
 	WIGET_TEXT_INPUT_USER_DATA_t *user_data = glv_getUserData(wiget);
 
-	GLV_IF_DEBUG_IME_INPUT printf("wiget_text_input_text_focus\n");
+	GLV_LOG_DEBUG(GLV_DEBUG_IME_INPUT,"wiget_text_input_text_focus\n");
 	if(focus_stat == GLV_STAT_OUT_FOCUS){
 		user_data->select_start = user_data->select_end = 0;
 		user_data->select_mode = 0;
@@ -72,28 +72,26 @@ static int wiget_text_input_text_input(glvWindow glv_win,glvSheet sheet,glvWiget
 
 	GLV_IF_DEBUG_KB_INPUT {
 		//printf("wiget_text_input_text_input\n");
+		const char *state_name = "";
 
-		if(kind == GLV_KEY_KIND_ASCII) printf(GLV_DEBUG_KB_INPUT_COLOR"GLV_KEY_KIND_ASCII "GLV_DEBUG_END_COLOR);
-		if(kind == GLV_KEY_KIND_CTRL) printf(GLV_DEBUG_KB_INPUT_COLOR"GLV_KEY_KIND_CTRL "GLV_DEBUG_END_COLOR);
-		if(kind == GLV_KEY_KIND_IM) printf(GLV_DEBUG_KB_INPUT_COLOR"GLV_KEY_KIND_IM "GLV_DEBUG_END_COLOR);
-
-		if(state == GLV_KEY_STATE_IM_PREEDIT) printf(GLV_DEBUG_KB_INPUT_COLOR"GLV_KEY_STATE_IM_PREEDIT "GLV_DEBUG_END_COLOR);
-		if(state == GLV_KEY_STATE_IM_COMMIT) printf(GLV_DEBUG_KB_INPUT_COLOR"GLV_KEY_STATE_IM_COMMIT "GLV_DEBUG_END_COLOR);
-		if(state == GLV_KEY_STATE_IM_RESET) printf(GLV_DEBUG_KB_INPUT_COLOR"GLV_KEY_STATE_IM_RESET "GLV_DEBUG_END_COLOR);
+		if(state == GLV_KEY_STATE_IM_PREEDIT) state_name = "GLV_KEY_STATE_IM_PREEDIT ";
+		if(state == GLV_KEY_STATE_IM_COMMIT) state_name = "GLV_KEY_STATE_IM_COMMIT ";
+		if(state == GLV_KEY_STATE_IM_RESET) state_name = "GLV_KEY_STATE_IM_RESET ";
 
 		if(kind == GLV_KEY_KIND_ASCII){
-			printf(GLV_DEBUG_KB_INPUT_COLOR"[%c]\n"GLV_DEBUG_END_COLOR,utf32[0]);
+			GLV_LOG_DEBUG(GLV_DEBUG_KB_INPUT,GLV_DEBUG_KB_INPUT_COLOR"GLV_KEY_KIND_ASCII %s[%c]\n"GLV_DEBUG_END_COLOR,state_name,utf32[0]);
 		}
 		if(kind == GLV_KEY_KIND_CTRL){
-			printf(GLV_DEBUG_KB_INPUT_COLOR"[%x]\n"GLV_DEBUG_END_COLOR,kyesym);
+			GLV_LOG_DEBUG(GLV_DEBUG_KB_INPUT,GLV_DEBUG_KB_INPUT_COLOR"GLV_KEY_KIND_CTRL %s[%x]\n"GLV_DEBUG_END_COLOR,state_name,kyesym);
 		}
 		if(kind == GLV_KEY_KIND_IM){
 			char *utf8;
 			utf8 = malloc(length * 4 + 1);
-			printf(GLV_DEBUG_KB_INPUT_COLOR"GLV_KEY_KIND_IM length = %d"GLV_DEBUG_END_COLOR,length);
-			glvFont_utf32_to_string(utf32,length,utf8,(length * 4));
-			printf(GLV_DEBUG_KB_INPUT_COLOR"[%s]\n"GLV_DEBUG_END_COLOR,utf8);
-			free(utf8);
+			if(utf8 != NULL){
+				glvFont_utf32_to_string(utf32,length,utf8,(length * 4));
+				GLV_LOG_DEBUG(GLV_DEBUG_KB_INPUT,GLV_DEBUG_KB_INPUT_COLOR"GLV_KEY_KIND_IM %slength = %d [%s]\n"GLV_DEBUG_END_COLOR,state_name,length,utf8);
+				free(utf8);
+			}
 		}
 	}
 
@@ -119,7 +117,7 @@ static int wiget_text_input_text_input(glvWindow glv_win,glvSheet sheet,glvWiget
 			if(end >= user_data->utf32_length){
 				end = user_data->utf32_length - 1;
 			}
-			GLV_IF_DEBUG_IME_INPUT printf("wiget_text_input_text_input delete %d -> %d\n",start,end);
+			GLV_LOG_DEBUG(GLV_DEBUG_IME_INPUT,"wiget_text_input_text_input delete %d -> %d\n",start,end);
 			num = end - start + 1;
 			if(num > 0){
 				user_data->cursorIndex = end + 1;
@@ -290,9 +288,11 @@ static int wiget_text_input_mousePointer(glvWindow glv_win,glvSheet sheet,glvWig
 				GLV_IF_DEBUG_IME_INPUT {
 					char *utf8;
 					utf8 = malloc(num * 4 + 1);
-					glvFont_utf32_to_string(user_data->utf32_string + start,num,utf8,num * 4);
-					printf("text_input_mouse selection %d -> %d [%s]\n",start,end,utf8);
-					free(utf8);
+					if(utf8 != NULL){
+						glvFont_utf32_to_string(user_data->utf32_string + start,num,utf8,num * 4);
+						GLV_LOG_DEBUG(GLV_DEBUG_IME_INPUT,"text_input_mouse selection %d -> %d [%s]\n",start,end,utf8);
+						free(utf8);
+					}
 				}
 			}
 		}
@@ -314,44 +314,48 @@ static int wiget_text_input_mousePointer(glvWindow glv_win,glvSheet sheet,glvWig
 static int wiget_text_input_mouseButton(glvWindow glv_win,glvSheet sheet,glvWiget wiget,int glv_mouse_event_type,glvTime glv_mouse_event_time,int glv_mouse_event_x,int glv_mouse_event_y,int pointer_stat)
 {
 	GLV_IF_DEBUG_IME_INPUT {
+		const char *type_name = "";
+		const char *stat_name = "";
+
 		switch(glv_mouse_event_type){
 			case GLV_MOUSE_EVENT_RELEASE:
-			printf("GLV_MOUSE_EVENT_RELEASE ");
+			type_name = "GLV_MOUSE_EVENT_RELEASE ";
 			break;
 			case GLV_MOUSE_EVENT_PRESS:
-			printf("GLV_MOUSE_EVENT_PRESS ");
+			type_name = "GLV_MOUSE_EVENT_PRESS ";
 			break;
 			case GLV_MOUSE_EVENT_MOTION:
-			printf("GLV_MOUSE_EVENT_MOTION ");
+			type_name = "GLV_MOUSE_EVENT_MOTION ";
 			break;
 		}
 
 		switch(pointer_stat){
 		case GLV_MOUSE_EVENT_LEFT_RELEASE:
-			printf("GLV_MOUSE_EVENT_LEFT_RELEASE\n");
+			stat_name = "GLV_MOUSE_EVENT_LEFT_RELEASE";
 			break;
 			case GLV_MOUSE_EVENT_LEFT_PRESS:
-			printf("GLV_MOUSE_EVENT_LEFT_PRESS\n");
+			stat_name = "GLV_MOUSE_EVENT_LEFT_PRESS";
 			break;
 			case GLV_MOUSE_EVENT_MIDDLE_RELEASE:
-			printf("GLV_MOUSE_EVENT_MIDDLE_RELEASE\n");
+			stat_name = "GLV_MOUSE_EVENT_MIDDLE_RELEASE";
 			break;
 			case GLV_MOUSE_EVENT_MIDDLE_PRESS:
-			printf("GLV_MOUSE_EVENT_MIDDLE_PRESS\n");
+			stat_name = "GLV_MOUSE_EVENT_MIDDLE_PRESS";
 			break;
 			case GLV_MOUSE_EVENT_RIGHT_RELEASE:
-			printf("GLV_MOUSE_EVENT_RIGHT_RELEASE\n");
+			stat_name = "GLV_MOUSE_EVENT_RIGHT_RELEASE";
 			break;
 			case GLV_MOUSE_EVENT_RIGHT_PRESS:
-			printf("GLV_MOUSE_EVENT_RIGHT_PRESS\n");
+			stat_name = "GLV_MOUSE_EVENT_RIGHT_PRESS";
 			break;
 			case GLV_MOUSE_EVENT_OTHER_RELEASE:
-			printf("GLV_MOUSE_EVENT_OTHER_RELEASE\n");
+			stat_name = "GLV_MOUSE_EVENT_OTHER_RELEASE";
 			break;
 			case GLV_MOUSE_EVENT_OTHER_PRESS:
-			printf("GLV_MOUSE_EVENT_OTHER_PRESS\n");
+			stat_name = "GLV_MOUSE_EVENT_OTHER_PRESS";
 			break;
 		}
+		GLV_LOG_DEBUG(GLV_DEBUG_IME_INPUT,"%s%s\n",type_name,stat_name);
 	}
 	return(GLV_OK);
 }
@@ -461,7 +465,7 @@ static int wiget_text_input_redraw(glvWindow glv_win,glvSheet sheet,glvWiget wig
 		if(end > user_data->utf32_length){
 			end = user_data->utf32_length;
 		}
-		GLV_IF_DEBUG_IME_INPUT printf("select (%d)->(%d)\n",start,end);
+		GLV_LOG_DEBUG(GLV_DEBUG_IME_INPUT,"select (%d)->(%d)\n",start,end);
 		for(i=start;i<end;i++){
 			utf32_string_attr[i] = 4;
 		}
@@ -580,9 +584,12 @@ static int wiget_text_input_redraw(glvWindow glv_win,glvSheet sheet,glvWiget wig
 	GLV_IF_DEBUG_IME_INPUT {
 		char *utf8;
 		utf8 = malloc(user_data->utf32_length * 4 + 1);
-		int length;
-		length = glvFont_utf32_to_string(user_data->utf32_string,user_data->utf32_length,utf8,(user_data->utf32_length * 4));
-		printf("glvFont_utf32_to_string %d [%s]\n",length,utf8);
+		if(utf8 != NULL){
+			int length;
+			length = glvFont_utf32_to_string(user_data->utf32_string,user_data->utf32_length,utf8,(user_data->utf32_length * 4));
+			GLV_LOG_DEBUG(GLV_DEBUG_IME_INPUT,"glvFont_utf32_to_string %d [%s]\n",length,utf8);
+			free(utf8);
+		}
 	}
 
 	if((select_mode == 0) && (user_data->cursorIndex >= 0)){
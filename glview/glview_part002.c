@@ -54,7 +54,8 @@ static int wiget_slider_bar_input(glvWindow glv_win,glvSheet sheet,glvWiget wige
 		}
 	}
 	if(drawFlag == 1){
-		glvOnReDraw(glv_win);
+		glvWiget_reqDraw(wiget);
+		glvOnUpdate(glv_win);
 	}
 	return(GLV_OK);
 }
@@ -67,10 +68,11 @@ static int wiget_slider_bar_mousePointer(glvWindow glv_win,glvSheet sheet,glvWig
 
 	user_data->position = user_data->range * glv_mouse_event_x / (geometry.width + geometry.width / user_data->range) + user_data->min;
 
-	printf("slider_bar_mouse (%d,%d) position = %d\n",glv_mouse_event_x,glv_mouse_event_y,user_data->position);
+	GLV_LOG_DEBUG(GLV_DEBUG_WIGET,"slider_bar_mouse (%d,%d) position = %d\n",glv_mouse_event_x,glv_mouse_event_y,user_data->position);
 
 	if(glv_mouse_event_type == GLV_MOUSE_EVENT_MOTION){
-		glvOnReDraw(glv_win);
+		glvWiget_reqDraw(wiget);
+		glvOnUpdate(glv_win);
 	}
 	return(GLV_OK);
 }
@@ -185,6 +187,8 @@ static int wiget_slider_bar_init(glvWindow glv_win,glvSheet sheet,glvWiget wiget
 	user_data->max = 9;
 	user_data->range = user_data->max - user_data->min + 1;
 
+	glvWiget_setPaintMargin(wiget,20/2);	// つまみは矩形の左右にはみ出して描画する
+
 	glv_setValue(wiget,"gFocusBkgdColor"	,"C",GLV_SET_RGBA(255,  0,  0,255));
 	glv_setValue(wiget,"gPressBkgdColor"	,"C",GLV_SET_RGBA(  0,255,  0,255));
 	glv_setValue(wiget,"gReleaseBkgdColor"	,"C",GLV_SET_RGBA(178,178,178,255));
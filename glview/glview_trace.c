@@ -0,0 +1,501 @@
+/*
+ * Copyright © 2026 glview contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/prctl.h>
+#include <xkbcommon/xkbcommon.h>
+#include "wayland-util.h"
+
+#include "config.h"
+#include "glview.h"
+#include "weston-client-window.h"
+#include "glview_local.h"
+
+// フレームのタイミングとメッセージ処理のトレース
+//
+// 各スレッドのリングバッファにイベントを記録し、Chromeのtrace event形式(JSON)で出力する。
+// 出力したファイルは chrome://tracing または Perfetto UI(ui.perfetto.dev) で表示できる。
+//   - msq     : メッセージキューへの格納・取り出しと格納数(queue depth のカウンタ)
+//   - handler : glvExecMsgでのメッセージ毎のハンドラ処理時間
+//   - frame   : glvSwapBuffersの処理時間とframe callback
+//   - latency : 入力メッセージの処理開始から、その描画が表示(frame callback)されるまで
+//
+// GLVIEW_TRACE=trace.json ./a.out	glvOpenDisplay()からglvCloseDisplay()までを記録して出力する
+
+#ifdef GLV_TRACE
+
+typedef struct _glv_trace_event {
+	uint64_t	ts;				// 時刻(ns)
+	uint64_t	dur;			// 処理時間(ns) 'X'のみ
+	const char	*name;			// イベント名(静的な文字列)
+	const char	*cat;			// カテゴリ(静的な文字列)
+	uint64_t	id;				// ウインドウID/キュー
+	int64_t		arg;			// 引数(queue depth等)
+	char		ph;				// 'X':処理時間 'i':瞬間 'C':カウンタ 'b','e':非同期の開始・終了
+	char		label[23];		// ウインドウ名等(記録時にコピーする)
+} GLV_TRACE_EVENT_t;
+
+typedef struct _glv_trace_ring {
+	struct _glv_trace_ring	*next;
+	pid_t					tid;
+	int						exited;				// 1:スレッドが終了した(以降は記録しない)
+	int						retired;			// 1:出力済み(スレッドが次に記録する時、または終了時に解放する)
+	char					threadName[16];
+	uint64_t				count;				// 記録したイベントの総数
+	GLV_TRACE_EVENT_t		event[GLV_TRACE_RING_SIZE];
+} GLV_TRACE_RING_t;
+
+int _glv_trace_enabled = 0;
+
+static pthread_mutex_t		_glv_trace_mutex = PTHREAD_MUTEX_INITIALIZER;
+static GLV_TRACE_RING_t		*_glv_trace_ring_list = NULL;
+static unsigned int			_glv_trace_generation = 1;		// リングバッファを解放する毎に更新する
+static char					*_glv_trace_env_path = NULL;	// 環境変数GLVIEW_TRACEの出力先
+static pthread_once_t		_glv_trace_once = PTHREAD_ONCE_INIT;
+static pthread_key_t		_glv_trace_key;
+
+static __thread GLV_TRACE_RING_t	*_glv_trace_ring = NULL;
+static __thread unsigned int		_glv_trace_ring_generation = 0;
+
+static const char *_glv_trace_msg_name[] = {
+	"ACTIVATE",
+	"INIT",
+	"CONFIGURE",
+	"RESHAPE",
+	"REDRAW",
+	"UPDATE",
+	"TIMER",
+	"MOUSE_POINTER",
+	"MOUSE_BUTTON",
+	"MOUSE_AXIS",
+	"ACTION",
+	"GESTURE",
+	"USER_MSG",
+	"KEY_INPUT",
+	"FOCUS",
+	"END_DRAW",
+	"KEY",
+};
+
+const char *_glvTraceMsgName(int event)
+{
+	if((event >= 0) && (event < (int)(sizeof(_glv_trace_msg_name) / sizeof(_glv_trace_msg_name[0])))){
+		return(_glv_trace_msg_name[event]);
+	}
+	if(event == GLV_ON_TERMINATE){
+		return("TERMINATE");
+	}
+	return("UNKNOWN");
+}
+
+uint64_t _glvTraceNow(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return((uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec);
+}
+
+// リングバッファはそのスレッドだけが書き込むので、スレッドが動作している間は他のスレッドから解放しない
+// スレッド終了時は、出力済みなら解放し、未出力なら出力まで残す
+static void _glvTraceDestructor(void *arg)
+{
+	GLV_TRACE_RING_t *ring = arg;
+
+	pthread_mutex_lock(&_glv_trace_mutex);
+	if(ring->retired == 1){
+		free(ring);
+	}else{
+		ring->exited = 1;
+	}
+	pthread_mutex_unlock(&_glv_trace_mutex);
+}
+
+static void _glvTraceOnce(void)
+{
+	pthread_key_create(&_glv_trace_key,_glvTraceDestructor);
+}
+
+// 呼び出したスレッドのリングバッファを取得する(初回に作成する)
+static GLV_TRACE_RING_t *_glvTraceGetRing(void)
+{
+	GLV_TRACE_RING_t *ring;
+	unsigned int generation;
+
+	generation = __atomic_load_n(&_glv_trace_generation,__ATOMIC_ACQUIRE);
+	if((_glv_trace_ring != NULL) && (_glv_trace_ring_generation == generation)){
+		return(_glv_trace_ring);
+	}
+	if(_glv_trace_ring != NULL){
+		// 出力済みの前回のリングバッファを解放する
+		pthread_mutex_lock(&_glv_trace_mutex);
+		if(_glv_trace_ring->retired == 1){
+			free(_glv_trace_ring);
+		}
+		pthread_mutex_unlock(&_glv_trace_mutex);
+		_glv_trace_ring = NULL;
+		pthread_setspecific(_glv_trace_key,NULL);
+	}
+	if(!GLV_TRACE_ON){
+		// 停止後に記録しようとした場合はリングバッファを作成しない
+		return(NULL);
+	}
+	pthread_once(&_glv_trace_once,_glvTraceOnce);
+	ring = malloc(sizeof(GLV_TRACE_RING_t));
+	if(ring == NULL){
+		return(NULL);
+	}
+	ring->tid = (pid_t)syscall(SYS_gettid);
+	ring->exited = 0;
+	ring->retired = 0;
+	ring->count = 0;
+	memset(ring->threadName,0,sizeof(ring->threadName));
+	prctl(PR_GET_NAME,ring->threadName,0,0,0);
+
+	pthread_mutex_lock(&_glv_trace_mutex);
+	ring->next = _glv_trace_ring_list;
+	_glv_trace_ring_list = ring;
+	_glv_trace_ring_generation = _glv_trace_generation;
+	pthread_mutex_unlock(&_glv_trace_mutex);
+
+	pthread_setspecific(_glv_trace_key,ring);
+	_glv_trace_ring = ring;
+	return(ring);
+}
+
+// 全ての項目を書き込んでからcountを更新する(glvTrace_dumpが書き込み途中のイベントを読まないように)
+static void _glvTraceRecord(char ph,const char *name,const char *cat,uint64_t id,
+							uint64_t ts,uint64_t dur,int64_t arg,const char *label)
+{
+	GLV_TRACE_RING_t *ring;
+	GLV_TRACE_EVENT_t *event;
+
+	ring = _glvTraceGetRing();
+	if(ring == NULL){
+		return;
+	}
+	// 満杯の場合は古いイベントから上書きする
+	event = &ring->event[ring->count % GLV_TRACE_RING_SIZE];
+	event->ph	= ph;
+	event->name	= name;
+	event->cat	= cat;
+	event->id	= id;
+	event->ts	= ts;
+	event->dur	= dur;
+	event->arg	= arg;
+	if(label != NULL){
+		strncpy(event->label,label,sizeof(event->label) - 1);
+		event->label[sizeof(event->label) - 1] = '\0';
+	}else{
+		event->label[0] = '\0';
+	}
+	__atomic_store_n(&ring->count,ring->count + 1,__ATOMIC_RELEASE);
+}
+
+/**
+ * @brief 処理時間のイベントを記録する(処理の終了時に呼ぶ)
+ *
+ * @param[in] name イベント名
+ * @param[in] cat カテゴリ
+ * @param[in] start 処理の開始時刻(_glvTraceNow)
+ * @param[in] id ウインドウID
+ * @param[in] label ウインドウ名等(NULL可)
+ */
+void _glvTraceComplete(const char *name,const char *cat,uint64_t start,uint64_t id,const char *label)
+{
+	uint64_t now = _glvTraceNow();
+
+	_glvTraceRecord('X',name,cat,id,start,now - start,0,label);
+}
+
+/**
+ * @brief 瞬間のイベントを記録する
+ */
+void _glvTraceInstant(const char *name,const char *cat,uint64_t id,int64_t arg,const char *label)
+{
+	_glvTraceRecord('i',name,cat,id,_glvTraceNow(),0,arg,label);
+}
+
+/**
+ * @brief カウンタの値を記録する(idが異なるものは別のカウンタとして表示される)
+ */
+void _glvTraceCounter(const char *name,uint64_t id,int64_t value)
+{
+	_glvTraceRecord('C',name,"counter",id,_glvTraceNow(),0,value,NULL);
+}
+
+/**
+ * @brief 非同期の区間(スレッドをまたがる区間)を記録する
+ */
+void _glvTraceAsync(const char *name,const char *cat,uint64_t id,uint64_t start,uint64_t end)
+{
+	_glvTraceRecord('b',name,cat,id,start,0,0,NULL);
+	_glvTraceRecord('e',name,cat,id,end,0,0,NULL);
+}
+
+/**
+ * @brief 入力メッセージの処理開始時刻を記録する(表示までの遅延の計測開始)
+ */
+void _glvTraceInput(GLV_WINDOW_t *glv_window,int event,uint64_t now)
+{
+	switch(event){
+		case GLV_ON_MOUSE_POINTER:
+		case GLV_ON_MOUSE_BUTTON:
+		case GLV_ON_MOUSE_AXIS:
+		case GLV_ON_GESTURE:
+		case GLV_ON_KEY_INPUT:
+		case GLV_ON_KEY:
+			// 描画に反映される前の入力が続く場合は最初の入力から計測する
+			if(glv_window->trace_input_time == 0){
+				glv_window->trace_input_time = now;
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+/**
+ * @brief SwapBuffersの時点で未反映の入力を、frame callbackで表示されるものとする
+ */
+void _glvTraceSwap(GLV_WINDOW_t *glv_window)
+{
+	if(glv_window->trace_input_time != 0){
+		__atomic_store_n(&glv_window->trace_present_input,glv_window->trace_input_time,__ATOMIC_RELAXED);
+		glv_window->trace_input_time = 0;
+	}
+}
+
+/**
+ * @brief frame callback(表示完了)を記録する
+ */
+void _glvTracePresent(GLV_WINDOW_t *glv_window)
+{
+	uint64_t input;
+	uint64_t now = _glvTraceNow();
+
+	_glvTraceInstant("frame","frame",glv_window->instance.Id,0,glv_window->name);
+	input = __atomic_exchange_n(&glv_window->trace_present_input,0,__ATOMIC_RELAXED);
+	if(input != 0){
+		_glvTraceAsync("input to present","latency",glv_window->instance.Id,input,now);
+	}
+}
+
+// pthread_msqのトレース用フック
+static void _glvTraceMsqHook(pthread_msq_id_t *queue,int event,const pthread_msq_msg_t *msg,int depth)
+{
+	if(!GLV_TRACE_ON) return;
+	_glvTraceRecord('i',(event == PTHREAD_MSQ_TRACE_SEND) ? "enqueue" : "dequeue","msq",
+					(uint64_t)msg->data[1],_glvTraceNow(),0,depth,_glvTraceMsgName((int)msg->data[0]));
+	_glvTraceCounter("queue depth",(uint64_t)(uintptr_t)queue,depth);
+}
+
+static void _glvTraceWriteString(FILE *fp,const char *str)
+{
+	fputc('"',fp);
+	for(;*str != '\0';str++){
+		if((*str == '"') || (*str == '\\')){
+			fputc('\\',fp);
+			fputc(*str,fp);
+		}else if((unsigned char)*str < 0x20){
+			fprintf(fp,"\\u%04x",(unsigned char)*str);
+		}else{
+			fputc(*str,fp);
+		}
+	}
+	fputc('"',fp);
+}
+
+static void _glvTraceWriteEvent(FILE *fp,GLV_TRACE_RING_t *ring,GLV_TRACE_EVENT_t *event,int pid)
+{
+	fprintf(fp,",\n{\"name\":");
+	_glvTraceWriteString(fp,event->name);
+	fprintf(fp,",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d",
+		event->cat,event->ph,(double)event->ts / 1000.0,pid,(int)ring->tid);
+	switch(event->ph){
+		case 'X':
+			fprintf(fp,",\"dur\":%.3f,\"args\":{\"window\":%llu,\"name\":",
+				(double)event->dur / 1000.0,(unsigned long long)event->id);
+			_glvTraceWriteString(fp,event->label);
+			fprintf(fp,"}}");
+			break;
+		case 'i':
+			fprintf(fp,",\"s\":\"t\",\"args\":{\"window\":%llu,\"value\":%lld,\"name\":",
+				(unsigned long long)event->id,(long long)event->arg);
+			_glvTraceWriteString(fp,event->label);
+			fprintf(fp,"}}");
+			break;
+		case 'C':
+			fprintf(fp,",\"id\":\"0x%llx\",\"args\":{\"depth\":%lld}}",
+				(unsigned long long)event->id,(long long)event->arg);
+			break;
+		default:	// 'b','e'
+			fprintf(fp,",\"id\":\"0x%llx\",\"args\":{}}",(unsigned long long)event->id);
+			break;
+	}
+}
+
+/**
+ * @brief トレースの記録を開始する
+ *
+ * @retval GLV_OK 正常
+ */
+int glvTrace_start(void)
+{
+	__atomic_store_n(&_glv_trace_enabled,1,__ATOMIC_RELAXED);
+	pthread_msq_set_trace_hook(_glvTraceMsqHook);
+	return(GLV_OK);
+}
+
+/**
+ * @brief トレースの記録を停止する(記録済みのイベントは保持する)
+ *
+ * @retval GLV_OK 正常
+ */
+int glvTrace_stop(void)
+{
+	pthread_msq_set_trace_hook(NULL);
+	__atomic_store_n(&_glv_trace_enabled,0,__ATOMIC_RELAXED);
+	return(GLV_OK);
+}
+
+/**
+ * @brief 記録したイベントをChromeのtrace event形式(JSON)でファイルに出力する
+ *
+ * 記録中のスレッドと競合しないように、glvTrace_stop()の後に呼ぶこと。
+ *
+ * @param[in] path 出力するファイル
+ * @retval GLV_OK 正常
+ * @retval GLV_ERROR ファイルを作成できない
+ */
+int glvTrace_dump(const char *path)
+{
+	GLV_TRACE_RING_t *ring;
+	uint64_t i,start,count;
+	FILE *fp;
+	int pid = (int)getpid();
+
+	fp = fopen(path,"w");
+	if(fp == NULL){
+		fprintf(stderr,"glvTrace_dump:Error: %s can't open\n",path);
+		return(GLV_ERROR);
+	}
+	fprintf(fp,"{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	fprintf(fp,"{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":0,\"args\":{\"name\":\"glview\"}}",pid);
+
+	pthread_mutex_lock(&_glv_trace_mutex);
+	for(ring = _glv_trace_ring_list;ring != NULL;ring = ring->next){
+		fprintf(fp,",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":",pid,(int)ring->tid);
+		_glvTraceWriteString(fp,ring->threadName);
+		fprintf(fp,"}}");
+		count = __atomic_load_n(&ring->count,__ATOMIC_ACQUIRE);
+		start = (count > GLV_TRACE_RING_SIZE) ? (count - GLV_TRACE_RING_SIZE) : 0;
+		for(i = start;i < count;i++){
+			_glvTraceWriteEvent(fp,ring,&ring->event[i % GLV_TRACE_RING_SIZE],pid);
+		}
+	}
+	pthread_mutex_unlock(&_glv_trace_mutex);
+
+	fprintf(fp,"\n]}\n");
+	fclose(fp);
+	return(GLV_OK);
+}
+
+/**
+ * @brief 環境変数GLVIEW_TRACEが設定されている場合は記録を開始する
+ */
+void _glvTraceInit(void)
+{
+	char *env;
+
+	env = getenv("GLVIEW_TRACE");
+	if((env == NULL) || (env[0] == '\0') || (_glv_trace_env_path != NULL)){
+		return;
+	}
+	_glv_trace_env_path = strdup(env);
+	glvTrace_start();
+}
+
+/**
+ * @brief 環境変数GLVIEW_TRACEで開始した記録を出力し、リングバッファを解放する
+ *
+ * 停止の直前に記録を始めたスレッドが書き込み中の場合があるので、動作中のスレッドの
+ * リングバッファは解放せずに出力済みとし、そのスレッドが解放する。
+ */
+void _glvTraceTerm(void)
+{
+	GLV_TRACE_RING_t *ring,*next;
+
+	if(_glv_trace_env_path == NULL){
+		return;
+	}
+	glvTrace_stop();
+	glvTrace_dump(_glv_trace_env_path);
+	free(_glv_trace_env_path);
+	_glv_trace_env_path = NULL;
+
+	pthread_mutex_lock(&_glv_trace_mutex);
+	ring = _glv_trace_ring_list;
+	_glv_trace_ring_list = NULL;
+	__atomic_add_fetch(&_glv_trace_generation,1,__ATOMIC_RELEASE);
+	while(ring != NULL){
+		next = ring->next;
+		if((ring->exited == 1) || (ring == _glv_trace_ring)){
+			free(ring);
+		}else{
+			ring->retired = 1;
+		}
+		ring = next;
+	}
+	pthread_mutex_unlock(&_glv_trace_mutex);
+	if(_glv_trace_ring != NULL){
+		_glv_trace_ring = NULL;
+		pthread_setspecific(_glv_trace_key,NULL);
+	}
+}
+
+#else
+
+int glvTrace_start(void)
+{
+	return(GLV_ERROR);
+}
+
+int glvTrace_stop(void)
+{
+	return(GLV_ERROR);
+}
+
+int glvTrace_dump(const char *path)
+{
+	return(GLV_ERROR);
+}
+
+#endif /* GLV_TRACE */
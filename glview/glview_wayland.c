@@ -128,6 +128,68 @@ static GLV_WINDOW_t *_glv_window_list_is_surface(GLV_DISPLAY_t *glv_dpy,struct w
 	return(NULL);
 }
 
+#ifdef GLV_HEADLESS_BACKEND
+/**
+ * @brief	headlessバックエンドで通知する時刻(ms)を取得する
+ */
+static uint32_t _glvHeadlessGetTime(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return((uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000));
+}
+
+/**
+ * @brief	headlessバックエンドの描画先(pbuffer)を作成する
+ * @param[in]	glv_window	ウィンドウ
+ * @param[in]	width		幅
+ * @param[in]	height		高さ
+ * @retval	EGL_NO_SURFACE	作成に失敗した
+ */
+static EGLSurface _glvHeadlessCreateSurface(GLV_WINDOW_t *glv_window,int width,int height)
+{
+	EGLint attribs[] = {
+		EGL_WIDTH, 1,
+		EGL_HEIGHT, 1,
+		EGL_NONE
+	};
+
+	if(width  > 0) attribs[1] = width;
+	if(height > 0) attribs[3] = height;
+
+	return(eglCreatePbufferSurface(glv_window->glv_dpy->egl_dpy,glv_window->ctx.egl_config,attribs));
+}
+
+/**
+ * @brief	ウィンドウのサイズに合わせてpbufferを作り直す
+ * @param[in]	glv_window	ウィンドウ
+ */
+static void _glvHeadlessResizeSurface(GLV_WINDOW_t *glv_window)
+{
+	EGLDisplay	egl_dpy = glv_window->glv_dpy->egl_dpy;
+	EGLSurface	egl_surf;
+	EGLint		width,height;
+
+	if((eglQuerySurface(egl_dpy,glv_window->ctx.egl_surf,EGL_WIDTH,&width) == EGL_TRUE) &&
+	   (eglQuerySurface(egl_dpy,glv_window->ctx.egl_surf,EGL_HEIGHT,&height) == EGL_TRUE)){
+		if((width == glv_window->width) && (height == glv_window->height)){
+			return;
+		}
+	}
+	// pbufferはサイズを変更できないので作り直す
+	egl_surf = _glvHeadlessCreateSurface(glv_window,glv_window->width,glv_window->height);
+	if(egl_surf == EGL_NO_SURFACE){
+		fprintf(stderr,"_glvHeadlessResizeSurface:Error: eglCreatePbufferSurface failed (eglError: %d)\n",eglGetError());
+		return;
+	}
+	// リサイズはウィンドウのスレッドで処理されるので、新しいpbufferをカレントにしてから古い方を破棄する
+	glvGl_MakeCurrent(egl_surf,glv_window->instance.Id);
+	eglDestroySurface(egl_dpy,glv_window->ctx.egl_surf);
+	glv_window->ctx.egl_surf = egl_surf;
+}
+#endif /* GLV_HEADLESS_BACKEND */
+
 void _glvResizeWindow(GLV_WINDOW_t *glv_window,int x,int y,int width,int height)
 {
 	glv_window->x  = x;
@@ -160,6 +222,17 @@ void _glvResizeWindow(GLV_WINDOW_t *glv_window,int x,int y,int width,int height)
 	printf("_glvResizeWindow: inner_width = %d, inner_height = %d\n",glv_window->frameInfo.inner_width,glv_window->frameInfo.inner_height);
 #endif
 
+#ifdef GLV_HEADLESS_BACKEND
+	if(glv_window->glv_dpy->headless == 1){
+		_glvHeadlessResizeSurface(glv_window);
+		if(glv_window->toplevel_maximized == 0){
+			glv_window->toplevel_unset_maximized_width  = width;
+			glv_window->toplevel_unset_maximized_height = height;
+		}
+		return;
+	}
+#endif /* GLV_HEADLESS_BACKEND */
+
 	wl_egl_window_resize(glv_window->egl_window,glv_window->width,glv_window->height,0,0);
 
 #if 1
@@ -231,6 +304,27 @@ void _glv_window_list_on_reshape(GLV_WINDOW_t *frame_window,int width,int height
 
 /* XKB キーマップ作成 */
 
+static void _xkb_set_keymap(struct _glvinput *glv_input,struct xkb_keymap *keymap)
+{
+    xkb_keymap_unref(glv_input->xkb_keymap);
+    xkb_state_unref(glv_input->xkb_state);
+
+    glv_input->xkb_keymap = keymap;
+    glv_input->xkb_state = xkb_state_new(keymap);
+
+    glv_input->shift_mask   = 1 << xkb_map_mod_get_index (glv_input->xkb_keymap, XKB_MOD_NAME_SHIFT);
+    glv_input->lock_mask    = 1 << xkb_map_mod_get_index (glv_input->xkb_keymap, XKB_MOD_NAME_CAPS);
+    glv_input->control_mask = 1 << xkb_map_mod_get_index (glv_input->xkb_keymap, XKB_MOD_NAME_CTRL);
+    glv_input->mod1_mask    = 1 << xkb_map_mod_get_index (glv_input->xkb_keymap, XKB_MOD_NAME_ALT);
+    glv_input->mod2_mask    = 1 << xkb_map_mod_get_index (glv_input->xkb_keymap, XKB_MOD_NAME_NUM);
+    glv_input->mod3_mask    = 1 << xkb_map_mod_get_index (glv_input->xkb_keymap, "Mod3");
+    glv_input->mod4_mask    = 1 << xkb_map_mod_get_index (glv_input->xkb_keymap, XKB_MOD_NAME_LOGO);
+    glv_input->mod5_mask    = 1 << xkb_map_mod_get_index (glv_input->xkb_keymap, "Mod5");
+    glv_input->super_mask   = 1 << xkb_map_mod_get_index (glv_input->xkb_keymap, "Super");
+    glv_input->hyper_mask   = 1 << xkb_map_mod_get_index (glv_input->xkb_keymap, "Hyper");
+    glv_input->meta_mask    = 1 << xkb_map_mod_get_index (glv_input->xkb_keymap, "Meta");	
+}
+
 static void _xkb_keymap(struct _glvinput *glv_input,char *mapstr)
 {
     struct xkb_context *context;
@@ -251,23 +345,7 @@ static void _xkb_keymap(struct _glvinput *glv_input,char *mapstr)
     }
 
     //
-    xkb_keymap_unref(glv_input->xkb_keymap);
-    xkb_state_unref(glv_input->xkb_state);
-
-    glv_input->xkb_keymap = keymap;
-    glv_input->xkb_state = xkb_state_new(keymap);
-
-    glv_input->shift_mask   = 1 << xkb_map_mod_get_index (glv_input->xkb_keymap, XKB_MOD_NAME_SHIFT);
-    glv_input->lock_mask    = 1 << xkb_map_mod_get_index (glv_input->xkb_keymap, XKB_MOD_NAME_CAPS);
-    glv_input->control_mask = 1 << xkb_map_mod_get_index (glv_input->xkb_keymap, XKB_MOD_NAME_CTRL);
-    glv_input->mod1_mask    = 1 << xkb_map_mod_get_index (glv_input->xkb_keymap, XKB_MOD_NAME_ALT);
-    glv_input->mod2_mask    = 1 << xkb_map_mod_get_index (glv_input->xkb_keymap, XKB_MOD_NAME_NUM);
-    glv_input->mod3_mask    = 1 << xkb_map_mod_get_index (glv_input->xkb_keymap, "Mod3");
-    glv_input->mod4_mask    = 1 << xkb_map_mod_get_index (glv_input->xkb_keymap, XKB_MOD_NAME_LOGO);
-    glv_input->mod5_mask    = 1 << xkb_map_mod_get_index (glv_input->xkb_keymap, "Mod5");
-    glv_input->super_mask   = 1 << xkb_map_mod_get_index (glv_input->xkb_keymap, "Super");
-    glv_input->hyper_mask   = 1 << xkb_map_mod_get_index (glv_input->xkb_keymap, "Hyper");
-    glv_input->meta_mask    = 1 << xkb_map_mod_get_index (glv_input->xkb_keymap, "Meta");	
+    _xkb_set_keymap(glv_input, keymap);
 
     //
     xkb_context_unref(context);
@@ -315,7 +393,7 @@ static void keyboard_handle_keymap(void *data, struct wl_keyboard *keyboard,
 		return;
 	}
 #endif
-	printf("glview:ime not connected.\n");
+	GLV_LOG_WARN(GLV_DEBUG_IME_INPUT,"glview:ime not connected.\n");
 }
 
 static void keyboard_handle_enter(void *data, struct wl_keyboard *keyboard,
@@ -372,7 +450,7 @@ static void keyboard_handle_key(void *data, struct wl_keyboard *keyboard,
     sym = xkb_state_key_get_one_sym(glv_input->xkb_state, key + 8);
 
 	if(state == WL_KEYBOARD_KEY_STATE_PRESSED){
-		GLV_IF_DEBUG_KB_INPUT printf("-- xkb keysym (0x%X) , %s\n", sym,(state == WL_KEYBOARD_KEY_STATE_PRESSED)? "press": "release");
+		GLV_LOG_DEBUG(GLV_DEBUG_KB_INPUT,"-- xkb keysym (0x%X) , %s\n", sym,(state == WL_KEYBOARD_KEY_STATE_PRESSED)? "press": "release");
 	}
 
 	if((sym >= XKB_KEY_F1) && (sym <= XKB_KEY_F12)){
@@ -576,29 +654,13 @@ static void keyboard_handle_modifiers(void *data, struct wl_keyboard *keyboard,
 #endif
 
     //状態表示
-	GLV_IF_DEBUG_KB_INPUT {
-		printf("-- mods: ");
-
-		if(mods & (1 << xkb_keymap_mod_get_index(glv_input->xkb_keymap, XKB_MOD_NAME_CTRL)))
-			printf("Ctrl ");
-
-		if(mods & (1 << xkb_keymap_mod_get_index(glv_input->xkb_keymap, XKB_MOD_NAME_SHIFT)))
-			printf("Shift ");
-
-		if(mods & (1 << xkb_keymap_mod_get_index(glv_input->xkb_keymap, XKB_MOD_NAME_ALT)))
-			printf("Alt ");
-
-		if(mods & (1 << xkb_keymap_mod_get_index(glv_input->xkb_keymap, XKB_MOD_NAME_LOGO)))
-			printf("Logo ");
-
-		if(mods & (1 << xkb_keymap_mod_get_index(glv_input->xkb_keymap, XKB_MOD_NAME_NUM)))
-			printf("NumLock ");
-
-		if(mods & (1 << xkb_keymap_mod_get_index(glv_input->xkb_keymap, XKB_MOD_NAME_CAPS)))
-			printf("CapsLock ");
-
-		printf("\n");
-	}
+	GLV_LOG_DEBUG(GLV_DEBUG_KB_INPUT,"-- mods: %s%s%s%s%s%s\n",
+		(mods & (1 << xkb_keymap_mod_get_index(glv_input->xkb_keymap, XKB_MOD_NAME_CTRL)))  ? "Ctrl "     : "",
+		(mods & (1 << xkb_keymap_mod_get_index(glv_input->xkb_keymap, XKB_MOD_NAME_SHIFT))) ? "Shift "    : "",
+		(mods & (1 << xkb_keymap_mod_get_index(glv_input->xkb_keymap, XKB_MOD_NAME_ALT)))   ? "Alt "      : "",
+		(mods & (1 << xkb_keymap_mod_get_index(glv_input->xkb_keymap, XKB_MOD_NAME_LOGO)))  ? "Logo "     : "",
+		(mods & (1 << xkb_keymap_mod_get_index(glv_input->xkb_keymap, XKB_MOD_NAME_NUM)))   ? "NumLock "  : "",
+		(mods & (1 << xkb_keymap_mod_get_index(glv_input->xkb_keymap, XKB_MOD_NAME_CAPS)))  ? "CapsLock " : "");
 
 	if(glv_input->ime_key_modifiers != NULL){
 		(glv_input->ime_key_modifiers)(glv_input,mods);
@@ -611,7 +673,7 @@ static void keyboard_handle_modifiers(void *data, struct wl_keyboard *keyboard,
 static void keyboard_repeat_info(void *data, struct wl_keyboard *keyboard,
     int32_t rate, int32_t delay)
 {
-    printf("repeat_info | rate:%d, delay:%d\n", rate, delay);
+    GLV_LOG_INFO(GLV_DEBUG_KB_INPUT,"repeat_info | rate:%d, delay:%d\n", rate, delay);
 }
 
 static const struct wl_keyboard_listener keyboard_listener = {
@@ -711,7 +773,7 @@ static void pointer_handle_motion(void *data, struct wl_pointer *pointer,
 		if(glv_input->pointer_focus_wigetId != wigetId){
 			if(glv_input->pointer_focus_wigetId != 0){
 				leave_window = _glvGetWindowFromId(glv_input->glv_dpy,glv_input->pointer_focus_windowId);
-				GLV_IF_DEBUG_WIGET printf("wigetId = %ld leave\n",glv_input->pointer_focus_wigetId);
+				GLV_LOG_DEBUG(GLV_DEBUG_WIGET,"wigetId = %ld leave\n",glv_input->pointer_focus_wigetId);
 				if(leave_window != NULL){
 					if(leave_window->active_sheet != NULL){
 						if(wigetId == 0){
@@ -722,7 +784,7 @@ static void pointer_handle_motion(void *data, struct wl_pointer *pointer,
 			}
 			if(wigetId != 0){
 				enter_window = glv_window;
-				GLV_IF_DEBUG_WIGET printf("wigetId = %ld enter\n",wigetId);
+				GLV_LOG_DEBUG(GLV_DEBUG_WIGET,"wigetId = %ld enter\n",wigetId);
 			}
 			// --------------------------------------------------------
 			if(leave_window == enter_window){
@@ -1246,29 +1308,29 @@ static void xdg_wm_toplevel_handle_configure(void *data, struct xdg_toplevel *to
     glv_window->toplevel_activated = 0;
     glv_window->toplevel_maximized = 0;
 
-    GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"xdg_wm_toplevel_handle_configure %s\n"GLV_DEBUG_END_COLOR,glv_window->name);
+    GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"xdg_wm_toplevel_handle_configure %s\n"GLV_DEBUG_END_COLOR,glv_window->name);
 
     wl_array_for_each(p, states) {
         uint32_t state = *p;
         switch (state) {
         case XDG_TOPLEVEL_STATE_MAXIMIZED:
 		    glv_window->toplevel_maximized = 1;
-            GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"XDG_TOPLEVEL_STATE_MAXIMIZED %s\n"GLV_DEBUG_END_COLOR,glv_window->name);
+            GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"XDG_TOPLEVEL_STATE_MAXIMIZED %s\n"GLV_DEBUG_END_COLOR,glv_window->name);
             break;
         case XDG_TOPLEVEL_STATE_FULLSCREEN:
-            GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"XDG_TOPLEVEL_STATE_FULLSCREEN %s\n"GLV_DEBUG_END_COLOR,glv_window->name);
+            GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"XDG_TOPLEVEL_STATE_FULLSCREEN %s\n"GLV_DEBUG_END_COLOR,glv_window->name);
             break;
         case XDG_TOPLEVEL_STATE_RESIZING:
-            GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"XDG_TOPLEVEL_STATE_RESIZING %s\n"GLV_DEBUG_END_COLOR,glv_window->name);
+            GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"XDG_TOPLEVEL_STATE_RESIZING %s\n"GLV_DEBUG_END_COLOR,glv_window->name);
             break;
         case XDG_TOPLEVEL_STATE_ACTIVATED:
             glv_window->toplevel_activated = 1;
 			glv_window->glv_dpy->toplevel_active_frameId = glv_window->instance.Id;
-            GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"XDG_TOPLEVEL_STATE_ACTIVATED %s\n"GLV_DEBUG_END_COLOR,glv_window->name);
+            GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"XDG_TOPLEVEL_STATE_ACTIVATED %s\n"GLV_DEBUG_END_COLOR,glv_window->name);
             break;
         default:
             /* Unknown state */
-            GLV_IF_DEBUG_MSG printf(GLV_DEBUG_MSG_COLOR"xdg_wm_toplevel_handle_configure:Unknown state %s\n"GLV_DEBUG_END_COLOR,glv_window->name);
+            GLV_LOG_DEBUG(GLV_DEBUG_MSG,GLV_DEBUG_MSG_COLOR"xdg_wm_toplevel_handle_configure:Unknown state %s\n"GLV_DEBUG_END_COLOR,glv_window->name);
             break;
         }
     }
@@ -1400,7 +1462,20 @@ static const struct wl_shell_surface_listener shell_surface_listener = {
 
 GLV_DISPLAY_t * _glvInitNativeDisplay(GLV_DISPLAY_t *glv_dpy)
 {
-	// non
+#ifdef GLV_HEADLESS_BACKEND
+	char *env;
+
+	// ディスプレイ名"headless"、または環境変数GLVIEW_BACKEND=headlessでheadlessバックエンドを選択する
+	glv_dpy->headless = 0;
+	if((glv_dpy->display_name != NULL) && (strcmp(glv_dpy->display_name,GLV_HEADLESS_DISPLAY_NAME) == 0)){
+		glv_dpy->headless = 1;
+	}
+	env = getenv("GLVIEW_BACKEND");
+	if((env != NULL) && (strcmp(env,GLV_HEADLESS_DISPLAY_NAME) == 0)){
+		glv_dpy->headless = 1;
+	}
+	if(glv_dpy->headless == 1) GLV_LOG_DEBUG(GLV_DEBUG_VERSION,"glview:backend = headless\n");
+#endif /* GLV_HEADLESS_BACKEND */
 	return(glv_dpy);
 }
 
@@ -1427,7 +1502,7 @@ static void data_offer_offer(void *data, struct wl_data_offer *wl_data_offer, co
 	struct data_offer *offer = data;
 	char **p;
 
-	GLV_IF_DEBUG_DATA_DEVICE printf("wl_data_offer # offer | type:\"%s\"\n", type);
+	GLV_LOG_DEBUG(GLV_DEBUG_DATA_DEVICE,"wl_data_offer # offer | type:\"%s\"\n", type);
 
 	p = wl_array_add(&offer->types, sizeof *p);
 	*p = strdup(type);
@@ -1475,7 +1550,7 @@ static void data_device_data_offer(void *data,
 {
 	struct data_offer *offer;
 
-    GLV_IF_DEBUG_DATA_DEVICE printf("wl_data_device # data_offer | offer:%p\n", _offer);
+    GLV_LOG_DEBUG(GLV_DEBUG_DATA_DEVICE,"wl_data_device # data_offer | offer:%p\n", _offer);
 
 	offer = malloc(sizeof *offer);
 
@@ -1613,7 +1688,7 @@ static void data_device_selection(void *data,
 	struct _glvinput *input = data;
 	char **p;
 
-    GLV_IF_DEBUG_DATA_DEVICE printf("wl_data_device # selection | offer:%p\n", offer);
+    GLV_LOG_DEBUG(GLV_DEBUG_DATA_DEVICE,"wl_data_device # selection | offer:%p\n", offer);
 
     //前回の data_offer は破棄する
 	if (input->selection_offer)
@@ -1657,11 +1732,11 @@ static void display_add_data_device(GLV_DISPLAY_t *glv_display, uint32_t id, uin
 static void shm_format(void *data,struct wl_shm *shm,uint32_t format)
 {
 	if(format == WL_SHM_FORMAT_ARGB8888){
-		printf("%u: ARGB8888\n", format);
+		GLV_LOG_DEBUG(GLV_DEBUG_VERSION,"%u: ARGB8888\n", format);
 	} else if(format == WL_SHM_FORMAT_XRGB8888){
-		printf("%u: XRGB8888\n", format);
+		GLV_LOG_DEBUG(GLV_DEBUG_VERSION,"%u: XRGB8888\n", format);
 	} else {
-		printf("0x%08X: '%c%c%c%c'\n",
+		GLV_LOG_DEBUG(GLV_DEBUG_VERSION,"0x%08X: '%c%c%c%c'\n",
 			format,
 			(char)(format >> 24),
 			(char)(format >> 16),
@@ -1711,7 +1786,7 @@ static void display_handle_geometry(void *data,
 {
 	struct _glvoutput *output = data;
 
-    GLV_IF_DEBUG_VERSION printf("glview: output geometry\n"
+    GLV_LOG_DEBUG(GLV_DEBUG_VERSION,"glview: output geometry\n"
         "  x:%d, y:%d, physical_width:%d mm, physical_height:%d mm\n"
         "  subpixel:%d, make:'%s', model:'%s', transform:%d\n",
         x, y, physical_width, physical_height,
@@ -1725,7 +1800,7 @@ static void display_handle_geometry(void *data,
 static void display_handle_done(void *data,
 		     struct wl_output *wl_output)
 {
-	GLV_IF_DEBUG_VERSION printf("glview:output done\n");
+	GLV_LOG_DEBUG(GLV_DEBUG_VERSION,"glview:output done\n");
 }
 
 static void display_handle_scale(void *data,
@@ -1734,7 +1809,7 @@ static void display_handle_scale(void *data,
 {
 	struct _glvoutput *output = data;
 
-	GLV_IF_DEBUG_VERSION printf("glview: output scale factor:%d\n", scale);
+	GLV_LOG_DEBUG(GLV_DEBUG_VERSION,"glview: output scale factor:%d\n", scale);
 
 	output->scale = scale;
 }
@@ -1748,7 +1823,7 @@ static void display_handle_mode(void *data,
 {
 	struct _glvoutput *output = data;
 
-    GLV_IF_DEBUG_VERSION printf("glview: output mode flags:0x%X, width:%d, heigh:%d, refresh:%d mHz\n",
+    GLV_LOG_DEBUG(GLV_DEBUG_VERSION,"glview: output mode flags:0x%X, width:%d, heigh:%d, refresh:%d mHz\n",
         flags, width, height, refresh);
 
 	if (flags & WL_OUTPUT_MODE_CURRENT) {
@@ -1785,39 +1860,39 @@ static void registry_handle_global(void *data, struct wl_registry *registry, uin
 	WL_DISPLAY_t *d = &glv_display->wl_dpy;
 
 	if (strcmp(interface, "wl_compositor") == 0) {
-		GLV_IF_DEBUG_VERSION printf("glview:registry-interface-wl_compositor , version = %d\n",version);
+		GLV_LOG_DEBUG(GLV_DEBUG_VERSION,"glview:registry-interface-wl_compositor , version = %d\n",version);
 		d->compositor = wl_registry_bind(registry, id, &wl_compositor_interface, 1);
 	} else if(strcmp(interface, "wl_subcompositor") == 0){
-		GLV_IF_DEBUG_VERSION printf("glview:registry-interface-wl_subcompositor , version = %d\n",version);
+		GLV_LOG_DEBUG(GLV_DEBUG_VERSION,"glview:registry-interface-wl_subcompositor , version = %d\n",version);
    		d->subcompositor = wl_registry_bind(registry, id, &wl_subcompositor_interface, 1);
 	} else if(strcmp(interface, "xdg_wm_base") == 0) {
-		GLV_IF_DEBUG_VERSION printf("glview:registry-interface-xdg_wm_base , version = %d\n",version);
+		GLV_LOG_DEBUG(GLV_DEBUG_VERSION,"glview:registry-interface-xdg_wm_base , version = %d\n",version);
 		d->xdg_wm_shell = wl_registry_bind(registry, id,&xdg_wm_base_interface, 1);
 		xdg_wm_base_add_listener(d->xdg_wm_shell, &wm_base_listener, d);
 	} else if(strcmp(interface, "zxdg_shell_v6") == 0) {
-		GLV_IF_DEBUG_VERSION printf("glview:registry-interface-zxdg_shell_v6 , version = %d\n",version);
+		GLV_LOG_DEBUG(GLV_DEBUG_VERSION,"glview:registry-interface-zxdg_shell_v6 , version = %d\n",version);
 		d->zxdgV6_shell = wl_registry_bind(registry, id,&zxdg_shell_v6_interface, 1);
 		zxdg_shell_v6_add_listener(d->zxdgV6_shell, &zxdgV6_shell_listener, d);
 	} else if(strcmp(interface, "ivi_application") == 0) {
-		GLV_IF_DEBUG_VERSION printf("glview:registry-interface-wl_shell , version = %d\n",version);
+		GLV_LOG_DEBUG(GLV_DEBUG_VERSION,"glview:registry-interface-wl_shell , version = %d\n",version);
 		d->ivi_application = wl_registry_bind(registry, id,&ivi_application_interface, 1);
 	} else if(strcmp(interface, "wl_shell") == 0) {
-		GLV_IF_DEBUG_VERSION printf("glview:registry-interface-wl_shell , version = %d\n",version);
+		GLV_LOG_DEBUG(GLV_DEBUG_VERSION,"glview:registry-interface-wl_shell , version = %d\n",version);
 		if((0 == d->xdg_wm_shell) && (0 == d->zxdgV6_shell) && (0 == d->ivi_application) ){
 			d->wl_shell = wl_registry_bind(registry, id, &wl_shell_interface, 1);
 		}
 	} else if(strcmp(interface, "wl_shm") == 0) {
-		GLV_IF_DEBUG_VERSION printf("glview:registry-interface-wl_shm , version = %d\n",version);
+		GLV_LOG_DEBUG(GLV_DEBUG_VERSION,"glview:registry-interface-wl_shm , version = %d\n",version);
 		d->shm = wl_registry_bind(registry, id, &wl_shm_interface, 1);
 		//wl_shm_add_listener(d->shm, &shm_listener, NULL);
 	} else if (strcmp(interface, "wl_seat") == 0) {
-		GLV_IF_DEBUG_VERSION printf("glview:registry-interface-wl_seat , version = %d\n",version);
+		GLV_LOG_DEBUG(GLV_DEBUG_VERSION,"glview:registry-interface-wl_seat , version = %d\n",version);
 		display_add_input(glv_display,registry,id,version);
 	} else if (strcmp(interface, "wl_data_device_manager") == 0) {
-		GLV_IF_DEBUG_VERSION printf("glview:registry-interface-wl_data_device_manager , version = %d\n",version);
+		GLV_LOG_DEBUG(GLV_DEBUG_VERSION,"glview:registry-interface-wl_data_device_manager , version = %d\n",version);
 		display_add_data_device(glv_display, id, version);
 	} else if (strcmp(interface, "wl_output") == 0) {
-		GLV_IF_DEBUG_VERSION printf("glview:registry-interface-wl_output , version = %d\n",version);
+		GLV_LOG_DEBUG(GLV_DEBUG_VERSION,"glview:registry-interface-wl_output , version = %d\n",version);
 		display_add_output(glv_display, id, version);
 	}
 }
@@ -1877,8 +1952,74 @@ static int wayland_roundtrip(struct wl_display *display)
    return ret;
 }
 
+#ifdef GLV_HEADLESS_BACKEND
+static GLV_DISPLAY_t *_glvOpenHeadlessDisplay(GLV_DISPLAY_t *glv_dpy)
+{
+	struct _glvinput	*glv_input;
+	struct xkb_context	*context;
+	struct xkb_keymap	*keymap;
+
+	glv_dpy->native_dpy = EGL_DEFAULT_DISPLAY;
+	glv_dpy->wl_dpy.display = NULL;
+
+	wl_list_init(&glv_dpy->wl_dpy.input_list);
+	wl_list_init(&glv_dpy->wl_dpy.output_list);
+
+	// 入力の注入先(wl_seatが無いのでinput_listには登録しない)
+	glv_input = calloc(1,sizeof(struct _glvinput));
+	if(glv_input == NULL){
+		return(NULL);
+	}
+	glv_input->glv_dpy = glv_dpy;
+	glv_input->wl_dpy  = &glv_dpy->wl_dpy;
+
+	// コンポジターからキーマップが通知されないので、既定のキーマップを使用する
+	context = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
+	if(context){
+		keymap = xkb_keymap_new_from_names(context,NULL,XKB_KEYMAP_COMPILE_NO_FLAGS);
+		if(keymap){
+			_xkb_set_keymap(glv_input,keymap);
+		}else{
+			fprintf(stderr,"glview:headless keymap not created.\n");
+		}
+		xkb_context_unref(context);
+	}
+	glv_dpy->headless_input = glv_input;
+
+	return(glv_dpy);
+}
+
+static void _glvCloseHeadlessDisplay(GLV_DISPLAY_t *glv_dpy)
+{
+	struct _glvinput *glv_input = glv_dpy->headless_input;
+
+	if(glv_input != NULL){
+		xkb_state_unref(glv_input->xkb_state);
+		xkb_keymap_unref(glv_input->xkb_keymap);
+		free(glv_input);
+		glv_dpy->headless_input = NULL;
+	}
+	weston_client_window__display_destroy(glv_dpy);
+}
+#endif /* GLV_HEADLESS_BACKEND */
+
 GLV_DISPLAY_t * _glvOpenNativeDisplay(GLV_DISPLAY_t *glv_dpy)
 {
+#ifdef GLV_PTHREAD_MUTEX_RECURSIVE
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE_NP);
+    pthread_mutex_init(&glv_dpy->display_mutex,&attr);	// display
+#else
+	pthread_mutex_init(&glv_dpy->display_mutex,NULL);	// display
+#endif
+
+#ifdef GLV_HEADLESS_BACKEND
+	if(glv_dpy->headless == 1){
+		return(_glvOpenHeadlessDisplay(glv_dpy));
+	}
+#endif /* GLV_HEADLESS_BACKEND */
+
 	glv_dpy->native_dpy = wl_display_connect(NULL);
 	glv_dpy->wl_dpy.display = glv_dpy->native_dpy;
 
@@ -1895,15 +2036,6 @@ GLV_DISPLAY_t * _glvOpenNativeDisplay(GLV_DISPLAY_t *glv_dpy)
 
 	weston_client_window__create_cursors(&glv_dpy->wl_dpy);
 
-#ifdef GLV_PTHREAD_MUTEX_RECURSIVE
-	pthread_mutexattr_t attr;
-	pthread_mutexattr_init(&attr);
-    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE_NP);
-    pthread_mutex_init(&glv_dpy->display_mutex,&attr);	// display
-#else
-	pthread_mutex_init(&glv_dpy->display_mutex,NULL);	// display
-#endif
-
 	return(glv_dpy);
 }
 
@@ -1971,6 +2103,13 @@ void _glvCloseNativeDisplay(GLV_DISPLAY_t *glv_dpy)
 		pthread_mutex_unlock(&glv_dpy->display_mutex);				// display
 	}
 
+#ifdef GLV_HEADLESS_BACKEND
+	if(glv_dpy->headless == 1){
+		_glvCloseHeadlessDisplay(glv_dpy);
+		return;
+	}
+#endif /* GLV_HEADLESS_BACKEND */
+
 	display_destroy_inputs(&glv_dpy->wl_dpy);
 
 	if(glv_dpy->wl_dpy.cursor_theme)
@@ -1996,6 +2135,244 @@ void _glvCloseNativeDisplay(GLV_DISPLAY_t *glv_dpy)
 	wl_display_disconnect(glv_dpy->native_dpy);
 }
 
+// ------------------------------------------------------------------------------------
+// headless
+/**
+ * @brief	headlessバックエンドで動作しているかを調べる
+ * @param[in]	glv_dpy	ディスプレイ
+ * @retval	1	headlessバックエンド
+ * @retval	0	waylandバックエンド
+ */
+int glvDisplay_isHeadless(glvDisplay glv_dpy)
+{
+	GLV_DISPLAY_t *display = (GLV_DISPLAY_t*)glv_dpy;
+
+	if(display == NULL){
+		return(0);
+	}
+	return(display->headless);
+}
+
+#ifdef GLV_HEADLESS_BACKEND
+static struct _glvinput *_glvHeadlessGetInput(GLV_DISPLAY_t *glv_dpy)
+{
+	if((glv_dpy == NULL) || (glv_dpy->headless != 1)){
+		return(NULL);
+	}
+	return(glv_dpy->headless_input);
+}
+
+/**
+ * @brief	コンポジターからのtoplevel configureを模擬する(headlessのみ)
+ * @param[in]	glv_frame	フレームウィンドウ
+ * @param[in]	width		ウィンドウの実体範囲の幅(影を除く)
+ * @param[in]	height		ウィンドウの実体範囲の高さ(影を除く)
+ * @retval	GLV_OK		正常終了
+ * @retval	GLV_ERROR	headlessではない、またはフレームではない
+ */
+int glvHeadless_configure(glvWindow glv_frame,int width,int height)
+{
+	GLV_WINDOW_t *glv_window = (GLV_WINDOW_t*)glv_frame;
+
+	if((glv_window == NULL) || (_glvHeadlessGetInput(glv_window->glv_dpy) == NULL)){
+		return(GLV_ERROR);
+	}
+	if(glv_window->windowType != GLV_TYPE_THREAD_FRAME){
+		return(GLV_ERROR);
+	}
+	glv_window->toplevel_activated = 1;
+	glv_window->glv_dpy->toplevel_active_frameId = glv_window->instance.Id;
+
+	_Window_configure(glv_window,width,height);
+
+	return(GLV_OK);
+}
+
+/**
+ * @brief	ポインターがウィンドウに入ったことを模擬する(headlessのみ)
+ * @param[in]	glv_win	ウィンドウ
+ * @param[in]	x		ウィンドウ内のx座標
+ * @param[in]	y		ウィンドウ内のy座標
+ * @retval	GLV_OK		正常終了
+ * @retval	GLV_ERROR	headlessではない
+ */
+int glvHeadless_pointerEnter(glvWindow glv_win,int x,int y)
+{
+	GLV_WINDOW_t *glv_window = (GLV_WINDOW_t*)glv_win;
+	struct _glvinput *glv_input;
+
+	if(glv_window == NULL){
+		return(GLV_ERROR);
+	}
+	glv_input = _glvHeadlessGetInput(glv_window->glv_dpy);
+	if(glv_input == NULL){
+		return(GLV_ERROR);
+	}
+
+	pthread_mutex_lock(&glv_input->glv_dpy->display_mutex);		// display
+
+	glv_input->wl_dpy->serial++;
+	glv_input->pointer_enter_windowId = glv_window->instance.Id;
+	glv_input->pointer_enter_serial = glv_input->wl_dpy->serial;
+	glv_input->pointer_sx = x;
+	glv_input->pointer_sy = y;
+	if(glv_window->windowType == GLV_TYPE_THREAD_FRAME){
+		glv_window->edges = _get_frame_edges(glv_window, glv_input->pointer_sx, glv_input->pointer_sy);
+	}
+
+	pthread_mutex_unlock(&glv_input->glv_dpy->display_mutex);		// display
+	return(GLV_OK);
+}
+
+/**
+ * @brief	ポインターがウィンドウから出たことを模擬する(headlessのみ)
+ * @param[in]	glv_dpy	ディスプレイ
+ */
+int glvHeadless_pointerLeave(glvDisplay glv_dpy)
+{
+	struct _glvinput *glv_input = _glvHeadlessGetInput((GLV_DISPLAY_t*)glv_dpy);
+
+	if(glv_input == NULL){
+		return(GLV_ERROR);
+	}
+	pointer_handle_leave(glv_input,NULL,glv_input->wl_dpy->serial + 1,NULL);
+	return(GLV_OK);
+}
+
+/**
+ * @brief	ポインターの移動を模擬する(headlessのみ)
+ * @param[in]	glv_dpy	ディスプレイ
+ * @param[in]	x		glvHeadless_pointerEnterで指定したウィンドウ内のx座標
+ * @param[in]	y		glvHeadless_pointerEnterで指定したウィンドウ内のy座標
+ */
+int glvHeadless_pointerMotion(glvDisplay glv_dpy,int x,int y)
+{
+	struct _glvinput *glv_input = _glvHeadlessGetInput((GLV_DISPLAY_t*)glv_dpy);
+
+	if(glv_input == NULL){
+		return(GLV_ERROR);
+	}
+	pointer_handle_motion(glv_input,NULL,_glvHeadlessGetTime(),wl_fixed_from_int(x),wl_fixed_from_int(y));
+	return(GLV_OK);
+}
+
+/**
+ * @brief	ポインターのボタン操作を模擬する(headlessのみ)
+ * @param[in]	glv_dpy	ディスプレイ
+ * @param[in]	button	ボタン(linux/input.hのBTN_LEFT,BTN_RIGHT,BTN_MIDDLE等)
+ * @param[in]	state	GLV_KEYBOARD_KEY_STATE_PRESSED:押下 GLV_KEYBOARD_KEY_STATE_RELEASED:解放
+ */
+int glvHeadless_pointerButton(glvDisplay glv_dpy,uint32_t button,int state)
+{
+	struct _glvinput *glv_input = _glvHeadlessGetInput((GLV_DISPLAY_t*)glv_dpy);
+
+	if(glv_input == NULL){
+		return(GLV_ERROR);
+	}
+	pointer_handle_button(glv_input,NULL,glv_input->wl_dpy->serial + 1,_glvHeadlessGetTime(),button,
+		(state == GLV_KEYBOARD_KEY_STATE_PRESSED) ? WL_POINTER_BUTTON_STATE_PRESSED : WL_POINTER_BUTTON_STATE_RELEASED);
+	return(GLV_OK);
+}
+
+/**
+ * @brief	ホイールの操作を模擬する(headlessのみ)
+ * @param[in]	glv_dpy	ディスプレイ
+ * @param[in]	axis	GLV_MOUSE_EVENT_AXIS_VERTICAL_SCROLL/GLV_MOUSE_EVENT_AXIS_HORIZONTAL_SCROLL
+ * @param[in]	value	移動量
+ */
+int glvHeadless_pointerAxis(glvDisplay glv_dpy,int axis,int value)
+{
+	struct _glvinput *glv_input = _glvHeadlessGetInput((GLV_DISPLAY_t*)glv_dpy);
+
+	if(glv_input == NULL){
+		return(GLV_ERROR);
+	}
+	pointer_handle_axis(glv_input,NULL,_glvHeadlessGetTime(),
+		(axis == GLV_MOUSE_EVENT_AXIS_VERTICAL_SCROLL) ? WL_POINTER_AXIS_VERTICAL_SCROLL : WL_POINTER_AXIS_HORIZONTAL_SCROLL,
+		wl_fixed_from_int(value));
+	return(GLV_OK);
+}
+
+/**
+ * @brief	修飾キーの状態を模擬する(headlessのみ)
+ * @param[in]	glv_dpy			ディスプレイ
+ * @param[in]	mods_depressed	押下中の修飾キー(xkbのmodマスク)
+ * @param[in]	mods_latched	ラッチ中の修飾キー
+ * @param[in]	mods_locked		ロック中の修飾キー
+ * @param[in]	group			キーボードのグループ
+ */
+int glvHeadless_keyboardModifiers(glvDisplay glv_dpy,uint32_t mods_depressed,uint32_t mods_latched,uint32_t mods_locked,uint32_t group)
+{
+	struct _glvinput *glv_input = _glvHeadlessGetInput((GLV_DISPLAY_t*)glv_dpy);
+
+	if((glv_input == NULL) || (glv_input->xkb_state == NULL)){
+		return(GLV_ERROR);
+	}
+	keyboard_handle_modifiers(glv_input,NULL,glv_input->wl_dpy->serial + 1,mods_depressed,mods_latched,mods_locked,group);
+	return(GLV_OK);
+}
+
+/**
+ * @brief	キー入力を模擬する(headlessのみ)
+ * @param[in]	glv_dpy	ディスプレイ
+ * @param[in]	key		evdevのキーコード(linux/input.hのKEY_A等)
+ * @param[in]	state	GLV_KEYBOARD_KEY_STATE_PRESSED:押下 GLV_KEYBOARD_KEY_STATE_RELEASED:解放
+ */
+int glvHeadless_keyboardKey(glvDisplay glv_dpy,uint32_t key,int state)
+{
+	struct _glvinput *glv_input = _glvHeadlessGetInput((GLV_DISPLAY_t*)glv_dpy);
+
+	if((glv_input == NULL) || (glv_input->xkb_state == NULL)){
+		return(GLV_ERROR);
+	}
+	keyboard_handle_key(glv_input,NULL,glv_input->wl_dpy->serial + 1,_glvHeadlessGetTime(),key,
+		(state == GLV_KEYBOARD_KEY_STATE_PRESSED) ? WL_KEYBOARD_KEY_STATE_PRESSED : WL_KEYBOARD_KEY_STATE_RELEASED);
+	return(GLV_OK);
+}
+#else
+// headlessバックエンドを組み込まない場合、入力の模擬は常にGLV_ERRORとする
+int glvHeadless_configure(glvWindow glv_frame,int width,int height)
+{
+	return(GLV_ERROR);
+}
+
+int glvHeadless_pointerEnter(glvWindow glv_win,int x,int y)
+{
+	return(GLV_ERROR);
+}
+
+int glvHeadless_pointerLeave(glvDisplay glv_dpy)
+{
+	return(GLV_ERROR);
+}
+
+int glvHeadless_pointerMotion(glvDisplay glv_dpy,int x,int y)
+{
+	return(GLV_ERROR);
+}
+
+int glvHeadless_pointerButton(glvDisplay glv_dpy,uint32_t button,int state)
+{
+	return(GLV_ERROR);
+}
+
+int glvHeadless_pointerAxis(glvDisplay glv_dpy,int axis,int value)
+{
+	return(GLV_ERROR);
+}
+
+int glvHeadless_keyboardModifiers(glvDisplay glv_dpy,uint32_t mods_depressed,uint32_t mods_latched,uint32_t mods_locked,uint32_t group)
+{
+	return(GLV_ERROR);
+}
+
+int glvHeadless_keyboardKey(glvDisplay glv_dpy,uint32_t key,int state)
+{
+	return(GLV_ERROR);
+}
+#endif /* GLV_HEADLESS_BACKEND */
+// ------------------------------------------------------------------------------------
+
 GLV_WINDOW_t *_glvAllocWindowResource(GLV_DISPLAY_t *glv_dpy,char *name)
 {
 	GLV_WINDOW_t *glv_window;
@@ -2071,13 +2448,32 @@ int _glvCreateWindow(GLV_WINDOW_t *glv_window,char *name,
 		glv_window->myFrame = glv_parent_window->myFrame;
 	}
 
-	w->surface = wl_compositor_create_surface(wl_dpy->compositor);
-
 	w->buffer_scale = 1;
 
+#ifdef GLV_HEADLESS_BACKEND
+	if(glv_dpy->headless == 1){
+		// --------------------------------------------------------------------------------------
+		// headlessはwaylandのsurfaceを作成しない、描画先はpbufferとする
+		native = NULL;
+		if((glv_parent_window == NULL) || (windowType == GLV_TYPE_THREAD_FRAME)){
+			glv_window->absolute_x = 0;
+			glv_window->absolute_y = 0;
+			if(glv_dpy->toplevel_active_frameId == 0){
+				// フォーカスの切り替えが無いので、最初のフレームをアクティブとする
+				glv_window->toplevel_activated = 1;
+				glv_dpy->toplevel_active_frameId = glv_window->instance.Id;
+			}
+		}else{
+			glv_window->absolute_x = glv_parent_window->absolute_x + x + glv_parent_window->frameInfo.left_size;
+			glv_window->absolute_y = glv_parent_window->absolute_y + y + glv_parent_window->frameInfo.top_size;
+		}
+		// --------------------------------------------------------------------------------------
+	}else
+#endif /* GLV_HEADLESS_BACKEND */
 	if((w->parent == NULL) || (windowType == GLV_TYPE_THREAD_FRAME)){
 		// --------------------------------------------------------------------------------------
 		/* frame */
+		w->surface = wl_compositor_create_surface(wl_dpy->compositor);
 #if 0
 		region = wl_compositor_create_region(wl_dpy->compositor);
 		wl_region_add(region, 0, 0, width, height);
@@ -2135,6 +2531,7 @@ int _glvCreateWindow(GLV_WINDOW_t *glv_window,char *name,
 		}
 #endif
 
+		w->surface = wl_compositor_create_surface(wl_dpy->compositor);
 		wl_surface_add_listener(w->surface,&surface_listener, NULL);
 
 		w->subsurface = wl_subcompositor_get_subsurface(wl_dpy->subcompositor,w->surface,w->parent);
@@ -2225,10 +2622,19 @@ int _glvCreateWindow(GLV_WINDOW_t *glv_window,char *name,
 			glv_window->ctx.egl_config = glv_window->teamLeader->ctx.egl_config;
 			break;
 		default:
-			printf("_glvCreateWindow unnon window type %d.\n",windowType);
+			GLV_LOG_ERROR(GLV_DEBUG_INSTANCE,"_glvCreateWindow unnon window type %d.\n",windowType);
 			break;
 	}
 
+#ifdef GLV_HEADLESS_BACKEND
+	if(glv_dpy->headless == 1){
+		glv_window->ctx.egl_surf = _glvHeadlessCreateSurface(glv_window,width,height);
+		if(!glv_window->ctx.egl_surf){
+			fprintf(stderr,"_glvCreateWindow:Error: eglCreatePbufferSurface failed\n");
+			return(GLV_ERROR);
+		}
+	}else
+#endif /* GLV_HEADLESS_BACKEND */
 	glv_window->ctx.egl_surf = eglCreateWindowSurface(glv_dpy->egl_dpy, glv_window->ctx.egl_config, glv_window->egl_window, NULL);
 	if(!glv_window->ctx.egl_surf){
     	fprintf(stderr,"_glvCreateWindow:Error: eglCreateWindowSurface failed\n");
@@ -2242,36 +2648,33 @@ int _glvCreateWindow(GLV_WINDOW_t *glv_window,char *name,
 	pthread_mutex_unlock(&glv_dpy->display_mutex);				// display
 
 	GLV_IF_DEBUG_INSTANCE {
-		printf(GLV_DEBUG_INSTANCE_COLOR"glvCreateWindow "GLV_DEBUG_END_COLOR);
+		const char *type;
 		switch(windowType){
 			case GLV_TYPE_THREAD_FRAME:
-				printf(GLV_DEBUG_INSTANCE_COLOR"freame "GLV_DEBUG_END_COLOR);
+				type = "freame";
 				break;
 			case GLV_TYPE_THREAD_WINDOW:
-				printf(GLV_DEBUG_INSTANCE_COLOR"thrad "GLV_DEBUG_END_COLOR);
+				type = "thrad";
 				break;
 			case GLV_TYPE_CHILD_WINDOW:
-				printf(GLV_DEBUG_INSTANCE_COLOR"child "GLV_DEBUG_END_COLOR);
+				type = "child";
 				break;
 			default:
-				printf(GLV_DEBUG_INSTANCE_COLOR"unknown "GLV_DEBUG_END_COLOR);
+				type = "unknown";
 				break;
 		}
-		printf(GLV_DEBUG_INSTANCE_COLOR" %ld [%s]"GLV_DEBUG_END_COLOR,glv_window->instance.Id,glv_window->name);
-		if(glv_window->parent == NULL){
-			printf(GLV_DEBUG_INSTANCE_COLOR" parent NULL"GLV_DEBUG_END_COLOR);
-		}else{
-			printf(GLV_DEBUG_INSTANCE_COLOR" parent %ld [%s]"GLV_DEBUG_END_COLOR,glv_window->parent->instance.Id,glv_window->parent->name);
-		}
-		if(glv_window->teamLeader == NULL){
-			printf(GLV_DEBUG_INSTANCE_COLOR" teamLeader NULL"GLV_DEBUG_END_COLOR);
-		}else{
-			printf(GLV_DEBUG_INSTANCE_COLOR" teamLeader %ld [%s]"GLV_DEBUG_END_COLOR,glv_window->teamLeader->instance.Id,glv_window->teamLeader->name);
-		}
-		printf("\n");
+		glvLog_write(GLV_LOG_LEVEL_DEBUG,GLV_DEBUG_INSTANCE,
+			GLV_DEBUG_INSTANCE_COLOR"glvCreateWindow %s  %ld [%s] parent %ld [%s] teamLeader %ld [%s]"GLV_DEBUG_END_COLOR"\n",
+			type,glv_window->instance.Id,glv_window->name,
+			(glv_window->parent != NULL) ? glv_window->parent->instance.Id : 0,
+			(glv_window->parent != NULL) ? glv_window->parent->name : "NULL",
+			(glv_window->teamLeader != NULL) ? glv_window->teamLeader->instance.Id : 0,
+			(glv_window->teamLeader != NULL) ? glv_window->teamLeader->name : "NULL");
 	}
 
-	wl_surface_commit(w->surface);
+	if(w->surface != NULL){
+		wl_surface_commit(w->surface);
+	}
 	return(GLV_OK);
 }
 
@@ -2283,7 +2686,8 @@ void _glvGcDestroyWindow(GLV_WINDOW_t *glv_window)
 
 	eglDestroySurface(glv_window->glv_dpy->egl_dpy, glv_window->ctx.egl_surf);
 
-	wl_egl_window_destroy(glv_window->egl_window);
+	if(glv_window->egl_window)
+		wl_egl_window_destroy(glv_window->egl_window);
 
 	// ---------------------------------------------------------------------
 	if(glv_window->wl_window.xdg_wm_toplevel)
@@ -2311,12 +2715,13 @@ void _glvGcDestroyWindow(GLV_WINDOW_t *glv_window)
 	if(glv_window->wl_window.subsurface)
 		wl_subsurface_destroy(glv_window->wl_window.subsurface);
 		
-	wl_surface_destroy(glv_window->wl_window.surface);
+	if(glv_window->wl_window.surface)
+		wl_surface_destroy(glv_window->wl_window.surface);
 
 	if(glv_window->wl_window.frame_cb)
 		wl_callback_destroy(glv_window->wl_window.frame_cb);
 
-	GLV_IF_DEBUG_INSTANCE printf(GLV_DEBUG_INSTANCE_COLOR"_glvGcDestroyWindow id = %ld [%s]\n"GLV_DEBUG_END_COLOR,glv_window->instance.Id,glv_window->name);
+	GLV_LOG_DEBUG(GLV_DEBUG_INSTANCE,GLV_DEBUG_INSTANCE_COLOR"_glvGcDestroyWindow id = %ld [%s]\n"GLV_DEBUG_END_COLOR,glv_window->instance.Id,glv_window->name);
 
 	sem_destroy(&glv_window->initSync);
 
@@ -2520,6 +2925,7 @@ void glvEscapeEventLoop(void *glv_instance)
 	GLV_DISPLAY_t *display = (GLV_DISPLAY_t*)glv_getDisplay(glv_instance);
 	if(display != NULL){
 		display->running = 0;
+		weston_client_window__display_wakeup(display);
 	}
 #endif
 }
@@ -2527,22 +2933,359 @@ void glvEscapeEventLoop(void *glv_instance)
 void glvCommitWindow(glvWindow glv_win)
 {
 	GLV_WINDOW_t	*glv_window = (GLV_WINDOW_t*)glv_win;
+	if(glv_window->wl_window.surface == NULL){
+		return;		// headless
+	}
 	wl_surface_commit(glv_window->wl_window.surface);
 }
 
-//#define DEBUG_frame_callback
-static void frame_callback(void *data, struct wl_callback *callback, uint32_t time)
+#ifndef EGL_BUFFER_AGE_EXT
+#define EGL_BUFFER_AGE_EXT			0x313D
+#endif
+
+static int _glvHasEglExtension(const char *extensions,const char *name)
 {
-	GLV_WINDOW_t *glv_window = data;
+	const char *p;
+	size_t len;
 
-	//assert(callback == glv_window->wl_window.frame_cb);
+	if(extensions == NULL) return(0);
+	len = strlen(name);
+	p = extensions;
+	while((p = strstr(p,name)) != NULL){
+		if(((p == extensions) || (p[-1] == ' ')) && ((p[len] == ' ') || (p[len] == '\0'))){
+			return(1);
+		}
+		p += len;
+	}
+	return(0);
+}
 
-	//printf("-------------------------- frame_callback [%s]\n",glv_window->name);
+/**
+ * @brief	SwapBuffersWithDamage/buffer ageの対応状況を調べる
+ * @param[in]	glv_dpy	ディスプレイ
+ */
+void _glvInitSwapDamage(GLV_DISPLAY_t *glv_dpy)
+{
+	const char *extensions;
 
-	wl_callback_destroy(callback);
-		
-	glv_window->wl_window.frame_cb = NULL;
+	glv_dpy->egl_swapBuffersWithDamage = NULL;
+	glv_dpy->egl_bufferAge = 0;
+
+	extensions = eglQueryString(glv_dpy->egl_dpy,EGL_EXTENSIONS);
+	if(_glvHasEglExtension(extensions,"EGL_KHR_swap_buffers_with_damage")){
+		glv_dpy->egl_swapBuffersWithDamage = (GLV_EGL_SWAP_BUFFERS_WITH_DAMAGE_t)eglGetProcAddress("eglSwapBuffersWithDamageKHR");
+	}
+	if((glv_dpy->egl_swapBuffersWithDamage == NULL) && _glvHasEglExtension(extensions,"EGL_EXT_swap_buffers_with_damage")){
+		glv_dpy->egl_swapBuffersWithDamage = (GLV_EGL_SWAP_BUFFERS_WITH_DAMAGE_t)eglGetProcAddress("eglSwapBuffersWithDamageEXT");
+	}
+	if(_glvHasEglExtension(extensions,"EGL_EXT_buffer_age")){
+		glv_dpy->egl_bufferAge = 1;
+	}
+}
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA		0x31DD
+#endif
+
+typedef EGLDisplay (*GLV_EGL_GET_PLATFORM_DISPLAY_t)(EGLenum platform,void *native_display,const EGLint *attrib_list);
+
+/**
+ * @brief	バックエンドに対応するEGLDisplayを取得する
+ * @param[in]	glv_dpy	ディスプレイ
+ * @retval	EGL_NO_DISPLAY	取得に失敗した
+ */
+EGLDisplay _glvGetNativeEglDisplay(GLV_DISPLAY_t *glv_dpy)
+{
+#ifdef GLV_HEADLESS_BACKEND
+	if(glv_dpy->headless == 1){
+		GLV_EGL_GET_PLATFORM_DISPLAY_t	getPlatformDisplay;
+		EGLDisplay	egl_dpy;
+		const char	*extensions;
+
+		// クライアント拡張(EGL_NO_DISPLAY)でsurfacelessプラットフォームの対応を調べる
+		extensions = eglQueryString(EGL_NO_DISPLAY,EGL_EXTENSIONS);
+		if(_glvHasEglExtension(extensions,"EGL_MESA_platform_surfaceless")){
+			getPlatformDisplay = (GLV_EGL_GET_PLATFORM_DISPLAY_t)eglGetProcAddress("eglGetPlatformDisplayEXT");
+			if(getPlatformDisplay != NULL){
+				egl_dpy = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA,EGL_DEFAULT_DISPLAY,NULL);
+				if(egl_dpy != EGL_NO_DISPLAY){
+					return(egl_dpy);
+				}
+			}
+		}
+		// surfacelessプラットフォームが無い場合は、既定のディスプレイのpbufferを使用する
+		return(eglGetDisplay(EGL_DEFAULT_DISPLAY));
+	}
+#endif /* GLV_HEADLESS_BACKEND */
+	return(eglGetDisplay(glv_dpy->native_dpy));
+}
+
+/**
+ * @brief	バックエンドで使用するEGLConfigのEGL_SURFACE_TYPEを取得する
+ * @param[in]	glv_dpy	ディスプレイ
+ */
+EGLint _glvGetNativeSurfaceType(GLV_DISPLAY_t *glv_dpy)
+{
+#ifdef GLV_HEADLESS_BACKEND
+	if(glv_dpy->headless == 1){
+		return(EGL_PBUFFER_BIT);
+	}
+#endif /* GLV_HEADLESS_BACKEND */
+	return(EGL_WINDOW_BIT);
+}
+
+static int _glvDamageContains(GLV_RECT_t *a,GLV_RECT_t *b)
+{
+	return((a->x <= b->x) && (a->y <= b->y) &&
+			((a->x + a->width) >= (b->x + b->width)) && ((a->y + a->height) >= (b->y + b->height)));
+}
+
+static void _glvDamageUnion(GLV_RECT_t *a,GLV_RECT_t *b)
+{
+	int x2,y2;
+
+	x2 = ((a->x + a->width) > (b->x + b->width)) ? (a->x + a->width) : (b->x + b->width);
+	y2 = ((a->y + a->height) > (b->y + b->height)) ? (a->y + a->height) : (b->y + b->height);
+	if(b->x < a->x) a->x = b->x;
+	if(b->y < a->y) a->y = b->y;
+	a->width  = x2 - a->x;
+	a->height = y2 - a->y;
+}
+
+// 2つの矩形を外接矩形にまとめても、増える面積(どちらにも含まれない部分)が小さいか
+static int _glvDamageWorthMerging(GLV_RECT_t *a,GLV_RECT_t *b)
+{
+	GLV_RECT_t u = *a;
+	long long area,cover,iw,ih;
+
+	_glvDamageUnion(&u,b);
+	iw = (long long)((a->x + a->width) < (b->x + b->width) ? (a->x + a->width) : (b->x + b->width)) - ((a->x > b->x) ? a->x : b->x);
+	ih = (long long)((a->y + a->height) < (b->y + b->height) ? (a->y + a->height) : (b->y + b->height)) - ((a->y > b->y) ? a->y : b->y);
+	cover = (long long)a->width * a->height + (long long)b->width * b->height;
+	if((iw > 0) && (ih > 0)){
+		cover -= iw * ih;
+	}
+	area = (long long)u.width * u.height;
+	return(((area - cover) * 100) <= (cover * GLV_DAMAGE_MERGE_WASTE));
+}
+
+// 更新領域に矩形を追加する(ウィンドウの範囲でクリップ済みであること)
+// 重なる(隣接する)矩形は、外接矩形で増える面積がGLV_DAMAGE_MERGE_WASTE(%)以下ならまとめる
+static void _glvDamageAddRect(GLV_DAMAGE_t *damage,GLV_RECT_t *rect)
+{
+	GLV_RECT_t add = *rect;
+	int i,merged;
+
+	if(damage->full == 1) return;
+
+	do{
+		merged = 0;
+		for(i=0;i<damage->num;i++){
+			if(_glvDamageContains(&damage->rect[i],&add)){
+				return;
+			}
+			if(_glvDamageContains(&add,&damage->rect[i]) || _glvDamageWorthMerging(&damage->rect[i],&add)){
+				// まとめた矩形は他の矩形とも重なる場合があるので、取り除いてから追加し直す
+				_glvDamageUnion(&add,&damage->rect[i]);
+				damage->rect[i] = damage->rect[--damage->num];
+				merged = 1;
+				break;
+			}
+		}
+	}while(merged == 1);
+
+	if(damage->num < GLV_DAMAGE_RECT_MAX){
+		damage->rect[damage->num++] = add;
+		return;
+	}
+	// 矩形数を超えた場合は外接矩形にまとめる
+	for(i=1;i<damage->num;i++){
+		_glvDamageUnion(&damage->rect[0],&damage->rect[i]);
+	}
+	_glvDamageUnion(&damage->rect[0],&add);
+	damage->num = 1;
+}
+
+static void _glvDamageMerge(GLV_DAMAGE_t *damage,GLV_DAMAGE_t *add)
+{
+	int i;
+
+	if(add->full == 1){
+		damage->full = 1;
+		damage->num = 0;
+		return;
+	}
+	for(i=0;i<add->num;i++){
+		_glvDamageAddRect(damage,&add->rect[i]);
+	}
+}
+
+/**
+ * @brief	次のSwapBuffersで表示に反映する更新領域を追加する
+ * @param[in]	glv_win	ウィンドウ
+ * @param[in]	x,y		更新領域の左上(ウィンドウ座標)
+ * @param[in]	width,height	更新領域のサイズ
+ * @retval	GLV_OK		正常
+ * @retval	GLV_ERROR	異常
+ */
+int glvWindow_addDamage(glvWindow glv_win,int x,int y,int width,int height)
+{
+	GLV_WINDOW_t *glv_window = (GLV_WINDOW_t*)glv_win;
+	GLV_RECT_t rect;
+
+	if(glv_window == NULL){
+		return(GLV_ERROR);
+	}
+
+	// ウィンドウの範囲でクリップする
+	if(x < 0){ width += x; x = 0; }
+	if(y < 0){ height += y; y = 0; }
+	if((x + width) > glv_window->width)   width  = glv_window->width - x;
+	if((y + height) > glv_window->height) height = glv_window->height - y;
+	if((width <= 0) || (height <= 0)){
+		return(GLV_OK);
+	}
+
+	pthread_mutex_lock(&glv_window->window_mutex);			// window
+	if((width == glv_window->width) && (height == glv_window->height)){
+		glv_window->damage.full = 1;
+		glv_window->damage.num = 0;
+	}else{
+		rect.x = x;
+		rect.y = y;
+		rect.width = width;
+		rect.height = height;
+		_glvDamageAddRect(&glv_window->damage,&rect);
+	}
+	pthread_mutex_unlock(&glv_window->window_mutex);		// window
+	return(GLV_OK);
+}
+
+/**
+ * @brief	次のSwapBuffersでウィンドウ全体を表示に反映する
+ * @param[in]	glv_win	ウィンドウ
+ * @retval	GLV_OK		正常
+ * @retval	GLV_ERROR	異常
+ */
+int glvWindow_addDamageFull(glvWindow glv_win)
+{
+	GLV_WINDOW_t *glv_window = (GLV_WINDOW_t*)glv_win;
+
+	if(glv_window == NULL){
+		return(GLV_ERROR);
+	}
+
+	pthread_mutex_lock(&glv_window->window_mutex);			// window
+	glv_window->damage.full = 1;
+	glv_window->damage.num = 0;
+	pthread_mutex_unlock(&glv_window->window_mutex);		// window
+	return(GLV_OK);
+}
+
+/**
+ * @brief	次のSwapBuffersまでに蓄積した更新領域を取得する
+ * @param[in]	glv_win	ウィンドウ
+ * @param[out]	damage	更新領域
+ * @retval	GLV_OK		正常
+ * @retval	GLV_ERROR	異常
+ */
+int glvWindow_getDamage(glvWindow glv_win,GLV_DAMAGE_t *damage)
+{
+	GLV_WINDOW_t *glv_window = (GLV_WINDOW_t*)glv_win;
+
+	if((glv_window == NULL) || (damage == NULL)){
+		return(GLV_ERROR);
+	}
+
+	pthread_mutex_lock(&glv_window->window_mutex);			// window
+	*damage = glv_window->damage;
+	pthread_mutex_unlock(&glv_window->window_mutex);		// window
+	return(GLV_OK);
+}
+
+/**
+ * @brief	このフレームで再描画が必要な領域を取得する
+ *
+ * 描画先バッファの内容が何フレーム前のものか(buffer age)を調べ、
+ * 蓄積中の更新領域にその間のフレームの更新領域を加えて返す。
+ * buffer ageが使えない場合やバッファの内容が不定の場合はfullを返す。
+ * 描画スレッド(eglMakeCurrent済み)から呼ぶこと。
+ *
+ * @param[in]	glv_win	ウィンドウ
+ * @param[out]	damage	再描画が必要な領域
+ * @retval	GLV_OK		正常
+ * @retval	GLV_ERROR	異常
+ */
+int glvWindow_getRepaintDamage(glvWindow glv_win,GLV_DAMAGE_t *damage)
+{
+	GLV_WINDOW_t *glv_window = (GLV_WINDOW_t*)glv_win;
+	EGLint age = 0;
+	int i,index;
+
+	if((glv_window == NULL) || (damage == NULL)){
+		return(GLV_ERROR);
+	}
+
+	if(glv_window->glv_dpy->egl_bufferAge == 1){
+		if(eglQuerySurface(glv_window->glv_dpy->egl_dpy,glv_window->ctx.egl_surf,EGL_BUFFER_AGE_EXT,&age) != EGL_TRUE){
+			age = 0;
+		}
+	}
+
+	pthread_mutex_lock(&glv_window->window_mutex);			// window
+	*damage = glv_window->damage;
+	if((age <= 0) || (age > (GLV_DAMAGE_HISTORY_NUM + 1))){
+		damage->full = 1;
+		damage->num = 0;
+	}else{
+		for(i=1;i<age;i++){
+			index = (glv_window->damageHistoryIndex - i + GLV_DAMAGE_HISTORY_NUM) % GLV_DAMAGE_HISTORY_NUM;
+			_glvDamageMerge(damage,&glv_window->damageHistory[index]);
+		}
+	}
+	pthread_mutex_unlock(&glv_window->window_mutex);		// window
+	return(GLV_OK);
+}
+
+// 蓄積した更新領域で表示に反映する
+// GLV_WINDOW_ATTR_DAMAGE_SWAPが無い、更新領域が無い、または拡張機能が無い場合は全体を反映する
+static void _glvSwapBuffersWithDamage(GLV_WINDOW_t *glv_window)
+{
+	GLV_DISPLAY_t *glv_dpy = glv_window->glv_dpy;
+	EGLint rects[4 * GLV_DAMAGE_RECT_MAX];
+	GLV_DAMAGE_t damage;
+	int i;
+
+	pthread_mutex_lock(&glv_window->window_mutex);			// window
+	damage = glv_window->damage;
+	if(((glv_window->attr & GLV_WINDOW_ATTR_DAMAGE_SWAP) == 0) || (damage.num == 0)){
+		damage.full = 1;
+		damage.num = 0;
+	}
+	glv_window->damageHistory[glv_window->damageHistoryIndex] = damage;
+	glv_window->damageHistoryIndex = (glv_window->damageHistoryIndex + 1) % GLV_DAMAGE_HISTORY_NUM;
+	glv_window->damage.full = 0;
+	glv_window->damage.num = 0;
+	pthread_mutex_unlock(&glv_window->window_mutex);		// window
+
+	if((damage.full == 0) && (glv_dpy->egl_swapBuffersWithDamage != NULL)){
+		// EGLの座標系は左下原点
+		for(i=0;i<damage.num;i++){
+			rects[i * 4 + 0] = damage.rect[i].x;
+			rects[i * 4 + 1] = glv_window->height - (damage.rect[i].y + damage.rect[i].height);
+			rects[i * 4 + 2] = damage.rect[i].width;
+			rects[i * 4 + 3] = damage.rect[i].height;
+		}
+		// wl_surface.damage_bufferはEGLの実装が発行する
+		glv_dpy->egl_swapBuffersWithDamage(glv_dpy->egl_dpy,glv_window->ctx.egl_surf,rects,damage.num);
+	}else{
+		eglSwapBuffers(glv_dpy->egl_dpy,glv_window->ctx.egl_surf);
+	}
+}
 
+//#define DEBUG_frame_callback
+static void _glvFrameDone(GLV_WINDOW_t *glv_window,uint32_t time)
+{
 	glv_window->wl_window.last_time = time;
 
 	pthread_mutex_lock(&glv_window->window_mutex);			// window
@@ -2557,11 +3300,36 @@ static void frame_callback(void *data, struct wl_callback *callback, uint32_t ti
 #endif /* DEBUG_frame_callback */
 	pthread_mutex_unlock(&glv_window->window_mutex);		// window
 
+#ifdef GLV_TRACE
+	if(GLV_TRACE_ON){
+		_glvTracePresent(glv_window);
+	}
+#endif /* GLV_TRACE */
+
+#ifdef GLV_FRAME_SCHEDULER
+	_glvOnFrameDone(glv_window);	// frame中に集約した描画要求を送信する
+#endif /* GLV_FRAME_SCHEDULER */
+
 	if(glv_window->eventFunc.endDraw != NULL){
 		_glvOnEndDraw(glv_window,time);
 	}
 }
 
+static void frame_callback(void *data, struct wl_callback *callback, uint32_t time)
+{
+	GLV_WINDOW_t *glv_window = data;
+
+	//assert(callback == glv_window->wl_window.frame_cb);
+
+	//printf("-------------------------- frame_callback [%s]\n",glv_window->name);
+
+	wl_callback_destroy(callback);
+		
+	glv_window->wl_window.frame_cb = NULL;
+
+	_glvFrameDone(glv_window,time);
+}
+
 static const struct wl_callback_listener freame_listener = {
 	frame_callback
 };
@@ -2586,8 +3354,10 @@ void glvSwapBuffers(glvWindow glv_win)
 	}
 #endif /* DEBUG_frame_callback */
 
-	glv_window->wl_window.frame_cb = wl_surface_frame(glv_window->wl_window.surface);
-	wl_callback_add_listener(glv_window->wl_window.frame_cb, &freame_listener, glv_window);
+	if(glv_window->wl_window.surface != NULL){
+		glv_window->wl_window.frame_cb = wl_surface_frame(glv_window->wl_window.surface);
+		wl_callback_add_listener(glv_window->wl_window.frame_cb, &freame_listener, glv_window);
+	}
 
 	glv_window->drawCount++;
 
@@ -2595,8 +3365,30 @@ void glvSwapBuffers(glvWindow glv_win)
 	glv_window->draw__run = 1;
 	glv_window->draw__run_count++;
 	pthread_mutex_unlock(&glv_window->window_mutex);		// window
-
-	eglSwapBuffers(glv_window->glv_dpy->egl_dpy, glv_window->ctx.egl_surf);
+#ifdef GLV_FRAME_SCHEDULER
+	_glvFrameBegin(glv_window);		// 次の描画はframe callbackまで待つ
+#endif /* GLV_FRAME_SCHEDULER */
+
+#ifdef GLV_TRACE
+	uint64_t trace_start = 0;
+	if(GLV_TRACE_ON){
+		trace_start = _glvTraceNow();
+		_glvTraceSwap(glv_window);
+	}
+#endif /* GLV_TRACE */
+	glvGl_FlushBatch();		// バッチ描画の蓄積分を描画
+	_glvSwapBuffersWithDamage(glv_window);
+#ifdef GLV_TRACE
+	if(GLV_TRACE_ON && (trace_start != 0)){
+		_glvTraceComplete("swapBuffers","frame",trace_start,glv_window->instance.Id,glv_window->name);
+	}
+#endif /* GLV_TRACE */
+#ifdef GLV_HEADLESS_BACKEND
+	if(glv_window->glv_dpy->headless == 1){
+		// headlessはframe callbackが通知されないので、swapの完了をframe callbackとする
+		_glvFrameDone(glv_window,_glvHeadlessGetTime());
+	}
+#endif /* GLV_HEADLESS_BACKEND */
 	//printf("glvSwapBuffers: eglSwapBuffers %s , draw__run_count = %d\n",glv_window->name,glv_window->draw__run_count);
 	// -------------------------------------------------------------------------
 	// surfaceを作成した最初の描画では、そのsurfaceが表示されない場合がある為、
@@ -2621,6 +3413,13 @@ GLV_WINDOW_t *_glvGetWindowFromId(GLV_DISPLAY_t *glv_dpy,glvInstanceId windowId)
 {
 	GLV_WINDOW_t *glv_window;
 
+#ifdef GLV_INSTANCE_ID_MAP
+	glv_window = _glvGetInstanceFromId(windowId,GLV_INSTANCE_TYPE_WINDOW);
+	if((glv_window != NULL) && (glv_window->glv_dpy == glv_dpy)){
+		return(glv_window);
+	}
+	return(NULL);
+#else
 	pthread_mutex_lock(&glv_dpy->display_mutex);			// display
 
 	wl_list_for_each(glv_window, &((GLV_DISPLAY_t*)glv_dpy)->window_list, link){
@@ -2631,6 +3430,7 @@ GLV_WINDOW_t *_glvGetWindowFromId(GLV_DISPLAY_t *glv_dpy,glvInstanceId windowId)
 	}
 	pthread_mutex_unlock(&glv_dpy->display_mutex);			// display
 	return(NULL);
+#endif /* GLV_INSTANCE_ID_MAP */
 }
 
 int _glv_destroyAllWindow(GLV_DISPLAY_t *glv_dpy)
@@ -2644,7 +3444,7 @@ int _glv_destroyAllWindow(GLV_DISPLAY_t *glv_dpy)
 		_glvDestroyWindow(glv_all_window);
 		pthread_mutex_destroy(&glv_all_window->window_mutex);
 		pthread_mutex_destroy(&glv_all_window->serialize_mutex);
-		GLV_IF_DEBUG_INSTANCE printf(GLV_DEBUG_INSTANCE_COLOR"_glv_destroyAllWindow: destroy [%s]\n"GLV_DEBUG_END_COLOR,glv_all_window->name);
+		GLV_LOG_DEBUG(GLV_DEBUG_INSTANCE,GLV_DEBUG_INSTANCE_COLOR"_glv_destroyAllWindow: destroy [%s]\n"GLV_DEBUG_END_COLOR,glv_all_window->name);
 		free(glv_all_window);
 	}
 	pthread_mutex_unlock(&glv_dpy->display_mutex);				// display
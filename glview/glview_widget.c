@@ -37,6 +37,175 @@
 
 glvInstanceId _glv_instance_Id = 0;
 
+// -----------------------------------------------------------------------------------------------
+// wiget検索用グリッド
+// 表示中のwigetの矩形をセル単位で登録し、座標からwigetを検索する
+// 更新・検索はsheet_mutexを取得して行う
+// -----------------------------------------------------------------------------------------------
+static int _glv_wiget_grid_div(int v)
+{
+	// 負の座標も切り捨てる
+	return((v >= 0) ? (v / GLV_WIGET_GRID_CELL_SIZE) : -((-v + GLV_WIGET_GRID_CELL_SIZE - 1) / GLV_WIGET_GRID_CELL_SIZE));
+}
+
+static GLV_WIGET_GRID_CELL_t *_glv_wiget_grid_cell(GLV_WIGET_GRID_t *grid,int cx,int cy)
+{
+	uint32_t hash;
+
+	hash = ((uint32_t)cx * 73856093u) ^ ((uint32_t)cy * 19349663u);
+	return(&grid->cell[hash % GLV_WIGET_GRID_HASH_SIZE]);
+}
+
+static void _glv_wiget_grid_cell_add(GLV_WIGET_GRID_CELL_t *cell,GLV_WIGET_t *glv_wiget)
+{
+	GLV_WIGET_t **wiget;
+	int i;
+
+	for(i=0;i<cell->num;i++){
+		if(cell->wiget[i] == glv_wiget) return;		// 同じハッシュに複数のセルが重なった場合
+	}
+	if(cell->num >= cell->max){
+		int max = (cell->max == 0) ? 8 : cell->max * 2;
+		wiget = realloc(cell->wiget,sizeof(GLV_WIGET_t*) * max);
+		if(wiget == NULL){
+			fprintf(stderr,"_glv_wiget_grid_cell_add:Error: realloc failed\n");
+			return;
+		}
+		cell->wiget = wiget;
+		cell->max = max;
+	}
+	cell->wiget[cell->num++] = glv_wiget;
+}
+
+static void _glv_wiget_grid_cell_remove(GLV_WIGET_GRID_CELL_t *cell,GLV_WIGET_t *glv_wiget)
+{
+	int i;
+
+	for(i=0;i<cell->num;i++){
+		if(cell->wiget[i] == glv_wiget){
+			cell->wiget[i] = cell->wiget[--cell->num];
+			return;
+		}
+	}
+}
+
+// sheet_mutexを取得した状態で呼ぶこと
+static void _glv_wiget_grid_remove(GLV_SHEET_t *glv_sheet,GLV_WIGET_t *glv_wiget)
+{
+	GLV_WIGET_GRID_t *grid = &glv_sheet->wiget_grid;
+	int cx,cy;
+
+	if(glv_wiget->grid_indexed == 0) return;
+
+	if(glv_wiget->grid_large == 1){
+		_glv_wiget_grid_cell_remove(&grid->large,glv_wiget);
+	}else{
+		for(cy=glv_wiget->grid_y0;cy<=glv_wiget->grid_y1;cy++){
+			for(cx=glv_wiget->grid_x0;cx<=glv_wiget->grid_x1;cx++){
+				_glv_wiget_grid_cell_remove(_glv_wiget_grid_cell(grid,cx,cy),glv_wiget);
+			}
+		}
+	}
+	glv_wiget->grid_indexed = 0;
+}
+
+// wigetの矩形・表示状態の変更をグリッドに反映する
+// sheet_mutexを取得した状態で呼ぶこと
+static void _glv_wiget_grid_update(GLV_WIGET_t *glv_wiget)
+{
+	GLV_SHEET_t *glv_sheet = glv_wiget->glv_sheet;
+	GLV_WIGET_GRID_t *grid = &glv_sheet->wiget_grid;
+	int cx,cy;
+
+	_glv_wiget_grid_remove(glv_sheet,glv_wiget);
+
+	if((glv_wiget->instance.alive == GLV_INSTANCE_ALIVE) && (glv_wiget->visible == GLV_VISIBLE) &&
+		(glv_wiget->width > 0) && (glv_wiget->height > 0)){
+		glv_wiget->grid_x0 = _glv_wiget_grid_div(glv_wiget->sheet_x);
+		glv_wiget->grid_y0 = _glv_wiget_grid_div(glv_wiget->sheet_y);
+		glv_wiget->grid_x1 = _glv_wiget_grid_div(glv_wiget->sheet_x + glv_wiget->width);
+		glv_wiget->grid_y1 = _glv_wiget_grid_div(glv_wiget->sheet_y + glv_wiget->height);
+		if(((glv_wiget->grid_x1 - glv_wiget->grid_x0 + 1) * (glv_wiget->grid_y1 - glv_wiget->grid_y0 + 1)) > GLV_WIGET_GRID_MAX_CELLS){
+			glv_wiget->grid_large = 1;
+			_glv_wiget_grid_cell_add(&grid->large,glv_wiget);
+		}else{
+			glv_wiget->grid_large = 0;
+			for(cy=glv_wiget->grid_y0;cy<=glv_wiget->grid_y1;cy++){
+				for(cx=glv_wiget->grid_x0;cx<=glv_wiget->grid_x1;cx++){
+					_glv_wiget_grid_cell_add(_glv_wiget_grid_cell(grid,cx,cy),glv_wiget);
+				}
+			}
+		}
+		glv_wiget->grid_indexed = 1;
+	}
+}
+
+static void _glv_wiget_grid_free(GLV_SHEET_t *glv_sheet)
+{
+	GLV_WIGET_GRID_t *grid = &glv_sheet->wiget_grid;
+	int i;
+
+	for(i=0;i<GLV_WIGET_GRID_HASH_SIZE;i++){
+		free(grid->cell[i].wiget);
+	}
+	free(grid->large.wiget);
+	memset(grid,0,sizeof(GLV_WIGET_GRID_t));
+}
+
+static GLV_WIGET_t *_glv_wiget_grid_hit_cell(GLV_WIGET_GRID_CELL_t *cell,GLV_WIGET_t *hit,int x,int y,int checkAttr)
+{
+	GLV_WIGET_t *glv_wiget;
+	int i;
+
+	for(i=0;i<cell->num;i++){
+		glv_wiget = cell->wiget[i];
+		if((hit != NULL) && (glv_wiget->zorder < hit->zorder)) continue;
+		if((glv_wiget->instance.alive == GLV_INSTANCE_ALIVE) &&
+			((checkAttr == 0) || (glv_wiget->attr != 0)) &&
+			(glv_wiget->visible == GLV_VISIBLE) &&
+			(glv_wiget->sheet_x < x ) &&
+			((glv_wiget->sheet_x + glv_wiget->width) > x) &&
+			(glv_wiget->sheet_y < y ) &&
+			((glv_wiget->sheet_y + glv_wiget->height) > y)){
+			hit = glv_wiget;
+		}
+	}
+	return(hit);
+}
+
+// 座標(x,y)にある一番上のwigetを検索する(wiget_listを後ろから探した場合と同じ結果)
+// checkAttr:1 属性(attr)が設定されていないwigetは対象外とする
+// sheet_mutexを取得した状態で呼ぶこと
+static GLV_WIGET_t *_glv_wiget_grid_hit(GLV_SHEET_t *glv_sheet,int x,int y,int checkAttr)
+{
+	GLV_WIGET_GRID_t *grid = &glv_sheet->wiget_grid;
+	GLV_WIGET_t *hit = NULL;
+
+	hit = _glv_wiget_grid_hit_cell(_glv_wiget_grid_cell(grid,_glv_wiget_grid_div(x),_glv_wiget_grid_div(y)),hit,x,y,checkAttr);
+	hit = _glv_wiget_grid_hit_cell(&grid->large,hit,x,y,checkAttr);
+	return(hit);
+}
+
+// sheetに属するwigetをインスタンスIDから検索する
+static GLV_WIGET_t *_glv_wiget_from_id(GLV_SHEET_t *glv_sheet,glvInstanceId wigetId)
+{
+	GLV_WIGET_t		*glv_wiget;
+
+#ifdef GLV_INSTANCE_ID_MAP
+	glv_wiget = _glvGetInstanceFromId(wigetId,GLV_INSTANCE_TYPE_WIGET);
+	if((glv_wiget != NULL) && (glv_wiget->glv_sheet == glv_sheet)){
+		return(glv_wiget);
+	}
+#else
+	wl_list_for_each_reverse(glv_wiget, &glv_sheet->wiget_list, link){
+		if(glv_wiget->instance.Id == wigetId){
+			return(glv_wiget);
+		}
+	}
+#endif /* GLV_INSTANCE_ID_MAP */
+	return(NULL);
+}
+
 void _glv_sheet_with_wiget_reshape_cb(GLV_WINDOW_t *glv_window)
 {
 	GLV_SHEET_t		*glv_sheet;
@@ -55,8 +224,10 @@ void _glv_sheet_with_wiget_reshape_cb(GLV_WINDOW_t *glv_window)
 			}
 			if(glv_sheet->reqDrawWigetsFlag == 1){
 				glv_sheet->reqDrawWigetsFlag = 0;
+				glv_sheet->reqDirtyWigetsFlag = 0;
 				wl_list_for_each(glv_wiget, &glv_sheet->wiget_list, link){
 					//printf("2 _glv_sheet_with_wiget_reshape_cb %s\n",glv_window->name);
+					glv_wiget->dirty = 0;
 					if((glv_wiget->instance.alive == GLV_INSTANCE_ALIVE) && (glv_wiget->visible == GLV_VISIBLE) && (glv_wiget->eventFunc.redraw != NULL)){
 						//printf("_glv_sheet_with_wiget_reshape_cb: redraw wiget id = %ld\n",glv_wiget->instance.Id);
 						rc = (glv_wiget->eventFunc.redraw)((glvWindow)glv_window,(glvSheet)glv_sheet,(glvWiget)glv_wiget);
@@ -93,7 +264,9 @@ void _glv_sheet_with_wiget_redraw_cb(GLV_WINDOW_t *glv_window)
 			}
 		}
 		// -------------------------------------------------------
+		glv_sheet->reqDirtyWigetsFlag = 0;
 		wl_list_for_each(glv_wiget, &glv_sheet->wiget_list, link){
+			glv_wiget->dirty = 0;
 			if((glv_wiget->instance.alive == GLV_INSTANCE_ALIVE) && (glv_wiget->visible == GLV_VISIBLE) && (glv_wiget->eventFunc.redraw != NULL)){
 				//printf("_glv_sheet_with_wiget_redraw_cb: redraw wiget id = %ld\n",glv_wiget->instance.Id);
 				rc = (glv_wiget->eventFunc.redraw)((glvWindow)glv_window,(glvSheet)glv_sheet,(glvWiget)glv_wiget);
@@ -106,6 +279,119 @@ void _glv_sheet_with_wiget_redraw_cb(GLV_WINDOW_t *glv_window)
 	}
 }
 
+// wigetが描画する範囲(矩形+paint_margin)
+static void _glv_wiget_paint_rect(GLV_WIGET_t *glv_wiget,GLV_RECT_t *rect)
+{
+	rect->x = glv_wiget->sheet_x - glv_wiget->paint_margin;
+	rect->y = glv_wiget->sheet_y - glv_wiget->paint_margin;
+	rect->width = glv_wiget->width + glv_wiget->paint_margin * 2;
+	rect->height = glv_wiget->height + glv_wiget->paint_margin * 2;
+}
+
+// wigetが描画する範囲を更新領域に追加する
+static void _glv_wiget_add_damage(GLV_WIGET_t *glv_wiget)
+{
+	GLV_RECT_t paint;
+
+	_glv_wiget_paint_rect(glv_wiget,&paint);
+	glvWindow_addDamage(glv_wiget->glv_sheet->glv_window,paint.x,paint.y,paint.width,paint.height);
+}
+
+static int _glv_wiget_is_overlap(GLV_WIGET_t *glv_wiget,GLV_RECT_t *rect)
+{
+	GLV_RECT_t paint;
+
+	_glv_wiget_paint_rect(glv_wiget,&paint);
+	return((paint.x < (rect->x + rect->width)) && ((paint.x + paint.width) > rect->x) &&
+			(paint.y < (rect->y + rect->height)) && ((paint.y + paint.height) > rect->y));
+}
+
+/**
+ * @brief	updateの描画を再描画が必要な領域に制限する
+ *
+ * 再描画要求(glvWiget_reqDraw)されたwigetがある場合に、GLV_ON_UPDATEでウィンドウ・シートの
+ * update(背景の描画)を呼ぶ前に呼ぶ。再描画が必要な領域(再描画要求されたwigetの描画範囲と
+ * buffer ageで失われた領域)の外接矩形をglScissorで設定する。背景とwigetはこの範囲だけ描画され、
+ * それ以外の領域は前のフレームの内容を残す。制限は_glv_sheet_with_wiget_update_cbで解除する。
+ *
+ * 次の場合は制限しない(_glv_sheet_with_wiget_update_cbで全てのwigetを再描画する)
+ *   - バッファの内容が不定(buffer ageが使えない)
+ *   - ウィンドウ・シートにupdateが無く、redrawで代用する(全体を描画する)
+ *
+ * @param[in]	glv_window	ウィンドウ
+ * @retval	1	制限した
+ * @retval	0	制限しない
+ */
+int _glv_sheet_begin_dirty_update(GLV_WINDOW_t *glv_window)
+{
+	GLV_SHEET_t		*glv_sheet;
+	GLV_DAMAGE_t	repaint;
+	GLV_RECT_t		*rect;
+	int i,x2,y2;
+
+	if(glv_window == NULL) return(0);
+	glv_sheet = glv_window->active_sheet;
+	if(glv_sheet == NULL) return(0);
+
+	glv_sheet->dirtyUpdate = 0;
+	if((glv_sheet->instance.alive != GLV_INSTANCE_ALIVE) || (glv_sheet->initialized != 1) ||
+		(glv_sheet->reqDirtyWigetsFlag != 1)){
+		return(0);
+	}
+	if(((glv_window->eventFunc.update == NULL) && (glv_window->eventFunc.redraw != NULL)) ||
+		((glv_sheet->eventFunc.update == NULL) && (glv_sheet->eventFunc.redraw != NULL))){
+		return(0);
+	}
+
+	glvWindow_getRepaintDamage(glv_window,&repaint);
+	if((repaint.full == 1) || (repaint.num == 0)){
+		return(0);
+	}
+
+	rect = &glv_sheet->dirtyRect;
+	*rect = repaint.rect[0];
+	for(i=1;i<repaint.num;i++){
+		x2 = ((rect->x + rect->width) > (repaint.rect[i].x + repaint.rect[i].width)) ? (rect->x + rect->width) : (repaint.rect[i].x + repaint.rect[i].width);
+		y2 = ((rect->y + rect->height) > (repaint.rect[i].y + repaint.rect[i].height)) ? (rect->y + rect->height) : (repaint.rect[i].y + repaint.rect[i].height);
+		if(repaint.rect[i].x < rect->x) rect->x = repaint.rect[i].x;
+		if(repaint.rect[i].y < rect->y) rect->y = repaint.rect[i].y;
+		rect->width  = x2 - rect->x;
+		rect->height = y2 - rect->y;
+	}
+	// 外接矩形の全体を描画するので、表示への反映も外接矩形で行う
+	glvWindow_addDamage(glv_window,rect->x,rect->y,rect->width,rect->height);
+
+	glvGl_FlushBatch();		// バッチ描画の蓄積分はglScissorの前に描画する
+	glEnable(GL_SCISSOR_TEST);
+	// GLの座標系は左下原点
+	glScissor(rect->x,glv_window->height - (rect->y + rect->height),rect->width,rect->height);
+	glv_sheet->dirtyUpdate = 1;
+	return(1);
+}
+
+// 再描画が必要な領域に重なるwigetを再描画して、updateの描画範囲の制限を解除する
+static void _glv_sheet_end_dirty_update(GLV_WINDOW_t *glv_window,GLV_SHEET_t *glv_sheet)
+{
+	GLV_WIGET_t		*glv_wiget;
+	int rc;
+
+	wl_list_for_each(glv_wiget, &glv_sheet->wiget_list, link){
+		glv_wiget->dirty = 0;
+		if((glv_wiget->instance.alive == GLV_INSTANCE_ALIVE) && (glv_wiget->visible == GLV_VISIBLE) && (glv_wiget->eventFunc.redraw != NULL) &&
+			_glv_wiget_is_overlap(glv_wiget,&glv_sheet->dirtyRect)){
+			rc = (glv_wiget->eventFunc.redraw)((glvWindow)glv_window,(glvSheet)glv_sheet,(glvWiget)glv_wiget);
+			if(rc != GLV_OK){
+				fprintf(stderr,"_glv_sheet_end_dirty_update:wiget redraw error\n");
+			}
+		}
+	}
+	glvGl_FlushBatch();
+	glDisable(GL_SCISSOR_TEST);
+
+	glv_sheet->dirtyUpdate = 0;
+	glv_window->reqSwapBuffersFlag = 1;
+}
+
 void _glv_sheet_with_wiget_update_cb(GLV_WINDOW_t *glv_window)
 {
 	GLV_SHEET_t		*glv_sheet;
@@ -125,16 +411,31 @@ void _glv_sheet_with_wiget_update_cb(GLV_WINDOW_t *glv_window)
 		}else
 		if(glv_sheet->eventFunc.redraw){
 			glv_sheet->reqDrawWigetsFlag = 1;
+			glvWindow_addDamageFull(glv_window);	// シート全体を描画する
 			rc = (glv_sheet->eventFunc.redraw)((glvWindow)glv_window,(glvSheet)glv_sheet,GLV_STAT_DRAW_REDRAW);
 			if(rc != GLV_OK){
 				fprintf(stderr,"_glv_sheet_with_wiget_update_cb:sheet redraw error\n");
 			}
 		}
 		// -------------------------------------------------------
-		if(glv_sheet->reqDrawWigetsFlag == 1){
+		if(glv_sheet->dirtyUpdate == 1){
+			// 背景は再描画が必要な領域だけ描画したので、そこに重なるwigetだけを再描画する
+			// (update中のglvSheet_reqDrawWigetsも同じ扱いにする)
+			glv_sheet->reqDrawWigetsFlag = 0;
+			glv_sheet->reqDirtyWigetsFlag = 0;
+			_glv_sheet_end_dirty_update(glv_window,glv_sheet);
+		}else
+		if((glv_sheet->reqDrawWigetsFlag == 1) || (glv_sheet->reqDirtyWigetsFlag == 1)){
+			if(glv_sheet->reqDrawWigetsFlag == 0){
+				// 描画範囲を制限できなかった再描画要求は全体を描画する
+				glvWindow_addDamageFull(glv_window);
+				glv_window->reqSwapBuffersFlag = 1;
+			}
 			glv_sheet->reqDrawWigetsFlag = 0;
+			glv_sheet->reqDirtyWigetsFlag = 0;
 			wl_list_for_each(glv_wiget, &glv_sheet->wiget_list, link){
 				//printf("2 _glv_sheet_with_wiget_update_cb %s\n",glv_window->name);
+				glv_wiget->dirty = 0;
 				if((glv_wiget->instance.alive == GLV_INSTANCE_ALIVE) && (glv_wiget->visible == GLV_VISIBLE) && (glv_wiget->eventFunc.redraw != NULL)){
 					//printf("_glv_sheet_with_wiget_update_cb: redraw wiget id = %ld\n",glv_wiget->instance.Id);
 					rc = (glv_wiget->eventFunc.redraw)((glvWindow)glv_window,(glvSheet)glv_sheet,(glvWiget)glv_wiget);
@@ -245,40 +546,34 @@ void _glv_wiget_mousePointer_front(struct _glvinput *glv_input,GLV_WINDOW_t *glv
 
 	if((glv_sheet->instance.alive == GLV_INSTANCE_ALIVE) && (glv_sheet->initialized == 1)){
 		// -------------------------------------------------------------------------------
-		wl_list_for_each_reverse(glv_wiget, &glv_sheet->wiget_list, link){
-			if(glv_wiget->instance.alive == GLV_INSTANCE_ALIVE){
-				if((glv_wiget->visible == GLV_VISIBLE) &&
-					(glv_wiget->sheet_x < x ) &&
-					((glv_wiget->sheet_x + glv_wiget->width) > x) &&
-					(glv_wiget->sheet_y < y ) &&
-					((glv_wiget->sheet_y + glv_wiget->height) > y)){
-					glv_sheet->select_wiget_x = x - glv_wiget->sheet_x;
-					glv_sheet->select_wiget_y = y - glv_wiget->sheet_y;
-					if(pointer_left_stat == GLV_MOUSE_EVENT_LEFT_PRESS){
-						if(glv_wiget->attr & (GLV_WIGET_ATTR_TEXT_INPUT_FOCUS | GLV_WIGET_ATTR_PUSH_ACTION)){
-							// kye borad input
-							if(glv_input->glv_dpy->kb_input_wigetId != glv_wiget->instance.Id){
-								_glvOnFocus((glvDisplay)glv_input->glv_dpy,GLV_STAT_OUT_FOCUS,glv_wiget);
-								glv_input->glv_dpy->kb_input_windowId = glv_window->instance.Id;
-								glv_input->glv_dpy->kb_input_sheetId  = glv_sheet->instance.Id;
-								glv_input->glv_dpy->kb_input_wigetId  = glv_wiget->instance.Id;
-								_glvOnFocus((glvDisplay)glv_input->glv_dpy,GLV_STAT_IN_FOCUS,glv_wiget);
-							}
-						}
-					}
-					if(	((glv_wiget->attr & GLV_WIGET_ATTR_POINTER_MOTION) == 0) &&
-						(type == GLV_MOUSE_EVENT_MOTION) &&
-						(pointer_left_stat == GLV_MOUSE_EVENT_LEFT_RELEASE)){
-						//  が設定されていない場合は、マウスリリース時のモーションイベントは発生させない
-					}else{
-						if(glv_wiget->eventFunc.mousePointer){
-							//printf("_glv_wiget_mousePointer_front\n");
-							//printf("(%d,%d) - wiget (%d,%d)-(%d,%d) \n",x,y,glv_wiget->sheet_x,glv_wiget->sheet_y,glv_wiget->width,glv_wiget->height);
-							//printf("glv_sheet->select_wiget_x = %d , glv_sheet->select_wiget_y = %d\n",glv_sheet->select_wiget_x,glv_sheet->select_wiget_y);
-							_glvOnMousePointer(glv_wiget,type,time,glv_sheet->select_wiget_x,glv_sheet->select_wiget_y,pointer_left_stat);
-						}
+		pthread_mutex_lock(&glv_sheet->sheet_mutex);				// sheet
+		glv_wiget = _glv_wiget_grid_hit(glv_sheet,x,y,0);
+		pthread_mutex_unlock(&glv_sheet->sheet_mutex);			// sheet
+		if(glv_wiget != NULL){
+			glv_sheet->select_wiget_x = x - glv_wiget->sheet_x;
+			glv_sheet->select_wiget_y = y - glv_wiget->sheet_y;
+			if(pointer_left_stat == GLV_MOUSE_EVENT_LEFT_PRESS){
+				if(glv_wiget->attr & (GLV_WIGET_ATTR_TEXT_INPUT_FOCUS | GLV_WIGET_ATTR_PUSH_ACTION)){
+					// kye borad input
+					if(glv_input->glv_dpy->kb_input_wigetId != glv_wiget->instance.Id){
+						_glvOnFocus((glvDisplay)glv_input->glv_dpy,GLV_STAT_OUT_FOCUS,glv_wiget);
+						glv_input->glv_dpy->kb_input_windowId = glv_window->instance.Id;
+						glv_input->glv_dpy->kb_input_sheetId  = glv_sheet->instance.Id;
+						glv_input->glv_dpy->kb_input_wigetId  = glv_wiget->instance.Id;
+						_glvOnFocus((glvDisplay)glv_input->glv_dpy,GLV_STAT_IN_FOCUS,glv_wiget);
 					}
-					break;
+				}
+			}
+			if(	((glv_wiget->attr & GLV_WIGET_ATTR_POINTER_MOTION) == 0) &&
+				(type == GLV_MOUSE_EVENT_MOTION) &&
+				(pointer_left_stat == GLV_MOUSE_EVENT_LEFT_RELEASE)){
+				//  が設定されていない場合は、マウスリリース時のモーションイベントは発生させない
+			}else{
+				if(glv_wiget->eventFunc.mousePointer){
+					//printf("_glv_wiget_mousePointer_front\n");
+					//printf("(%d,%d) - wiget (%d,%d)-(%d,%d) \n",x,y,glv_wiget->sheet_x,glv_wiget->sheet_y,glv_wiget->width,glv_wiget->height);
+					//printf("glv_sheet->select_wiget_x = %d , glv_sheet->select_wiget_y = %d\n",glv_sheet->select_wiget_x,glv_sheet->select_wiget_y);
+					_glvOnMousePointer(glv_wiget,type,time,glv_sheet->select_wiget_x,glv_sheet->select_wiget_y,pointer_left_stat);
 				}
 			}
 		}
@@ -297,19 +592,17 @@ void _glv_wiget_mousePointer_cb(GLV_WINDOW_t *glv_window,glvInstanceId sheetId,g
 
 	if((glv_sheet->instance.Id == sheetId) && (glv_sheet->instance.alive == GLV_INSTANCE_ALIVE) && (glv_sheet->initialized == 1)){
 		// -------------------------------------------------------------------------------
-		wl_list_for_each_reverse(glv_wiget, &glv_sheet->wiget_list, link){
-			if(glv_wiget->instance.Id == wigetId){
-				if((glv_wiget->instance.alive == GLV_INSTANCE_ALIVE) && (glv_wiget->visible == GLV_VISIBLE)){
-					if(glv_wiget->eventFunc.mousePointer){
-						//printf("_glv_wiget_mousePointer_cb\n");
-						//rc = (glv_wiget->eventFunc.mousePointer)((glvWindow)glv_window,(glvSheet)glv_sheet,(glvWiget)glv_wiget,type,time,glv_sheet->select_wiget_x,glv_sheet->select_wiget_y,pointer_left_stat);
-						rc = (glv_wiget->eventFunc.mousePointer)((glvWindow)glv_window,(glvSheet)glv_sheet,(glvWiget)glv_wiget,type,time,x,y,pointer_left_stat);
-						if(rc != GLV_OK){
-							fprintf(stderr,"_glv_wiget_mousePointer_cb:wiget mousePointer error\n");
-						}
-					}							
-				}
-				break;
+		glv_wiget = _glv_wiget_from_id(glv_sheet,wigetId);
+		if(glv_wiget != NULL){
+			if((glv_wiget->instance.alive == GLV_INSTANCE_ALIVE) && (glv_wiget->visible == GLV_VISIBLE)){
+				if(glv_wiget->eventFunc.mousePointer){
+					//printf("_glv_wiget_mousePointer_cb\n");
+					//rc = (glv_wiget->eventFunc.mousePointer)((glvWindow)glv_window,(glvSheet)glv_sheet,(glvWiget)glv_wiget,type,time,glv_sheet->select_wiget_x,glv_sheet->select_wiget_y,pointer_left_stat);
+					rc = (glv_wiget->eventFunc.mousePointer)((glvWindow)glv_window,(glvSheet)glv_sheet,(glvWiget)glv_wiget,type,time,x,y,pointer_left_stat);
+					if(rc != GLV_OK){
+						fprintf(stderr,"_glv_wiget_mousePointer_cb:wiget mousePointer error\n");
+					}
+				}							
 			}
 		}
 		// -------------------------------------------------------------------------------
@@ -402,18 +695,16 @@ void _glv_wiget_mouseButton_cb(GLV_WINDOW_t *glv_window,glvInstanceId sheetId,gl
 
 	if((glv_sheet->instance.Id == sheetId) && (glv_sheet->instance.alive == GLV_INSTANCE_ALIVE) && (glv_sheet->initialized == 1)){
 		// -------------------------------------------------------------------------------
-		wl_list_for_each_reverse(glv_wiget, &glv_sheet->wiget_list, link){
-			if(glv_wiget->instance.Id == wigetId){
-				if((glv_wiget->instance.alive == GLV_INSTANCE_ALIVE) && (glv_wiget->visible == GLV_VISIBLE)){
-					if(glv_wiget->eventFunc.mouseButton){
-						//printf("_glv_wiget_mouseButton_cb\n");
-						rc = (glv_wiget->eventFunc.mouseButton)((glvWindow)glv_window,(glvSheet)glv_sheet,(glvWiget)glv_wiget,type,time,x,y,pointer_stat);
-						if(rc != GLV_OK){
-							fprintf(stderr,"_glv_wiget_mouseButton_cb:wiget mouseButton error\n");
-						}
-					}							
-				}
-				break;
+		glv_wiget = _glv_wiget_from_id(glv_sheet,wigetId);
+		if(glv_wiget != NULL){
+			if((glv_wiget->instance.alive == GLV_INSTANCE_ALIVE) && (glv_wiget->visible == GLV_VISIBLE)){
+				if(glv_wiget->eventFunc.mouseButton){
+					//printf("_glv_wiget_mouseButton_cb\n");
+					rc = (glv_wiget->eventFunc.mouseButton)((glvWindow)glv_window,(glvSheet)glv_sheet,(glvWiget)glv_wiget,type,time,x,y,pointer_stat);
+					if(rc != GLV_OK){
+						fprintf(stderr,"_glv_wiget_mouseButton_cb:wiget mouseButton error\n");
+					}
+				}							
 			}
 		}
 		// -------------------------------------------------------------------------------
@@ -497,19 +788,17 @@ void _glv_wiget_mouseAxis_cb(GLV_WINDOW_t *glv_window,glvInstanceId sheetId,glvI
 
 	if((glv_sheet->instance.Id == sheetId) && (glv_sheet->instance.alive == GLV_INSTANCE_ALIVE) && (glv_sheet->initialized == 1)){
 		// -------------------------------------------------------------------------------
-		wl_list_for_each_reverse(glv_wiget, &glv_sheet->wiget_list, link){
-			if(glv_wiget->instance.Id == wigetId){
-				if((glv_wiget->instance.alive == GLV_INSTANCE_ALIVE) && (glv_wiget->visible == GLV_VISIBLE)){
+		glv_wiget = _glv_wiget_from_id(glv_sheet,wigetId);
+		if(glv_wiget != NULL){
+			if((glv_wiget->instance.alive == GLV_INSTANCE_ALIVE) && (glv_wiget->visible == GLV_VISIBLE)){
+				//printf("_glv_wiget_mouseAxis_cb\n");
+				if(glv_wiget->eventFunc.mouseAxis){
 					//printf("_glv_wiget_mouseAxis_cb\n");
-					if(glv_wiget->eventFunc.mouseAxis){
-						//printf("_glv_wiget_mouseAxis_cb\n");
-						rc = (glv_wiget->eventFunc.mouseAxis)((glvWindow)glv_window,(glvSheet)glv_sheet,(glvWiget)glv_wiget,type,time,value);
-						if(rc != GLV_OK){
-							fprintf(stderr,"_glv_wiget_mouseAxis_cb:wiget mouseAxis error\n");
-						}
-					}							
-				}
-				break;
+					rc = (glv_wiget->eventFunc.mouseAxis)((glvWindow)glv_window,(glvSheet)glv_sheet,(glvWiget)glv_wiget,type,time,value);
+					if(rc != GLV_OK){
+						fprintf(stderr,"_glv_wiget_mouseAxis_cb:wiget mouseAxis error\n");
+					}
+				}							
 			}
 		}
 		// -------------------------------------------------------------------------------
@@ -527,17 +816,15 @@ void _glv_wiget_key_input_cb(GLV_WINDOW_t *glv_window,glvInstanceId sheetId,glvI
 
 	if((glv_sheet->instance.Id == sheetId) && (glv_sheet->instance.alive == GLV_INSTANCE_ALIVE) && (glv_sheet->initialized == 1)){
 		// -------------------------------------------------------------------------------
-		wl_list_for_each_reverse(glv_wiget, &glv_sheet->wiget_list, link){
-			if(glv_wiget->instance.Id == wigetId){
-				if((glv_wiget->instance.alive == GLV_INSTANCE_ALIVE) && (glv_wiget->visible == GLV_VISIBLE)){
-					if(glv_wiget->eventFunc.input){
-						rc = (glv_wiget->eventFunc.input)((glvWindow)glv_window,(glvSheet)glv_sheet,(glvWiget)glv_wiget,type,state,kyesym,in_text,attr,length);
-						if(rc != GLV_OK){
-							fprintf(stderr,"_glv_wiget_key_input_cb:wiget input error\n");
-						}
-					}							
-				}
-				break;
+		glv_wiget = _glv_wiget_from_id(glv_sheet,wigetId);
+		if(glv_wiget != NULL){
+			if((glv_wiget->instance.alive == GLV_INSTANCE_ALIVE) && (glv_wiget->visible == GLV_VISIBLE)){
+				if(glv_wiget->eventFunc.input){
+					rc = (glv_wiget->eventFunc.input)((glvWindow)glv_window,(glvSheet)glv_sheet,(glvWiget)glv_wiget,type,state,kyesym,in_text,attr,length);
+					if(rc != GLV_OK){
+						fprintf(stderr,"_glv_wiget_key_input_cb:wiget input error\n");
+					}
+				}							
 			}
 		}
 		// -------------------------------------------------------------------------------
@@ -561,13 +848,11 @@ void _glv_wiget_focus_cb(GLV_WINDOW_t *glv_window,glvInstanceId sheetId,glvInsta
 		if(glv_sheet){
 			if((glv_sheet->instance.Id == in_sheetId) && (glv_sheet->instance.alive == GLV_INSTANCE_ALIVE) && (glv_sheet->initialized == 1)){
 				// -------------------------------------------------------------------------------
-				wl_list_for_each_reverse(glv_wiget, &glv_sheet->wiget_list, link){
-					if(glv_wiget->instance.Id == in_wigetId){
-						if((glv_wiget->instance.alive == GLV_INSTANCE_ALIVE) && (glv_wiget->visible == GLV_VISIBLE)){
-							glv_in_wiget = glv_wiget;
-							//printf("_glv_wiget_focus_cb: in_wigwt glv_in_wiget = %p\n",glv_in_wiget);
-						}
-						break;
+				glv_wiget = _glv_wiget_from_id(glv_sheet,in_wigetId);
+				if(glv_wiget != NULL){
+					if((glv_wiget->instance.alive == GLV_INSTANCE_ALIVE) && (glv_wiget->visible == GLV_VISIBLE)){
+						glv_in_wiget = glv_wiget;
+						//printf("_glv_wiget_focus_cb: in_wigwt glv_in_wiget = %p\n",glv_in_wiget);
 					}
 				}
 				// -------------------------------------------------------------------------------
@@ -580,17 +865,15 @@ void _glv_wiget_focus_cb(GLV_WINDOW_t *glv_window,glvInstanceId sheetId,glvInsta
 	if(glv_sheet){
 		if((glv_sheet->instance.Id == sheetId) && (glv_sheet->instance.alive == GLV_INSTANCE_ALIVE) && (glv_sheet->initialized == 1)){
 			// -------------------------------------------------------------------------------
-			wl_list_for_each_reverse(glv_wiget, &glv_sheet->wiget_list, link){
-				if(glv_wiget->instance.Id == wigetId){
-					if((glv_wiget->instance.alive == GLV_INSTANCE_ALIVE) && (glv_wiget->visible == GLV_VISIBLE)){
-						if(glv_wiget->eventFunc.focus){
-							rc = (glv_wiget->eventFunc.focus)((glvWindow)glv_window,(glvSheet)glv_sheet,(glvWiget)glv_wiget,focus_stat,(glvWiget)glv_in_wiget);
-							if(rc != GLV_OK){
-								fprintf(stderr,"_glv_wiget_focus_cb:wiget focus error\n");
-							}
-						}							
-					}
-					break;
+			glv_wiget = _glv_wiget_from_id(glv_sheet,wigetId);
+			if(glv_wiget != NULL){
+				if((glv_wiget->instance.alive == GLV_INSTANCE_ALIVE) && (glv_wiget->visible == GLV_VISIBLE)){
+					if(glv_wiget->eventFunc.focus){
+						rc = (glv_wiget->eventFunc.focus)((glvWindow)glv_window,(glvSheet)glv_sheet,(glvWiget)glv_wiget,focus_stat,(glvWiget)glv_in_wiget);
+						if(rc != GLV_OK){
+							fprintf(stderr,"_glv_wiget_focus_cb:wiget focus error\n");
+						}
+					}							
 				}
 			}
 			// -------------------------------------------------------------------------------
@@ -629,33 +912,26 @@ glvInstanceId _glv_wiget_check_wiget_area(GLV_WINDOW_t *glv_window,int x,int y,i
 		glv_sheet->select_wiget_button_status = GLV_MOUSE_EVENT_RELEASE;
 	}
 
-	wl_list_for_each_reverse(glv_wiget, &glv_sheet->wiget_list, link){
-		if((glv_wiget->instance.alive == GLV_INSTANCE_ALIVE) && (glv_wiget->attr != 0)){
-			if((glv_wiget->visible == GLV_VISIBLE) &&
-				(glv_wiget->sheet_x < x ) &&
-				((glv_wiget->sheet_x + glv_wiget->width) > x) &&
-				(glv_wiget->sheet_y < y ) &&
-				((glv_wiget->sheet_y + glv_wiget->height) > y)){
-				findFlag = 1;
-				glv_wigetId = glv_wiget->instance.Id;
-                if((button_status == GLV_MOUSE_EVENT_RELEASE) || (button_status == GLV_MOUSE_EVENT_PRESS)){
-					glv_sheet->select_wiget_Id = glv_wigetId;
-					glv_sheet->select_wiget_x = x - glv_wiget->sheet_x;
-					glv_sheet->select_wiget_y = y - glv_wiget->sheet_y;
-					glv_sheet->select_wiget_button_status = button_status;
-				}else{
-					if(glv_wiget->attr & GLV_WIGET_ATTR_POINTER_FOCUS){
-						//printf("_glv_wiget_check_wiget_area focus wiget id = %ld\n",glv_wigetId);
-					}else{
-						glv_wigetId = 0;
-					}
-				}
-				glv_sheet->pointer_focus_wiget_Id = glv_wigetId;
-//				glv_sheet->pointer_focus_wiget_x = x - glv_wiget->sheet_x;
-//				glv_sheet->pointer_focus_wiget_y = y - glv_wiget->sheet_y;
-				break;
+	// グリッドから座標にある一番上のwigetを検索する
+	glv_wiget = _glv_wiget_grid_hit(glv_sheet,x,y,1);
+	if(glv_wiget != NULL){
+		findFlag = 1;
+		glv_wigetId = glv_wiget->instance.Id;
+		if((button_status == GLV_MOUSE_EVENT_RELEASE) || (button_status == GLV_MOUSE_EVENT_PRESS)){
+			glv_sheet->select_wiget_Id = glv_wigetId;
+			glv_sheet->select_wiget_x = x - glv_wiget->sheet_x;
+			glv_sheet->select_wiget_y = y - glv_wiget->sheet_y;
+			glv_sheet->select_wiget_button_status = button_status;
+		}else{
+			if(glv_wiget->attr & GLV_WIGET_ATTR_POINTER_FOCUS){
+				//printf("_glv_wiget_check_wiget_area focus wiget id = %ld\n",glv_wigetId);
+			}else{
+				glv_wigetId = 0;
 			}
 		}
+		glv_sheet->pointer_focus_wiget_Id = glv_wigetId;
+//		glv_sheet->pointer_focus_wiget_x = x - glv_wiget->sheet_x;
+//		glv_sheet->pointer_focus_wiget_y = y - glv_wiget->sheet_y;
 	}
 	if(findFlag == 0){
 		glv_sheet->pointer_focus_wiget_Id = 0;
@@ -713,7 +989,7 @@ glvSheet glvCreateSheet(glvWindow glv_win,const struct glv_sheet_listener *liste
 		glvSheet_setHandler_userMsg(glv_sheet,listener->userMsg);
 		glvSheet_setHandler_terminate(glv_sheet,listener->terminate);
 	}
-	GLV_IF_DEBUG_INSTANCE printf(GLV_DEBUG_INSTANCE_COLOR"glvCreateSheet id = %ld [%s] [%s]\n"GLV_DEBUG_END_COLOR,glv_sheet->instance.Id,glv_sheet->name,glv_window->name);
+	GLV_LOG_DEBUG(GLV_DEBUG_INSTANCE,GLV_DEBUG_INSTANCE_COLOR"glvCreateSheet id = %ld [%s] [%s]\n"GLV_DEBUG_END_COLOR,glv_sheet->instance.Id,glv_sheet->name,glv_window->name);
 	return(glv_sheet);
 }
 int glvWindow_activeSheet(glvWindow glv_win,glvSheet sheet)
@@ -796,8 +1072,9 @@ void _glvGcDestroySheet(GLV_SHEET_t *glv_sheet)
 
 	glvDestroyResource(&glv_sheet->instance);
 
-	GLV_IF_DEBUG_INSTANCE printf(GLV_DEBUG_INSTANCE_COLOR"_glvGcDestroySheet id = %ld [%s]\n"GLV_DEBUG_END_COLOR,glv_sheet->instance.Id,glv_sheet->name);
+	GLV_LOG_DEBUG(GLV_DEBUG_INSTANCE,GLV_DEBUG_INSTANCE_COLOR"_glvGcDestroySheet id = %ld [%s]\n"GLV_DEBUG_END_COLOR,glv_sheet->instance.Id,glv_sheet->name);
 	glv_sheet->instance.oneself = NULL;
+	_glv_wiget_grid_free(glv_sheet);
 	pthread_mutex_destroy(&glv_sheet->sheet_mutex);
 	free(glv_sheet->name);
 	free(glv_sheet);
@@ -815,8 +1092,66 @@ int glvSheet_reqSwapBuffers(glvSheet sheet)
 int glvSheet_reqDrawWigets(glvSheet sheet)
 {
 	GLV_SHEET_t *glv_sheet = (GLV_SHEET_t*)sheet;
+	GLV_WIGET_t *glv_wiget;
 
 	glv_sheet->reqDrawWigetsFlag = 1;
+	if(glv_sheet->dirtyUpdate == 1){
+		// 描画範囲を制限したupdate中は、その範囲に重なるwigetだけを再描画する
+		return(GLV_OK);
+	}
+
+	// 再描画するwigetの領域を更新領域に追加する
+	wl_list_for_each(glv_wiget, &glv_sheet->wiget_list, link){
+		if((glv_wiget->instance.alive == GLV_INSTANCE_ALIVE) && (glv_wiget->visible == GLV_VISIBLE)){
+			_glv_wiget_add_damage(glv_wiget);
+		}
+	}
+	return(GLV_OK);
+}
+
+/**
+ * @brief	wigetの再描画を要求する
+ *
+ * 次のupdate(glvOnUpdate)で、再描画要求されたwigetの描画範囲をglScissorで制限して
+ * ウィンドウ・シートのupdate(背景)とその範囲に重なるwigetを再描画する。
+ *
+ * @param[in]	wiget	wiget
+ * @retval	GLV_OK		正常
+ * @retval	GLV_ERROR	異常
+ */
+int glvWiget_reqDraw(glvWiget wiget)
+{
+	GLV_WIGET_t *glv_wiget = (GLV_WIGET_t*)wiget;
+
+	if(glv_wiget == NULL){
+		return(GLV_ERROR);
+	}
+
+	glv_wiget->dirty = 1;
+	glv_wiget->glv_sheet->reqDirtyWigetsFlag = 1;
+	_glv_wiget_add_damage(glv_wiget);
+	return(GLV_OK);
+}
+
+/**
+ * @brief	wigetが矩形の外側に描画する幅を設定する
+ *
+ * 再描画要求(glvWiget_reqDraw)や移動で再描画する範囲は、wigetの矩形をこの幅だけ広げた範囲になる。
+ *
+ * @param[in]	wiget	wiget
+ * @param[in]	margin	矩形の外側に描画する幅(ピクセル)
+ * @retval	GLV_OK		正常
+ * @retval	GLV_ERROR	異常
+ */
+int glvWiget_setPaintMargin(glvWiget wiget,int margin)
+{
+	GLV_WIGET_t *glv_wiget = (GLV_WIGET_t*)wiget;
+
+	if((glv_wiget == NULL) || (margin < 0)){
+		return(GLV_ERROR);
+	}
+
+	glv_wiget->paint_margin = margin;
 	return(GLV_OK);
 }
 
@@ -882,6 +1217,7 @@ glvWiget glvCreateWiget(glvSheet sheet,const struct glv_wiget_listener *listener
 
 	pthread_mutex_lock(&glv_sheet->sheet_mutex);				// sheet
 	wl_list_insert(glv_sheet->wiget_list.prev, &glv_wiget->link);
+	glv_wiget->zorder = ++glv_sheet->wiget_zorder;			// 後から作成したwigetが上
 	pthread_mutex_unlock(&glv_sheet->sheet_mutex);			// sheet
 
 	if(listener != NULL){
@@ -897,7 +1233,7 @@ glvWiget glvCreateWiget(glvSheet sheet,const struct glv_wiget_listener *listener
 		glvWiget_setHandler_focus(glv_wiget,listener->focus);
 		glvWiget_setHandler_terminate(glv_wiget,listener->terminate);
 	}
-	GLV_IF_DEBUG_INSTANCE printf(GLV_DEBUG_INSTANCE_COLOR"glvCreateWiget id = %ld [%s] [%s]\n"GLV_DEBUG_END_COLOR,glv_wiget->instance.Id,glv_sheet->name,glv_sheet->glv_window->name);
+	GLV_LOG_DEBUG(GLV_DEBUG_INSTANCE,GLV_DEBUG_INSTANCE_COLOR"glvCreateWiget id = %ld [%s] [%s]\n"GLV_DEBUG_END_COLOR,glv_wiget->instance.Id,glv_sheet->name,glv_sheet->glv_window->name);
 	glv_wiget->instance.oneself = NULL;
 	return(glv_wiget);
 }
@@ -916,7 +1252,11 @@ void glvDestroyWiget(glvWiget wiget)
 	}
 
 	glv_wiget->instance.alive = GLV_INSTANCE_DEAD;
-	
+
+	pthread_mutex_lock(&glv_wiget->glv_sheet->sheet_mutex);		// sheet
+	_glv_wiget_grid_remove(glv_wiget->glv_sheet,glv_wiget);
+	pthread_mutex_unlock(&glv_wiget->glv_sheet->sheet_mutex);		// sheet
+
 	wl_list_remove(&glv_wiget->link);
 	if(gc_lock == 1) pthread_mutex_lock(&_glv_garbage_box.pthread_mutex);			// garbage box
 	wl_list_insert(_glv_garbage_box.wiget_list.prev, &glv_wiget->link);
@@ -937,7 +1277,7 @@ void _glvGcDestroyWiget(GLV_WIGET_t *glv_wiget)
 
 	glvDestroyResource(&glv_wiget->instance);
 
-	GLV_IF_DEBUG_INSTANCE printf(GLV_DEBUG_INSTANCE_COLOR"_glvGcDestroyWiget id = %ld\n"GLV_DEBUG_END_COLOR,glv_wiget->instance.Id);
+	GLV_LOG_DEBUG(GLV_DEBUG_INSTANCE,GLV_DEBUG_INSTANCE_COLOR"_glvGcDestroyWiget id = %ld\n"GLV_DEBUG_END_COLOR,glv_wiget->instance.Id);
 	free(glv_wiget);
 }
 
@@ -949,11 +1289,25 @@ int glvWiget_setWigetGeometry(glvWiget wiget,GLV_WIGET_GEOMETRY_t *geometry)
 		return(GLV_ERROR);
 	}
 
+	if((glv_wiget->sheet_x != geometry->x) || (glv_wiget->sheet_y != geometry->y) ||
+		(glv_wiget->width != geometry->width) || (glv_wiget->height != geometry->height)){
+		// 移動前と移動後の領域を再描画する(移動前の領域は背景で塗りつぶされる)
+		_glv_wiget_add_damage(glv_wiget);
+		glv_wiget->dirty = 1;
+		glv_wiget->glv_sheet->reqDirtyWigetsFlag = 1;
+	}
+
+	pthread_mutex_lock(&glv_wiget->glv_sheet->sheet_mutex);		// sheet
 	glv_wiget->sheet_x = geometry->x;
 	glv_wiget->sheet_y = geometry->y;
 	glv_wiget->width = geometry->width;
 	glv_wiget->height = geometry->height;
 	glv_wiget->scale = geometry->scale;
+	_glv_wiget_grid_update(glv_wiget);
+	pthread_mutex_unlock(&glv_wiget->glv_sheet->sheet_mutex);		// sheet
+	if(glv_wiget->dirty == 1){
+		_glv_wiget_add_damage(glv_wiget);
+	}
 	return(GLV_OK);
 }
 
@@ -985,7 +1339,14 @@ int glvWiget_setWigetVisible(glvWiget wiget,int visible)
 		return(GLV_ERROR);
 	}
 
+	if(glv_wiget->visible != visible){
+		// 表示/非表示の切り替えはwigetの領域を再描画する(非表示は背景で塗りつぶされる)
+		glvWiget_reqDraw(wiget);
+	}
+	pthread_mutex_lock(&glv_wiget->glv_sheet->sheet_mutex);		// sheet
 	glv_wiget->visible = visible;
+	_glv_wiget_grid_update(glv_wiget);
+	pthread_mutex_unlock(&glv_wiget->glv_sheet->sheet_mutex);		// sheet
 	return(GLV_OK);
 }
 
@@ -273,6 +273,19 @@ void weston_client_window__display_exit(struct _glv_display *display)
 	display->running = 0;
 }
 
+// 他のスレッドからdisplay_runのepoll_waitを復帰させる
+// (headlessではwaylandのイベントが無いので、終了要求はこれで通知する)
+void weston_client_window__display_wakeup(struct _glv_display *display)
+{
+	uint64_t value = 1;
+	ssize_t rc;
+
+	if (display->root_queue_fd >= 0) {
+		rc = write(display->root_queue_fd, &value, sizeof(value));
+		(void)rc;
+	}
+}
+
 static void handle_display_data(struct task *task, uint32_t events)
 {
 	struct _glv_display *display = wl_container_of(task, display, display_task);
@@ -351,23 +364,53 @@ static int weston_shared_os_compatibility__os_epoll_create_cloexec(void)
 	return weston_shared_os_compatibility__set_cloexec_or_close(fd);
 }
 
+// rootWindowのメッセージキューにメッセージが格納された
+// 通知をクリアするだけで、メッセージはdisplay_runのループ先頭で処理する
+static void handle_root_queue(struct task *task, uint32_t events)
+{
+	struct _glv_display *display = wl_container_of(task, display, root_queue_task);
+
+	pthread_msq_eventfd_clear(&display->rootWindow->ctx.queue);
+}
+
 void weston_client_window__display_create(struct _glv_display *display)
 {
 	struct wl_display	*wl_display = ((GLV_DISPLAY_t*)display)->wl_dpy.display;
 
 	display->epoll_fd = weston_shared_os_compatibility__os_epoll_create_cloexec();
-	display->display_fd = wl_display_get_fd(wl_display);
-	display->display_task.run = handle_display_data;
-	weston_client_window__display_watch_fd(display, display->display_fd, EPOLLIN | EPOLLERR | EPOLLHUP,
-			 &display->display_task);
+	display->display_fd = -1;
+	if (wl_display != NULL) {
+		// headlessではwaylandのfdを監視しない
+		display->display_fd = wl_display_get_fd(wl_display);
+		display->display_task.run = handle_display_data;
+		weston_client_window__display_watch_fd(display, display->display_fd, EPOLLIN | EPOLLERR | EPOLLHUP,
+				 &display->display_task);
+	}
+
+	// 他のスレッドからrootWindowに送られたメッセージで、epoll_waitから復帰させる
+	display->root_queue_fd = -1;
+	if (display->rootWindow) {
+		display->root_queue_fd = pthread_msq_eventfd_open(&display->rootWindow->ctx.queue);
+		if (display->root_queue_fd >= 0) {
+			display->root_queue_task.run = handle_root_queue;
+			weston_client_window__display_watch_fd(display, display->root_queue_fd, EPOLLIN,
+					 &display->root_queue_task);
+		}
+	}
 }
 
 void weston_client_window__display_destroy(struct _glv_display *display)
 {
 	struct wl_display	*wl_display = ((GLV_DISPLAY_t*)display)->wl_dpy.display;
+	if (display->root_queue_fd >= 0) {
+		// eventfdはメッセージキューの破棄で閉じる
+		weston_client_window__display_unwatch_fd(display, display->root_queue_fd);
+		display->root_queue_fd = -1;
+	}
 	close(display->epoll_fd);
 
-	if (!(display->display_fd_events & EPOLLERR) &&
+	if ((wl_display != NULL) &&
+	    !(display->display_fd_events & EPOLLERR) &&
 	    !(display->display_fd_events & EPOLLHUP))
 		wl_display_flush(wl_display);
 }
@@ -384,23 +427,27 @@ void weston_client_window__display_run(struct _glv_display *display)
 		_glvWindowMsgHandler_dispatch(display);
 		_glvGcGarbageBox();
 
-		wl_display_dispatch_pending(wl_display);
+		if (wl_display != NULL)
+			wl_display_dispatch_pending(wl_display);
 
 		if (!display->running)
 			break;
 
-		ret = wl_display_flush(wl_display);
-		if (ret < 0 && errno == EAGAIN) {
-			ep[0].events =
-				EPOLLIN | EPOLLOUT | EPOLLERR | EPOLLHUP;
-			ep[0].data.ptr = &display->display_task;
-
-			epoll_ctl(display->epoll_fd, EPOLL_CTL_MOD,
-				  display->display_fd, &ep[0]);
-		} else if (ret < 0) {
-			break;
+		if (wl_display != NULL) {
+			ret = wl_display_flush(wl_display);
+			if (ret < 0 && errno == EAGAIN) {
+				ep[0].events =
+					EPOLLIN | EPOLLOUT | EPOLLERR | EPOLLHUP;
+				ep[0].data.ptr = &display->display_task;
+
+				epoll_ctl(display->epoll_fd, EPOLL_CTL_MOD,
+					  display->display_fd, &ep[0]);
+			} else if (ret < 0) {
+				break;
+			}
 		}
 
+		glvLog_flush();		// 待ちに入る前に溜まっているログを出力する
 		count = epoll_wait(display->epoll_fd,
 				   ep, ARRAY_LENGTH(ep), -1);
 		for (i = 0; i < count; i++) {
@@ -22,8 +22,636 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#include <stdint.h>
+#include <string.h>
+#include <sched.h>
 #include "pthread_msq.h"
 
+// ロックフリーキュー(PTHREAD_MSQ_TYPE_LOCKFREE)はfutexを使うためLinuxのみ
+// それ以外の環境ではPTHREAD_MSQ_TYPE_MUTEXで作成する
+#if defined(__linux__) && !defined(__SMS_APPLE__)
+#define PTHREAD_MSQ_USE_LOCKFREE
+#endif
+
+// 送信通知用のeventfdはLinuxのみ
+#if defined(__linux__) && !defined(__SMS_APPLE__)
+#define PTHREAD_MSQ_USE_EVENTFD
+#endif
+
+/* トレース用フック(未設定の場合は送信・受信毎にポインタを1回参照するだけ) */
+static pthread_msq_trace_hook_t pthread_msq_trace_hook = NULL;
+
+/**
+ * トレース用フックを呼び出す
+ */
+static inline void pthread_msq_trace(pthread_msq_id_t *queue, int event, const pthread_msq_msg_t *msg, int depth) {
+	pthread_msq_trace_hook_t hook;
+
+	hook = __atomic_load_n(&pthread_msq_trace_hook, __ATOMIC_RELAXED);
+	if (NULL != hook) {
+		if (depth < 0) depth = 0;
+		hook(queue, event, msg, depth);
+	}
+}
+
+/*
+ * 可変長データ(ペイロード)のプール
+ *
+ * キュー毎に大きさ別のブロックを持ち、送信側が確保して直接書き込み、
+ * メッセージと一緒に所有権を受信側に渡す(コピー無し)。受信側は処理後に解放する。
+ * 空きブロックはロックフリーのスタックで管理する(ABA対策で先頭に世代を持つ)。
+ * ブロックはキャッシュラインの倍数で区切り、隣のペイロードと同じラインを共有しない。
+ * 収まらない大きさ、空きが無い場合はmallocで確保する。
+ */
+#define PTHREAD_MSQ_POOL_CLASS_NUM	(4)			// ブロックの大きさの種類
+#define PTHREAD_MSQ_POOL_SPARE		(8)			// キューの格納数に加えるブロック数(送信側が書き込み中の分)
+#define PTHREAD_MSQ_POOL_CLASS_MAX	(64*1024)	// 1種類あたりの最大byte数(キューの格納数分のブロックより優先する)
+#define PTHREAD_MSQ_POOL_MALLOC		(0xffffffffu)
+#define PTHREAD_MSQ_POOL_CLOSED		((struct pthread_msq_pool_t *)1)	// キューが破壊された(プールを作成しない)
+
+static const size_t pthread_msq_pool_stride[PTHREAD_MSQ_POOL_CLASS_NUM] = {64, 256, 1024, 4096};
+
+/* ペイロードの前に置くヘッダー(ペイロードは16byte境界になる) */
+typedef struct pthread_msq_payload_t {
+	struct pthread_msq_pool_t *pool;	// NULL:mallocで確保
+	size_t size;
+	unsigned int klass;					// PTHREAD_MSQ_POOL_MALLOC:mallocで確保
+	unsigned int index;
+	size_t reserved;
+} pthread_msq_payload_t;
+
+typedef struct pthread_msq_pool_class_t {
+	uint64_t head;						// 空きブロックの先頭(上位32bit:世代,下位32bit:ブロック番号+1 0:空き無し)
+	char *arena;						// ブロック(最初の確保時に作成)
+	uint32_t *next;						// 次の空きブロック(ブロック番号+1,arenaの後ろに置く)
+	int blockNum;						// ブロック数
+} __attribute__((aligned(64))) pthread_msq_pool_class_t;
+
+struct pthread_msq_pool_t {
+	pthread_msq_pool_class_t klass[PTHREAD_MSQ_POOL_CLASS_NUM];
+	int refs;							// 参照数(キュー:1 + 確保中のペイロード数 + 確保処理中の数)
+};
+
+/**
+ * キューのプールを作成する(poolBusyを加算した状態で呼ぶこと)
+ *
+ * @retval	NULL以外	プール(参照を加算済み)
+ * @retval	NULL		キューが破壊された,または作成できない
+ */
+static struct pthread_msq_pool_t *pthread_msq_pool_create(pthread_msq_id_t *queue) {
+	struct pthread_msq_pool_t *pool, *expected = NULL;
+	size_t num;
+	int i;
+
+	if (0 != posix_memalign((void **)&pool, 64, sizeof(struct pthread_msq_pool_t))) {
+		return (NULL);
+	}
+	memset(pool, 0, sizeof(struct pthread_msq_pool_t));
+	for (i = 0; i < PTHREAD_MSQ_POOL_CLASS_NUM; i++) {
+		// キューに格納できる数だけ用意する(大きいブロックは上限まで)
+		num = queue->maxMsgQueueNum + PTHREAD_MSQ_POOL_SPARE;
+		if (num * pthread_msq_pool_stride[i] > PTHREAD_MSQ_POOL_CLASS_MAX) {
+			num = PTHREAD_MSQ_POOL_CLASS_MAX / pthread_msq_pool_stride[i];
+		}
+		pool->klass[i].blockNum = (int)num;
+	}
+	pool->refs = 2;		// キューと呼び出し元
+	if (!__atomic_compare_exchange_n(&queue->pool, &expected, pool, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+		// 他の送信スレッドが先に作成した,またはキューが破壊された
+		free(pool);
+		if (PTHREAD_MSQ_POOL_CLOSED == expected) {
+			return (NULL);
+		}
+		pool = expected;
+		__atomic_add_fetch(&pool->refs, 1, __ATOMIC_RELAXED);
+	}
+	return (pool);
+}
+
+/**
+ * プールの参照を解放する(最後の参照の場合はプールを破壊する)
+ */
+static void pthread_msq_pool_unref(struct pthread_msq_pool_t *pool) {
+	int i;
+
+	if (0 != __atomic_sub_fetch(&pool->refs, 1, __ATOMIC_ACQ_REL)) {
+		return;
+	}
+	for (i = 0; i < PTHREAD_MSQ_POOL_CLASS_NUM; i++) {
+		free(pool->klass[i].arena);
+	}
+	free(pool);
+}
+
+/**
+ * キューのプールを参照する(無ければ作成する)
+ *
+ * pthread_msq_pool_destroy()はpoolBusyが0になるまで待つので、
+ * poolBusyを加算している間に読んだプールは参照を加算するまで解放されない。
+ *
+ * @retval	NULL以外	プール(参照を加算済み,pthread_msq_pool_unref()で解放する)
+ * @retval	NULL		キューが破壊された,またはプールを作成できない
+ */
+static struct pthread_msq_pool_t *pthread_msq_pool_get(pthread_msq_id_t *queue) {
+	struct pthread_msq_pool_t *pool;
+
+	__atomic_add_fetch(&queue->poolBusy, 1, __ATOMIC_SEQ_CST);
+	pool = __atomic_load_n(&queue->pool, __ATOMIC_SEQ_CST);
+	if (PTHREAD_MSQ_POOL_CLOSED == pool) {
+		pool = NULL;
+	} else if (NULL != pool) {
+		__atomic_add_fetch(&pool->refs, 1, __ATOMIC_RELAXED);
+	} else {
+		pool = pthread_msq_pool_create(queue);
+	}
+	__atomic_sub_fetch(&queue->poolBusy, 1, __ATOMIC_RELEASE);
+	return (pool);
+}
+
+/**
+ * ブロックを作成して空きブロックに登録する
+ */
+static void pthread_msq_pool_class_init(pthread_msq_pool_class_t *klass, size_t stride) {
+	char *arena, *expected = NULL;
+	uint32_t *next;
+	int num = klass->blockNum;
+	int i;
+
+	if (0 != posix_memalign((void **)&arena, 64, stride * num + sizeof(uint32_t) * num)) {
+		return;
+	}
+	next = (uint32_t *)(arena + stride * num);
+	for (i = 0; i < num - 1; i++) {
+		next[i] = i + 2;
+	}
+	next[num - 1] = 0;
+	if (!__atomic_compare_exchange_n(&klass->arena, &expected, arena, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+		// 他の送信スレッドが先に作成した
+		free(arena);
+		return;
+	}
+	klass->next = next;
+	__atomic_store_n(&klass->head, (uint64_t)1, __ATOMIC_RELEASE);
+}
+
+/**
+ * 空きブロックを取り出す
+ *
+ * @retval	0以上	ブロック番号
+ * @retval	-1		空き無し
+ */
+static int pthread_msq_pool_pop(pthread_msq_pool_class_t *klass) {
+	uint64_t old, new;
+	uint32_t index, next;
+
+	old = __atomic_load_n(&klass->head, __ATOMIC_ACQUIRE);
+	do {
+		index = (uint32_t)old;
+		if (0 == index) {
+			return (-1);
+		}
+		next = __atomic_load_n(&klass->next[index - 1], __ATOMIC_RELAXED);
+		new = (((old >> 32) + 1) << 32) | next;
+	} while (!__atomic_compare_exchange_n(&klass->head, &old, new, 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+	return ((int)index - 1);
+}
+
+/**
+ * ブロックを空きブロックに戻す
+ */
+static void pthread_msq_pool_push(pthread_msq_pool_class_t *klass, int index) {
+	uint64_t old, new;
+
+	old = __atomic_load_n(&klass->head, __ATOMIC_RELAXED);
+	do {
+		__atomic_store_n(&klass->next[index], (uint32_t)old, __ATOMIC_RELAXED);
+		new = (((old >> 32) + 1) << 32) | (uint32_t)(index + 1);
+	} while (!__atomic_compare_exchange_n(&klass->head, &old, new, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+/**
+ * キューからプールを切り離す
+ *
+ * 確保中のペイロードがある場合は、最後のペイロードが解放された時にプールを破壊する。
+ */
+static void pthread_msq_pool_destroy(pthread_msq_id_t *queue) {
+	struct pthread_msq_pool_t *pool;
+
+	pool = __atomic_exchange_n(&queue->pool, PTHREAD_MSQ_POOL_CLOSED, __ATOMIC_SEQ_CST);
+	// プールを読んだ確保処理が参照を加算し終わるまで待つ
+	while (0 != __atomic_load_n(&queue->poolBusy, __ATOMIC_SEQ_CST)) {
+		sched_yield();
+	}
+	if ((NULL == pool) || (PTHREAD_MSQ_POOL_CLOSED == pool)) {
+		return;
+	}
+	pthread_msq_pool_unref(pool);
+}
+
+/**
+ * 可変長データを確保する
+ *
+ * 受信側キューのプールから確保する。送信側はここに直接書き込み、
+ * pthread_msq_msg_send_payload()で送信する。送信しなかった場合はpthread_msq_payload_free()で解放する。
+ * 受信側のpthread_msq_destroy()の後でも解放できる(プールは最後のペイロードが解放されるまで残る)。
+ *
+ * @param[in]	queue	送信先のキュー(NULL:mallocで確保する)
+ * @param[in]	size	大きさ
+ * @retval	NULL以外	ペイロード(16byte境界)
+ * @retval	NULL		確保できない
+ */
+void *pthread_msq_payload_alloc(pthread_msq_id_t *queue, size_t size) {
+	struct pthread_msq_pool_t *pool = NULL;
+	pthread_msq_pool_class_t *klass;
+	pthread_msq_payload_t *header;
+	int i, index;
+
+	if ((NULL != queue) && (__atomic_load_n(&queue->oneself, __ATOMIC_ACQUIRE) == queue)) {
+		pool = pthread_msq_pool_get(queue);
+	}
+	if (NULL != pool) {
+		for (i = 0; i < PTHREAD_MSQ_POOL_CLASS_NUM; i++) {
+			if (sizeof(pthread_msq_payload_t) + size <= pthread_msq_pool_stride[i]) {
+				break;
+			}
+		}
+		if (i < PTHREAD_MSQ_POOL_CLASS_NUM) {
+			klass = &pool->klass[i];
+			if (NULL == __atomic_load_n(&klass->arena, __ATOMIC_ACQUIRE)) {
+				pthread_msq_pool_class_init(klass, pthread_msq_pool_stride[i]);
+			}
+			index = pthread_msq_pool_pop(klass);
+			if (index >= 0) {
+				header = (pthread_msq_payload_t *)(__atomic_load_n(&klass->arena, __ATOMIC_ACQUIRE) + pthread_msq_pool_stride[i] * index);
+				header->pool = pool;
+				header->size = size;
+				header->klass = i;
+				header->index = index;
+				return (header + 1);		// プールの参照はペイロードの解放時に解放する
+			}
+		}
+		pthread_msq_pool_unref(pool);
+	}
+	// プールに収まらない
+	header = malloc(sizeof(pthread_msq_payload_t) + size);
+	if (NULL == header) {
+		return (NULL);
+	}
+	header->pool = NULL;
+	header->size = size;
+	header->klass = PTHREAD_MSQ_POOL_MALLOC;
+	header->index = 0;
+	return (header + 1);
+}
+
+/**
+ * 可変長データを解放する
+ */
+void pthread_msq_payload_free(void *payload) {
+	pthread_msq_payload_t *header;
+	struct pthread_msq_pool_t *pool;
+
+	if (NULL == payload) {
+		return;
+	}
+	header = (pthread_msq_payload_t *)payload - 1;
+	if (PTHREAD_MSQ_POOL_MALLOC == header->klass) {
+		free(header);
+		return;
+	}
+	// 空きブロックに戻した後は他のスレッドがヘッダーを書き換えるので先に読む
+	pool = header->pool;
+	pthread_msq_pool_push(&pool->klass[header->klass], header->index);
+	pthread_msq_pool_unref(pool);
+}
+
+/**
+ * 可変長データの大きさ
+ */
+size_t pthread_msq_payload_size(const void *payload) {
+	if (NULL == payload) {
+		return (0);
+	}
+	return (((const pthread_msq_payload_t *)payload - 1)->size);
+}
+
+#ifdef PTHREAD_MSQ_USE_EVENTFD
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+/**
+ * eventfdに送信を通知する
+ */
+static void pthread_msq_eventfd_signal(pthread_msq_id_t *queue) {
+	uint64_t value = 1;
+	ssize_t rc;
+	int fd;
+
+	fd = __atomic_load_n(&queue->eventFd, __ATOMIC_ACQUIRE);
+	if (fd >= 0) {
+		rc = write(fd, &value, sizeof(value));
+		(void)rc;	/* カウンタが飽和(EAGAIN)しても通知済みなので問題ない */
+	}
+}
+
+/**
+ * eventfdを閉じる
+ */
+static void pthread_msq_eventfd_close(pthread_msq_id_t *queue) {
+	int fd;
+
+	fd = __atomic_exchange_n(&queue->eventFd, -1, __ATOMIC_ACQ_REL);
+	if (fd >= 0) {
+		close(fd);
+	}
+}
+#endif /* PTHREAD_MSQ_USE_EVENTFD */
+
+#ifdef PTHREAD_MSQ_USE_LOCKFREE
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#define PTHREAD_MSQ_LF_CACHE_LINE	(64)
+#define PTHREAD_MSQ_LF_SPIN_COUNT	(128)	// futexで眠る前にスピンする回数
+
+#if defined(__x86_64__) || defined(__i386__)
+#define pthread_msq_lf_cpu_relax()	__builtin_ia32_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#define pthread_msq_lf_cpu_relax()	__asm__ __volatile__("yield" ::: "memory")
+#else
+#define pthread_msq_lf_cpu_relax()	__asm__ __volatile__("" ::: "memory")
+#endif
+
+typedef struct pthread_msq_lf_slot_t {
+	size_t seq;						// スロットのシーケンス番号(書き込み可能:pos 読み出し可能:pos+1)
+	pthread_msq_msg_t msg;
+} pthread_msq_lf_slot_t;
+
+// 送信側と受信側が書き換える変数は別のキャッシュラインに置く
+struct pthread_msq_lf_t {
+	size_t mask;					// スロット数-1(スロット数は2のべき乗)
+	int spinCount;					// futexで眠る前にスピンする回数(シングルCPUでは0)
+	pthread_msq_lf_slot_t *slot;
+	size_t tail __attribute__((aligned(PTHREAD_MSQ_LF_CACHE_LINE)));		// 送信位置(複数の送信スレッドが更新)
+	size_t head __attribute__((aligned(PTHREAD_MSQ_LF_CACHE_LINE)));		// 受信位置(受信スレッドのみ更新)
+	int sleeping __attribute__((aligned(PTHREAD_MSQ_LF_CACHE_LINE)));	// 1:受信スレッドが待機中
+	int wakeSeq;					// 受信スレッド待機用のfutex
+	int spaceWaiters;				// キューの空き待ちをしている送信スレッド数
+	int spaceSeq;					// 送信スレッド待機用のfutex
+};
+
+static int pthread_msq_lf_futex_wait(int *addr, int val)
+{
+	return (syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0));
+}
+
+static void pthread_msq_lf_futex_wake(int *addr, int num)
+{
+	syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, num, NULL, NULL, 0);
+}
+
+/**
+ * ロックフリーキューの作成
+ */
+static int pthread_msq_lf_create(pthread_msq_id_t *queue, int qsize) {
+	struct pthread_msq_lf_t *lf;
+	pthread_msq_lf_slot_t *slot;
+	size_t num, i;
+	void *mem;
+
+	// スロット数は2のべき乗に切り上げる
+	num = 1;
+	while (num < (size_t)qsize) {
+		num <<= 1;
+	}
+
+	if (0 != posix_memalign(&mem, PTHREAD_MSQ_LF_CACHE_LINE, sizeof(struct pthread_msq_lf_t))) {
+		return (PTHREAD_MSQ_ERROR);
+	}
+	lf = mem;
+	memset(lf, 0, sizeof(struct pthread_msq_lf_t));
+
+	slot = malloc(sizeof(pthread_msq_lf_slot_t) * num);
+	if (NULL == slot) {
+		free(lf);
+		return (PTHREAD_MSQ_ERROR);
+	}
+	for (i = 0; i < num; i++) {
+		slot[i].seq = i;
+	}
+	lf->mask = num - 1;
+	lf->spinCount = (sysconf(_SC_NPROCESSORS_ONLN) > 1) ? PTHREAD_MSQ_LF_SPIN_COUNT : 0;
+	lf->slot = slot;
+
+	pthread_mutex_init(&queue->mutex, NULL);
+
+	pthread_mutex_lock(&queue->mutex);
+	queue->type = PTHREAD_MSQ_TYPE_LOCKFREE;
+	queue->lf = lf;
+	queue->eventFd = -1;
+	queue->pool = NULL;
+	queue->poolBusy = 0;
+	queue->maxMsgQueueNum = (int)num;
+	queue->fifoIndex = 0;
+	queue->queueNum = 0;
+	queue->ringBuffer = NULL;
+	__atomic_store_n(&queue->oneself, queue, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&queue->mutex);
+
+	return (PTHREAD_MSQ_OK);
+}
+
+/**
+ * ロックフリーキューへのメッセージ送信
+ */
+static int pthread_msq_lf_send(pthread_msq_id_t *queue, pthread_msq_msg_t *msg, void *sender, void *payload) {
+	struct pthread_msq_lf_t *lf = queue->lf;
+	pthread_msq_lf_slot_t *slot;
+	size_t pos, seq;
+	intptr_t diff;
+	int space;
+	int spin = 0;
+	int i;
+	size_t *in, *out;
+
+	pos = __atomic_load_n(&lf->tail, __ATOMIC_RELAXED);
+	for (;;) {
+		/* メッセージキュー停止チェック */
+		if (__atomic_load_n(&queue->stop, __ATOMIC_RELAXED) == 1) {
+			return (PTHREAD_MSQ_ERROR);
+		}
+		slot = &lf->slot[pos & lf->mask];
+		seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+		diff = (intptr_t)seq - (intptr_t)pos;
+		if (diff == 0) {
+			// 書き込み位置を確保する
+			if (__atomic_compare_exchange_n(&lf->tail, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+				break;
+			}
+		} else if ((diff < 0) && (spin < lf->spinCount)) {
+			// キューが満杯:しばらくスピンして空きを待つ
+			spin++;
+			pthread_msq_lf_cpu_relax();
+			pos = __atomic_load_n(&lf->tail, __ATOMIC_RELAXED);
+		} else if (diff < 0) {
+			// キューが満杯:受信スレッドが空けるまで待つ
+			space = __atomic_load_n(&lf->spaceSeq, __ATOMIC_ACQUIRE);
+			__atomic_add_fetch(&lf->spaceWaiters, 1, __ATOMIC_SEQ_CST);
+			seq = __atomic_load_n(&slot->seq, __ATOMIC_SEQ_CST);
+			if (((intptr_t)seq - (intptr_t)pos < 0) && (__atomic_load_n(&queue->stop, __ATOMIC_RELAXED) == 0)) {
+				pthread_msq_lf_futex_wait(&lf->spaceSeq, space);
+			}
+			__atomic_sub_fetch(&lf->spaceWaiters, 1, __ATOMIC_SEQ_CST);
+			spin = 0;
+			pos = __atomic_load_n(&lf->tail, __ATOMIC_RELAXED);
+		} else {
+			// 他の送信スレッドが先に確保した
+			pos = __atomic_load_n(&lf->tail, __ATOMIC_RELAXED);
+		}
+	}
+
+	/* スロットにメッセージを格納する */
+	slot->msg.__sender = sender;
+	slot->msg.__payload = payload;
+	out = slot->msg.data;
+	in = msg->data;
+	for (i = 0; i < PTHREAD_MSQ_MSG_NUM; i++) {
+		*out++ = *in++;
+	}
+	__atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+	pthread_msq_trace(queue, PTHREAD_MSQ_TRACE_SEND, msg,
+		(int)(pos + 1 - __atomic_load_n(&lf->head, __ATOMIC_RELAXED)));
+
+	/* 受信スレッドが待機中の場合のみ起こす */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&lf->sleeping, __ATOMIC_RELAXED)) {
+		__atomic_add_fetch(&lf->wakeSeq, 1, __ATOMIC_RELEASE);
+		pthread_msq_lf_futex_wake(&lf->wakeSeq, 1);
+	}
+#ifdef PTHREAD_MSQ_USE_EVENTFD
+	pthread_msq_eventfd_signal(queue);
+#endif /* PTHREAD_MSQ_USE_EVENTFD */
+	return (PTHREAD_MSQ_OK);
+}
+
+/**
+ * ロックフリーキューからのメッセージ受信(wait無し)
+ */
+static int pthread_msq_lf_receive_try(pthread_msq_id_t *queue, pthread_msq_msg_t *msg) {
+	struct pthread_msq_lf_t *lf = queue->lf;
+	pthread_msq_lf_slot_t *slot;
+	size_t pos;
+	int i;
+	size_t *in, *out;
+
+	pos = lf->head;
+	slot = &lf->slot[pos & lf->mask];
+	if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != pos + 1) {
+		// msg無し
+		return (PTHREAD_MSQ_ERROR);
+	}
+
+	/* スロットからメッセージを取り出す */
+	msg->__sender = slot->msg.__sender;
+	msg->__payload = slot->msg.__payload;
+	out = msg->data;
+	in = slot->msg.data;
+	for (i = 0; i < PTHREAD_MSQ_MSG_NUM; i++) {
+		*out++ = *in++;
+	}
+	__atomic_store_n(&slot->seq, pos + lf->mask + 1, __ATOMIC_RELEASE);
+	__atomic_store_n(&lf->head, pos + 1, __ATOMIC_RELAXED);
+	pthread_msq_trace(queue, PTHREAD_MSQ_TRACE_RECEIVE, msg,
+		(int)(__atomic_load_n(&lf->tail, __ATOMIC_RELAXED) - (pos + 1)));
+
+	/* 空き待ちの送信スレッドがいる場合のみ起こす(空いた1スロットにつき1スレッド) */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&lf->spaceWaiters, __ATOMIC_RELAXED) > 0) {
+		__atomic_add_fetch(&lf->spaceSeq, 1, __ATOMIC_RELEASE);
+		pthread_msq_lf_futex_wake(&lf->spaceSeq, 1);
+	}
+	return (PTHREAD_MSQ_OK);
+}
+
+/**
+ * ロックフリーキューからのメッセージ受信
+ */
+static int pthread_msq_lf_receive(pthread_msq_id_t *queue, pthread_msq_msg_t *msg) {
+	struct pthread_msq_lf_t *lf = queue->lf;
+	pthread_msq_lf_slot_t *slot;
+	int wake;
+	int spin;
+
+	for (;;) {
+		// しばらくスピンしてからfutexで眠る
+		spin = 0;
+		do {
+			if (PTHREAD_MSQ_OK == pthread_msq_lf_receive_try(queue, msg)) {
+				return (PTHREAD_MSQ_OK);
+			}
+			pthread_msq_lf_cpu_relax();
+		} while (++spin < lf->spinCount);
+		/* メッセージキューIDのチェック */
+		if (__atomic_load_n(&queue->oneself, __ATOMIC_ACQUIRE) != queue) {
+			return (PTHREAD_MSQ_ERROR);
+		}
+		// 待機することを送信側に知らせてから再確認し、メッセージが無ければ眠る
+		wake = __atomic_load_n(&lf->wakeSeq, __ATOMIC_ACQUIRE);
+		__atomic_store_n(&lf->sleeping, 1, __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		slot = &lf->slot[lf->head & lf->mask];
+		if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != lf->head + 1) {
+			pthread_msq_lf_futex_wait(&lf->wakeSeq, wake);
+		}
+		__atomic_store_n(&lf->sleeping, 0, __ATOMIC_RELAXED);
+	}
+}
+
+/**
+ * ロックフリーキューの破壊
+ */
+static int pthread_msq_lf_destroy(pthread_msq_id_t *queue) {
+	struct pthread_msq_lf_t *lf;
+
+	pthread_mutex_lock(&queue->mutex);
+	lf = queue->lf;
+	__atomic_store_n(&queue->oneself, NULL, __ATOMIC_RELEASE);
+	queue->lf = NULL;
+#ifdef PTHREAD_MSQ_USE_EVENTFD
+	pthread_msq_eventfd_close(queue);
+#endif /* PTHREAD_MSQ_USE_EVENTFD */
+	pthread_mutex_unlock(&queue->mutex);
+	pthread_mutex_destroy(&queue->mutex); /* ミューテックスを破壊する */
+	pthread_msq_pool_destroy(queue);
+	if (NULL != lf) {
+		free(lf->slot);
+		free(lf);
+	}
+	return (PTHREAD_MSQ_OK);
+}
+#endif /* PTHREAD_MSQ_USE_LOCKFREE */
+
+/**
+ * メッセージキューの作成(実装指定)
+ */
+int pthread_msq_create_ex(pthread_msq_id_t *queue, int qsize, int type) {
+	if (NULL != queue->oneself) {
+		return (PTHREAD_MSQ_ERROR);
+	}
+#ifdef PTHREAD_MSQ_USE_LOCKFREE
+	if (PTHREAD_MSQ_TYPE_LOCKFREE == type) {
+		return (pthread_msq_lf_create(queue, qsize));
+	}
+#endif /* PTHREAD_MSQ_USE_LOCKFREE */
+	queue->type = PTHREAD_MSQ_TYPE_MUTEX;
+	return (pthread_msq_create(queue, qsize));
+}
+
 /**
  * メッセージキューの作成
  */
@@ -91,6 +719,9 @@ int pthread_msq_create(pthread_msq_id_t *queue, int qsize) {
 	}
 	pthread_mutex_lock(&queue->mutex);		// 2021.01.25 append by T.Aikawa
 	queue->oneself = queue;
+	queue->eventFd = -1;
+	queue->pool = NULL;
+	queue->poolBusy = 0;
 	queue->maxMsgQueueNum = qsize;
 	queue->fifoIndex = 0;
 	queue->queueNum = 0;
@@ -103,9 +734,10 @@ int pthread_msq_create(pthread_msq_id_t *queue, int qsize) {
 /**
  * メッセージ送信
  */
-int pthread_msq_msg_send(pthread_msq_id_t *queue, pthread_msq_msg_t *msg, void *sender) {
+static int pthread_msq_send(pthread_msq_id_t *queue, pthread_msq_msg_t *msg, void *sender, void *payload) {
 	pthread_msq_msg_t *msq_msg;
 	int fifo;
+	int depth;
 	int i;
 	size_t *in, *out;
 
@@ -113,6 +745,11 @@ int pthread_msq_msg_send(pthread_msq_id_t *queue, pthread_msq_msg_t *msg, void *
 	if (queue->oneself != queue) {
 		return (PTHREAD_MSQ_ERROR);
 	}
+#ifdef PTHREAD_MSQ_USE_LOCKFREE
+	if (PTHREAD_MSQ_TYPE_LOCKFREE == queue->type) {
+		return (pthread_msq_lf_send(queue, msg, sender, payload));
+	}
+#endif /* PTHREAD_MSQ_USE_LOCKFREE */
 	/* メッセージキュー停止チェック */			// 2021.01.25 append by T.Aikawa
 	if (queue->stop == 1) {						// 2021.01.25 append by T.Aikawa
 		return (PTHREAD_MSQ_ERROR);				// 2021.01.25 append by T.Aikawa
@@ -146,6 +783,7 @@ int pthread_msq_msg_send(pthread_msq_id_t *queue, pthread_msq_msg_t *msg, void *
 
 	/* リングバッファーにメッセージを格納する */
 	msq_msg->__sender = sender;
+	msq_msg->__payload = payload;
 	out = msq_msg->data;
 	in = msg->data;
 	for (i = 0; i < PTHREAD_MSQ_MSG_NUM; i++) {
@@ -154,22 +792,104 @@ int pthread_msq_msg_send(pthread_msq_id_t *queue, pthread_msq_msg_t *msg, void *
 
 	/* メッセージの格納数を＋１する */
 	queue->queueNum++;
+	depth = queue->queueNum;
 
 	pthread_mutex_unlock(&queue->mutex);
+	pthread_msq_trace(queue, PTHREAD_MSQ_TRACE_SEND, msg, depth);
 
 #ifdef __SMS_APPLE__
 	sem_post(queue->receiveId); /* 受信を許可する */
 #else
 	sem_post(&queue->receiveId); /* 受信を許可する */
 #endif /* __SMS_APPLE__ */
+#ifdef PTHREAD_MSQ_USE_EVENTFD
+	/* 格納数の更新からsem_postまでの間に受信側が受信し尽くして待機に戻ることがあるので、
+	   空からの格納かどうかに関わらず毎回通知する */
+	pthread_msq_eventfd_signal(queue);
+#endif /* PTHREAD_MSQ_USE_EVENTFD */
 	return (PTHREAD_MSQ_OK);
 }
 
+/**
+ * メッセージ送信
+ */
+int pthread_msq_msg_send(pthread_msq_id_t *queue, pthread_msq_msg_t *msg, void *sender) {
+	return (pthread_msq_send(queue, msg, sender, NULL));
+}
+
+/**
+ * 可変長データ付きメッセージ送信
+ *
+ * payloadはpthread_msq_payload_alloc(queue, ...)で確保したもの。受信側はpthread_msq_msg_payload()で
+ * 取り出し、処理後にpthread_msq_payload_free()で解放する。送信に失敗した場合は送信側が解放する。
+ */
+int pthread_msq_msg_send_payload(pthread_msq_id_t *queue, pthread_msq_msg_t *msg, void *sender, void *payload) {
+	return (pthread_msq_send(queue, msg, sender, payload));
+}
+
+/**
+ * メッセージ送信(未受信の末尾メッセージと集約)
+ *
+ * キューの末尾にあるまだ受信されていないメッセージとdata[0]～data[keyNum-1]が
+ * 一致する場合、新しいメッセージを追加せずに末尾のメッセージを更新する。
+ * 末尾のメッセージとしか集約しないため、間に他のメッセージがあれば順序は保たれる。
+ *
+ * @param[in]	keyNum		一致を判定するdataの個数
+ * @param[in]	sumIndex	PTHREAD_MSQ_COALESCE_REPLACE:新しいメッセージで置き換える
+ *							0以上:data[sumIndex]は加算し、それ以外は置き換える
+ */
+int pthread_msq_msg_send_coalesce(pthread_msq_id_t *queue, pthread_msq_msg_t *msg, void *sender, int keyNum, int sumIndex) {
+	pthread_msq_msg_t *msq_msg;
+	size_t sum;
+	int tail;
+	int i;
+
+	/* メッセージキューIDのチェック */
+	if (queue->oneself != queue) {
+		return (PTHREAD_MSQ_ERROR);
+	}
+	if ((PTHREAD_MSQ_TYPE_MUTEX != queue->type) || (keyNum <= 0) || (keyNum > PTHREAD_MSQ_MSG_NUM)) {
+		// ロックフリーキューは受信側と競合せずに格納済みのスロットを書き換えられないため集約しない
+		return (pthread_msq_msg_send(queue, msg, sender));
+	}
+
+	pthread_mutex_lock(&queue->mutex);
+	if ((queue->oneself == queue) && (queue->stop == 0) && (queue->queueNum > 0)) {
+		/* リングバッファー内の末尾のメッセージを求める */
+		tail = (queue->fifoIndex + queue->queueNum - 1) % queue->maxMsgQueueNum;
+		msq_msg = queue->ringBuffer + tail;
+		for (i = 0; i < keyNum; i++) {
+			if (msq_msg->data[i] != msg->data[i]) {
+				break;
+			}
+		}
+		if ((i == keyNum) && (msq_msg->__sender == sender) && (NULL == msq_msg->__payload)) {
+			/* 末尾のメッセージを更新する */
+			sum = 0;
+			if ((sumIndex >= 0) && (sumIndex < PTHREAD_MSQ_MSG_NUM)) {
+				sum = msq_msg->data[sumIndex] + msg->data[sumIndex];
+			}
+			for (i = keyNum; i < PTHREAD_MSQ_MSG_NUM; i++) {
+				msq_msg->data[i] = msg->data[i];
+			}
+			if ((sumIndex >= 0) && (sumIndex < PTHREAD_MSQ_MSG_NUM)) {
+				msq_msg->data[sumIndex] = sum;
+			}
+			pthread_mutex_unlock(&queue->mutex);
+			return (PTHREAD_MSQ_OK);
+		}
+	}
+	pthread_mutex_unlock(&queue->mutex);
+
+	return (pthread_msq_msg_send(queue, msg, sender));
+}
+
 /**
  * メッセージ受信
  */
 int pthread_msq_msg_receive(pthread_msq_id_t *queue, pthread_msq_msg_t *msg) {
 	pthread_msq_msg_t *msq_msg;
+	int depth;
 	int i;
 	size_t *in, *out;
 
@@ -177,6 +897,11 @@ int pthread_msq_msg_receive(pthread_msq_id_t *queue, pthread_msq_msg_t *msg) {
 	if (queue->oneself != queue) {
 		return (PTHREAD_MSQ_ERROR);
 	}
+#ifdef PTHREAD_MSQ_USE_LOCKFREE
+	if (PTHREAD_MSQ_TYPE_LOCKFREE == queue->type) {
+		return (pthread_msq_lf_receive(queue, msg));
+	}
+#endif /* PTHREAD_MSQ_USE_LOCKFREE */
 
 #ifdef __SMS_APPLE__
 	sem_wait(queue->receiveId); /* 受信可能になるまで待つ */
@@ -196,6 +921,7 @@ int pthread_msq_msg_receive(pthread_msq_id_t *queue, pthread_msq_msg_t *msg) {
 
 	/* リングバッファーからメッセージを取り出す */
 	msg->__sender = msq_msg->__sender;
+	msg->__payload = msq_msg->__payload;
 	out = msg->data;
 	in = msq_msg->data;
 	for (i = 0; i < PTHREAD_MSQ_MSG_NUM; i++) {
@@ -207,9 +933,10 @@ int pthread_msq_msg_receive(pthread_msq_id_t *queue, pthread_msq_msg_t *msg) {
 		queue->fifoIndex = 0;
 	}
 	/* メッセージの格納数をー１する */
-	--queue->queueNum;
+	depth = --queue->queueNum;
 
 	pthread_mutex_unlock(&queue->mutex);
+	pthread_msq_trace(queue, PTHREAD_MSQ_TRACE_RECEIVE, msg, depth);
 #ifdef __SMS_APPLE__
 	sem_post(queue->sendId); /* 送信を許可する */
 #else
@@ -223,13 +950,18 @@ int pthread_msq_msg_receive(pthread_msq_id_t *queue, pthread_msq_msg_t *msg) {
  */
 int pthread_msq_msg_receive_try(pthread_msq_id_t *queue, pthread_msq_msg_t *msg) {
 	pthread_msq_msg_t *msq_msg;
-	int i, ret;
+	int i, ret, depth;
 	size_t *in, *out;
 
 	/* メッセージキューIDのチェック */
 	if (queue->oneself != queue) {
 		return (PTHREAD_MSQ_ERROR);
 	}
+#ifdef PTHREAD_MSQ_USE_LOCKFREE
+	if (PTHREAD_MSQ_TYPE_LOCKFREE == queue->type) {
+		return (pthread_msq_lf_receive_try(queue, msg));
+	}
+#endif /* PTHREAD_MSQ_USE_LOCKFREE */
 
 #ifdef __SMS_APPLE__
 	ret = sem_trywait(queue->receiveId); /* 受信可能ならば処理 */
@@ -253,6 +985,7 @@ int pthread_msq_msg_receive_try(pthread_msq_id_t *queue, pthread_msq_msg_t *msg)
 
 	/* リングバッファーからメッセージを取り出す */
 	msg->__sender = msq_msg->__sender;
+	msg->__payload = msq_msg->__payload;
 	out = msg->data;
 	in = msq_msg->data;
 	for (i = 0; i < PTHREAD_MSQ_MSG_NUM; i++) {
@@ -264,9 +997,10 @@ int pthread_msq_msg_receive_try(pthread_msq_id_t *queue, pthread_msq_msg_t *msg)
 		queue->fifoIndex = 0;
 	}
 	/* メッセージの格納数をー１する */
-	--queue->queueNum;
+	depth = --queue->queueNum;
 
 	pthread_mutex_unlock(&queue->mutex);
+	pthread_msq_trace(queue, PTHREAD_MSQ_TRACE_RECEIVE, msg, depth);
 #ifdef __SMS_APPLE__
 	sem_post(queue->sendId); /* 送信を許可する */
 #else
@@ -298,6 +1032,11 @@ int pthread_msq_destroy(pthread_msq_id_t *queue) {
 #else
 // 2021.01.25 append by T.Aikawa
 int pthread_msq_destroy(pthread_msq_id_t *queue) {
+#ifdef PTHREAD_MSQ_USE_LOCKFREE
+	if (PTHREAD_MSQ_TYPE_LOCKFREE == queue->type) {
+		return (pthread_msq_lf_destroy(queue));
+	}
+#endif /* PTHREAD_MSQ_USE_LOCKFREE */
 	pthread_mutex_lock(&queue->mutex);		// 2021.01.25 append by T.Aikawa
 #ifdef __SMS_APPLE__
 	sem_close(queue->sendId);
@@ -309,9 +1048,13 @@ int pthread_msq_destroy(pthread_msq_id_t *queue) {
 	sem_destroy(&queue->receiveId); /* セマフォを削除する */
 #endif /* __SMS_APPLE__ */
 	free(queue->ringBuffer);
-	queue->oneself = NULL;
+	__atomic_store_n(&queue->oneself, NULL, __ATOMIC_RELEASE);
+#ifdef PTHREAD_MSQ_USE_EVENTFD
+	pthread_msq_eventfd_close(queue);
+#endif /* PTHREAD_MSQ_USE_EVENTFD */
 	pthread_mutex_unlock(&queue->mutex);	// 2021.01.25 append by T.Aikawa
 	pthread_mutex_destroy(&queue->mutex); /* ミューテックスを破壊する */
+	pthread_msq_pool_destroy(queue);
 	return (PTHREAD_MSQ_OK);
 }
 #endif
@@ -319,7 +1062,14 @@ int pthread_msq_destroy(pthread_msq_id_t *queue) {
 // 2021.01.25 append by T.Aikawa
 int pthread_msq_stop(pthread_msq_id_t *queue) {
 	pthread_mutex_lock(&queue->mutex);
-	queue->stop = 1;
+	__atomic_store_n(&queue->stop, 1, __ATOMIC_RELAXED);
+#ifdef PTHREAD_MSQ_USE_LOCKFREE
+	if ((PTHREAD_MSQ_TYPE_LOCKFREE == queue->type) && (NULL != queue->lf)) {
+		// 空き待ちの送信スレッドを起こしてエラーで返す
+		__atomic_add_fetch(&queue->lf->spaceSeq, 1, __ATOMIC_RELEASE);
+		pthread_msq_lf_futex_wake(&queue->lf->spaceSeq, INT_MAX);
+	}
+#endif /* PTHREAD_MSQ_USE_LOCKFREE */
 	pthread_mutex_unlock(&queue->mutex);
 	return (PTHREAD_MSQ_OK);
 }
@@ -330,4 +1080,75 @@ int pthread_msq_start(pthread_msq_id_t *queue) {
 	queue->stop = 0;
 	pthread_mutex_unlock(&queue->mutex);
 	return (PTHREAD_MSQ_OK);
-}
\ No newline at end of file
+}
+
+/**
+ * 送信時に通知されるeventfdを取得する
+ *
+ * 初回の呼び出しでeventfdを作成する。メッセージが格納されると読み込み可能になる。
+ * 受信側はpthread_msq_eventfd_clear()で通知をクリアした後、
+ * pthread_msq_msg_receive_try()でキューが空になるまで受信すること。
+ * eventfdはpthread_msq_destroy()で閉じられる。
+ *
+ * @retval	0以上	eventfd
+ * @retval	PTHREAD_MSQ_ERROR	作成できない(未対応の環境を含む)
+ */
+int pthread_msq_eventfd_open(pthread_msq_id_t *queue) {
+#ifdef PTHREAD_MSQ_USE_EVENTFD
+	int fd;
+
+	/* メッセージキューIDのチェック */
+	if (queue->oneself != queue) {
+		return (PTHREAD_MSQ_ERROR);
+	}
+	pthread_mutex_lock(&queue->mutex);
+	fd = queue->eventFd;
+	if (fd < 0) {
+		fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (fd < 0) {
+			pthread_mutex_unlock(&queue->mutex);
+			return (PTHREAD_MSQ_ERROR);
+		}
+		__atomic_store_n(&queue->eventFd, fd, __ATOMIC_RELEASE);
+		/* 作成前に格納済みのメッセージがある場合に備えて通知しておく */
+		pthread_msq_eventfd_signal(queue);
+	}
+	pthread_mutex_unlock(&queue->mutex);
+	return (fd);
+#else
+	(void)queue;
+	return (PTHREAD_MSQ_ERROR);
+#endif /* PTHREAD_MSQ_USE_EVENTFD */
+}
+
+/**
+ * eventfdの通知をクリアする
+ */
+int pthread_msq_eventfd_clear(pthread_msq_id_t *queue) {
+#ifdef PTHREAD_MSQ_USE_EVENTFD
+	uint64_t value;
+	int fd;
+
+	fd = __atomic_load_n(&queue->eventFd, __ATOMIC_ACQUIRE);
+	if (fd < 0) {
+		return (PTHREAD_MSQ_ERROR);
+	}
+	if (read(fd, &value, sizeof(value)) < 0) {
+		/* EAGAIN:通知無し */
+		return (PTHREAD_MSQ_ERROR);
+	}
+	return (PTHREAD_MSQ_OK);
+#else
+	(void)queue;
+	return (PTHREAD_MSQ_ERROR);
+#endif /* PTHREAD_MSQ_USE_EVENTFD */
+}
+
+/**
+ * トレース用フックを設定する(NULL:解除)
+ *
+ * フックは送信・受信したスレッドで、キューのロックを解放した後に呼ばれる。
+ */
+void pthread_msq_set_trace_hook(pthread_msq_trace_hook_t hook) {
+	__atomic_store_n(&pthread_msq_trace_hook, hook, __ATOMIC_RELAXED);
+}
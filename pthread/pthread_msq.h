@@ -34,11 +34,19 @@
 #define PTHREAD_MSQ_ERROR		(-1)
 #define PTHREAD_MSQ_MSG_NUM		(10)
 
+// キューの実装
+#define PTHREAD_MSQ_TYPE_MUTEX		(0)		// セマフォ+ミューテックス(従来の実装)
+#define PTHREAD_MSQ_TYPE_LOCKFREE	(1)		// ロックフリーMPSCリング(受信側が待機中の時だけfutexで起こす)
+
+// メッセージの集約方法(pthread_msq_msg_send_coalesce)
+#define PTHREAD_MSQ_COALESCE_REPLACE	(-1)	// 未受信のメッセージを新しいメッセージで置き換える
+
 #define pthread_msq_msg_issender(msg) ((msg)->__sender)
+#define pthread_msq_msg_payload(msg) ((msg)->__payload)
 #ifdef __SMS_APPLE__
-#define PTHREAD_MSQ_ID_INITIALIZER(sendName,receiveName) {NULL,0,NULL,NULL,sendName,receiveName,PTHREAD_MUTEX_INITIALIZER,0,0,0,NULL}
+#define PTHREAD_MSQ_ID_INITIALIZER(sendName,receiveName) {NULL,0,NULL,NULL,sendName,receiveName,PTHREAD_MUTEX_INITIALIZER,0,0,0,NULL,PTHREAD_MSQ_TYPE_MUTEX,NULL,-1,NULL,0}
 #else
-#define PTHREAD_MSQ_ID_INITIALIZER {NULL,0,{},{},PTHREAD_MUTEX_INITIALIZER,0,0,0,NULL}
+#define PTHREAD_MSQ_ID_INITIALIZER {NULL,0,{},{},PTHREAD_MUTEX_INITIALIZER,0,0,0,NULL,PTHREAD_MSQ_TYPE_MUTEX,NULL,-1,NULL,0}
 #endif /* __SMS_APPLE__ */
 
 /**
@@ -46,6 +54,7 @@
  */
 typedef struct {
 	void *__sender;
+	void *__payload;				// 可変長データ(pthread_msq_msg_send_payload()で送信した場合のみ,それ以外はNULL)
 	size_t data[PTHREAD_MSQ_MSG_NUM];
 } pthread_msq_msg_t;
 
@@ -69,15 +78,33 @@ typedef struct msg_queue_t {
 	int fifoIndex;					// リングバッファー内のデータ取り出し位置
 	int queueNum;					// キューイング中のデータ数
 	pthread_msq_msg_t *ringBuffer;
+	int type;						// PTHREAD_MSQ_TYPE_MUTEX/PTHREAD_MSQ_TYPE_LOCKFREE
+	struct pthread_msq_lf_t *lf;	// ロックフリーキュー(PTHREAD_MSQ_TYPE_LOCKFREE)
+	int eventFd;					// 送信通知用eventfd(-1:未使用)
+	struct pthread_msq_pool_t *pool;	// 可変長データのプール(最初のpthread_msq_payload_alloc()で作成)
+	int poolBusy;					// プールを参照中の確保処理の数
 } pthread_msq_id_t;
 
+// トレース用フックに通知するイベント
+#define PTHREAD_MSQ_TRACE_SEND		(0)		// 送信(キューに格納した)
+#define PTHREAD_MSQ_TRACE_RECEIVE	(1)		// 受信(キューから取り出した)
+
+// トレース用フック(depth:送信・受信した後のキューの格納数)
+typedef void (*pthread_msq_trace_hook_t)(pthread_msq_id_t *queue, int event, const pthread_msq_msg_t *msg, int depth);
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 /* メッセージキューの作成 */
 int pthread_msq_create(pthread_msq_id_t *queue, int qsize);
+/* メッセージキューの作成(実装指定) */
+int pthread_msq_create_ex(pthread_msq_id_t *queue, int qsize, int type);
 /* メッセージ送信 */
 int pthread_msq_msg_send(pthread_msq_id_t *queue, pthread_msq_msg_t *msg, void *sender);
+/* 可変長データ付きメッセージ送信(payloadの所有権は受信側に移る) */
+int pthread_msq_msg_send_payload(pthread_msq_id_t *queue, pthread_msq_msg_t *msg, void *sender, void *payload);
+/* メッセージ送信(未受信の末尾メッセージと集約) */
+int pthread_msq_msg_send_coalesce(pthread_msq_id_t *queue, pthread_msq_msg_t *msg, void *sender, int keyNum, int sumIndex);
 /* メッセージ送信（タイムアウト指定有り）*/
 int pthread_msq_msg_timedsend(pthread_msq_id_t *queue, pthread_msq_msg_t *msg, void *sender, const struct timespec *abs_timeout);
 /* メッセージ受信 */
@@ -91,6 +118,18 @@ int pthread_msq_destroy(pthread_msq_id_t *queue);
 /* メッセージ受信を停止する */
 int pthread_msq_stop(pthread_msq_id_t *queue);		// 2021.01.25 append by T.Aikawa
 int pthread_msq_starrt(pthread_msq_id_t *queue);	// 2021.01.25 append by T.Aikawa
+/* 送信時に通知されるeventfdを取得する(poll/epollで受信を待つ場合) */
+int pthread_msq_eventfd_open(pthread_msq_id_t *queue);
+/* eventfdの通知をクリアする */
+int pthread_msq_eventfd_clear(pthread_msq_id_t *queue);
+/* 可変長データを受信側キューのプールから確保する(queueがNULLの場合はmalloc) */
+void *pthread_msq_payload_alloc(pthread_msq_id_t *queue, size_t size);
+/* 可変長データを解放する(NULLは何もしない) */
+void pthread_msq_payload_free(void *payload);
+/* 可変長データの大きさ */
+size_t pthread_msq_payload_size(const void *payload);
+/* トレース用フックを設定する(NULL:解除) */
+void pthread_msq_set_trace_hook(pthread_msq_trace_hook_t hook);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,181 @@
+/*
+ * Copyright © 2026 glview contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+// pthread_msqのベンチマーク
+// PTHREAD_MSQ_TYPE_MUTEXとPTHREAD_MSQ_TYPE_LOCKFREEのスループットと遅延を比較する
+//
+// usage: pthread_msq_bench [メッセージ数]
+
+#include <stdio.h>
+#include <string.h>
+#include "pthread_msq.h"
+
+#define BENCH_QUEUE_SIZE	(100)		// glviewのウィンドウと同じキューサイズ
+#define BENCH_PRODUCER_MAX	(8)
+
+typedef struct _bench_arg {
+	pthread_msq_id_t	*queue;
+	int					count;
+} BENCH_ARG_t;
+
+static double bench_now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((double)ts.tv_sec + (double)ts.tv_nsec / 1000000000.0);
+}
+
+static void *bench_producer(void *arg)
+{
+	BENCH_ARG_t *bench = arg;
+	pthread_msq_msg_t smsg;
+	int i;
+
+	memset(&smsg, 0, sizeof(pthread_msq_msg_t));
+	for (i = 0; i < bench->count; i++) {
+		smsg.data[0] = i;
+		pthread_msq_msg_send(bench->queue, &smsg, 0);
+	}
+	return (NULL);
+}
+
+static void *bench_latency_producer(void *arg)
+{
+	BENCH_ARG_t *bench = arg;
+	pthread_msq_msg_t smsg;
+	struct timespec ts;
+	struct timespec interval = {0, 20000};	// 受信側が待機状態に入るように間隔をあける
+	int i;
+
+	memset(&smsg, 0, sizeof(pthread_msq_msg_t));
+	for (i = 0; i < bench->count; i++) {
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		smsg.data[0] = ts.tv_sec;
+		smsg.data[1] = ts.tv_nsec;
+		pthread_msq_msg_send(bench->queue, &smsg, 0);
+		nanosleep(&interval, NULL);
+	}
+	return (NULL);
+}
+
+static int bench_queue_create(pthread_msq_id_t *queue, int type)
+{
+	pthread_msq_id_t init = PTHREAD_MSQ_ID_INITIALIZER;
+
+	memcpy(queue, &init, sizeof(pthread_msq_id_t));
+	return (pthread_msq_create_ex(queue, BENCH_QUEUE_SIZE, type));
+}
+
+// 複数スレッドから送信し、1スレッドで受信する
+static int bench_throughput(const char *name, int type, int producers, int count)
+{
+	pthread_msq_id_t queue;
+	pthread_t thread[BENCH_PRODUCER_MAX];
+	BENCH_ARG_t arg;
+	pthread_msq_msg_t rmsg;
+	double start, end;
+	int i, total;
+
+	if (bench_queue_create(&queue, type) != PTHREAD_MSQ_OK) {
+		fprintf(stderr, "pthread_msq_bench:Error: pthread_msq_create_ex() failed\n");
+		return (-1);
+	}
+	arg.queue = &queue;
+	arg.count = count / producers;
+	total = arg.count * producers;
+
+	start = bench_now();
+	for (i = 0; i < producers; i++) {
+		pthread_create(&thread[i], NULL, bench_producer, &arg);
+	}
+	for (i = 0; i < total; i++) {
+		pthread_msq_msg_receive(&queue, &rmsg);
+	}
+	end = bench_now();
+	for (i = 0; i < producers; i++) {
+		pthread_join(thread[i], NULL);
+	}
+	pthread_msq_destroy(&queue);
+
+	printf("%-8s throughput producers=%d : %10.0f msg/s (%.3f s)\n",
+		name, producers, (double)total / (end - start), end - start);
+	return (0);
+}
+
+// 送信から受信までの遅延(受信側が待機中からの起床を含む)
+static int bench_latency(const char *name, int type, int count)
+{
+	pthread_msq_id_t queue;
+	pthread_t thread;
+	BENCH_ARG_t arg;
+	pthread_msq_msg_t rmsg;
+	struct timespec ts;
+	double latency, sum = 0.0, max = 0.0;
+	int i;
+
+	if (bench_queue_create(&queue, type) != PTHREAD_MSQ_OK) {
+		fprintf(stderr, "pthread_msq_bench:Error: pthread_msq_create_ex() failed\n");
+		return (-1);
+	}
+	arg.queue = &queue;
+	arg.count = count;
+
+	pthread_create(&thread, NULL, bench_latency_producer, &arg);
+	for (i = 0; i < count; i++) {
+		pthread_msq_msg_receive(&queue, &rmsg);
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		latency = (double)(ts.tv_sec - (time_t)rmsg.data[0]) * 1000000.0
+				+ (double)(ts.tv_nsec - (long)rmsg.data[1]) / 1000.0;
+		sum += latency;
+		if (latency > max) max = latency;
+	}
+	pthread_join(thread, NULL);
+	pthread_msq_destroy(&queue);
+
+	printf("%-8s latency   : avg %8.2f us  max %8.2f us\n", name, sum / count, max);
+	return (0);
+}
+
+int main(int argc, char *argv[])
+{
+	int count = 1000000;
+	int latencyCount;
+	int producers[] = {1, 2, 4, BENCH_PRODUCER_MAX};
+	int i;
+
+	if (argc > 1) {
+		count = atoi(argv[1]);
+		if (count <= 0) count = 1000000;
+	}
+	latencyCount = count / 100;
+	if (latencyCount < 1000) latencyCount = 1000;
+
+	for (i = 0; i < (int)(sizeof(producers) / sizeof(producers[0])); i++) {
+		if (bench_throughput("mutex", PTHREAD_MSQ_TYPE_MUTEX, producers[i], count) != 0) return (1);
+		if (bench_throughput("lockfree", PTHREAD_MSQ_TYPE_LOCKFREE, producers[i], count) != 0) return (1);
+	}
+	if (bench_latency("mutex", PTHREAD_MSQ_TYPE_MUTEX, latencyCount) != 0) return (1);
+	if (bench_latency("lockfree", PTHREAD_MSQ_TYPE_LOCKFREE, latencyCount) != 0) return (1);
+
+	return (0);
+}
@@ -21,19 +21,27 @@
  * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
  * DEALINGS IN THE SOFTWARE.
  */
-
 #define _GNU_SOURCE
 
 #include <stdio.h>
 #include <time.h>
 #include <errno.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include "pthread_timer.h"
 
+// タイマーは個数の制限無し
+// 起動中のタイマーは満了時刻の最小ヒープで管理し、先頭の満了時刻までCLOCK_MONOTONICで待つ
+// (CLOCK_REALTIMEの時刻変更の影響を受けない)
+// threadId,idからの検索はidをキーとしたハッシュで行う
 
 #define PTHREAD_TIMER_STOP	(0)
 #define PTHREAD_TIMER_START	(1)
 
+#define PTHREAD_TIMER_HASH_SIZE		(64)	/* 2のべき乗 */
+#define PTHREAD_TIMER_HEAP_INIT		(16)
+#define PTHREAD_TIMER_CATCHUP_MAX	(16)	/* PTHREAD_TIMER_MISSED_CATCHUPで続けて通知する最大回数(超えた分はまとめる) */
+
 typedef struct _pthreadTimerTable {
 	pthread_t	threadId;
 	size_t		userData1;
@@ -44,37 +52,177 @@ typedef struct _pthreadTimerTable {
 	int 	active;
 	struct timespec reqWaitTime;	/* タイマーの経過待ち時間 */
 	long	reqCount;
-	struct timespec absWaitTime;	/* 絶対待ち時間　reqWaitTimeと現在時間から生成する */
+	struct timespec absWaitTime;	/* 絶対待ち時間　reqWaitTimeと現在時間から生成する(CLOCK_MONOTONIC) */
 	pthread_msq_id_t	*queue;
+	int		heapIndex;				/* ヒープ内の位置(-1:起動していない) */
+	int		policy;					/* PTHREAD_TIMER_MISSED_COALESCE/SKIP/CATCHUP */
+	int		inflight;				/* 1:通知済みで受信側が未処理(pthreadCheckTimerで0になる) */
+	long	missed;					/* 受信側が未処理のため通知しなかった回数 */
+	struct _pthreadTimerTable *hashNext;
+	struct _pthreadTimerTable *listNext;
 } PTHREADTIMERTABLE_t;
 
 static pthread_t timer_threadId;
-static sem_t timer_sem;
+static pthread_cond_t timer_cond;
 static int running=1;
-#define PTHREAD_TIMER_TABLE_MAX		(10)
-static PTHREADTIMERTABLE_t pthread_timer_table[PTHREAD_TIMER_TABLE_MAX];
+
+static PTHREADTIMERTABLE_t *pthread_timer_hash[PTHREAD_TIMER_HASH_SIZE];	/* threadId,idからの検索 */
+static PTHREADTIMERTABLE_t *pthread_timer_list = NULL;						/* 全てのタイマー */
+static PTHREADTIMERTABLE_t **pthread_timer_heap = NULL;						/* 起動中のタイマー(満了時刻の最小ヒープ) */
+static int pthread_timer_heap_num = 0;
+static int pthread_timer_heap_max = 0;
 
 /* ----------------------------------------------------------------- */
 static pthread_mutex_t pthread_timer_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 static int pthreadCalcAbsWaitTime(struct timespec *crtTime,struct timespec *reqWaitTime,struct timespec *absWaitTime)
 {
-#if 0
-	time_t tv_sec;
-	__syscall_slong_t tv_nsec;
-
-	tv_sec  = mTime / 1000;
-	tv_nsec = (mTime % 1000) * 1000000;
-#endif
-
 	absWaitTime->tv_sec  = crtTime->tv_sec + reqWaitTime->tv_sec + (crtTime->tv_nsec + reqWaitTime->tv_nsec) / 1000000000;
 	absWaitTime->tv_nsec = (crtTime->tv_nsec + reqWaitTime->tv_nsec) % 1000000000;
 	return(PTHREAD_TIMER_OK);
 }
 
+static int64_t pthreadTimeToNsec(struct timespec *t)
+{
+	return((int64_t)t->tv_sec * 1000000000 + t->tv_nsec);
+}
+
+static void pthreadAddNsec(struct timespec *t,int64_t nsec)
+{
+	nsec += t->tv_nsec;
+	t->tv_sec  += nsec / 1000000000;
+	t->tv_nsec  = nsec % 1000000000;
+}
+
+static int pthreadCompareTime(struct timespec *a,struct timespec *b)
+{
+	if(a->tv_sec != b->tv_sec){
+		return((a->tv_sec < b->tv_sec) ? -1 : 1);
+	}
+	if(a->tv_nsec != b->tv_nsec){
+		return((a->tv_nsec < b->tv_nsec) ? -1 : 1);
+	}
+	return(0);
+}
+
+/* ----------------------------------------------------------------- */
+/* ヒープ操作(pthread_timer_mutexを取得して呼び出すこと) */
+
+static void pthreadHeapSet(int index,PTHREADTIMERTABLE_t *timer)
+{
+	pthread_timer_heap[index] = timer;
+	timer->heapIndex = index;
+}
+
+static void pthreadHeapUp(int index)
+{
+	PTHREADTIMERTABLE_t *timer = pthread_timer_heap[index];
+	int parent;
+
+	while(index > 0){
+		parent = (index - 1) / 2;
+		if(pthreadCompareTime(&pthread_timer_heap[parent]->absWaitTime,&timer->absWaitTime) <= 0){
+			break;
+		}
+		pthreadHeapSet(index,pthread_timer_heap[parent]);
+		index = parent;
+	}
+	pthreadHeapSet(index,timer);
+}
+
+static void pthreadHeapDown(int index)
+{
+	PTHREADTIMERTABLE_t *timer = pthread_timer_heap[index];
+	int child;
+
+	while((child = index * 2 + 1) < pthread_timer_heap_num){
+		if((child + 1 < pthread_timer_heap_num) &&
+			(pthreadCompareTime(&pthread_timer_heap[child + 1]->absWaitTime,&pthread_timer_heap[child]->absWaitTime) < 0)){
+			child++;
+		}
+		if(pthreadCompareTime(&timer->absWaitTime,&pthread_timer_heap[child]->absWaitTime) <= 0){
+			break;
+		}
+		pthreadHeapSet(index,pthread_timer_heap[child]);
+		index = child;
+	}
+	pthreadHeapSet(index,timer);
+}
+
+static int pthreadHeapInsert(PTHREADTIMERTABLE_t *timer)
+{
+	PTHREADTIMERTABLE_t **heap;
+	int max;
+
+	if(pthread_timer_heap_num >= pthread_timer_heap_max){
+		max = (pthread_timer_heap_max == 0) ? PTHREAD_TIMER_HEAP_INIT : pthread_timer_heap_max * 2;
+		heap = realloc(pthread_timer_heap,sizeof(PTHREADTIMERTABLE_t *) * max);
+		if(heap == NULL){
+			return(PTHREAD_TIMER_ERROR);
+		}
+		pthread_timer_heap = heap;
+		pthread_timer_heap_max = max;
+	}
+	pthreadHeapSet(pthread_timer_heap_num,timer);
+	pthread_timer_heap_num++;
+	pthreadHeapUp(timer->heapIndex);
+	return(PTHREAD_TIMER_OK);
+}
+
+static void pthreadHeapRemove(PTHREADTIMERTABLE_t *timer)
+{
+	int index = timer->heapIndex;
+
+	if(index < 0){
+		return;
+	}
+	timer->heapIndex = -1;
+	pthread_timer_heap_num--;
+	if(index == pthread_timer_heap_num){
+		return;
+	}
+	pthreadHeapSet(index,pthread_timer_heap[pthread_timer_heap_num]);
+	if((index > 0) &&
+		(pthreadCompareTime(&pthread_timer_heap[index]->absWaitTime,&pthread_timer_heap[(index - 1) / 2]->absWaitTime) < 0)){
+		pthreadHeapUp(index);
+	}else{
+		pthreadHeapDown(index);
+	}
+}
+
+/* ----------------------------------------------------------------- */
+/* タイマーの検索(pthread_timer_mutexを取得して呼び出すこと) */
+
+static PTHREADTIMERTABLE_t *pthreadFindTimer(pthread_t threadId,int id)
+{
+	PTHREADTIMERTABLE_t *timer;
+
+	for(timer = pthread_timer_hash[id & (PTHREAD_TIMER_HASH_SIZE - 1)];timer != NULL;timer = timer->hashNext)
+	{
+		if((timer->id == id)&&
+			(pthread_equal(timer->threadId,threadId)))
+		{
+			return(timer);
+		}
+	}
+	return(NULL);
+}
+
+static void pthreadStopTimerEntry(PTHREADTIMERTABLE_t *timer)
+{
+	pthreadHeapRemove(timer);
+	timer->active = PTHREAD_TIMER_STOP;
+	timer->reqCount++;
+	timer->inflight = 0;
+	timer->missed = 0;
+}
+
+/* ----------------------------------------------------------------- */
+
 int pthreadCreate_uTimer(pthread_t threadId,pthread_msq_id_t *queue,size_t userData1,size_t userData2,int group,int id,int type,struct timespec *reqWaitTime)
 {
-	int i;
+	PTHREADTIMERTABLE_t *timer;
+	int hash;
 
 	if((type != PTHREAD_TIMER_ONLY_ONCE) &&
 			(type != PTHREAD_TIMER_REPEAT)){
@@ -87,51 +235,56 @@ int pthreadCreate_uTimer(pthread_t threadId,pthread_msq_id_t *queue,size_t userD
 
 	pthread_mutex_lock(&pthread_timer_mutex);
 
-	for(i=0;i<PTHREAD_TIMER_TABLE_MAX;i++)
+	timer = pthreadFindTimer(threadId,id);
+	if(timer != NULL)
 	{
-		if((pthread_timer_table[i].id == id)&&
-			(pthread_equal(pthread_timer_table[i].threadId,threadId)))
-		{
-			pthread_timer_table[i].group		= group;
-			pthread_timer_table[i].userData1	= userData1;
-			pthread_timer_table[i].userData2	= userData2;
-			pthread_timer_table[i].type			= type;
-			pthread_timer_table[i].active		= PTHREAD_TIMER_STOP;
-			pthread_timer_table[i].reqWaitTime.tv_sec	= reqWaitTime->tv_sec;
-			pthread_timer_table[i].reqWaitTime.tv_nsec	= reqWaitTime->tv_nsec;
-			pthread_timer_table[i].absWaitTime.tv_sec	= 0;
-			pthread_timer_table[i].absWaitTime.tv_nsec	= 0;
-			//printf("pthreadCreateTimer:timer reuse  [%d] \n",i);
-			pthread_mutex_unlock(&pthread_timer_mutex);
-			return(PTHREAD_TIMER_OK);
-		}
+		pthreadHeapRemove(timer);
+		timer->queue		= queue;
+		timer->group		= group;
+		timer->userData1	= userData1;
+		timer->userData2	= userData2;
+		timer->type			= type;
+		timer->active		= PTHREAD_TIMER_STOP;
+		timer->reqWaitTime.tv_sec	= reqWaitTime->tv_sec;
+		timer->reqWaitTime.tv_nsec	= reqWaitTime->tv_nsec;
+		timer->absWaitTime.tv_sec	= 0;
+		timer->absWaitTime.tv_nsec	= 0;
+		timer->inflight		= 0;
+		timer->missed		= 0;
+		//printf("pthreadCreateTimer:timer reuse  [%d] \n",id);
+		pthread_mutex_unlock(&pthread_timer_mutex);
+		return(PTHREAD_TIMER_OK);
 	}
-	for(i=0;i<PTHREAD_TIMER_TABLE_MAX;i++)
+
+	timer = calloc(1,sizeof(PTHREADTIMERTABLE_t));
+	if(timer == NULL)
 	{
-		if(pthread_timer_table[i].id == 0)
-		{
-			pthread_timer_table[i].threadId		= threadId;
-			pthread_timer_table[i].userData1	= userData1;
-			pthread_timer_table[i].userData2	= userData2;
-			pthread_timer_table[i].group		= group;
-			pthread_timer_table[i].id			= id;
-			pthread_timer_table[i].type			= type;
-			pthread_timer_table[i].active		= PTHREAD_TIMER_STOP;
-			pthread_timer_table[i].reqWaitTime.tv_sec	= reqWaitTime->tv_sec;
-			pthread_timer_table[i].reqWaitTime.tv_nsec	= reqWaitTime->tv_nsec;
-			pthread_timer_table[i].absWaitTime.tv_sec	= 0;
-			pthread_timer_table[i].absWaitTime.tv_nsec	= 0;
-			pthread_timer_table[i].queue		= queue;
-			//printf("pthreadCreateTimer:timer create [%d] \n",i);
-			pthread_mutex_unlock(&pthread_timer_mutex);
-			return(PTHREAD_TIMER_OK);
-		}
+		pthread_mutex_unlock(&pthread_timer_mutex);
+		fprintf(stderr,"pthreadCreateTimer:timer alloc error [%d] \n",id);
+		return(PTHREAD_TIMER_ERROR);
 	}
+	timer->threadId		= threadId;
+	timer->userData1	= userData1;
+	timer->userData2	= userData2;
+	timer->group		= group;
+	timer->id			= id;
+	timer->type			= type;
+	timer->active		= PTHREAD_TIMER_STOP;
+	timer->reqWaitTime.tv_sec	= reqWaitTime->tv_sec;
+	timer->reqWaitTime.tv_nsec	= reqWaitTime->tv_nsec;
+	timer->queue		= queue;
+	timer->heapIndex	= -1;
+	timer->policy		= PTHREAD_TIMER_MISSED_COALESCE;
+
+	hash = id & (PTHREAD_TIMER_HASH_SIZE - 1);
+	timer->hashNext = pthread_timer_hash[hash];
+	pthread_timer_hash[hash] = timer;
+	timer->listNext = pthread_timer_list;
+	pthread_timer_list = timer;
+	//printf("pthreadCreateTimer:timer create [%d] \n",id);
 
 	pthread_mutex_unlock(&pthread_timer_mutex);
-	fprintf(stderr,"pthreadCreateTimer:timer table over [%d] \n",i);
-	/* table over */
-	return(PTHREAD_TIMER_ERROR);
+	return(PTHREAD_TIMER_OK);
 }
 
 int pthreadCreate_mTimer(pthread_t threadId,pthread_msq_id_t *queue,size_t userData1,size_t userData2,int group,int id,int type,int mTime)
@@ -148,85 +301,105 @@ int pthreadCreate_mTimer(pthread_t threadId,pthread_msq_id_t *queue,size_t userD
 
 int pthreadStartTimer(pthread_t threadId,int id)
 {
-    static struct timespec crtTime;
-	int i;
+	struct timespec crtTime;
+	PTHREADTIMERTABLE_t *timer;
+	int rc = PTHREAD_TIMER_OK;
 
 	pthread_mutex_lock(&pthread_timer_mutex);
 
-	for(i=0;i<PTHREAD_TIMER_TABLE_MAX;i++)
+	timer = pthreadFindTimer(threadId,id);
+	if(timer != NULL)
 	{
-		if((pthread_timer_table[i].id == id)&&
-			(pthread_equal(pthread_timer_table[i].threadId,threadId)))
-		{
-			if (clock_gettime(CLOCK_REALTIME, &crtTime) == 0){
-			    pthreadCalcAbsWaitTime(&crtTime,&pthread_timer_table[i].reqWaitTime,&pthread_timer_table[i].absWaitTime);
-				pthread_timer_table[i].active = PTHREAD_TIMER_START;
-				sem_post(&timer_sem); /* タイマーの待を解除 */
+		if (clock_gettime(CLOCK_MONOTONIC, &crtTime) == 0){
+			pthreadHeapRemove(timer);
+			pthreadCalcAbsWaitTime(&crtTime,&timer->reqWaitTime,&timer->absWaitTime);
+			timer->inflight = 0;
+			timer->missed = 0;
+			rc = pthreadHeapInsert(timer);
+			if(rc == PTHREAD_TIMER_OK){
+				timer->active = PTHREAD_TIMER_START;
+				if(timer->heapIndex == 0){
+					pthread_cond_signal(&timer_cond); /* 先頭の満了時刻が変わったのでタイマーの待を解除 */
+				}
+			}else{
+				timer->active = PTHREAD_TIMER_STOP;
 			}
-			break;
 		}
 	}
 	pthread_mutex_unlock(&pthread_timer_mutex);
 
-	return(PTHREAD_TIMER_OK);
+	return(rc);
 }
 
 int pthreadStopTimer(pthread_t threadId,int id)
 {
-	int i;
+	PTHREADTIMERTABLE_t *timer;
 
 	pthread_mutex_lock(&pthread_timer_mutex);
 
-	for(i=0;i<PTHREAD_TIMER_TABLE_MAX;i++)
+	timer = pthreadFindTimer(threadId,id);
+	if(timer != NULL)
 	{
-		if((pthread_timer_table[i].id == id)&&
-			(pthread_equal(pthread_timer_table[i].threadId,threadId)))
-		{
-			pthread_timer_table[i].active = PTHREAD_TIMER_STOP;
-			pthread_timer_table[i].reqCount++;
-			pthread_mutex_unlock(&pthread_timer_mutex);
-			return(PTHREAD_TIMER_OK);
-		}
+		pthreadStopTimerEntry(timer);
 	}
 	pthread_mutex_unlock(&pthread_timer_mutex);
 	return(PTHREAD_TIMER_OK);
 }
 
+int pthreadSetMissedPolicy(pthread_t threadId,int id,int policy)
+{
+	PTHREADTIMERTABLE_t *timer;
+	int rc = PTHREAD_TIMER_ERROR;
+
+	if((policy != PTHREAD_TIMER_MISSED_COALESCE) &&
+			(policy != PTHREAD_TIMER_MISSED_SKIP) &&
+			(policy != PTHREAD_TIMER_MISSED_CATCHUP)){
+		return(PTHREAD_TIMER_ERROR);
+	}
+
+	pthread_mutex_lock(&pthread_timer_mutex);
+
+	timer = pthreadFindTimer(threadId,id);
+	if(timer != NULL)
+	{
+		timer->policy = policy;
+		rc = PTHREAD_TIMER_OK;
+	}
+	pthread_mutex_unlock(&pthread_timer_mutex);
+	return(rc);
+}
+
+/* 受信側でタイマーの通知を処理する時に呼び出す(通知済みの状態を解除する) */
 int pthreadCheckTimer(pthread_t threadId,int id,int count)
 {
-	int i;
+	PTHREADTIMERTABLE_t *timer;
+	int rc = PTHREAD_TIMER_ERROR;
 
 	pthread_mutex_lock(&pthread_timer_mutex);
 
-	for(i=0;i<PTHREAD_TIMER_TABLE_MAX;i++)
+	timer = pthreadFindTimer(threadId,id);
+	if((timer != NULL) && (timer->reqCount == count))
 	{
-		if((pthread_timer_table[i].id == id)&&
-			(pthread_equal(pthread_timer_table[i].threadId,threadId)))
-		{
-			if(pthread_timer_table[i].reqCount == count){
-				pthread_mutex_unlock(&pthread_timer_mutex);
-				return(PTHREAD_TIMER_OK);
-			}
-		}
+		timer->inflight = 0;
+		rc = PTHREAD_TIMER_OK;
 	}
 	pthread_mutex_unlock(&pthread_timer_mutex);
 
-	return(PTHREAD_TIMER_ERROR);
+	return(rc);
 }
 
 int pthreadGroupStopTimer(pthread_t threadId,int group)
 {
-	int i;
+	PTHREADTIMERTABLE_t *timer;
 
 	pthread_mutex_lock(&pthread_timer_mutex);
 
-	for(i=0;i<PTHREAD_TIMER_TABLE_MAX;i++)
+	for(timer = pthread_timer_list;timer != NULL;timer = timer->listNext)
 	{
-		if((pthread_timer_table[i].group == group)&&
-			(pthread_equal(pthread_timer_table[i].threadId,threadId)))
+		if((timer->group == group)&&
+			(pthread_equal(timer->threadId,threadId)))
 		{
-			pthread_timer_table[i].active = PTHREAD_TIMER_STOP;
-			pthread_timer_table[i].reqCount++;
+			pthreadStopTimerEntry(timer);
 		}
 	}
 	pthread_mutex_unlock(&pthread_timer_mutex);
@@ -235,16 +408,15 @@ int pthreadGroupStopTimer(pthread_t threadId,int group)
 }
 int pthreadAllStopTimer(pthread_t threadId)
 {
-	int i;
+	PTHREADTIMERTABLE_t *timer;
 
 	pthread_mutex_lock(&pthread_timer_mutex);
 
-	for(i=0;i<PTHREAD_TIMER_TABLE_MAX;i++)
+	for(timer = pthread_timer_list;timer != NULL;timer = timer->listNext)
 	{
-		if(pthread_equal(pthread_timer_table[i].threadId,threadId))
+		if(pthread_equal(timer->threadId,threadId))
 		{
-			pthread_timer_table[i].active = PTHREAD_TIMER_STOP;
-			pthread_timer_table[i].reqCount++;
+			pthreadStopTimerEntry(timer);
 		}
 	}
 	pthread_mutex_unlock(&pthread_timer_mutex);
@@ -253,180 +425,212 @@ int pthreadAllStopTimer(pthread_t threadId)
 }
 int pthreadDestroyTimer(void)
 {
+	PTHREADTIMERTABLE_t *timer;
 	int i;
 
 	pthread_mutex_lock(&pthread_timer_mutex);
 
-	for(i=0;i<PTHREAD_TIMER_TABLE_MAX;i++)
+	while(pthread_timer_list != NULL)
 	{
-		pthread_timer_table[i].id		= 0;
-		pthread_timer_table[i].active	= PTHREAD_TIMER_STOP;
-		pthread_timer_table[i].reqCount++;
+		timer = pthread_timer_list;
+		pthread_timer_list = timer->listNext;
+		free(timer);
 	}
+	for(i=0;i<PTHREAD_TIMER_HASH_SIZE;i++)
+	{
+		pthread_timer_hash[i] = NULL;
+	}
+	free(pthread_timer_heap);
+	pthread_timer_heap = NULL;
+	pthread_timer_heap_num = 0;
+	pthread_timer_heap_max = 0;
 	pthread_mutex_unlock(&pthread_timer_mutex);
 
-	sem_destroy(&timer_sem); /* セマフォを削除する */
+	pthread_cond_destroy(&timer_cond); /* 条件変数を削除する */
 	pthread_mutex_destroy(&pthread_timer_mutex); /* ミューテックスを破壊する */
 
 	return(PTHREAD_TIMER_OK);
 }
 
+/* pthread_timer_mutexを取得して呼び出すこと */
 int pthreadGetWaitAbsTime(struct timespec *absWaitTime)
 {
-	int i;
-	long min_sec,min_nsec;
-
-    clock_gettime(CLOCK_REALTIME, absWaitTime);
+	if(pthread_timer_heap_num == 0){
+		clock_gettime(CLOCK_MONOTONIC, absWaitTime);
+		absWaitTime->tv_sec += 60;
+		return(PTHREAD_TIMER_OK);
+	}
+	absWaitTime->tv_sec  = pthread_timer_heap[0]->absWaitTime.tv_sec;
+	absWaitTime->tv_nsec = pthread_timer_heap[0]->absWaitTime.tv_nsec;
+	return(PTHREAD_TIMER_OK);
+}
 
-	pthread_mutex_lock(&pthread_timer_mutex);
+/*
+ * 繰り返しタイマーの次の満了時刻を求める(pthread_timer_mutexを取得して呼び出すこと)
+ * 満了時刻は前回の満了時刻に周期を加えた時刻とし、処理の遅れを次の満了時刻に持ち越さない
+ * @retval	通知する場合は1、通知しない場合は0
+ */
+static int pthreadRepeatTimer(PTHREADTIMERTABLE_t *timer,struct timespec *crtTime,long *missed)
+{
+	int64_t period = pthreadTimeToNsec(&timer->reqWaitTime);
+	int64_t late;
+	int64_t overrun;
+
+	*missed = 0;
+	if(period <= 0){
+		pthreadCalcAbsWaitTime(crtTime,&timer->reqWaitTime,&timer->absWaitTime);
+		return(1);
+	}
 
-	min_sec  = -1;
-	min_nsec = -1;
+	/* 満了時刻を過ぎてから、さらに経過した周期の数 */
+	late = pthreadTimeToNsec(crtTime) - pthreadTimeToNsec(&timer->absWaitTime);
+	overrun = late / period;
 
-	for(i=0;i<PTHREAD_TIMER_TABLE_MAX;i++)
-	{
-		if(pthread_timer_table[i].active == PTHREAD_TIMER_START)
-		{
-			if(min_sec < 0){
-				min_sec = pthread_timer_table[i].absWaitTime.tv_sec;
-				min_nsec = pthread_timer_table[i].absWaitTime.tv_nsec;
-			}else{
-				if(min_sec > pthread_timer_table[i].absWaitTime.tv_sec){
-					min_sec = pthread_timer_table[i].absWaitTime.tv_sec;
-					min_nsec = pthread_timer_table[i].absWaitTime.tv_nsec;
-				}else if(min_sec == pthread_timer_table[i].absWaitTime.tv_sec){
-					if(min_nsec > pthread_timer_table[i].absWaitTime.tv_nsec){
-						min_nsec = pthread_timer_table[i].absWaitTime.tv_nsec;
-					}
-				}
+	switch(timer->policy){
+		case PTHREAD_TIMER_MISSED_CATCHUP:
+			/* 1周期ずつ進めて続けて通知する(遅れすぎた分はまとめる) */
+			if(overrun > PTHREAD_TIMER_CATCHUP_MAX){
+				pthreadAddNsec(&timer->absWaitTime,(overrun - PTHREAD_TIMER_CATCHUP_MAX) * period);
+				*missed = overrun - PTHREAD_TIMER_CATCHUP_MAX;
 			}
-		}
-	}
-	pthread_mutex_unlock(&pthread_timer_mutex);
-	if(min_sec == -1){
-		absWaitTime->tv_sec += 60;
-		return(PTHREAD_TIMER_OK);
+			pthreadAddNsec(&timer->absWaitTime,period);
+			return(1);
+		case PTHREAD_TIMER_MISSED_SKIP:
+			pthreadAddNsec(&timer->absWaitTime,(overrun + 1) * period);
+			if(timer->inflight == 1){
+				return(0);
+			}
+			return(1);
+		case PTHREAD_TIMER_MISSED_COALESCE:
+		default:
+			pthreadAddNsec(&timer->absWaitTime,(overrun + 1) * period);
+			if(timer->inflight == 1){
+				/* 受信側が前回の通知を未処理:次の通知にまとめる */
+				timer->missed += overrun + 1;
+				return(0);
+			}
+			*missed = timer->missed + overrun;
+			timer->missed = 0;
+			return(1);
 	}
-	absWaitTime->tv_sec  = min_sec;
-	absWaitTime->tv_nsec = min_nsec;
-	return(PTHREAD_TIMER_OK);
 }
 
+/* pthread_timer_mutexを取得して呼び出すこと(送信中は一時的に解放する) */
 void pthreadSendTime(void)
 {
-    static struct timespec crtTime;
-	pthread_msq_msg_t smsg;
+	struct timespec crtTime;
+	pthread_msq_msg_t smsg = {};
 	pthread_msq_id_t *queue;
-	int i,time_flag;
-
-	clock_gettime(CLOCK_REALTIME, &crtTime);
+	PTHREADTIMERTABLE_t *timer;
+	long missed;
+	long reqCount;
+	pthread_t threadId;
+	int id;
+	int rc;
 
-	pthread_mutex_lock(&pthread_timer_mutex);
+	clock_gettime(CLOCK_MONOTONIC, &crtTime);
 
-	for(i=0;i<PTHREAD_TIMER_TABLE_MAX;i++)
+	while((running == 1) && (pthread_timer_heap_num > 0))
 	{
-		time_flag = 0;
-		if(pthread_timer_table[i].active == PTHREAD_TIMER_START)
-		{
-			if(crtTime.tv_sec > pthread_timer_table[i].absWaitTime.tv_sec){
-				time_flag = 1;
-			}else if(crtTime.tv_sec == pthread_timer_table[i].absWaitTime.tv_sec){
-				if(crtTime.tv_nsec > pthread_timer_table[i].absWaitTime.tv_nsec){
-					time_flag = 1;
-				}
+		timer = pthread_timer_heap[0];
+		if(pthreadCompareTime(&crtTime,&timer->absWaitTime) < 0){
+			break;
+		}
+		missed = 0;
+		if(timer->type == PTHREAD_TIMER_ONLY_ONCE){
+			pthreadHeapRemove(timer);
+			timer->active = PTHREAD_TIMER_STOP;
+		}else{
+			rc = pthreadRepeatTimer(timer,&crtTime,&missed);
+			pthreadHeapDown(0);
+			if(rc == 0){
+				continue;
 			}
-			if(time_flag == 1){
-				if(pthread_timer_table[i].type == PTHREAD_TIMER_ONLY_ONCE){
-					pthread_timer_table[i].active = PTHREAD_TIMER_STOP;
-				}else{
-					pthreadCalcAbsWaitTime(&crtTime,&pthread_timer_table[i].reqWaitTime,&pthread_timer_table[i].absWaitTime);
-			    }
-				smsg.data[0] = pthread_timer_table[i].userData1;
-				smsg.data[1] = pthread_timer_table[i].userData2;
-				smsg.data[2] = pthread_timer_table[i].group;
-				smsg.data[3] = pthread_timer_table[i].id;
-				smsg.data[4] = pthread_timer_table[i].reqCount;
-				queue		 = pthread_timer_table[i].queue;
-
-				pthread_mutex_unlock(&pthread_timer_mutex);
-
-				if(queue != NULL){
-					pthread_msq_msg_send(queue,&smsg,0);
-				}
+		}
+		timer->inflight = 1;
+		smsg.data[0] = timer->userData1;
+		smsg.data[1] = timer->userData2;
+		smsg.data[2] = timer->group;
+		smsg.data[3] = timer->id;
+		smsg.data[4] = timer->reqCount;
+		smsg.data[5] = missed;
+		queue		 = timer->queue;
+		threadId	 = timer->threadId;
+		id			 = timer->id;
+		reqCount	 = timer->reqCount;
+
+		pthread_mutex_unlock(&pthread_timer_mutex);
+
+		rc = PTHREAD_MSQ_ERROR;
+		if(queue != NULL){
+			rc = pthread_msq_msg_send(queue,&smsg,0);
+		}
+
+		pthread_mutex_lock(&pthread_timer_mutex);
 
-				pthread_mutex_lock(&pthread_timer_mutex);
+		if(rc != PTHREAD_MSQ_OK){
+			/* 通知できなかった:受信側の処理待ちにしない */
+			timer = pthreadFindTimer(threadId,id);
+			if((timer != NULL) && (timer->reqCount == reqCount)){
+				timer->inflight = 0;
 			}
 		}
 	}
-	pthread_mutex_unlock(&pthread_timer_mutex);
 }
 
 void *pthreadTimerProc(void* no_arg)
 {
-    static struct timespec absWaitTime;
-    int rc;
+	struct timespec absWaitTime;
 
-	do{
-	    pthreadGetWaitAbsTime(&absWaitTime);
+	pthread_mutex_lock(&pthread_timer_mutex);
+	while(running == 1)
+	{
+		pthreadGetWaitAbsTime(&absWaitTime);
 
-	    //printf("pthreadTimerProc:sem_timedwait():call\n");
-	    while ((rc = sem_timedwait(&timer_sem, &absWaitTime)) == -1 && errno == EINTR){
-			if(running == 0){
-				//printf("pthreadTimerProc terminate.\n");
-				return(NULL);
-			}
-	        continue;       /* Restart if interrupted by handler */
-		}
+		/* 満了時刻まで、またはタイマーの再設定要求があるまで待つ */
+		pthread_cond_timedwait(&timer_cond,&pthread_timer_mutex,&absWaitTime);
 
 		if(running == 0){
-			//printf("pthreadTimerProc terminate.\n");
-			return(NULL);
+			break;
 		}
-#if 0
-	    /* Check what happened */
-	    if (rc == -1) {
-	        if (errno == ETIMEDOUT){
-	            printf("pthreadTimerProc:sem_timedwait:timed out\n");
-	        	/* タイマーに設定した時間が経過した */
-	        }else{
-	        	printf("pthreadTimerProc:sem_timedwait:error (%d)\n",errno);
-	        }
-	    } else{
-	        printf("pthreadTimerProc:sem_timedwait:succeeded\n");
-	        /* タイマーの再設定要求が発生 */
-	    }
-#endif
-	    pthreadSendTime();
-	}while(1);
+		pthreadSendTime();
+	}
+	pthread_mutex_unlock(&pthread_timer_mutex);
+	//printf("pthreadTimerProc terminate.\n");
 
 	return(NULL);
 }
 
 void pthreadInitializeTimer(void)
 {
+	pthread_condattr_t	attr;
 	int		pret = 0;
 	int		i;
 
 	pthread_mutex_init(&pthread_timer_mutex,NULL);
 
-	for(i=0;i<PTHREAD_TIMER_TABLE_MAX;i++)
+	for(i=0;i<PTHREAD_TIMER_HASH_SIZE;i++)
 	{
-		pthread_timer_table[i].threadId		= 0;
-		pthread_timer_table[i].group		= 0;
-		pthread_timer_table[i].id			= 0;
-		pthread_timer_table[i].type			= 0;
-		pthread_timer_table[i].active		= PTHREAD_TIMER_STOP;
-		pthread_timer_table[i].reqCount		= 0;
-		pthread_timer_table[i].reqWaitTime.tv_sec	= 0;
-		pthread_timer_table[i].reqWaitTime.tv_nsec	= 0;
-		pthread_timer_table[i].absWaitTime.tv_sec	= 0;
-		pthread_timer_table[i].absWaitTime.tv_nsec	= 0;
-		pthread_timer_table[i].queue		= NULL;
+		pthread_timer_hash[i] = NULL;
+	}
+	pthread_timer_list		= NULL;
+	pthread_timer_heap		= NULL;
+	pthread_timer_heap_num	= 0;
+	pthread_timer_heap_max	= 0;
+	running = 1;
+
+	pthread_condattr_init(&attr);
+	if (pthread_condattr_setclock(&attr, CLOCK_MONOTONIC) != 0){
+		fprintf(stderr,"pthreadTimeProc:Error: pthread_condattr_setclock() failed\n");
+		pthread_condattr_destroy(&attr);
+		return;
 	}
-    if (sem_init(&timer_sem, 0, 0) == -1){
-		fprintf(stderr,"pthreadTimeProc:Error: sem_init() failed\n");
-    	return;
-    }
+	if (pthread_cond_init(&timer_cond, &attr) != 0){
+		fprintf(stderr,"pthreadTimeProc:Error: pthread_cond_init() failed\n");
+		pthread_condattr_destroy(&attr);
+		return;
+	}
+	pthread_condattr_destroy(&attr);
 
 	// スレッド生成
 	pret = pthread_create(&timer_threadId, NULL, pthreadTimerProc, (void *)NULL);
@@ -443,7 +647,9 @@ void pthreadInitializeTimer(void)
 
 void pthreadTerminateTimer(void)
 {
+	pthread_mutex_lock(&pthread_timer_mutex);
 	running = 0;
-	sem_post(&timer_sem); /* タイマーの待を解除 */
+	pthread_cond_signal(&timer_cond); /* タイマーの待を解除 */
+	pthread_mutex_unlock(&pthread_timer_mutex);
 	pthread_join(timer_threadId,NULL);
 }
@@ -35,6 +35,12 @@ extern "C" {
 #define PTHREAD_TIMER_ONLY_ONCE		(1)
 #define PTHREAD_TIMER_REPEAT		(2)
 
+// 繰り返しタイマーの満了時刻に間に合わなかった場合(受信側の処理が遅れた場合)の扱い
+// 満了時刻は起動時刻からの周期で決まり、処理の遅れで後ろにずれない
+#define PTHREAD_TIMER_MISSED_COALESCE	(0)		// 1回の通知にまとめ、逃した回数をdata[5]で通知する(既定)
+#define PTHREAD_TIMER_MISSED_SKIP		(1)		// 逃した分は通知しない
+#define PTHREAD_TIMER_MISSED_CATCHUP	(2)		// 逃した分を続けて通知する
+
 #define PTHREAD_TIMER_ERROR		(0)
 #define PTHREAD_TIMER_OK		(1)
 
@@ -45,6 +51,7 @@ int pthreadCreate_uTimer(pthread_t threadId,pthread_msq_id_t *queue,size_t userD
 int pthreadCreate_mTimer(pthread_t threadId,pthread_msq_id_t *queue,size_t userData1,size_t userData2,int group,int id,int type,int mTime);
 int pthreadStartTimer(pthread_t threadId,int id);
 int pthreadStopTimer(pthread_t threadId,int id);
+int pthreadSetMissedPolicy(pthread_t threadId,int id,int policy);
 
 
 #ifdef __cplusplus